@@ -133,11 +133,13 @@ void Config::ReadValues() {
 
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
+    ReadSetting("Core", Settings::values.parallel_cpu_cores);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
     ReadSetting("Core", Settings::values.enable_custom_cpu_ticks);
     ReadSetting("Core", Settings::values.custom_cpu_ticks);
     ReadSetting("Core", Settings::values.core_downcount_hack);
     ReadSetting("Core", Settings::values.priority_boost);
+    ReadSetting("Core", Settings::values.fs_timing_profile);
 
     // Renderer
     Settings::values.use_gles = sdl2_config->GetBoolean("Renderer", "use_gles", true);
@@ -245,6 +247,7 @@ void Config::ReadValues() {
     ReadSetting("Audio", Settings::values.audio_emulation);
     ReadSetting("Audio", Settings::values.enable_audio_stretching);
     ReadSetting("Audio", Settings::values.enable_realtime_audio);
+    ReadSetting("Audio", Settings::values.polyphase_interpolation);
     ReadSetting("Audio", Settings::values.volume);
     ReadSetting("Audio", Settings::values.output_type);
     ReadSetting("Audio", Settings::values.output_device);
@@ -253,6 +256,8 @@ void Config::ReadValues() {
 
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
+    ReadSetting("Data Storage", Settings::values.cache_decompressed_code);
     ReadSetting("Data Storage", Settings::values.hide_images);
 
     // System
@@ -100,6 +100,13 @@ sustained_performance =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Execute each emulated CPU core on its own host thread (experimental, requires the JIT)
+# Only affects New 3DS titles that use the extra cores. Kernel calls are still serialized.
+# Only used with the software renderer and when no movie is recorded or played back, as the
+# timing of the cores then depends on the host and is not reproducible.
+# 0 (default): Off, 1: On
+parallel_cpu_cores =
+
 # Change the Clock Frequency of the emulated 3DS CPU.
 # Underclocking can increase the performance at the risk of freezing.
 # Overclocking may fix lagging, but at the risk of freezing.
@@ -123,6 +130,12 @@ core_downcount_hack =
 # 0 (default): Off, 1: On
 priority_boost =
 
+# How long emulated file system reads and file opens take.
+# Fast keeps the fixed cost of every request but drops the time spent transferring data and waiting
+# for other requests, which shortens loading screens. Games that time their loading can misbehave.
+# 0 (default): Accurate, 1: Fast
+fs_timing_profile =
+
 # Whether to hide 3DS camera and screenshot images from being indexed by Android
 # 0: Off (default), 1: On
 hide_images =
@@ -397,7 +410,7 @@ async_custom_loading =
 
 [Audio]
 # Whether to enable Audio DSP in HLE or LLE mode (Note: LLE mode has a heavy performance impact)
-# 0 (default): HLE, 1: LLE, 2: LLE Multithreaded
+# 0 (default): HLE, 1: LLE, 2: LLE Multithreaded, 3: HLE Multithreaded
 audio_emulation =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -410,6 +423,11 @@ enable_audio_stretching =
 # 0 (default): No, 1: Yes
 enable_realtime_audio =
 
+# Plays sources that request polyphase interpolation with a windowed-sinc filter instead of
+# linear interpolation (HLE only). Changes the audio output of most titles.
+# 0 (default): No, 1: Yes
+polyphase_interpolation =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
@@ -439,6 +457,14 @@ use_virtual_sd =
 # 1: Yes, 0 (default): No
 use_custom_storage =
 
+# Size of the cache of decrypted RomFS data, in MiB. 0 disables the cache.
+# 0 - 1024: Cache size (default: 16)
+romfs_cache_size =
+
+# Keeps decompressed game code in the cache directory so it is not decompressed on every boot
+# 0: No, 1 (default): Yes
+cache_decompressed_code =
+
 # The path of the virtual SD card directory.
 # empty (default) will use the user_path
 sdmc_directory =
@@ -929,7 +929,8 @@ JNIEXPORT jobject JNICALL Java_io_github_borked3ds_android_utils_CiaInstallWorke
     JNIEnv* env, jobject jobj, jstring jpath) {
     std::string path = GetJString(env, jpath);
     Service::AM::InstallStatus res = Service::AM::InstallCIA(
-        path, [env, jobj](std::size_t total_bytes_read, std::size_t file_size) {
+        Core::System::GetInstance(), path,
+        [env, jobj](std::size_t total_bytes_read, std::size_t file_size) {
             env->CallVoidMethod(jobj, IDCache::GetCiaInstallHelperSetProgress(),
                                 static_cast<jint>(file_size), static_cast<jint>(total_bytes_read));
         });
@@ -9,33 +9,38 @@
 #include <cstring>
 #include "audio_core/audio_types.h"
 #include "audio_core/codec.h"
+#include "common/arch.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 
+#if BORKED3DS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif BORKED3DS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::Codec {
 
-StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+void DecodeADPCM(const u8* const data, const std::size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 StereoOutput16 output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
 
     constexpr std::size_t FRAME_LEN = 8;
     constexpr std::size_t SAMPLES_PER_FRAME = 14;
-    static constexpr std::array<int, 16> SIGNED_NIBBLES{
-        0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1,
-    };
 
-    const std::size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
+    // Samples are decoded in pairs, so for an odd sample count the nibble following the last
+    // sample is decoded as well.
+    const std::size_t decoded_count = ADPCMDecodedSize(sample_count);
+    ASSERT(output.size() >= decoded_count);
 
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+    const u8* frame = data;
+    for (std::size_t outputi = 0; outputi < decoded_count; frame += FRAME_LEN) {
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -43,85 +48,129 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const std::size_t sample_count,
         const int coef1 = adpcm_coeff[idx * 2 + 0];
         const int coef2 = adpcm_coeff[idx * 2 + 1];
 
-        // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
-            const int xn = nibble * scale;
-            // We first transform everything into 11 bit fixed point, perform the second order
-            // digital filter, then transform back.
-            // 0x400 == 0.5 in 11 bit fixed point.
-            // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
-            int val = ((xn << 11) + 0x400 + coef1 * yn1 + coef2 * yn2) >> 11;
-            // Clamp to output range.
-            val = std::clamp(val, -32768, 32767);
-            // Advance output feedback.
+        const std::size_t frame_samples = std::min(SAMPLES_PER_FRAME, decoded_count - outputi);
+
+        // Unpack the frame up front, so that only the filter recursion is left in the loop below.
+        // We first transform everything into 11 bit fixed point, perform the second order
+        // digital filter, then transform back.
+        // 0x400 == 0.5 in 11 bit fixed point.
+        std::array<int, SAMPLES_PER_FRAME> xn;
+        for (std::size_t i = 0; i < frame_samples; i += 2) {
+            const s8 nibbles = static_cast<s8>(frame[1 + i / 2]);
+            xn[i + 0] = (((nibbles >> 4) * scale) << 11) + 0x400;
+            xn[i + 1] = (((static_cast<s8>(nibbles << 4) >> 4) * scale) << 11) + 0x400;
+        }
+
+        // Filter: y[n] = x[n] + 0.5 + c1 * y[n-1] + c2 * y[n-2]
+        for (std::size_t i = 0; i < frame_samples; i++) {
+            const int val = std::clamp((xn[i] + coef1 * yn1 + coef2 * yn2) >> 11, -32768, 32767);
             yn2 = yn1;
             yn1 = val;
-            return (s16)val;
-        };
-
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+            output[outputi + i].fill(static_cast<s16>(val));
         }
+
+        outputi += frame_samples;
     }
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                StereoOutput16 output) {
     ASSERT(num_channels == 1 || num_channels == 2);
+    ASSERT(output.size() >= sample_count);
 
     const auto decode_sample = [](u8 sample) {
         return static_cast<s16>(static_cast<u16>(sample) << 8);
     };
 
-    StereoBuffer16 ret(sample_count);
+    // Number of input bytes, and the bytes handled per vector iteration.
+    const std::size_t size = sample_count * num_channels;
+    constexpr std::size_t block = 16;
+    [[maybe_unused]] std::size_t i = 0;
+    auto* const out = reinterpret_cast<s16*>(output.data());
+
+#if BORKED3DS_ARCH(x86_64)
+    // Unpacking against zero widens each byte into the upper half of a 16-bit lane.
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + block <= size; i += block) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i lo = _mm_unpacklo_epi8(zero, in);
+        const __m128i hi = _mm_unpackhi_epi8(zero, in);
+        if (num_channels == 1) {
+            auto* const dest = reinterpret_cast<__m128i*>(out + i * 2);
+            _mm_storeu_si128(dest + 0, _mm_unpacklo_epi16(lo, lo));
+            _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(lo, lo));
+            _mm_storeu_si128(dest + 2, _mm_unpacklo_epi16(hi, hi));
+            _mm_storeu_si128(dest + 3, _mm_unpackhi_epi16(hi, hi));
+        } else {
+            auto* const dest = reinterpret_cast<__m128i*>(out + i);
+            _mm_storeu_si128(dest + 0, lo);
+            _mm_storeu_si128(dest + 1, hi);
+        }
+    }
+#elif BORKED3DS_ARCH(arm64)
+    for (; i + block <= size; i += block) {
+        const uint8x16_t in = vld1q_u8(data + i);
+        const int16x8_t lo = vreinterpretq_s16_u16(vshll_n_u8(vget_low_u8(in), 8));
+        const int16x8_t hi = vreinterpretq_s16_u16(vshll_high_n_u8(in, 8));
+        if (num_channels == 1) {
+            vst2q_s16(out + i * 2, (int16x8x2_t{lo, lo}));
+            vst2q_s16(out + i * 2 + 16, (int16x8x2_t{hi, hi}));
+        } else {
+            vst1q_s16(out + i, lo);
+            vst1q_s16(out + i + 8, hi);
+        }
+    }
+#endif
 
     if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(decode_sample(data[i]));
+        for (std::size_t samplei = i; samplei < sample_count; samplei++) {
+            output[samplei].fill(decode_sample(data[samplei]));
         }
     } else {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = decode_sample(data[i * 2 + 0]);
-            ret[i][1] = decode_sample(data[i * 2 + 1]);
+        for (std::size_t samplei = i / 2; samplei < sample_count; samplei++) {
+            output[samplei][0] = decode_sample(data[samplei * 2 + 0]);
+            output[samplei][1] = decode_sample(data[samplei * 2 + 1]);
         }
     }
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                 StereoOutput16 output) {
     ASSERT(num_channels == 1 || num_channels == 2);
+    ASSERT(output.size() >= sample_count);
 
-    StereoBuffer16 ret(sample_count);
+    if (num_channels == 2) {
+        // Interleaved stereo is already in the output format.
+        std::memcpy(output.data(), data, sample_count * sizeof(output[0]));
+        return;
+    }
 
-    if (num_channels == 1) {
-        for (std::size_t i = 0; i < sample_count; i++) {
-            s16 sample;
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
-        }
-    } else {
-        for (std::size_t i = 0; i < sample_count; ++i) {
-            std::memcpy(&ret[i], data + i * sizeof(s16) * 2, 2 * sizeof(s16));
-        }
+    // Number of samples handled per vector iteration.
+    constexpr std::size_t block = 8;
+    [[maybe_unused]] std::size_t i = 0;
+    auto* const out = reinterpret_cast<s16*>(output.data());
+
+#if BORKED3DS_ARCH(x86_64)
+    for (; i + block <= sample_count; i += block) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 2));
+        auto* const dest = reinterpret_cast<__m128i*>(out + i * 2);
+        _mm_storeu_si128(dest + 0, _mm_unpacklo_epi16(in, in));
+        _mm_storeu_si128(dest + 1, _mm_unpackhi_epi16(in, in));
     }
+#elif BORKED3DS_ARCH(arm64)
+    for (; i + block <= sample_count; i += block) {
+        const int16x8_t in = vreinterpretq_s16_u8(vld1q_u8(data + i * 2));
+        vst2q_s16(out + i * 2, (int16x8x2_t{in, in}));
+    }
+#endif
 
-    return ret;
+    for (; i < sample_count; i++) {
+        s16 sample;
+        std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
+        output[i].fill(sample);
+    }
 }
 } // namespace AudioCore::Codec
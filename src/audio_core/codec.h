@@ -6,6 +6,8 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <span>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
@@ -17,33 +19,56 @@ struct ADPCMState {
     // required for ADPCM decoding
     s16 yn1; ///< y[n-1]
     s16 yn2; ///< y[n-2]
+
+    bool operator==(const ADPCMState&) const = default;
 };
 
+/// Decoded stereo samples are written to a span of this type.
+using StereoOutput16 = std::span<std::array<s16, 2>>;
+
+/// Number of samples DecodeADPCM produces for a buffer of sample_count samples. ADPCM samples are
+/// decoded in pairs, so an odd sample count is rounded up.
+constexpr std::size_t ADPCMDecodedSize(std::size_t sample_count) {
+    return sample_count % 2 == 0 ? sample_count : sample_count + 1;
+}
+
+/// Number of bytes DecodeADPCM reads for a buffer of sample_count samples. Every frame is 8 bytes:
+/// a header byte followed by 14 samples.
+constexpr std::size_t ADPCMInputSize(std::size_t sample_count) {
+    const std::size_t decoded_count = ADPCMDecodedSize(sample_count);
+    const std::size_t partial_samples = decoded_count % 14;
+    return decoded_count / 14 * 8 + (partial_samples == 0 ? 0 : 1 + partial_samples / 2);
+}
+
 /**
  * @param data Pointer to buffer that contains ADPCM data to decode
  * @param sample_count Length of buffer in terms of number of samples
  * @param adpcm_coeff ADPCM coefficients
  * @param state ADPCM state, this is updated with new state
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data, must hold at least
+ *               ADPCMDecodedSize(sample_count) samples
  */
-StereoBuffer16 DecodeADPCM(const u8* data, const std::size_t sample_count,
-                           const std::array<s16, 16>& adpcm_coeff, ADPCMState& state);
+void DecodeADPCM(const u8* data, const std::size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state, StereoOutput16 output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM8 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data, must hold at least sample_count
+ *               samples
  */
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const std::size_t sample_count);
+void DecodePCM8(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                StereoOutput16 output);
 
 /**
  * @param num_channels Number of channels
  * @param data Pointer to buffer that contains PCM16 data to decode
  * @param sample_count Length of buffer in terms of number of samples
- * @return Decoded stereo signed PCM16 data, sample_count in length
+ * @param output Receives the decoded stereo signed PCM16 data, must hold at least sample_count
+ *               samples
  */
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const std::size_t sample_count);
+void DecodePCM16(const unsigned num_channels, const u8* const data, const std::size_t sample_count,
+                 StereoOutput16 output);
+
 } // namespace AudioCore::Codec
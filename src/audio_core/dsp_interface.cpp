@@ -3,7 +3,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
@@ -23,9 +26,15 @@ void DspInterface::SetSink(AudioCore::SinkType sink_type, std::string_view audio
     sink.reset();
 
     sink = AudioCore::GetSinkDetails(sink_type).create_sink(audio_device);
+    // The callback state must be ready before the sink can start calling into it.
+    realtime_sink = sink->IsRealTime();
+    sink_sample_rate = sink->GetNativeSampleRate();
+    time_stretcher.SetOutputSampleRate(sink_sample_rate);
+    latency_controller.SetSampleRate(sink_sample_rate);
+    scratch_begin = scratch_end = 0;
+    resample_position = 1.0;
     sink->SetCallback(
         [this](s16* buffer, std::size_t num_frames) { OutputCallback(buffer, num_frames); });
-    time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
 }
 
 Sink& DspInterface::GetSink() {
@@ -37,12 +46,37 @@ void DspInterface::EnableStretching(bool enable) {
     enable_time_stretching = enable;
 }
 
+AudioOutputStats DspInterface::GetOutputStats() const {
+    return {
+        .underruns = underrun_count.load(std::memory_order_relaxed),
+        .dropped_frames = dropped_frames.load(std::memory_order_relaxed),
+        .fill_level = last_fill_level.load(std::memory_order_relaxed),
+        .target_level = last_target_level.load(std::memory_order_relaxed),
+        .correction_ratio = last_correction_ratio.load(std::memory_order_relaxed),
+        .time_stretching = performing_time_stretching.load(std::memory_order_relaxed),
+    };
+}
+
+void DspInterface::PushFrames(const std::array<s16, 2>* frames, std::size_t count) {
+    if (!realtime_sink) {
+        // Offline sinks take the output exactly as generated, without any latency control.
+        sink->PushSamples({frames, count});
+        return;
+    }
+
+    frames_received.fetch_add(count, std::memory_order_relaxed);
+    const std::size_t pushed = fifo.Push(frames, count);
+    if (pushed < count) {
+        dropped_frames.fetch_add(count - pushed, std::memory_order_relaxed);
+    }
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink) {
         return;
     }
 
-    fifo.Push(frame.data(), frame.size());
+    PushFrames(frame.data(), frame.size());
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -55,7 +89,7 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
     }
 
-    fifo.Push(&sample, 1);
+    PushFrames(&sample, 1);
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -63,21 +97,89 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
     }
 }
 
+bool DspInterface::ShouldStretch(std::size_t num_frames) {
+    // Compare how much audio the emulated DSP produced against how much was played over the last
+    // half second. This tracks emulation speed without touching PerfStats and its mutex from the
+    // real-time audio thread. The sink plays at its own rate, which need not be the DSP's.
+    const std::size_t window = sink_sample_rate / 2;
+    speed_window_played += num_frames;
+    if (speed_window_played >= window) {
+        const u64 received = frames_received.load(std::memory_order_relaxed);
+        const double played = static_cast<double>(speed_window_played) * native_sample_rate /
+                              static_cast<double>(sink_sample_rate);
+        const double speed = static_cast<double>(received - speed_window_received) / played;
+        emulation_slow = speed <= 0.95;
+        speed_window_received = received;
+        speed_window_played = 0;
+    }
+    return enable_time_stretching && emulation_slow;
+}
+
+bool DspInterface::ReadInputFrame(std::array<s16, 2>& frame, std::size_t frames_wanted) {
+    if (scratch_begin == scratch_end) {
+        scratch_begin = 0;
+        scratch_end = fifo.Pop(scratch.data(), std::min(frames_wanted, scratch.size()));
+        if (scratch_end == 0) {
+            return false;
+        }
+    }
+    frame = scratch[scratch_begin++];
+    return true;
+}
+
+std::size_t DspInterface::ResampleOutput(s16* buffer, std::size_t num_frames, double ratio) {
+    // Pop roughly what this callback will consume in one go rather than frame by frame.
+    const auto frames_wanted =
+        static_cast<std::size_t>(std::ceil(static_cast<double>(num_frames) * ratio)) + 1;
+
+    for (std::size_t i = 0; i < num_frames; i++) {
+        while (resample_position >= 1.0) {
+            std::array<s16, 2> frame;
+            if (!ReadInputFrame(frame, frames_wanted)) {
+                return i;
+            }
+            resample_current = resample_next;
+            resample_next = frame;
+            resample_position -= 1.0;
+        }
+
+        // Linear interpolation with a 15 bit fraction, so the product fits into 32 bits.
+        const s32 fraction = static_cast<s32>(resample_position * 0x8000);
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s32 current = resample_current[channel];
+            const s32 delta = resample_next[channel] - current;
+            buffer[i * 2 + channel] = static_cast<s16>(current + ((delta * fraction) >> 15));
+        }
+        resample_position += ratio;
+    }
+    return num_frames;
+}
+
+std::size_t DspInterface::StretchOutput(s16* buffer, std::size_t num_frames) {
+    // The stretcher keeps its own backlog, so hand it everything that is buffered.
+    std::copy(scratch.begin() + scratch_begin, scratch.begin() + scratch_end, scratch.begin());
+    scratch_end -= scratch_begin;
+    scratch_end += fifo.Pop(scratch.data() + scratch_end, scratch.size() - scratch_end);
+    const std::size_t num_in = scratch_end;
+    scratch_begin = scratch_end = 0;
+    return time_stretcher.Process(reinterpret_cast<const s16*>(scratch.data()), num_in, buffer,
+                                  num_frames);
+}
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
-    // Determine if we should stretch based on the current emulation speed.
-    const auto perf_stats = system.GetLastPerfStats();
-    const auto should_stretch = enable_time_stretching && perf_stats.emulation_speed <= 95;
+    const bool should_stretch = ShouldStretch(num_frames);
     if (performing_time_stretching && !should_stretch) {
         // If we just stopped stretching, flush the stretcher before returning to normal output.
         flushing_time_stretcher = true;
     }
     performing_time_stretching = should_stretch;
 
+    const std::size_t fill_level = fifo.Size() + (scratch_end - scratch_begin);
+    last_fill_level.store(fill_level, std::memory_order_relaxed);
+
     std::size_t frames_written = 0;
     if (performing_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
+        frames_written = StretchOutput(buffer, num_frames);
     } else {
         if (flushing_time_stretcher) {
             time_stretcher.Flush();
@@ -87,8 +189,29 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
             // Make sure any frames that did not fit are cleared from the time stretcher,
             // so that they do not bleed into the next time the stretcher is enabled.
             time_stretcher.Clear();
+
+            // Resume resampling from the stretcher's output rather than from stale input.
+            resample_next = last_frame;
+            resample_position = 1.0;
         }
-        frames_written += fifo.Pop(buffer, num_frames - frames_written);
+
+        const std::size_t remaining = num_frames - frames_written;
+        const double ratio = latency_controller.Update(fill_level, remaining);
+        const std::size_t resampled =
+            ResampleOutput(buffer + 2 * frames_written, remaining, ratio);
+        frames_written += resampled;
+
+        // Running dry part way through is an underrun. Getting nothing at all means emulation
+        // is paused or not producing audio, which more latency would not help with.
+        if (resampled > 0 && resampled < remaining) {
+            latency_controller.ReportUnderrun();
+        }
+        last_target_level.store(latency_controller.GetTargetLevel(), std::memory_order_relaxed);
+        last_correction_ratio.store(ratio, std::memory_order_relaxed);
+    }
+
+    if (frames_written > 0 && frames_written < num_frames) {
+        underrun_count.fetch_add(1, std::memory_order_relaxed);
     }
 
     if (frames_written > 0) {
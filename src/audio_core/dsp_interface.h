@@ -5,10 +5,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <span>
 #include <boost/serialization/access.hpp>
 #include "audio_core/audio_types.h"
+#include "audio_core/latency_controller.h"
 #include "audio_core/time_stretch.h"
 #include "common/common_types.h"
 #include "common/ring_buffer.h"
@@ -27,6 +29,22 @@ namespace AudioCore {
 class Sink;
 enum class SinkType : u32;
 
+/// Snapshot of the audio output queue, safe to read from any thread.
+struct AudioOutputStats {
+    /// Callbacks that ran out of audio and had to pad with the last frame.
+    u64 underruns = 0;
+    /// Frames dropped because the output queue was full.
+    u64 dropped_frames = 0;
+    /// Frames buffered at the start of the last callback.
+    std::size_t fill_level = 0;
+    /// Fill level the latency controller is steering towards.
+    std::size_t target_level = 0;
+    /// Input frames consumed per output frame; 1.0 means no correction.
+    double correction_ratio = 1.0;
+    /// Whether the output is currently being time stretched.
+    bool time_stretching = false;
+};
+
 class DspInterface {
 public:
     DspInterface(Core::System& system_);
@@ -106,24 +124,62 @@ public:
     Sink& GetSink();
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
+    /// Get statistics about the audio output queue
+    [[nodiscard]] AudioOutputStats GetOutputStats() const;
 
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
 
 private:
-    void FlushResidualStretcherAudio();
+    static constexpr std::size_t fifo_capacity = 0x2000;
+
+    void PushFrames(const std::array<s16, 2>* frames, std::size_t count);
     void OutputCallback(s16* buffer, std::size_t num_frames);
+    /// Decides whether to time stretch from how fast audio arrives relative to playback.
+    bool ShouldStretch(std::size_t num_frames);
+    /// Fills `buffer` from the fifo, resampled by the latency controller's ratio.
+    std::size_t ResampleOutput(s16* buffer, std::size_t num_frames, double ratio);
+    std::size_t StretchOutput(s16* buffer, std::size_t num_frames);
+    /// Reads the next input frame, refilling the scratch buffer from the fifo when needed.
+    bool ReadInputFrame(std::array<s16, 2>& frame, std::size_t frames_wanted);
 
     Core::System& system;
 
     std::atomic<bool> enable_time_stretching = false;
     std::atomic<bool> performing_time_stretching = false;
-    std::atomic<bool> flushing_time_stretcher = false;
-    Common::RingBuffer<s16, 0x2000, 2> fifo;
+    bool flushing_time_stretcher = false;
+    bool emulation_slow = false;
+    Common::MPSCRingBuffer<s16, fifo_capacity, 2> fifo;
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
+    bool realtime_sink = true;
+    /// Rate the sink plays at, in frames per second.
+    unsigned int sink_sample_rate = native_sample_rate;
+
+    // State below is owned by the audio callback thread. Nothing in it allocates or locks.
+    LatencyController latency_controller{fifo_capacity * 3 / 4};
+    /// Frames popped from the fifo but not yet consumed.
+    std::array<std::array<s16, 2>, fifo_capacity> scratch{};
+    std::size_t scratch_begin = 0;
+    std::size_t scratch_end = 0;
+    /// Linear interpolation state: the output lies `resample_position` of the way from
+    /// `resample_current` to `resample_next`.
+    std::array<s16, 2> resample_current{};
+    std::array<s16, 2> resample_next{};
+    double resample_position = 1.0;
+    /// Emulation speed estimate, measured as audio received versus audio played.
+    u64 speed_window_received = 0;
+    std::size_t speed_window_played = 0;
+
+    /// Frames handed to OutputFrame/OutputSample, including dropped ones.
+    std::atomic<u64> frames_received = 0;
+    std::atomic<u64> underrun_count = 0;
+    std::atomic<u64> dropped_frames = 0;
+    std::atomic<std::size_t> last_fill_level = 0;
+    std::atomic<std::size_t> last_target_level = 0;
+    std::atomic<double> last_correction_ratio = 1.0;
 
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {}
@@ -0,0 +1,429 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "audio_core/file_sink.h"
+#include "audio_core/stage_timings.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr u32 num_channels = 2;
+constexpr u32 bits_per_sample = 16;
+
+template <typename T>
+void PutLE(u8* out, T value) {
+    for (std::size_t i = 0; i < sizeof(T); i++) {
+        out[i] = static_cast<u8>(value >> (i * 8));
+    }
+}
+
+class WavEncoder final : public FileSink::Encoder {
+public:
+    explicit WavEncoder(FileUtil::IOFile file_) : file(std::move(file_)) {
+        WriteHeader();
+    }
+
+    void Write(std::span<const std::array<s16, 2>> samples) override {
+        for (const auto& sample : samples) {
+            std::array<u8, 4> bytes;
+            PutLE(bytes.data(), static_cast<u16>(sample[0]));
+            PutLE(bytes.data() + 2, static_cast<u16>(sample[1]));
+            buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+        }
+        data_size += samples.size() * bytes_per_frame;
+        if (buffer.size() >= flush_threshold) {
+            Flush();
+        }
+    }
+
+    void Finish() override {
+        Flush();
+        file.Seek(0, SEEK_SET);
+        WriteHeader();
+        file.Close();
+    }
+
+private:
+    static constexpr u32 bytes_per_frame = num_channels * bits_per_sample / 8;
+    static constexpr std::size_t flush_threshold = 64 * 1024;
+
+    void WriteHeader() {
+        // Sizes are capped rather than wrapped if the file outgrows what RIFF can describe.
+        const auto data_bytes = static_cast<u32>(std::min<u64>(data_size, 0xFFFFFFFFU - 36));
+
+        std::array<u8, 44> header{};
+        std::memcpy(header.data(), "RIFF", 4);
+        PutLE<u32>(header.data() + 4, 36 + data_bytes);
+        std::memcpy(header.data() + 8, "WAVEfmt ", 8);
+        PutLE<u32>(header.data() + 16, 16);
+        PutLE<u16>(header.data() + 20, 1); // PCM
+        PutLE<u16>(header.data() + 22, num_channels);
+        PutLE<u32>(header.data() + 24, native_sample_rate);
+        PutLE<u32>(header.data() + 28, native_sample_rate * bytes_per_frame);
+        PutLE<u16>(header.data() + 32, bytes_per_frame);
+        PutLE<u16>(header.data() + 34, bits_per_sample);
+        std::memcpy(header.data() + 36, "data", 4);
+        PutLE<u32>(header.data() + 40, data_bytes);
+        file.WriteBytes(header.data(), header.size());
+    }
+
+    void Flush() {
+        file.WriteBytes(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+    FileUtil::IOFile file;
+    std::vector<u8> buffer;
+    u64 data_size = 0;
+};
+
+/// MSB-first bit writer, as used throughout the FLAC bitstream.
+class BitWriter {
+public:
+    void Write(u32 value, u32 bits) {
+        if (bits == 0) {
+            return;
+        }
+        accumulator = (accumulator << bits) | (value & (0xFFFFFFFFU >> (32 - bits)));
+        accumulator_bits += bits;
+        while (accumulator_bits >= 8) {
+            accumulator_bits -= 8;
+            bytes.push_back(static_cast<u8>(accumulator >> accumulator_bits));
+        }
+    }
+
+    /// Writes `zeros` zero bits followed by a one.
+    void WriteUnary(u32 zeros) {
+        for (; zeros >= 32; zeros -= 32) {
+            Write(0, 32);
+        }
+        Write(1, zeros + 1);
+    }
+
+    void AlignToByte() {
+        if (accumulator_bits != 0) {
+            Write(0, 8 - accumulator_bits);
+        }
+    }
+
+    void Clear() {
+        bytes.clear();
+        accumulator = 0;
+        accumulator_bits = 0;
+    }
+
+    [[nodiscard]] const std::vector<u8>& Bytes() const {
+        return bytes;
+    }
+
+private:
+    std::vector<u8> bytes;
+    u64 accumulator = 0;
+    u32 accumulator_bits = 0;
+};
+
+u8 Crc8(std::span<const u8> data) {
+    u8 crc = 0;
+    for (const u8 byte : data) {
+        crc ^= byte;
+        for (int i = 0; i < 8; i++) {
+            crc = static_cast<u8>((crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+u16 Crc16(std::span<const u8> data) {
+    u16 crc = 0;
+    for (const u8 byte : data) {
+        crc ^= static_cast<u16>(byte << 8);
+        for (int i = 0; i < 8; i++) {
+            crc = static_cast<u16>((crc & 0x8000) != 0 ? (crc << 1) ^ 0x8005 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Minimal FLAC encoder: fixed-size blocks, independent channels and the fixed polynomial
+ * predictors with a single Rice partition. That is enough compression for a render target,
+ * without depending on libFLAC.
+ */
+class FlacEncoder final : public FileSink::Encoder {
+public:
+    explicit FlacEncoder(FileUtil::IOFile file_) : file(std::move(file_)) {
+        WriteStreamInfo();
+        block.reserve(block_size);
+    }
+
+    void Write(std::span<const std::array<s16, 2>> samples) override {
+        while (!samples.empty()) {
+            const std::size_t count = std::min(samples.size(), block_size - block.size());
+            block.insert(block.end(), samples.begin(), samples.begin() + count);
+            samples = samples.subspan(count);
+            if (block.size() == block_size) {
+                EncodeFrame();
+            }
+        }
+    }
+
+    void Finish() override {
+        if (!block.empty()) {
+            EncodeFrame();
+        }
+        file.Seek(0, SEEK_SET);
+        WriteStreamInfo();
+        file.Close();
+    }
+
+private:
+    static constexpr std::size_t block_size = 4096;
+    static constexpr u32 max_fixed_order = 4;
+    static constexpr u32 max_rice_parameter = 14;
+
+    void WriteStreamInfo() {
+        BitWriter writer;
+        for (const char c : {'f', 'L', 'a', 'C'}) {
+            writer.Write(static_cast<u8>(c), 8);
+        }
+        writer.Write(1, 1);  // Last metadata block
+        writer.Write(0, 7);  // STREAMINFO
+        writer.Write(34, 24);
+        writer.Write(block_size, 16);
+        writer.Write(block_size, 16);
+        writer.Write(0, 24); // Minimum frame size unknown
+        writer.Write(0, 24); // Maximum frame size unknown
+        writer.Write(native_sample_rate, 20);
+        writer.Write(num_channels - 1, 3);
+        writer.Write(bits_per_sample - 1, 5);
+        writer.Write(static_cast<u32>(total_samples >> 32), 4);
+        writer.Write(static_cast<u32>(total_samples), 32);
+        for (int i = 0; i < 4; i++) {
+            writer.Write(0, 32); // MD5 of the audio not computed
+        }
+        file.WriteBytes(writer.Bytes().data(), writer.Bytes().size());
+    }
+
+    void EncodeFrame() {
+        writer.Clear();
+
+        const bool full_block = block.size() == block_size;
+        writer.Write(0xFFF8, 16);               // Sync code, fixed block size stream
+        writer.Write(full_block ? 0xC : 0x7, 4); // 4096 samples, or 16 bit size at end of header
+        writer.Write(0x0, 4);                    // Sample rate from STREAMINFO
+        writer.Write(0x1, 4);                    // Left, right
+        writer.Write(0x4, 3);                    // 16 bits per sample
+        writer.Write(0, 1);
+        WriteFrameNumber(frame_number);
+        if (!full_block) {
+            writer.Write(static_cast<u32>(block.size() - 1), 16);
+        }
+        writer.Write(Crc8(writer.Bytes()), 8);
+
+        for (std::size_t channel = 0; channel < num_channels; channel++) {
+            samples.resize(block.size());
+            for (std::size_t i = 0; i < block.size(); i++) {
+                samples[i] = block[i][channel];
+            }
+            EncodeSubframe();
+        }
+
+        writer.AlignToByte();
+        writer.Write(Crc16(writer.Bytes()), 16);
+        file.WriteBytes(writer.Bytes().data(), writer.Bytes().size());
+
+        total_samples += block.size();
+        frame_number++;
+        block.clear();
+    }
+
+    /// Frame numbers use the same variable length coding as UTF-8.
+    void WriteFrameNumber(u32 number) {
+        if (number < 0x80) {
+            writer.Write(number, 8);
+            return;
+        }
+        u32 continuation_bytes = 1;
+        while (continuation_bytes < 5 && number >= (1U << (5 * continuation_bytes + 6))) {
+            continuation_bytes++;
+        }
+        const u32 lead_marker = (0xFF00U >> (continuation_bytes + 1)) & 0xFF;
+        writer.Write(lead_marker | (number >> (6 * continuation_bytes)), 8);
+        for (u32 i = continuation_bytes; i-- > 0;) {
+            writer.Write(0x80 | ((number >> (6 * i)) & 0x3F), 8);
+        }
+    }
+
+    void EncodeSubframe() {
+        const std::size_t count = samples.size();
+        if (std::all_of(samples.begin(), samples.end(), [&](s32 s) { return s == samples[0]; })) {
+            writer.Write(0x00, 8); // CONSTANT
+            writer.Write(static_cast<u32>(samples[0]), bits_per_sample);
+            return;
+        }
+
+        // Pick the fixed predictor with the smallest residual.
+        const u32 max_order = std::min<u32>(max_fixed_order, static_cast<u32>(count - 1));
+        u32 best_order = 0;
+        u64 best_sum = ~u64{0};
+        for (u32 order = 0; order <= max_order; order++) {
+            ComputeResidual(order);
+            u64 sum = 0;
+            for (const u32 value : residual) {
+                sum += value;
+            }
+            if (sum < best_sum) {
+                best_sum = sum;
+                best_order = order;
+            }
+        }
+        ComputeResidual(best_order);
+
+        u32 best_parameter = 0;
+        u64 best_bits = ~u64{0};
+        for (u32 parameter = 0; parameter <= max_rice_parameter; parameter++) {
+            u64 bits = residual.size() * (parameter + 1);
+            for (const u32 value : residual) {
+                bits += value >> parameter;
+            }
+            if (bits < best_bits) {
+                best_bits = bits;
+                best_parameter = parameter;
+            }
+        }
+
+        if (best_bits >= static_cast<u64>(count - best_order) * bits_per_sample) {
+            writer.Write(0x02, 8); // VERBATIM
+            for (const s32 sample : samples) {
+                writer.Write(static_cast<u32>(sample), bits_per_sample);
+            }
+            return;
+        }
+
+        writer.Write((0x08 | best_order) << 1, 8); // FIXED
+        for (u32 i = 0; i < best_order; i++) {
+            writer.Write(static_cast<u32>(samples[i]), bits_per_sample);
+        }
+        writer.Write(0, 2); // Rice coding with 4 bit parameters
+        writer.Write(0, 4); // Single partition
+        writer.Write(best_parameter, 4);
+        for (const u32 value : residual) {
+            writer.WriteUnary(value >> best_parameter);
+            writer.Write(value, best_parameter);
+        }
+    }
+
+    /// Fills `residual` with the zigzag encoded prediction error of a fixed predictor.
+    void ComputeResidual(u32 order) {
+        residual.clear();
+        for (std::size_t i = order; i < samples.size(); i++) {
+            const s32* x = samples.data() + i;
+            s32 error;
+            switch (order) {
+            case 0:
+                error = x[0];
+                break;
+            case 1:
+                error = x[0] - x[-1];
+                break;
+            case 2:
+                error = x[0] - 2 * x[-1] + x[-2];
+                break;
+            case 3:
+                error = x[0] - 3 * x[-1] + 3 * x[-2] - x[-3];
+                break;
+            default:
+                error = x[0] - 4 * x[-1] + 6 * x[-2] - 4 * x[-3] + x[-4];
+                break;
+            }
+            residual.push_back((static_cast<u32>(error) << 1) ^ static_cast<u32>(error >> 31));
+        }
+    }
+
+    FileUtil::IOFile file;
+    BitWriter writer;
+    std::vector<std::array<s16, 2>> block;
+    std::vector<s32> samples;
+    std::vector<u32> residual;
+    u32 frame_number = 0;
+    u64 total_samples = 0;
+};
+
+} // Anonymous namespace
+
+FileSink::FileSink(std::string_view path_) : path(path_) {
+    if (path.empty() || path == auto_device_name) {
+        path = FileUtil::GetUserPath(FileUtil::UserPath::DumpDir) + "audio.wav";
+    }
+    FileUtil::CreateFullPath(path);
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Audio_Sink, "Could not open {} for writing", path);
+        return;
+    }
+
+    if (Common::ToLower(path).ends_with(".flac")) {
+        encoder = std::make_unique<FlacEncoder>(std::move(file));
+    } else {
+        encoder = std::make_unique<WavEncoder>(std::move(file));
+    }
+    LOG_INFO(Audio_Sink, "Rendering audio to {}", path);
+
+    ResetStageTimings();
+    SetStageTimingEnabled(true);
+}
+
+FileSink::~FileSink() {
+    SetStageTimingEnabled(false);
+    if (encoder) {
+        encoder->Finish();
+        LogReport();
+    }
+}
+
+void FileSink::PushSamples(std::span<const std::array<s16, 2>> samples) {
+    std::scoped_lock lock{mutex};
+    if (!encoder) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (frames_written == 0) {
+        first_push = now;
+    }
+    last_push = now;
+
+    encoder->Write(samples);
+    frames_written += samples.size();
+}
+
+void FileSink::LogReport() const {
+    using Seconds = std::chrono::duration<double>;
+    const double audio_seconds = static_cast<double>(frames_written) / native_sample_rate;
+    const double wall_seconds = std::chrono::duration_cast<Seconds>(last_push - first_push).count();
+    LOG_INFO(Audio_Sink, "Rendered {:.2f}s of audio to {} in {:.2f}s ({:.1f}x real time)",
+             audio_seconds, path, wall_seconds,
+             wall_seconds > 0.0 ? audio_seconds / wall_seconds : 0.0);
+
+    // Timings are normalized to the 160 sample frames the DSP generates at a time.
+    const double dsp_frames = std::max(1.0, static_cast<double>(frames_written) / 160.0);
+    const StageTimings timings = GetStageTimings();
+    for (std::size_t i = 0; i < timings.size(); i++) {
+        const double total_ms =
+            std::chrono::duration<double, std::milli>(timings[i].total).count();
+        LOG_INFO(Audio_Sink, "  {:<14} {:>10} calls {:>10.3f}ms total {:>8.3f}us per frame",
+                 GetStageName(static_cast<AudioStage>(i)), timings[i].calls, total_ms,
+                 total_ms * 1000.0 / dsp_frames);
+    }
+}
+
+} // namespace AudioCore
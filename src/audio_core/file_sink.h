@@ -0,0 +1,68 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include "audio_core/audio_types.h"
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Headless sink that renders the DSP output to a WAV or FLAC file.
+ *
+ * The sink is not paced by any clock: samples are written as fast as the emulator produces them
+ * and without any latency control or time stretching, so the file holds exactly what the DSP
+ * generated. Together with deterministic DSP emulation this makes the output suitable for
+ * golden-file comparisons. While the sink is alive the audio stage timings are collected, and a
+ * summary of them is logged when it is destroyed.
+ */
+class FileSink final : public Sink {
+public:
+    /// @param path File to write to. A ".flac" extension selects FLAC, anything else WAV. "auto"
+    ///             writes audio.wav to the dump directory.
+    explicit FileSink(std::string_view path);
+    ~FileSink() override;
+
+    unsigned int GetNativeSampleRate() const override {
+        return native_sample_rate;
+    }
+
+    void SetCallback(std::function<void(s16*, std::size_t)>) override {}
+
+    bool IsRealTime() const override {
+        return false;
+    }
+
+    void PushSamples(std::span<const std::array<s16, 2>> samples) override;
+
+    /// Encodes samples into a file format.
+    class Encoder {
+    public:
+        virtual ~Encoder() = default;
+        virtual void Write(std::span<const std::array<s16, 2>> samples) = 0;
+        /// Writes out any buffered samples and fixes up the header.
+        virtual void Finish() = 0;
+    };
+
+private:
+    void LogReport() const;
+
+    std::string path;
+    std::unique_ptr<Encoder> encoder;
+
+    std::mutex mutex;
+    u64 frames_written = 0;
+    std::chrono::steady_clock::time_point first_push;
+    std::chrono::steady_clock::time_point last_push;
+};
+
+} // namespace AudioCore
@@ -5,10 +5,52 @@
 
 #include <neaacdec.h>
 #include "audio_core/hle/aac_decoder.h"
+#include "common/assert.h"
+#include "common/hash.h"
+#include "common/profiling.h"
+#include "common/thread.h"
 
 namespace AudioCore::HLE {
 
-AACDecoder::AACDecoder(Memory::MemorySystem& memory) : memory(memory) {
+/// About three minutes of 48 kHz stereo, enough to hold most looping background music.
+constexpr std::size_t decode_cache_capacity = 32 * 1024 * 1024;
+
+AACDecodeCache::AACDecodeCache(std::size_t capacity_bytes) : capacity_bytes(capacity_bytes) {}
+
+std::shared_ptr<const DecodedAAC> AACDecodeCache::Find(u64 key) {
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return nullptr;
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void AACDecodeCache::Insert(u64 key, std::shared_ptr<const DecodedAAC> output) {
+    const std::size_t output_size = output->SizeBytes();
+    if (output_size > capacity_bytes) {
+        return;
+    }
+
+    if (const auto it = entries.find(key); it != entries.end()) {
+        size_bytes -= it->second->second->SizeBytes();
+        lru.erase(it->second);
+        entries.erase(it);
+    }
+    while (size_bytes + output_size > capacity_bytes) {
+        const auto& [evicted_key, evicted] = lru.back();
+        size_bytes -= evicted->SizeBytes();
+        entries.erase(evicted_key);
+        lru.pop_back();
+    }
+
+    lru.emplace_front(key, std::move(output));
+    entries.emplace(key, lru.begin());
+    size_bytes += output_size;
+}
+
+AACDecoder::AACDecoder(Memory::MemorySystem& memory)
+    : memory(memory), cache(decode_cache_capacity) {
     decoder = NeAACDecOpen();
     if (decoder == nullptr) {
         LOG_CRITICAL(Audio_DSP, "Could not open FAAD2 decoder.");
@@ -25,23 +67,52 @@ AACDecoder::AACDecoder(Memory::MemorySystem& memory) : memory(memory) {
         return;
     }
 
+    worker_thread =
+        std::jthread([this](std::stop_token stop_token) { WorkerThread(stop_token); });
+
     LOG_INFO(Audio_DSP, "Created FAAD2 AAC decoder.");
 }
 
 AACDecoder::~AACDecoder() {
+    if (worker_thread.joinable()) {
+        worker_thread.request_stop();
+        worker_thread.join();
+    }
+
     if (decoder) {
         NeAACDecClose(decoder);
         decoder = nullptr;
 
-        LOG_INFO(Audio_DSP, "Destroyed FAAD2 AAC decoder.");
+        LOG_INFO(Audio_DSP, "Destroyed FAAD2 AAC decoder ({} of {} requests served from cache).",
+                 cache_hits, cache_hits + decodes);
     }
 }
 
 BinaryMessage AACDecoder::ProcessRequest(const BinaryMessage& request) {
+    ASSERT_MSG(jobs_in_flight == 0,
+               "Requests in flight must be collected with PopResponses first");
+    if (auto response = SubmitRequest(request)) {
+        return *response;
+    }
+    return PopResponses().front();
+}
+
+std::optional<BinaryMessage> AACDecoder::SubmitRequest(const BinaryMessage& request) {
+    auto response = StartRequest(request);
+    if (response && jobs_in_flight > 0) {
+        // Responses are returned in request order, so this one waits for the decodes before it.
+        job_queue.Push(Job{.request = request, .response = response});
+        jobs_in_flight++;
+        return std::nullopt;
+    }
+    return response;
+}
+
+std::optional<BinaryMessage> AACDecoder::StartRequest(const BinaryMessage& request) {
     if (request.header.codec != DecoderCodec::DecodeAAC) {
         LOG_ERROR(Audio_DSP, "AAC decoder received unsupported codec: {}",
                   static_cast<u16>(request.header.codec));
-        return {
+        return BinaryMessage{
             .header =
                 {
                     .result = ResultStatus::Error,
@@ -56,7 +127,28 @@ BinaryMessage AACDecoder::ProcessRequest(const BinaryMessage& request) {
         return response;
     }
     case DecoderCommand::EncodeDecode: {
-        return Decode(request);
+        Job job{.request = request};
+        if (decoder == nullptr) {
+            return WriteOutput(job);
+        }
+
+        if (request.decode_aac_request.src_addr < Memory::FCRAM_PADDR ||
+            request.decode_aac_request.src_addr + request.decode_aac_request.size >
+                Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
+            LOG_ERROR(Audio_DSP, "Got out of bounds src_addr {:08x}",
+                      request.decode_aac_request.src_addr);
+            return WriteOutput(job);
+        }
+
+        // The application may reuse the input buffer once it has been handed over, so only a
+        // copy of it goes to the worker thread.
+        const u8* data =
+            memory.GetFCRAMPointer(request.decode_aac_request.src_addr - Memory::FCRAM_PADDR);
+        job.input.assign(data, data + request.decode_aac_request.size);
+
+        job_queue.Push(std::move(job));
+        jobs_in_flight++;
+        return std::nullopt;
     }
     case DecoderCommand::Shutdown:
     case DecoderCommand::SaveState:
@@ -70,7 +162,7 @@ BinaryMessage AACDecoder::ProcessRequest(const BinaryMessage& request) {
     default:
         LOG_ERROR(Audio_DSP, "Got unknown AAC binary request: {}",
                   static_cast<u16>(request.header.cmd));
-        return {
+        return BinaryMessage{
             .header =
                 {
                     .result = ResultStatus::Error,
@@ -79,43 +171,82 @@ BinaryMessage AACDecoder::ProcessRequest(const BinaryMessage& request) {
     }
 }
 
-BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
-    BinaryMessage response{};
-    response.header.codec = request.header.codec;
-    response.header.cmd = request.header.cmd;
-    response.decode_aac_response.size = request.decode_aac_request.size;
-    // This is a hack to continue games when a failure occurs.
-    response.decode_aac_response.sample_rate = DecoderSampleRate::Rate48000;
-    response.decode_aac_response.num_channels = 2;
-    response.decode_aac_response.num_samples = 1024;
+std::vector<BinaryMessage> AACDecoder::PopResponses() {
+    std::vector<BinaryMessage> responses;
+    responses.reserve(jobs_in_flight);
+    for (; jobs_in_flight > 0; jobs_in_flight--) {
+        const Job job = done_queue.PopWait();
+        responses.push_back(job.response ? *job.response : WriteOutput(job));
+    }
+    return responses;
+}
 
-    if (decoder == nullptr) {
-        return response;
+void AACDecoder::WorkerThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("AACDecoder");
+    while (!stop_token.stop_requested()) {
+        Job job = job_queue.PopWait(stop_token);
+        if (stop_token.stop_requested()) {
+            break;
+        }
+        if (!job.response) {
+            RunJob(job);
+        }
+        done_queue.Push(std::move(job));
     }
+}
 
-    if (request.decode_aac_request.src_addr < Memory::FCRAM_PADDR ||
-        request.decode_aac_request.src_addr + request.decode_aac_request.size >
-            Memory::FCRAM_PADDR + Memory::FCRAM_SIZE) {
-        LOG_ERROR(Audio_DSP, "Got out of bounds src_addr {:08x}",
-                  request.decode_aac_request.src_addr);
-        return response;
+void AACDecoder::RunJob(Job& job) {
+    BORKED3DS_PROFILE("Audio", "AAC Decode");
+
+    // Frames overlap with the one before them, so the output of a request depends on the previous
+    // input as well as its own.
+    const u64 input_hash = Common::ComputeHash64(job.input.data(), job.input.size());
+    const u64 key = Common::HashCombine(previous_input_hash, input_hash);
+
+    job.output = cache.Find(key);
+    if (job.output) {
+        cache_hits++;
+        decoder_behind = true;
+    } else {
+        // After serving from the cache, the decoder has not seen the previous frame yet. Feed it
+        // through first so that the overlap carried into this frame is correct.
+        if (decoder_behind && !previous_input.empty()) {
+            Decode(previous_input);
+        }
+        decoder_behind = false;
+
+        job.output = Decode(job.input);
+        if (job.output && job.output->cacheable) {
+            cache.Insert(key, job.output);
+        }
+        decodes++;
     }
-    u8* data = memory.GetFCRAMPointer(request.decode_aac_request.src_addr - Memory::FCRAM_PADDR);
-    u32 data_len = request.decode_aac_request.size;
+
+    previous_input = std::move(job.input);
+    previous_input_hash = input_hash;
+}
+
+std::shared_ptr<const DecodedAAC> AACDecoder::Decode(std::span<const u8> input) {
+    // FAAD2 takes non-const input, but does not write to it.
+    u8* data = const_cast<u8*>(input.data());
+    u32 data_len = static_cast<u32>(input.size());
 
     unsigned long sample_rate;
     u8 num_channels;
     auto init_result = NeAACDecInit(decoder, data, data_len, &sample_rate, &num_channels);
     if (init_result < 0) {
         LOG_ERROR(Audio_DSP, "Could not initialize FAAD2 AAC decoder for request: {}", init_result);
-        return response;
+        return nullptr;
     }
 
     // Advance past the frame header if needed.
     data += init_result;
     data_len -= init_result;
 
-    std::array<std::vector<s16>, 2> out_streams;
+    auto output = std::make_shared<DecodedAAC>();
+    output->sample_rate = static_cast<u32>(sample_rate);
+    output->num_channels = num_channels;
+    auto& out_streams = output->channels;
 
     while (data_len > 0) {
         NeAACDecFrameInfo frame_info;
@@ -123,11 +254,18 @@ BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
             static_cast<s16*>(NeAACDecDecode(decoder, &frame_info, data, data_len));
         if (curr_sample_buffer == nullptr || frame_info.error != 0) {
             LOG_ERROR(Audio_DSP, "Failed to decode AAC buffer using FAAD2: {}", frame_info.error);
-            return response;
+            return nullptr;
+        }
+
+        if (frame_info.object_type != LC || frame_info.sbr != NO_SBR || frame_info.ps != 0) {
+            output->cacheable = false;
         }
 
         // Split the decode result into channels.
         u32 num_samples = frame_info.samples / frame_info.channels;
+        for (u32 ch = 0; ch < frame_info.channels; ch++) {
+            out_streams[ch].reserve(out_streams[ch].size() + num_samples);
+        }
         for (u32 sample = 0; sample < num_samples; sample++) {
             for (u32 ch = 0; ch < frame_info.channels; ch++) {
                 out_streams[ch].push_back(curr_sample_buffer[(sample * frame_info.channels) + ch]);
@@ -138,6 +276,26 @@ BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
         data_len -= frame_info.bytesconsumed;
     }
 
+    return output;
+}
+
+BinaryMessage AACDecoder::WriteOutput(const Job& job) {
+    const auto& request = job.request;
+
+    BinaryMessage response{};
+    response.header.codec = request.header.codec;
+    response.header.cmd = request.header.cmd;
+    response.decode_aac_response.size = request.decode_aac_request.size;
+    // This is a hack to continue games when a failure occurs.
+    response.decode_aac_response.sample_rate = DecoderSampleRate::Rate48000;
+    response.decode_aac_response.num_channels = 2;
+    response.decode_aac_response.num_samples = 1024;
+
+    if (!job.output) {
+        return response;
+    }
+    const auto& out_streams = job.output->channels;
+
     // Transfer the decoded buffer from vector to the FCRAM.
     for (std::size_t ch = 0; ch < out_streams.size(); ch++) {
         if (out_streams[ch].empty()) {
@@ -156,8 +314,8 @@ BinaryMessage AACDecoder::Decode(const BinaryMessage& request) {
     }
 
     // Set the output frame info.
-    response.decode_aac_response.sample_rate = GetSampleRateEnum(sample_rate);
-    response.decode_aac_response.num_channels = num_channels;
+    response.decode_aac_response.sample_rate = GetSampleRateEnum(job.output->sample_rate);
+    response.decode_aac_response.num_channels = job.output->num_channels;
     response.decode_aac_response.num_samples = static_cast<u32_le>(out_streams[0].size());
 
     return response;
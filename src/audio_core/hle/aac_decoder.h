@@ -5,23 +5,106 @@
 
 #pragma once
 
+#include <array>
+#include <list>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
 #include "audio_core/hle/decoder.h"
+#include "common/polyfill_thread.h"
+#include "common/threadsafe_queue.h"
 
 namespace AudioCore::HLE {
 
 using NeAACDecHandle = void*;
 
+/// PCM output of one decode request, split into channels.
+struct DecodedAAC {
+    u32 sample_rate = 0;
+    u8 num_channels = 0;
+    std::array<std::vector<s16>, 2> channels;
+    /// Whether every frame was plain AAC-LC, whose output only depends on the frame before it.
+    /// SBR and PS keep more state across frames, so their output cannot be replayed.
+    bool cacheable = true;
+
+    std::size_t SizeBytes() const {
+        return (channels[0].size() + channels[1].size()) * sizeof(s16);
+    }
+};
+
+/// Least recently used cache of decoded AAC output, bounded by the total size of the PCM data.
+class AACDecodeCache {
+public:
+    explicit AACDecodeCache(std::size_t capacity_bytes);
+
+    /// Returns the cached output for the key, or nullptr if there is none.
+    std::shared_ptr<const DecodedAAC> Find(u64 key);
+
+    /// Adds output to the cache, evicting the least recently used entries to make room for it.
+    void Insert(u64 key, std::shared_ptr<const DecodedAAC> output);
+
+    std::size_t Count() const {
+        return entries.size();
+    }
+
+    std::size_t SizeBytes() const {
+        return size_bytes;
+    }
+
+private:
+    using Entry = std::pair<u64, std::shared_ptr<const DecodedAAC>>;
+
+    std::size_t capacity_bytes;
+    std::size_t size_bytes = 0;
+    std::list<Entry> lru; ///< Most recently used first.
+    std::unordered_map<u64, std::list<Entry>::iterator> entries;
+};
+
+/**
+ * AAC decoder backed by FAAD2. Decode requests are run on a worker thread, so that the emulation
+ * thread only copies the input and later writes back the output. Looping streams submit the same
+ * frames over and over, so decoded AAC-LC output is cached by the content of the input.
+ */
 class AACDecoder final : public DecoderBase {
 public:
     explicit AACDecoder(Memory::MemorySystem& memory);
     ~AACDecoder() override;
     BinaryMessage ProcessRequest(const BinaryMessage& request) override;
+    std::optional<BinaryMessage> SubmitRequest(const BinaryMessage& request) override;
+    std::vector<BinaryMessage> PopResponses() override;
 
 private:
-    BinaryMessage Decode(const BinaryMessage& request);
+    struct Job {
+        BinaryMessage request{};
+        std::vector<u8> input;
+        std::shared_ptr<const DecodedAAC> output;
+        /// Set for requests answered without decoding that were submitted behind decodes.
+        std::optional<BinaryMessage> response;
+    };
+
+    /// Answers the request if it needs no decoding, otherwise queues it to the worker thread.
+    std::optional<BinaryMessage> StartRequest(const BinaryMessage& request);
+    void WorkerThread(std::stop_token stop_token);
+    void RunJob(Job& job);
+    std::shared_ptr<const DecodedAAC> Decode(std::span<const u8> input);
+    BinaryMessage WriteOutput(const Job& job);
 
     Memory::MemorySystem& memory;
     NeAACDecHandle decoder = nullptr;
+
+    // Only accessed by the worker thread.
+    AACDecodeCache cache;
+    std::vector<u8> previous_input;
+    u64 previous_input_hash = 0;
+    bool decoder_behind = false;
+    std::size_t cache_hits = 0;
+    std::size_t decodes = 0;
+
+    std::size_t jobs_in_flight = 0;
+    Common::SPSCQueue<Job, true> job_queue;
+    Common::SPSCQueue<Job> done_queue;
+    std::jthread worker_thread;
 };
 
 } // namespace AudioCore::HLE
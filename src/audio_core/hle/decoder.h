@@ -137,7 +137,25 @@ enum_le<DecoderSampleRate> GetSampleRateEnum(u32 sample_rate);
 class DecoderBase {
 public:
     virtual ~DecoderBase() = default;
+
+    /// Processes a request and returns its response. Requests submitted with SubmitRequest must
+    /// have been collected with PopResponses before.
     virtual BinaryMessage ProcessRequest(const BinaryMessage& request) = 0;
+
+    /**
+     * Starts processing a request. Decoders that work in the background return std::nullopt, and
+     * the response is returned by a later call to PopResponses. Responses are always returned in
+     * request order, so a request that could be answered right away also returns std::nullopt
+     * while earlier ones are still in flight.
+     */
+    virtual std::optional<BinaryMessage> SubmitRequest(const BinaryMessage& request) {
+        return ProcessRequest(request);
+    }
+
+    /// Waits for the requests still in flight and returns their responses in submission order.
+    virtual std::vector<BinaryMessage> PopResponses() {
+        return {};
+    }
 };
 
 } // namespace AudioCore::HLE
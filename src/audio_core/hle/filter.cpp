@@ -6,11 +6,16 @@
 #include <algorithm>
 #include <array>
 #include <cstddef>
-#include "audio_core/hle/common.h"
+#include <cstring>
 #include "audio_core/hle/filter.h"
 #include "audio_core/hle/shared_memory.h"
+#include "common/arch.h"
 #include "common/common_types.h"
 
+#if BORKED3DS_ARCH(x86_64)
+#include <emmintrin.h>
+#endif
+
 namespace AudioCore::HLE {
 
 void SourceFilters::Reset() {
@@ -40,11 +45,11 @@ void SourceFilters::ProcessFrame(StereoFrame16& frame) {
         return;
 
     if (simple_filter_enabled) {
-        FilterFrame(frame, simple_filter);
+        simple_filter.ProcessFrame(frame);
     }
 
     if (biquad_filter_enabled) {
-        FilterFrame(frame, biquad_filter);
+        biquad_filter.ProcessFrame(frame);
     }
 }
 
@@ -64,16 +69,18 @@ void SourceFilters::SimpleFilter::Configure(
     b0 = config.b0;
 }
 
-std::array<s16, 2> SourceFilters::SimpleFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + a1 * y1[i]) >> 15;
-        y0[i] = std::clamp(tmp, -32768, 32767);
+void SourceFilters::SimpleFilter::ProcessFrame(StereoFrame16& frame) {
+    // The recursion through y1 is inherently serial, so only the two channels run in parallel.
+    // They are left to the scalar units: with a single multiply per channel, packing them into a
+    // vector lengthens the dependency chain from one sample to the next more than it saves.
+    s32 y1_l = y1[0];
+    s32 y1_r = y1[1];
+    for (auto& sample : frame) {
+        y1_l = std::clamp((b0 * sample[0] + a1 * y1_l) >> 15, -32768, 32767);
+        y1_r = std::clamp((b0 * sample[1] + a1 * y1_r) >> 15, -32768, 32767);
+        sample = {static_cast<s16>(y1_l), static_cast<s16>(y1_r)};
     }
-
-    y1 = y0;
-
-    return y0;
+    y1 = {static_cast<s16>(y1_l), static_cast<s16>(y1_r)};
 }
 
 // BiquadFilter
@@ -98,19 +105,83 @@ void SourceFilters::BiquadFilter::Configure(
     b2 = config.b2;
 }
 
-std::array<s16, 2> SourceFilters::BiquadFilter::ProcessSample(const std::array<s16, 2>& x0) {
-    std::array<s16, 2> y0;
-    for (std::size_t i = 0; i < 2; i++) {
-        const s32 tmp = (b0 * x0[i] + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14;
-        y0[i] = std::clamp(tmp, -32768, 32767);
-    }
+#if BORKED3DS_ARCH(x86_64)
+
+/// Loads a stereo sample into the low 32 bits of a vector.
+static __m128i LoadStereo(const std::array<s16, 2>& sample) {
+    s32 packed;
+    std::memcpy(&packed, sample.data(), sizeof(packed));
+    return _mm_cvtsi32_si128(packed);
+}
 
-    x2 = x1;
-    x1 = x0;
-    y2 = y1;
-    y1 = y0;
+static void StoreStereo(std::array<s16, 2>& sample, __m128i value) {
+    const s32 packed = _mm_cvtsi128_si32(value);
+    std::memcpy(sample.data(), &packed, sizeof(packed));
+}
+
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    // Both channels are filtered at once. Every coefficient is a 16 bit value, so each madd
+    // computes two terms of the difference equation for both channels:
+    //   {x0 x1 x0 x1 x2 y1 x2 y1} * {b0 b1 b0 b1 b2 a1 b2 a1} and {y2 0 y2 0} * {a2 0 a2 0}.
+    // Packing the 32 bit sums back to 16 bits saturates, which is the clamp.
+    const __m128i c0 = _mm_setr_epi16(static_cast<s16>(b0), static_cast<s16>(b1),
+                                      static_cast<s16>(b0), static_cast<s16>(b1),
+                                      static_cast<s16>(b2), static_cast<s16>(a1),
+                                      static_cast<s16>(b2), static_cast<s16>(a1));
+    const __m128i c1 = _mm_setr_epi16(static_cast<s16>(a2), 0, static_cast<s16>(a2), 0, 0, 0, 0, 0);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i x1_ = LoadStereo(x1);
+    __m128i x2_ = LoadStereo(x2);
+    __m128i y1_ = LoadStereo(y1);
+    __m128i y2_ = LoadStereo(y2);
+    for (auto& sample : frame) {
+        const __m128i x0 = LoadStereo(sample);
+        const __m128i terms = _mm_unpacklo_epi64(_mm_unpacklo_epi16(x0, x1_),
+                                                 _mm_unpacklo_epi16(x2_, y1_));
+        __m128i sum = _mm_madd_epi16(terms, c0);
+        sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi16(y2_, zero), c1));
+        const __m128i y0 = _mm_packs_epi32(_mm_srai_epi32(sum, 14), zero);
+        StoreStereo(sample, y0);
+        x2_ = x1_;
+        x1_ = x0;
+        y2_ = y1_;
+        y1_ = y0;
+    }
+    StoreStereo(x1, x1_);
+    StoreStereo(x2, x2_);
+    StoreStereo(y1, y1_);
+    StoreStereo(y2, y2_);
+}
 
-    return y0;
+#else
+
+void SourceFilters::BiquadFilter::ProcessFrame(StereoFrame16& frame) {
+    std::array<s32, 2> x1_ = {x1[0], x1[1]};
+    std::array<s32, 2> x2_ = {x2[0], x2[1]};
+    std::array<s32, 2> y1_ = {y1[0], y1[1]};
+    std::array<s32, 2> y2_ = {y2[0], y2[1]};
+    for (auto& sample : frame) {
+        for (std::size_t i = 0; i < 2; i++) {
+            const s32 x0 = sample[i];
+            const s32 y0 = std::clamp(
+                (b0 * x0 + b1 * x1_[i] + b2 * x2_[i] + a1 * y1_[i] + a2 * y2_[i]) >> 14, -32768,
+                32767);
+            x2_[i] = x1_[i];
+            x1_[i] = x0;
+            y2_[i] = y1_[i];
+            y1_[i] = y0;
+            sample[i] = static_cast<s16>(y0);
+        }
+    }
+    for (std::size_t i = 0; i < 2; i++) {
+        x1[i] = static_cast<s16>(x1_[i]);
+        x2[i] = static_cast<s16>(x2_[i]);
+        y1[i] = static_cast<s16>(y1_[i]);
+        y2[i] = static_cast<s16>(y2_[i]);
+    }
 }
 
+#endif
+
 } // namespace AudioCore::HLE
@@ -68,11 +68,11 @@ private:
         void Configure(SourceConfiguration::Configuration::SimpleFilter config);
 
         /**
-         * Processes a single stereo PCM16 sample.
-         * @param x0 Input sample
-         * @return Output sample
+         * Processes a whole frame in-place, keeping the filter state in registers for the
+         * duration of the frame.
+         * @param frame Frame to filter
          */
-        std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0);
+        void ProcessFrame(StereoFrame16& frame);
 
     private:
         // Configuration
@@ -96,11 +96,11 @@ private:
         void Configure(SourceConfiguration::Configuration::BiquadFilter config);
 
         /**
-         * Processes a single stereo PCM16 sample.
-         * @param x0 Input sample
-         * @return Output sample
+         * Processes a whole frame in-place, keeping the filter state in registers for the
+         * duration of the frame.
+         * @param frame Frame to filter
          */
-        std::array<s16, 2> ProcessSample(const std::array<s16, 2>& x0);
+        void ProcessFrame(StereoFrame16& frame);
 
     private:
         // Configuration
@@ -4,6 +4,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -19,12 +21,15 @@
 #include "audio_core/hle/shared_memory.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
+#include "audio_core/stage_timings.h"
 #include "common/archives.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/profiling.h"
 #include "common/settings.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -32,7 +37,8 @@ using InterruptType = Service::DSP::InterruptType;
 
 namespace AudioCore {
 
-DspHle::DspHle(Core::System& system) : DspHle(system, system.Memory(), system.CoreTiming()) {}
+DspHle::DspHle(Core::System& system, bool multithread)
+    : DspHle(system, system.Memory(), system.CoreTiming(), multithread) {}
 
 template <class Archive>
 void DspHle::serialize(Archive& ar, const unsigned int) {
@@ -50,7 +56,8 @@ static constexpr u64 audio_frame_ticks = samples_per_frame * 4096 * 2ull; ///< U
 
 struct DspHle::Impl final {
 public:
-    explicit Impl(DspHle& parent, Memory::MemorySystem& memory, Core::Timing& timing);
+    explicit Impl(DspHle& parent, Memory::MemorySystem& memory, Core::Timing& timing,
+                  bool multithread);
     ~Impl();
 
     DspState GetDspState() const;
@@ -69,13 +76,38 @@ public:
 private:
     void ResetPipes();
     void WriteU16(DspPipe pipe_number, u16 value);
+    void WriteBinaryResponse(const HLE::BinaryMessage& response);
+    void CollectDecoderResponses();
     void AudioPipeWriteStructAddresses();
 
     std::size_t CurrentRegionIndex() const;
     HLE::SharedMemory& ReadRegion();
     HLE::SharedMemory& WriteRegion();
 
-    StereoFrame16 GenerateCurrentFrame();
+    /// What the mixers read from the shared memory region to generate a frame. Sources read
+    /// their configuration and samples ahead in Source::PrepareFrame instead.
+    struct FrameInput {
+        HLE::DspConfiguration dsp_configuration;
+        HLE::IntermediateMixSamples intermediate_mix_samples;
+    };
+
+    /// Everything the DSP writes back to the shared memory region after generating a frame.
+    struct FrameOutput {
+        HLE::SourceStatus source_statuses;
+        HLE::DspStatus dsp_status;
+        HLE::IntermediateMixSamples intermediate_mix_samples;
+        std::array<bool, 2> aux_bus_sent;
+        StereoFrame16 output_frame;
+    };
+
+    void CaptureFrameInput();
+    void GenerateFrame();
+    void CommitFrameOutput();
+
+    void FrameThread();
+    void StopFrameThread();
+    void FinishPendingFrame();
+
     bool Tick();
     void AudioTickCallback(s64 cycles_late);
 
@@ -93,31 +125,64 @@ private:
     HLE::Mixers mixers{};
 
     DspHle& parent;
+    Memory::MemorySystem& memory;
     Core::Timing& core_timing;
     Core::TimingEventType* tick_event{};
 
     std::unique_ptr<HLE::DecoderBase> aac_decoder{};
+    // Decode requests are answered on the audio tick after they were submitted. Responses that
+    // have been written to the binary pipe but not signalled yet are counted here.
+    u32 pending_binary_interrupts = 0;
 
     std::function<void(Service::DSP::InterruptType type, DspPipe pipe)> interrupt_handler{};
 
+    FrameInput frame_input{};
+    FrameOutput frame_output{};
+
+    // In multithreaded mode frames are generated on frame_thread, one frame behind the emulation
+    // thread: each tick commits the previous frame's results and hands over the current frame's
+    // input. sources and mixers are only touched by frame_thread while frame_pending is set.
+    const bool multithread;
+    std::thread frame_thread;
+    Common::Event frame_requested;
+    Common::Event frame_completed;
+    std::atomic<bool> stop_signal = false;
+    bool frame_pending = false;
+
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
+        // Savestates never contain a frame or a decode in flight.
+        FinishPendingFrame();
+        if constexpr (Archive::is_saving::value) {
+            CollectDecoderResponses();
+        } else {
+            // Drop any decodes still running for the state being replaced.
+            aac_decoder = std::make_unique<HLE::AACDecoder>(memory);
+        }
         ar & dsp_state;
         ar & pipe_data;
         ar & dsp_memory.raw_memory;
         ar & sources;
         ar & mixers;
+        if (file_version > 0) {
+            ar & pending_binary_interrupts;
+        } else if (Archive::is_loading::value) {
+            // Older states answered every binary request right away.
+            pending_binary_interrupts = 0;
+        }
         // interrupt_handler is reregistered when loading state from DSP_DSP
     }
     friend class boost::serialization::access;
 };
 
-DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing& timing)
-    : parent(parent_), core_timing(timing) {
+DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing& timing,
+                   bool multithread)
+    : parent(parent_), memory(memory), core_timing(timing), multithread(multithread) {
     dsp_memory.raw_memory.fill(0);
 
     for (auto& source : sources) {
         source.SetMemory(memory);
+        source.SetPolyphaseEnabled(Settings::values.polyphase_interpolation.GetValue());
     }
 
     aac_decoder = std::make_unique<HLE::AACDecoder>(memory);
@@ -126,10 +191,15 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing&
             this->AudioTickCallback(cycles_late);
         });
     core_timing.ScheduleEvent(audio_frame_ticks, tick_event);
+
+    if (multithread) {
+        frame_thread = std::thread(&Impl::FrameThread, this);
+    }
 }
 
 DspHle::Impl::~Impl() {
     core_timing.UnscheduleEvent(tick_event, 0);
+    StopFrameThread();
 }
 
 DspState DspHle::Impl::GetDspState() const {
@@ -257,7 +327,6 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, std::span<const u8> buffer) {
         return;
     }
     case DspPipe::Binary: {
-        // TODO(B3N30): Make this async, and signal the interrupt
         HLE::BinaryMessage request{};
         if (sizeof(request) != buffer.size()) {
             LOG_CRITICAL(Audio_DSP, "got binary pipe with wrong size {}", buffer.size());
@@ -270,11 +339,12 @@ void DspHle::Impl::PipeWrite(DspPipe pipe_number, std::span<const u8> buffer) {
             UNIMPLEMENTED();
             return;
         }
-        const HLE::BinaryMessage response = aac_decoder->ProcessRequest(request);
-        pipe_data[static_cast<u32>(pipe_number)].resize(sizeof(response));
-        std::memcpy(pipe_data[static_cast<u32>(pipe_number)].data(), &response, sizeof(response));
-
-        interrupt_handler(InterruptType::Pipe, DspPipe::Binary);
+        // Decodes run in the background and are answered on the next audio tick, everything else
+        // is answered right away.
+        if (const auto response = aac_decoder->SubmitRequest(request)) {
+            WriteBinaryResponse(*response);
+            interrupt_handler(InterruptType::Pipe, DspPipe::Binary);
+        }
         break;
     }
     default:
@@ -310,6 +380,20 @@ void DspHle::Impl::WriteU16(DspPipe pipe_number, u16 value) {
     data.emplace_back(value >> 8);
 }
 
+void DspHle::Impl::WriteBinaryResponse(const HLE::BinaryMessage& response) {
+    std::vector<u8>& data = pipe_data[static_cast<u32>(DspPipe::Binary)];
+    const std::size_t offset = data.size();
+    data.resize(offset + sizeof(response));
+    std::memcpy(data.data() + offset, &response, sizeof(response));
+}
+
+void DspHle::Impl::CollectDecoderResponses() {
+    for (const auto& response : aac_decoder->PopResponses()) {
+        WriteBinaryResponse(response);
+        pending_binary_interrupts++;
+    }
+}
+
 void DspHle::Impl::AudioPipeWriteStructAddresses() {
     // These struct addresses are DSP dram addresses.
     // See also: DSP_DSP::ConvertProcessAddressFromDspDram
@@ -368,50 +452,124 @@ HLE::SharedMemory& DspHle::Impl::WriteRegion() {
     return CurrentRegionIndex() != 0 ? dsp_memory.region_0 : dsp_memory.region_1;
 }
 
-StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
+void DspHle::Impl::CaptureFrameInput() {
     HLE::SharedMemory& read = ReadRegion();
-    HLE::SharedMemory& write = WriteRegion();
 
+    // Everything the frame reads from guest memory is read here, on the emulation thread, so that
+    // the application may change it while the frame is generated.
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        sources[i].PrepareFrame(read.source_configurations.config[i],
+                                read.adpcm_coefficients.coeff[i]);
+    }
+
+    frame_input.dsp_configuration = read.dsp_configuration;
+    frame_input.intermediate_mix_samples = read.intermediate_mix_samples;
+
+    // Acknowledge the configuration updates now, exactly as parsing them would have.
+    read.dsp_configuration.dirty_raw = 0;
+}
+
+void DspHle::Impl::GenerateFrame() {
     std::array<QuadFrame32, 3> intermediate_mixes = {};
 
+    for (std::size_t i = 0; i < HLE::num_sources; i++) {
+        frame_output.source_statuses.status[i] = sources[i].Tick();
+    }
+
+    BORKED3DS_AUDIO_STAGE(AudioStage::Mixing, "Mixing");
+
     // Generate intermediate mixes
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
         for (std::size_t mix = 0; mix < 3; mix++) {
             sources[i].MixInto(intermediate_mixes[mix], mix);
         }
     }
 
     // Generate final mix
-    write.dsp_status = mixers.Tick(read.dsp_configuration, read.intermediate_mix_samples,
-                                   write.intermediate_mix_samples, intermediate_mixes);
+    frame_output.dsp_status =
+        mixers.Tick(frame_input.dsp_configuration, frame_input.intermediate_mix_samples,
+                    frame_output.intermediate_mix_samples, intermediate_mixes);
+    frame_output.aux_bus_sent = {mixers.IsAuxBusEnabled(0), mixers.IsAuxBusEnabled(1)};
+
+    frame_output.output_frame = mixers.GetOutput();
+}
+
+void DspHle::Impl::CommitFrameOutput() {
+    HLE::SharedMemory& write = WriteRegion();
 
-    StereoFrame16 output_frame = mixers.GetOutput();
+    write.source_statuses = frame_output.source_statuses;
+    write.dsp_status = frame_output.dsp_status;
+    if (frame_output.aux_bus_sent[0]) {
+        write.intermediate_mix_samples.mix1 = frame_output.intermediate_mix_samples.mix1;
+    }
+    if (frame_output.aux_bus_sent[1]) {
+        write.intermediate_mix_samples.mix2 = frame_output.intermediate_mix_samples.mix2;
+    }
 
     // Write current output frame to the shared memory region
+    const StereoFrame16& output_frame = frame_output.output_frame;
     for (std::size_t samplei = 0; samplei < output_frame.size(); samplei++) {
         for (std::size_t channeli = 0; channeli < output_frame[0].size(); channeli++) {
             write.final_samples.pcm16[samplei][channeli] = s16_le(output_frame[samplei][channeli]);
         }
     }
 
-    return output_frame;
+    parent.OutputFrame(output_frame);
 }
 
-bool DspHle::Impl::Tick() {
-    StereoFrame16 current_frame = {};
+void DspHle::Impl::FrameThread() {
+    while (true) {
+        frame_requested.Wait();
+        if (stop_signal) {
+            break;
+        }
+        BORKED3DS_PROFILE("Audio", "DspHle");
+        GenerateFrame();
+        frame_completed.Set();
+    }
+}
+
+void DspHle::Impl::StopFrameThread() {
+    if (frame_thread.joinable()) {
+        stop_signal = true;
+        frame_requested.Set();
+        frame_thread.join();
+    }
+}
+
+void DspHle::Impl::FinishPendingFrame() {
+    if (frame_pending) {
+        frame_completed.Wait();
+        frame_pending = false;
+        CommitFrameOutput();
+    }
+}
 
+bool DspHle::Impl::Tick() {
     // TODO: Check dsp::DSP semaphore (which indicates emulated application has finished writing to
     // shared memory region)
-    current_frame = GenerateCurrentFrame();
-
-    parent.OutputFrame(std::move(current_frame));
+    if (multithread) {
+        // The results of the previous frame are written back one frame late, so that generating
+        // a frame overlaps with the emulation of the next one.
+        FinishPendingFrame();
+        CaptureFrameInput();
+        frame_pending = true;
+        frame_requested.Set();
+    } else {
+        CaptureFrameInput();
+        GenerateFrame();
+        CommitFrameOutput();
+    }
 
     return GetDspState() == DspState::On;
 }
 
 void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
+    CollectDecoderResponses();
+    for (; pending_binary_interrupts > 0; pending_binary_interrupts--) {
+        interrupt_handler(InterruptType::Pipe, DspPipe::Binary);
+    }
+
     if (Tick()) {
         // TODO(merry): Signal all the other interrupts as appropriate.
         interrupt_handler(InterruptType::Pipe, DspPipe::Audio);
@@ -427,8 +585,9 @@ void DspHle::Impl::AudioTickCallback(s64 cycles_late) {
     core_timing.ScheduleEvent(adjusted_ticks, tick_event);
 }
 
-DspHle::DspHle(Core::System& system, Memory::MemorySystem& memory, Core::Timing& timing)
-    : DspInterface(system), impl(std::make_unique<Impl>(*this, memory, timing)) {}
+DspHle::DspHle(Core::System& system, Memory::MemorySystem& memory, Core::Timing& timing,
+               bool multithread)
+    : DspInterface(system), impl(std::make_unique<Impl>(*this, memory, timing, multithread)) {}
 DspHle::~DspHle() = default;
 
 u16 DspHle::RecvData(u32 register_number) {
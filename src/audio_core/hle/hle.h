@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 #include <boost/serialization/export.hpp>
+#include <boost/serialization/version.hpp>
 #include "audio_core/audio_types.h"
 #include "audio_core/dsp_interface.h"
 #include "common/common_types.h"
@@ -27,8 +28,9 @@ namespace AudioCore {
 
 class DspHle final : public DspInterface {
 public:
-    explicit DspHle(Core::System& system);
-    explicit DspHle(Core::System& system, Memory::MemorySystem& memory, Core::Timing& timing);
+    explicit DspHle(Core::System& system, bool multithread);
+    explicit DspHle(Core::System& system, Memory::MemorySystem& memory, Core::Timing& timing,
+                    bool multithread);
     ~DspHle();
 
     u16 RecvData(u32 register_number) override;
@@ -57,3 +59,5 @@ private:
 };
 
 } // namespace AudioCore
+
+BOOST_CLASS_VERSION(AudioCore::DspHle::Impl, 1)
@@ -0,0 +1,335 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "audio_core/hle/mix_kernels.h"
+#include "common/arch.h"
+
+#if BORKED3DS_ARCH(x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif BORKED3DS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+#if BORKED3DS_ARCH(x86_64) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace AudioCore::HLE {
+
+static_assert(samples_per_frame % 4 == 0);
+
+namespace Generic {
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(std::clamp(value, -32768, 32767));
+}
+
+static std::array<s16, 2> AddAndClampToS16(const std::array<s16, 2>& a,
+                                           const std::array<s16, 2>& b) {
+    return {ClampToS16(static_cast<s32>(a[0]) + static_cast<s32>(b[0])),
+            ClampToS16(static_cast<s32>(a[1]) + static_cast<s32>(b[1]))};
+}
+
+static void MixIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        // Conversion from stereo (source) to quadraphonic (dest) occurs here.
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+}
+
+static void DownmixStereo(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    std::transform(dest.begin(), dest.end(), source.begin(), dest.begin(),
+                   [gain](const std::array<s16, 2>& accumulator,
+                          const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+                       // Downmix to stereo
+                       s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+                       s16 right =
+                           ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+                       // Mix into current frame
+                       return AddAndClampToS16(accumulator, {left, right});
+                   });
+}
+
+static void DownmixMono(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    std::transform(dest.begin(), dest.end(), source.begin(), dest.begin(),
+                   [gain](const std::array<s16, 2>& accumulator,
+                          const std::array<s32, 4>& sample) -> std::array<s16, 2> {
+                       // Downmix to mono
+                       s16 mono = ClampToS16(static_cast<s32>(
+                           (gain * sample[0] + gain * sample[1] + gain * sample[2] +
+                            gain * sample[3]) /
+                           2));
+                       // Mix into current frame
+                       return AddAndClampToS16(accumulator, {mono, mono});
+                   });
+}
+
+static void QuadToPlanar(PlanarQuadFrame32& dest, const QuadFrame32& source) {
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            dest[channel][sample] = source[sample][channel];
+        }
+    }
+}
+
+static void PlanarToQuad(QuadFrame32& dest, const PlanarQuadFrame32& source) {
+    for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            dest[sample][channel] = source[channel][sample];
+        }
+    }
+}
+
+constexpr MixKernels kernels{
+    .mix_into_quad = MixIntoQuad,
+    .downmix_stereo = DownmixStereo,
+    .downmix_mono = DownmixMono,
+    .quad_to_planar = QuadToPlanar,
+    .planar_to_quad = PlanarToQuad,
+};
+
+} // namespace Generic
+
+#if BORKED3DS_ARCH(x86_64)
+namespace SSE2 {
+
+/// Sign-extends samples {L0, R0, L1, R1} to {L0, R0, L0, R0} and {L1, R1, L1, R1}.
+static void WidenStereoPair(const std::array<s16, 2>* source, __m128i& first, __m128i& second) {
+    const __m128i in = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+    const __m128i dup = _mm_unpacklo_epi32(in, in);
+    first = _mm_srai_epi32(_mm_unpacklo_epi16(dup, dup), 16);
+    second = _mm_srai_epi32(_mm_unpackhi_epi16(dup, dup), 16);
+}
+
+static void MixIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    const __m128 g = _mm_loadu_ps(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        __m128i first, second;
+        WidenStereoPair(&source[i], first, second);
+        auto* const d = reinterpret_cast<__m128i*>(&dest[i]);
+        const __m128i mixed0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(first), g));
+        const __m128i mixed1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(second), g));
+        _mm_storeu_si128(d, _mm_add_epi32(_mm_loadu_si128(d), mixed0));
+        _mm_storeu_si128(d + 1, _mm_add_epi32(_mm_loadu_si128(d + 1), mixed1));
+    }
+}
+
+/// Loads four quadraphonic samples and scales them, transposed so that row c holds channel c.
+static void LoadScaledTransposed(const std::array<s32, 4>* source, __m128 g, __m128& c0,
+                                 __m128& c1, __m128& c2, __m128& c3) {
+    const auto* const s = reinterpret_cast<const __m128i*>(source);
+    c0 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(s + 0)), g);
+    c1 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(s + 1)), g);
+    c2 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(s + 2)), g);
+    c3 = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(s + 3)), g);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+}
+
+/// Saturates {L0..L3} and {R0..R3} to s16, interleaves them and adds them to four stereo
+/// samples of dest with saturation.
+static void StoreStereo(std::array<s16, 2>* dest, __m128 left, __m128 right) {
+    const __m128i l = _mm_cvttps_epi32(left);
+    const __m128i r = _mm_cvttps_epi32(right);
+    const __m128i mixed = _mm_packs_epi32(_mm_unpacklo_epi32(l, r), _mm_unpackhi_epi32(l, r));
+    auto* const d = reinterpret_cast<__m128i*>(dest);
+    _mm_storeu_si128(d, _mm_adds_epi16(_mm_loadu_si128(d), mixed));
+}
+
+static void DownmixStereo(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128 c0, c1, c2, c3;
+        LoadScaledTransposed(&source[i], g, c0, c1, c2, c3);
+        StoreStereo(&dest[i], _mm_add_ps(c0, c2), _mm_add_ps(c1, c3));
+    }
+}
+
+static void DownmixMono(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    const __m128 half = _mm_set1_ps(0.5f);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128 c0, c1, c2, c3;
+        LoadScaledTransposed(&source[i], g, c0, c1, c2, c3);
+        const __m128 mono = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(c0, c1), c2), c3), half);
+        StoreStereo(&dest[i], mono, mono);
+    }
+}
+
+static void QuadToPlanar(PlanarQuadFrame32& dest, const QuadFrame32& source) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const auto* const s = reinterpret_cast<const float*>(&source[i]);
+        __m128 c0 = _mm_loadu_ps(s + 0);
+        __m128 c1 = _mm_loadu_ps(s + 4);
+        __m128 c2 = _mm_loadu_ps(s + 8);
+        __m128 c3 = _mm_loadu_ps(s + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(reinterpret_cast<float*>(&dest[0][i]), c0);
+        _mm_storeu_ps(reinterpret_cast<float*>(&dest[1][i]), c1);
+        _mm_storeu_ps(reinterpret_cast<float*>(&dest[2][i]), c2);
+        _mm_storeu_ps(reinterpret_cast<float*>(&dest[3][i]), c3);
+    }
+}
+
+static void PlanarToQuad(QuadFrame32& dest, const PlanarQuadFrame32& source) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        __m128 s0 = _mm_loadu_ps(reinterpret_cast<const float*>(&source[0][i]));
+        __m128 s1 = _mm_loadu_ps(reinterpret_cast<const float*>(&source[1][i]));
+        __m128 s2 = _mm_loadu_ps(reinterpret_cast<const float*>(&source[2][i]));
+        __m128 s3 = _mm_loadu_ps(reinterpret_cast<const float*>(&source[3][i]));
+        _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+        auto* const d = reinterpret_cast<float*>(&dest[i]);
+        _mm_storeu_ps(d + 0, s0);
+        _mm_storeu_ps(d + 4, s1);
+        _mm_storeu_ps(d + 8, s2);
+        _mm_storeu_ps(d + 12, s3);
+    }
+}
+
+constexpr MixKernels kernels{
+    .mix_into_quad = MixIntoQuad,
+    .downmix_stereo = DownmixStereo,
+    .downmix_mono = DownmixMono,
+    .quad_to_planar = QuadToPlanar,
+    .planar_to_quad = PlanarToQuad,
+};
+
+} // namespace SSE2
+
+namespace AVX2 {
+
+TARGET_AVX2 static void MixIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                                    const std::array<float, 4>& gains) {
+    const __m128 g128 = _mm_loadu_ps(gains.data());
+    const __m256 g = _mm256_insertf128_ps(_mm256_castps128_ps256(g128), g128, 1);
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        // {L0, R0, L1, R1, L2, R2, L3, R3} -> {L0, R0, L0, R0, L1, R1, L1, R1}, ...
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[i]));
+        const __m256i first = _mm256_cvtepi16_epi32(_mm_unpacklo_epi32(in, in));
+        const __m256i second = _mm256_cvtepi16_epi32(_mm_unpackhi_epi32(in, in));
+        auto* const d = reinterpret_cast<__m256i*>(&dest[i]);
+        const __m256i mixed0 = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(first), g));
+        const __m256i mixed1 = _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(second), g));
+        _mm256_storeu_si256(d, _mm256_add_epi32(_mm256_loadu_si256(d), mixed0));
+        _mm256_storeu_si256(d + 1, _mm256_add_epi32(_mm256_loadu_si256(d + 1), mixed1));
+    }
+}
+
+} // namespace AVX2
+#endif // BORKED3DS_ARCH(x86_64)
+
+#if BORKED3DS_ARCH(arm64)
+namespace NEON {
+
+static void MixIntoQuad(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    const float32x4_t g = vld1q_f32(gains.data());
+    for (std::size_t i = 0; i < samples_per_frame; i += 2) {
+        // {L0, R0, L1, R1} -> {L0, R0, L0, R0} and {L1, R1, L1, R1}
+        const int32x2_t pair = vreinterpret_s32_s16(vld1_s16(source[i].data()));
+        const int32x4_t first = vmovl_s16(vreinterpret_s16_s32(vdup_lane_s32(pair, 0)));
+        const int32x4_t second = vmovl_s16(vreinterpret_s16_s32(vdup_lane_s32(pair, 1)));
+        s32* const d = dest[i].data();
+        vst1q_s32(d, vaddq_s32(vld1q_s32(d), vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(first), g))));
+        vst1q_s32(d + 4, vaddq_s32(vld1q_s32(d + 4),
+                                   vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(second), g))));
+    }
+}
+
+/// Saturates {L0..L3} and {R0..R3} to s16 and adds them to four stereo samples of dest with
+/// saturation.
+static void StoreStereo(std::array<s16, 2>* dest, float32x4_t left, float32x4_t right) {
+    int16x4x2_t d = vld2_s16(dest->data());
+    d.val[0] = vqadd_s16(d.val[0], vqmovn_s32(vcvtq_s32_f32(left)));
+    d.val[1] = vqadd_s16(d.val[1], vqmovn_s32(vcvtq_s32_f32(right)));
+    vst2_s16(dest->data(), d);
+}
+
+static void DownmixStereo(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int32x4x4_t s = vld4q_s32(source[i].data());
+        const float32x4_t c0 = vmulq_n_f32(vcvtq_f32_s32(s.val[0]), gain);
+        const float32x4_t c1 = vmulq_n_f32(vcvtq_f32_s32(s.val[1]), gain);
+        const float32x4_t c2 = vmulq_n_f32(vcvtq_f32_s32(s.val[2]), gain);
+        const float32x4_t c3 = vmulq_n_f32(vcvtq_f32_s32(s.val[3]), gain);
+        StoreStereo(&dest[i], vaddq_f32(c0, c2), vaddq_f32(c1, c3));
+    }
+}
+
+static void DownmixMono(StereoFrame16& dest, const QuadFrame32& source, float gain) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int32x4x4_t s = vld4q_s32(source[i].data());
+        const float32x4_t c0 = vmulq_n_f32(vcvtq_f32_s32(s.val[0]), gain);
+        const float32x4_t c1 = vmulq_n_f32(vcvtq_f32_s32(s.val[1]), gain);
+        const float32x4_t c2 = vmulq_n_f32(vcvtq_f32_s32(s.val[2]), gain);
+        const float32x4_t c3 = vmulq_n_f32(vcvtq_f32_s32(s.val[3]), gain);
+        const float32x4_t mono = vmulq_n_f32(vaddq_f32(vaddq_f32(vaddq_f32(c0, c1), c2), c3), 0.5f);
+        StoreStereo(&dest[i], mono, mono);
+    }
+}
+
+static void QuadToPlanar(PlanarQuadFrame32& dest, const QuadFrame32& source) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        const int32x4x4_t s = vld4q_s32(source[i].data());
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            vst1q_s32(reinterpret_cast<s32*>(&dest[channel][i]), s.val[channel]);
+        }
+    }
+}
+
+static void PlanarToQuad(QuadFrame32& dest, const PlanarQuadFrame32& source) {
+    for (std::size_t i = 0; i < samples_per_frame; i += 4) {
+        int32x4x4_t s;
+        for (std::size_t channel = 0; channel < 4; channel++) {
+            s.val[channel] = vld1q_s32(reinterpret_cast<const s32*>(&source[channel][i]));
+        }
+        vst4q_s32(dest[i].data(), s);
+    }
+}
+
+constexpr MixKernels kernels{
+    .mix_into_quad = MixIntoQuad,
+    .downmix_stereo = DownmixStereo,
+    .downmix_mono = DownmixMono,
+    .quad_to_planar = QuadToPlanar,
+    .planar_to_quad = PlanarToQuad,
+};
+
+} // namespace NEON
+#endif // BORKED3DS_ARCH(arm64)
+
+const MixKernels& GetGenericMixKernels() {
+    return Generic::kernels;
+}
+
+const MixKernels& GetMixKernels() {
+    static const MixKernels kernels = GetSupportedMixKernels().back().second;
+    return kernels;
+}
+
+std::vector<std::pair<std::string_view, MixKernels>> GetSupportedMixKernels() {
+    // Ordered from slowest to fastest.
+    std::vector<std::pair<std::string_view, MixKernels>> supported{{"Generic", Generic::kernels}};
+#if BORKED3DS_ARCH(x86_64)
+    supported.emplace_back("SSE2", SSE2::kernels);
+    if (Common::GetCPUCaps().avx2) {
+        MixKernels avx2 = SSE2::kernels;
+        avx2.mix_into_quad = AVX2::MixIntoQuad;
+        supported.emplace_back("AVX2", avx2);
+    }
+#elif BORKED3DS_ARCH(arm64)
+    supported.emplace_back("NEON", NEON::kernels);
+#endif
+    return supported;
+}
+
+} // namespace AudioCore::HLE
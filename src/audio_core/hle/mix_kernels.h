@@ -0,0 +1,55 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "audio_core/audio_types.h"
+#include "common/common_types.h"
+#include "common/swap.h"
+
+namespace AudioCore::HLE {
+
+/// Channel-major sample layout used by IntermediateMixSamples.
+using PlanarQuadFrame32 = s32_le[4][samples_per_frame];
+
+/**
+ * Frame-wide mixing kernels used by the HLE DSP. Every implementation produces bit-identical
+ * results to the generic one; the fastest one supported by the host is picked at runtime.
+ */
+struct MixKernels {
+    /// Mixes a stereo frame into a quadraphonic one:
+    /// dest[i] += {gains[0] * L, gains[1] * R, gains[2] * L, gains[3] * R}
+    void (*mix_into_quad)(QuadFrame32& dest, const StereoFrame16& source,
+                          const std::array<float, 4>& gains);
+
+    /// Downmixes a quadraphonic frame to stereo with the given gain and mixes it into dest,
+    /// saturating to s16 at both steps.
+    void (*downmix_stereo)(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+    /// Downmixes a quadraphonic frame to mono with the given gain and mixes it into both
+    /// channels of dest, saturating to s16 at both steps.
+    void (*downmix_mono)(StereoFrame16& dest, const QuadFrame32& source, float gain);
+
+    /// Converts a quadraphonic frame to the channel-major layout.
+    void (*quad_to_planar)(PlanarQuadFrame32& dest, const QuadFrame32& source);
+
+    /// Converts a channel-major frame to a quadraphonic frame.
+    void (*planar_to_quad)(QuadFrame32& dest, const PlanarQuadFrame32& source);
+};
+
+/// Returns the portable scalar kernels.
+const MixKernels& GetGenericMixKernels();
+
+/// Returns the fastest kernels supported by the host CPU.
+const MixKernels& GetMixKernels();
+
+/// Returns every set of kernels the host CPU supports by name, including the ones GetMixKernels
+/// passes over for a faster one.
+std::vector<std::pair<std::string_view, MixKernels>> GetSupportedMixKernels();
+
+} // namespace AudioCore::HLE
@@ -27,6 +27,11 @@ public:
         return current_frame;
     }
 
+    /// Whether the last Tick sent the given aux bus out through write_samples.
+    [[nodiscard]] bool IsAuxBusEnabled(std::size_t bus) const {
+        return state.aux_bus_enable.at(bus);
+    }
+
 private:
     StereoFrame16 current_frame = {};
 
@@ -7,18 +7,29 @@
 #include <array>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/mix_kernels.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
+#include "audio_core/stage_timings.h"
 #include "common/assert.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
 namespace AudioCore::HLE {
 
-SourceStatus::Status Source::Tick(SourceConfiguration::Configuration& config,
-                                  const s16_le (&adpcm_coeffs)[16]) {
+void Source::PrepareFrame(SourceConfiguration::Configuration& config,
+                          const s16_le (&adpcm_coeffs)[16]) {
     ParseConfig(config, adpcm_coeffs);
 
+    prefetched_buffers.clear();
+    next_prefetched_buffer = 0;
+    if (state.enabled) {
+        PrefetchSamples();
+    }
+}
+
+SourceStatus::Status Source::Tick() {
     if (state.enabled) {
         GenerateFrame();
     }
@@ -30,19 +41,13 @@ void Source::MixInto(QuadFrame32& dest, std::size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    GetMixKernels().mix_into_quad(dest, current_frame, state.gain.at(intermediate_mix_id));
 }
 
 void Source::Reset() {
     current_frame.fill({});
     state = {};
+    decoded_buffers.clear();
 }
 
 void Source::SetMemory(Memory::MemorySystem& memory) {
@@ -64,6 +69,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
     if (config.partial_reset_flag) {
         config.partial_reset_flag.Assign(0);
         state.input_queue = std::priority_queue<Buffer, std::vector<Buffer>, BufferOrder>{};
+        decoded_buffers.clear();
         LOG_TRACE(Audio_DSP, "source_id={} partial_reset", source_id);
     }
 
@@ -97,6 +103,8 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
         std::transform(adpcm_coeffs, adpcm_coeffs + state.adpcm_coeffs.size(),
                        state.adpcm_coeffs.begin(),
                        [](const auto& coeff) { return static_cast<s16>(coeff); });
+        // Buffers decoded with the old coefficients.
+        decoded_buffers.clear();
         LOG_TRACE(Audio_DSP, "source_id={} adpcm update", source_id);
     }
 
@@ -143,6 +151,10 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
 
     if (config.interpolation_dirty) {
         config.interpolation_dirty.Assign(0);
+        if (state.interpolation_mode != config.interpolation_mode) {
+            // Only the polyphase filter keeps a third history sample, don't start from a stale one.
+            state.interp_state.xn3 = {};
+        }
         state.interpolation_mode = config.interpolation_mode;
         LOG_TRACE(Audio_DSP, "source_id={} interpolation_mode={}", source_id,
                   static_cast<std::size_t>(state.interpolation_mode));
@@ -178,56 +190,54 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
         // buffer_id (after a check comparing the buffer_id to something, probably to make sure it's
         // the same buffer?), flags2_raw.is_looping, and length.
 
-        // A quick and dirty way of extending the current buffer is to just read the whole thing
-        // again with the new length. Note that this uses the latched physical address instead of
-        // whatever is in config, because that may be invalid.
+        // Extend the current buffer to the new length. Note that this uses the latched physical
+        // address instead of whatever is in config, because that may be invalid.
         const u8* const memory =
             memory_system->GetPhysicalPointer(state.current_buffer_physical_address & 0xFFFFFFFC);
 
-        // TODO(xperia64): This could potentially be optimized by only decoding the new data and
-        // appending that to the buffer.
         if (memory) {
-            const unsigned num_channels = state.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
             bool valid = false;
             switch (state.format) {
             case Format::PCM8:
                 // TODO(xperia64): This may just work fine like PCM16, but I haven't tested and
                 // couldn't find any test case games
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "PCM8");
-                // state.current_buffer = Codec::DecodePCM8(num_channels, memory, config.length);
                 break;
             case Format::PCM16:
-                state.current_buffer = Codec::DecodePCM16(num_channels, memory, config.length);
+                if (state.current_buffer_in_place) {
+                    // Nothing was decoded, the new samples are read in place like the old ones.
+                    state.current_buffer_length = config.length;
+                } else {
+                    // TODO(xperia64): This could potentially be optimized by only decoding the new
+                    // data and appending that to the buffer.
+                    DecodeCurrentBuffer(memory, config.length, Format::PCM16,
+                                        state.mono_or_stereo);
+                }
                 valid = true;
                 break;
             case Format::ADPCM:
                 // TODO(xperia64): Are partial embedded buffer updates even valid for ADPCM? What
                 // about the adpcm state?
                 UNIMPLEMENTED_MSG("{} not handled for partial buffer updates", "ADPCM");
-                /* state.current_buffer =
-                    Codec::DecodeADPCM(memory, config.length, state.adpcm_coeffs,
-                   state.adpcm_state); */
                 break;
             default:
                 UNIMPLEMENTED();
                 break;
             }
 
-            // Again, because our interpolation consumes samples instead of using an index, let's
-            // just re-consume the samples up to the current sample number. There may be some
-            // imprecision here with the current sample number, as Detective Pikachu sounds a little
-            // rough at times.
+            // Seek back to the current sample number, as the interpolator's read position is not
+            // tracked in the same units. There may be some imprecision here with the current
+            // sample number, as Detective Pikachu sounds a little rough at times.
             if (valid) {
 
                 // TODO(xperia64): Tomodachi life apparently can decrease config.length when the
                 // user skips dialog. I don't know the correct behavior, but to avoid crashing, just
                 // reset the current sample number to 0 and don't try to truncate the buffer
-                if (state.current_buffer.size() < state.current_sample_number) {
+                if (state.current_buffer_length < state.current_sample_number) {
                     state.current_sample_number = 0;
+                    state.current_buffer_position = 0;
                 } else {
-                    state.current_buffer.erase(
-                        state.current_buffer.begin(),
-                        std::next(state.current_buffer.begin(), state.current_sample_number));
+                    state.current_buffer_position = state.current_sample_number;
                 }
             }
         }
@@ -319,10 +329,154 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
     config.dirty_raw = 0;
 }
 
+void Source::PrefetchSamples() {
+    // When the current buffer is exhausted, the frame only dequeues the next buffer.
+    const bool dequeue_only = IsCurrentBufferExhausted();
+    std::size_t budget =
+        dequeue_only ? 0
+                     : AudioInterp::MaxInputSamples(state.interp_state, state.rate_multiplier,
+                                                    current_frame.size());
+
+    if (!dequeue_only) {
+        const std::size_t count =
+            std::min(budget, state.current_buffer_length - state.current_buffer_position);
+        if (state.current_buffer_in_place) {
+            state.current_buffer_offset = state.current_buffer_position;
+            if (!ReadInPlaceSamples(state.current_buffer_physical_address,
+                                    state.current_buffer_position, count,
+                                    state.current_buffer)) {
+                // The memory backing the buffer went away, drop the rest of the buffer.
+                state.current_buffer.clear();
+                state.current_buffer_position = state.current_buffer_length;
+            }
+        }
+        budget -= count;
+    }
+
+    for (auto& decoded : decoded_buffers) {
+        decoded->used = false;
+    }
+
+    // Walk a copy of the queue in the same order DequeueBuffer takes buffers from it.
+    auto queue = state.input_queue;
+    Codec::ADPCMState adpcm_state = state.adpcm_state;
+    while (!queue.empty() && (dequeue_only || budget > 0)) {
+        Buffer buf = queue.top();
+        queue.pop();
+
+        if (buf.adpcm_dirty) {
+            adpcm_state.yn1 = buf.adpcm_yn[0];
+            adpcm_state.yn2 = buf.adpcm_yn[1];
+        }
+
+        auto& prefetched = prefetched_buffers.emplace_back();
+        prefetched.buffer_id = buf.buffer_id;
+        // This physical address masking occurs due to how the DSP DMA hardware is configured by
+        // the firmware.
+        const u8* const memory =
+            memory_system->GetPhysicalPointer(buf.physical_address & 0xFFFFFFFC);
+        prefetched.valid = memory != nullptr;
+        if (!memory) {
+            // DequeueBuffer drops the buffer without playing it.
+            if (dequeue_only) {
+                break;
+            }
+            continue;
+        }
+
+        // The first playthrough starts at play_position, loops start at the beginning.
+        const std::size_t start_position = buf.has_played ? 0 : buf.play_position;
+        std::size_t count = 0;
+        if (buf.format == Format::PCM16 && buf.mono_or_stereo == MonoOrStereo::Stereo) {
+            prefetched.offset = std::min<std::size_t>(start_position, buf.length);
+            count = std::min<std::size_t>(budget, buf.length - prefetched.offset);
+            ReadInPlaceSamples(buf.physical_address, prefetched.offset, count, prefetched.samples);
+        } else {
+            prefetched.offset = 0;
+            prefetched.decoded = GetDecodedBuffer(buf, memory, adpcm_state);
+            const std::size_t size = prefetched.decoded->samples.size();
+            count = std::min(budget, size - std::min(start_position, size));
+        }
+        budget -= count;
+
+        // A looping buffer without any samples to play would be dequeued forever.
+        if (dequeue_only || (buf.is_looping && count == 0)) {
+            break;
+        }
+        if (buf.is_looping) {
+            buf.has_played = true;
+            queue.push(buf);
+        }
+    }
+}
+
+std::shared_ptr<Source::DecodedBuffer> Source::GetDecodedBuffer(const Buffer& buf,
+                                                                const u8* memory,
+                                                                Codec::ADPCMState& adpcm_state) {
+    const std::size_t num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    std::size_t input_size = 0;
+    switch (buf.format) {
+    case Format::PCM8:
+        input_size = buf.length * num_channels;
+        break;
+    case Format::PCM16:
+        input_size = buf.length * num_channels * sizeof(s16);
+        break;
+    case Format::ADPCM:
+        input_size = Codec::ADPCMInputSize(buf.length);
+        break;
+    }
+    // Hashing the buffer is much cheaper than decoding it, and notices the guest writing to it.
+    const u64 data_hash = Common::ComputeHash64(memory, input_size);
+
+    const auto is_same_location = [&](const std::shared_ptr<DecodedBuffer>& decoded) {
+        return decoded->physical_address == buf.physical_address &&
+               decoded->length == buf.length && decoded->format == buf.format &&
+               decoded->mono_or_stereo == buf.mono_or_stereo;
+    };
+    const auto is_same_input = [&](const std::shared_ptr<DecodedBuffer>& decoded) {
+        return is_same_location(decoded) &&
+               (buf.format != Format::ADPCM || decoded->initial_adpcm_state == adpcm_state);
+    };
+    auto it = std::find_if(decoded_buffers.begin(), decoded_buffers.end(), is_same_input);
+    if (it != decoded_buffers.end() && (*it)->data_hash == data_hash) {
+        (*it)->used = true;
+        adpcm_state = (*it)->final_adpcm_state;
+        return *it;
+    }
+    if (it == decoded_buffers.end()) {
+        // An ADPCM buffer played from another state replaces the samples decoded from the old
+        // one, unless this frame plays both.
+        it = std::find_if(decoded_buffers.begin(), decoded_buffers.end(),
+                          [&](const auto& decoded) {
+                              return is_same_location(decoded) && !decoded->used;
+                          });
+    }
+
+    // Not decoded yet, or the guest wrote to the buffer since.
+    auto decoded = std::make_shared<DecodedBuffer>();
+    decoded->physical_address = buf.physical_address;
+    decoded->length = buf.length;
+    decoded->format = buf.format;
+    decoded->mono_or_stereo = buf.mono_or_stereo;
+    decoded->initial_adpcm_state = adpcm_state;
+    decoded->data_hash = data_hash;
+    DecodeBuffer(memory, buf.length, buf.format, buf.mono_or_stereo, adpcm_state,
+                 decoded->samples);
+    decoded->final_adpcm_state = adpcm_state;
+    decoded->used = true;
+    if (it != decoded_buffers.end()) {
+        *it = decoded;
+    } else {
+        decoded_buffers.push_back(decoded);
+    }
+    return decoded;
+}
+
 void Source::GenerateFrame() {
     current_frame.fill({});
 
-    if (state.current_buffer.empty()) {
+    if (IsCurrentBufferExhausted()) {
         // TODO(SachinV): Should dequeue happen at the end of the frame generation?
         if (DequeueBuffer()) {
             return;
@@ -336,28 +490,44 @@ void Source::GenerateFrame() {
 
     std::size_t frame_position = 0;
     while (frame_position < current_frame.size()) {
-        if (state.current_buffer.empty() && !DequeueBuffer()) {
+        if (IsCurrentBufferExhausted() && !DequeueBuffer()) {
             break;
         }
 
-        switch (state.interpolation_mode) {
-        case InterpolationMode::None:
-            AudioInterp::None(state.interp_state, state.current_buffer, state.rate_multiplier,
-                              current_frame, frame_position);
-            break;
-        case InterpolationMode::Linear:
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
-            break;
-        case InterpolationMode::Polyphase:
-            // TODO(merry): Implement polyphase interpolation
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier,
-                                current_frame, frame_position);
-            break;
-        default:
-            UNIMPLEMENTED();
+        // current_buffer only holds the samples of the buffer from current_buffer_offset on.
+        std::size_t position = state.current_buffer_position - state.current_buffer_offset;
+        if (!IsCurrentBufferExhausted() && position >= state.current_buffer.size()) {
+            // Everything PrepareFrame read for this frame has been consumed.
             break;
         }
+
+        {
+            BORKED3DS_AUDIO_STAGE(AudioStage::Interpolation, "Interpolation");
+            const AudioInterp::StereoSpan16 samples = state.current_buffer;
+            switch (state.interpolation_mode) {
+            case InterpolationMode::None:
+                AudioInterp::None(state.interp_state, samples, position, state.rate_multiplier,
+                                  current_frame, frame_position);
+                break;
+            case InterpolationMode::Linear:
+                AudioInterp::Linear(state.interp_state, samples, position, state.rate_multiplier,
+                                    current_frame, frame_position);
+                break;
+            case InterpolationMode::Polyphase:
+                if (polyphase_enabled) {
+                    AudioInterp::Polyphase(state.interp_state, samples, position,
+                                           state.rate_multiplier, current_frame, frame_position);
+                } else {
+                    AudioInterp::Linear(state.interp_state, samples, position,
+                                        state.rate_multiplier, current_frame, frame_position);
+                }
+                break;
+            default:
+                UNIMPLEMENTED();
+                break;
+            }
+        }
+        state.current_buffer_position = state.current_buffer_offset + position;
     }
     // TODO(jroweboy): Keep track of frame_position independently so that it doesn't lose precision
     // over time
@@ -367,49 +537,64 @@ void Source::GenerateFrame() {
 }
 
 bool Source::DequeueBuffer() {
-    ASSERT_MSG(state.current_buffer.empty(),
+    ASSERT_MSG(IsCurrentBufferExhausted(),
                "Shouldn't dequeue; we still have data in current_buffer");
 
-    if (state.input_queue.empty())
+    // The rest of the queue is prefetched for the next frame.
+    if (state.input_queue.empty() || next_prefetched_buffer == prefetched_buffers.size())
         return false;
 
     Buffer buf = state.input_queue.top();
     state.input_queue.pop();
+    auto& prefetched = prefetched_buffers[next_prefetched_buffer++];
+    DEBUG_ASSERT(prefetched.buffer_id == buf.buffer_id);
 
     if (buf.adpcm_dirty) {
         state.adpcm_state.yn1 = buf.adpcm_yn[0];
         state.adpcm_state.yn2 = buf.adpcm_yn[1];
     }
 
-    // This physical address masking occurs due to how the DSP DMA hardware is configured by the
-    // firmware.
-    const u8* const memory = memory_system->GetPhysicalPointer(buf.physical_address & 0xFFFFFFFC);
-    if (memory) {
-        const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
-    } else {
+    if (!prefetched.valid) {
         LOG_WARNING(Audio_DSP,
                     "source_id={} buffer_id={} length={}: Invalid physical address {:#010x}",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
+        state.current_buffer_in_place = false;
         state.current_buffer.clear();
+        state.current_buffer_offset = 0;
+        state.current_buffer_length = 0;
+        state.current_buffer_position = 0;
         return true;
     }
 
+    state.current_buffer_offset = prefetched.offset;
+    if (auto& decoded = prefetched.decoded) {
+        state.adpcm_state = decoded->final_adpcm_state;
+        if (buf.is_looping) {
+            // Kept for the next loop.
+            state.current_buffer = decoded->samples;
+        } else {
+            std::erase(decoded_buffers, decoded);
+            // Another queued buffer may have the same contents.
+            if (decoded.use_count() == 1) {
+                state.current_buffer = std::move(decoded->samples);
+            } else {
+                state.current_buffer = decoded->samples;
+            }
+        }
+        decoded.reset();
+    } else {
+        state.current_buffer = std::move(prefetched.samples);
+    }
+    if (buf.format == Format::PCM16 && buf.mono_or_stereo == MonoOrStereo::Stereo) {
+        // Interleaved stereo PCM16 is exactly what the interpolator consumes, so the buffer is
+        // not decoded. This also means looping buffers are never decoded again.
+        state.current_buffer_in_place = true;
+        state.current_buffer_length = buf.length;
+    } else {
+        state.current_buffer_in_place = false;
+        state.current_buffer_length = static_cast<u32>(state.current_buffer.size());
+    }
+
     // the first playthrough starts at play_position, loops start at the beginning of the buffer
     state.current_sample_number = (!buf.has_played) ? buf.play_position : 0;
     state.current_buffer_physical_address = buf.physical_address;
@@ -422,20 +607,66 @@ bool Source::DequeueBuffer() {
         state.input_queue.push(buf);
     }
 
-    // Because our interpolation consumes samples instead of using an index,
-    // let's just consume the samples up to the current sample number.
-    state.current_buffer.erase(
-        state.current_buffer.begin(),
-        std::next(state.current_buffer.begin(), state.current_sample_number));
+    // Because our interpolation reads samples from an index, start reading at the current sample
+    // number.
+    state.current_buffer_position =
+        std::min<std::size_t>(state.current_sample_number, state.current_buffer_length);
 
     LOG_TRACE(Audio_DSP,
-              "source_id={} buffer_id={} from_queue={} current_buffer.size()={}, "
+              "source_id={} buffer_id={} from_queue={} remaining samples={}, "
               "buf.has_played={}, buf.play_position={}",
-              source_id, buf.buffer_id, buf.from_queue, state.current_buffer.size(), buf.has_played,
+              source_id, buf.buffer_id, buf.from_queue,
+              state.current_buffer_length - state.current_buffer_position, buf.has_played,
               buf.play_position);
     return true;
 }
 
+void Source::DecodeCurrentBuffer(const u8* memory, u32 length, Format format,
+                                 MonoOrStereo mono_or_stereo) {
+    DecodeBuffer(memory, length, format, mono_or_stereo, state.adpcm_state, state.current_buffer);
+    state.current_buffer_in_place = false;
+    state.current_buffer_offset = 0;
+    state.current_buffer_length = static_cast<u32>(state.current_buffer.size());
+}
+
+void Source::DecodeBuffer(const u8* memory, u32 length, Format format,
+                          MonoOrStereo mono_or_stereo, Codec::ADPCMState& adpcm_state,
+                          AudioInterp::StereoBuffer16& output) const {
+    BORKED3DS_AUDIO_STAGE(AudioStage::SourceDecode, "Source decode");
+    const unsigned num_channels = mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    // Resizing keeps the allocation of output, which is reused when decoding into it again.
+    switch (format) {
+    case Format::PCM8:
+        output.resize(length);
+        Codec::DecodePCM8(num_channels, memory, length, output);
+        break;
+    case Format::PCM16:
+        output.resize(length);
+        Codec::DecodePCM16(num_channels, memory, length, output);
+        break;
+    case Format::ADPCM:
+        DEBUG_ASSERT(num_channels == 1);
+        output.resize(Codec::ADPCMDecodedSize(length));
+        Codec::DecodeADPCM(memory, length, state.adpcm_coeffs, adpcm_state, output);
+        break;
+    default:
+        UNIMPLEMENTED();
+        output.clear();
+        break;
+    }
+}
+
+bool Source::ReadInPlaceSamples(PAddr physical_address, std::size_t start, std::size_t count,
+                                AudioInterp::StereoBuffer16& output) {
+    const u8* const memory = memory_system->GetPhysicalPointer(physical_address & 0xFFFFFFFC);
+    if (!memory) {
+        return false;
+    }
+    const auto* const samples = reinterpret_cast<const std::array<s16, 2>*>(memory) + start;
+    output.assign(samples, samples + count);
+    return true;
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret;
 
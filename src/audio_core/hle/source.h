@@ -6,9 +6,9 @@
 #pragma once
 
 #include <array>
+#include <memory>
 #include <vector>
 #include <boost/serialization/array.hpp>
-#include <boost/serialization/deque.hpp>
 #include <boost/serialization/priority_queue.hpp>
 #include <boost/serialization/vector.hpp>
 #include <queue>
@@ -46,16 +46,30 @@ public:
     /// Sets the memory system to read data from
     void SetMemory(Memory::MemorySystem& memory);
 
+    /// Enables the polyphase filter for sources requesting it, they use linear interpolation
+    /// otherwise.
+    void SetPolyphaseEnabled(bool enabled) {
+        polyphase_enabled = enabled;
+    }
+
     /**
-     * This is called once every audio frame. This performs per-source processing every frame.
+     * This is called once every audio frame on the emulation thread, before Tick. This applies
+     * the new configuration and reads everything the next frame needs from guest memory, so that
+     * Tick does not touch guest memory.
      * @param config The new configuration we've got for this Source from the application.
      * @param adpcm_coeffs ADPCM coefficients to use if config tells us to use them (may contain
      * invalid values otherwise).
+     */
+    void PrepareFrame(SourceConfiguration::Configuration& config,
+                      const s16_le (&adpcm_coeffs)[16]);
+
+    /**
+     * This is called once every audio frame, after PrepareFrame. This performs per-source
+     * processing every frame.
      * @return The current status of this Source. This is given back to the emulated application via
      * SharedMemory.
      */
-    SourceStatus::Status Tick(SourceConfiguration::Configuration& config,
-                              const s16_le (&adpcm_coeffs)[16]);
+    SourceStatus::Status Tick();
 
     /**
      * Mix this source's output into dest, using the gains for the `intermediate_mix_id`-th
@@ -68,6 +82,7 @@ public:
 private:
     const std::size_t source_id;
     Memory::MemorySystem* memory_system{};
+    bool polyphase_enabled = false;
     StereoFrame16 current_frame;
 
     using Format = SourceConfiguration::Configuration::Format;
@@ -117,6 +132,44 @@ private:
         }
     };
 
+    /// Decoded samples of a queued buffer. These are kept across frames and loops, until the
+    /// buffer is dequeued for the last time or the guest writes to it. Entries are looked up by
+    /// the buffer's location, format and ADPCM state, and checked against the hash of its data.
+    struct DecodedBuffer {
+        PAddr physical_address;
+        u32 length;
+        Format format;
+        MonoOrStereo mono_or_stereo;
+        /// ADPCM state the buffer was decoded from.
+        Codec::ADPCMState initial_adpcm_state;
+        /// Hash of the guest memory the samples were decoded from.
+        u64 data_hash;
+        AudioInterp::StereoBuffer16 samples;
+        /// ADPCM state once the buffer has been decoded.
+        Codec::ADPCMState final_adpcm_state;
+        /// Whether the current PrefetchSamples already used these samples.
+        bool used;
+    };
+
+    /// Samples of a queued buffer, read by PrepareFrame for the frame that dequeues it.
+    struct PrefetchedBuffer {
+        u16 buffer_id;
+        /// False if the buffer's physical address was invalid.
+        bool valid;
+        /// Index within the buffer of the first sample in samples.
+        std::size_t offset;
+        /// Samples of a buffer read in place.
+        AudioInterp::StereoBuffer16 samples;
+        /// Samples of a buffer that is decoded, set instead of samples.
+        std::shared_ptr<DecodedBuffer> decoded;
+    };
+
+    /// Buffers the next frame may dequeue, in the order it dequeues them.
+    std::vector<PrefetchedBuffer> prefetched_buffers;
+    std::size_t next_prefetched_buffer = 0;
+    /// Buffers decoded by PrefetchSamples, see DecodedBuffer.
+    std::vector<std::shared_ptr<DecodedBuffer>> decoded_buffers;
+
     struct {
 
         // State variables
@@ -138,7 +191,18 @@ private:
 
         u32 current_sample_number = 0;
         PAddr current_buffer_physical_address = 0;
+        /// Length of the current buffer, in samples.
+        u32 current_buffer_length = 0;
+        /// Stereo PCM16 buffers are already in the layout the interpolator consumes, so they are
+        /// not decoded. Only the samples the next frame reads are copied into current_buffer.
+        bool current_buffer_in_place = false;
+        /// Decoded samples of the current buffer, starting at current_buffer_offset.
         AudioInterp::StereoBuffer16 current_buffer = {};
+        /// Index within the buffer of the first sample in current_buffer. Always 0 unless the
+        /// buffer is read in place.
+        std::size_t current_buffer_offset = 0;
+        /// Index of the next sample of the current buffer to be consumed.
+        std::size_t current_buffer_position = 0;
 
         // buffer_id state
 
@@ -187,19 +251,58 @@ private:
 
     /// INTERNAL: Update our internal state based on the current config.
     void ParseConfig(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
+    /// INTERNAL: Reads the samples the next frame consumes from guest memory.
+    void PrefetchSamples();
     /// INTERNAL: Generate the current audio output for this frame based on our internal state.
     void GenerateFrame();
-    /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
-    /// into current_buffer.
+    /// INTERNAL: Dequeues a buffer and makes it the current buffer, taking its samples from
+    /// prefetched_buffers. Returns false if there is none or it was not prefetched.
     bool DequeueBuffer();
+    /// INTERNAL: Decodes `length` samples starting at `memory` into current_buffer.
+    void DecodeCurrentBuffer(const u8* memory, u32 length, Format format,
+                             MonoOrStereo mono_or_stereo);
+    /// INTERNAL: Returns the decoded samples of `buf`, decoding it only if it is not in
+    /// decoded_buffers yet or its guest memory changed since. Updates `adpcm_state`.
+    std::shared_ptr<DecodedBuffer> GetDecodedBuffer(const Buffer& buf, const u8* memory,
+                                                    Codec::ADPCMState& adpcm_state);
+    /// INTERNAL: Decodes `length` samples starting at `memory` into `output`.
+    void DecodeBuffer(const u8* memory, u32 length, Format format, MonoOrStereo mono_or_stereo,
+                      Codec::ADPCMState& adpcm_state, AudioInterp::StereoBuffer16& output) const;
+    /// INTERNAL: Copies `count` samples, starting at sample `start` of the stereo PCM16 buffer at
+    /// `physical_address`, into `output`. Returns false if the address is invalid.
+    bool ReadInPlaceSamples(PAddr physical_address, std::size_t start, std::size_t count,
+                            AudioInterp::StereoBuffer16& output);
+    /// INTERNAL: Returns true once every sample of the current buffer has been consumed.
+    bool IsCurrentBufferExhausted() const {
+        return state.current_buffer_position >= state.current_buffer_length;
+    }
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int) {
+    void serialize(Archive& ar, const unsigned int file_version) {
         ar & state;
+        if (file_version > 0) {
+            ar & state.current_buffer_length;
+            ar & state.current_buffer_in_place;
+            ar & state.current_buffer_position;
+        } else if (Archive::is_loading::value) {
+            // Older states stored only the unconsumed part of the decoded buffer.
+            state.current_buffer_length = static_cast<u32>(state.current_buffer.size());
+            state.current_buffer_in_place = false;
+            state.current_buffer_position = 0;
+        }
+        if (Archive::is_loading::value) {
+            // Samples read ahead from guest memory are read again by the next PrepareFrame.
+            state.current_buffer_offset = 0;
+            prefetched_buffers.clear();
+            next_prefetched_buffer = 0;
+            decoded_buffers.clear();
+        }
     }
     friend class boost::serialization::access;
 };
 
 } // namespace AudioCore::HLE
+
+BOOST_CLASS_VERSION(AudioCore::HLE::Source, 1)
@@ -4,9 +4,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
 #include "audio_core/interpolate.h"
+#include "common/arch.h"
 #include "common/assert.h"
 
+#if BORKED3DS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif BORKED3DS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
@@ -14,64 +24,232 @@ namespace AudioCore::AudioInterp {
 constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
+using Sample = std::array<s16, 2>;
+
 /// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
-static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-                            std::size_t& outputi, Function fn) {
+/// Each step fn is passed a pointer to `Taps` adjacent samples, the first `Taps - 1` of which are
+/// carried over between calls as history. The history samples are addressed as if they preceded
+/// input[inputi], so that neither the history nor the consumed samples have to be moved around in
+/// the input buffer.
+template <std::size_t Taps, typename Function>
+static void StepOverSamples(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+                            StereoFrame16& output, std::size_t& outputi, Function fn) {
+    static_assert(Taps == 3 || Taps == 4);
+    constexpr std::size_t history_size = Taps - 1;
+
     ASSERT(rate > 0);
 
-    if (input.empty())
+    if (inputi >= input.size())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    const StereoSpan16 samples = input.subspan(inputi);
+    const std::size_t size = samples.size() + history_size;
+
+    // Windows starting within the history are read from a small contiguous copy of the history
+    // followed by the first few samples, all later ones straight from the input.
+    std::array<Sample, 2 * history_size> prefix{};
+    if constexpr (Taps == 4) {
+        prefix[0] = state.xn3;
+    }
+    prefix[history_size - 2] = state.xn2;
+    prefix[history_size - 1] = state.xn1;
+    std::copy_n(samples.begin(), std::min(history_size, samples.size()),
+                prefix.begin() + history_size);
+    const auto window = [&](std::size_t i) -> const Sample* {
+        return i < history_size ? prefix.data() + i : samples.data() + (i - history_size);
+    };
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
     u64 fposition = state.fposition;
-    std::size_t inputi = 0;
+    std::size_t i = 0;
 
     while (outputi < output.size()) {
-        inputi = static_cast<std::size_t>(fposition / scale_factor);
+        i = static_cast<std::size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (i + history_size >= size) {
+            i = size - history_size;
             break;
         }
 
         u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        output[outputi++] = fn(fraction, window(i));
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
-    state.fposition = fposition - inputi * scale_factor;
+    const Sample* const history = window(i);
+    if constexpr (Taps == 4) {
+        state.xn3 = history[history_size - 3];
+    }
+    state.xn2 = history[history_size - 2];
+    state.xn1 = history[history_size - 1];
+    state.fposition = fposition - i * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    inputi += i;
 }
 
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-          std::size_t& outputi) {
-    StepOverSamples(
-        state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+std::size_t MaxInputSamples(const State& state, float rate, std::size_t output_count) {
+    // The n-th output reads the input up to index (fposition + n * step_size) / scale_factor.
+    const u64 step_size = static_cast<u64>(rate * scale_factor);
+    return static_cast<std::size_t>((state.fposition + output_count * step_size) / scale_factor) +
+           1;
 }
 
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-            std::size_t& outputi) {
+void None(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+          StereoFrame16& output, std::size_t& outputi) {
+    StepOverSamples<3>(state, input, inputi, rate, output, outputi,
+                       [](u64 fraction, const Sample* x) { return x[0]; });
+}
+
+void Linear(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+            StereoFrame16& output, std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    StepOverSamples<3>(state, input, inputi, rate, output, outputi,
+                       [](u64 fraction, const Sample* x) {
+                           // This is a saturated subtraction. (Verified by black-box fuzzing.)
+                           s64 delta0 = std::clamp<s64>(x[1][0] - x[0][0], -32768, 32767);
+                           s64 delta1 = std::clamp<s64>(x[1][1] - x[0][1], -32768, 32767);
+
+                           return Sample{
+                               static_cast<s16>(x[0][0] + fraction * delta0 / scale_factor),
+                               static_cast<s16>(x[0][1] + fraction * delta1 / scale_factor),
+                           };
+                       });
+}
+
+namespace {
+
+constexpr std::size_t polyphase_taps = 4;
+constexpr std::size_t polyphase_phase_bits = 8;
+constexpr std::size_t polyphase_phases = 1 << polyphase_phase_bits;
+constexpr std::size_t polyphase_banks = 3;
+
+/// Q15 filter coefficients, indexed by [bank][phase][tap].
+using PolyphaseTable =
+    std::array<std::array<std::array<s16, polyphase_taps>, polyphase_phases>, polyphase_banks>;
+
+/// Lanczos window parameter, the number of zero crossings of the sinc kept on each side. A
+/// four-tap filter spans two input samples on either side of the output position.
+constexpr double polyphase_lanczos_a = polyphase_taps / 2;
+
+/// Highest stretch factor handled by each filter bank. A bank's cutoff is the output Nyquist
+/// frequency at that rate, 1 / rate relative to the input Nyquist frequency, so upsampling keeps
+/// the full band and decimation filters out what would otherwise alias. Higher rates use the last
+/// bank.
+constexpr std::array<double, polyphase_banks> polyphase_bank_rates = {1.0, 4.0 / 3.0, 2.0};
+
+/// Selects the filter bank for a stretch factor.
+std::size_t PolyphaseBank(float rate) {
+    for (std::size_t bank = 0; bank < polyphase_banks - 1; bank++) {
+        if (rate <= polyphase_bank_rates[bank]) {
+            return bank;
+        }
+    }
+    return polyphase_banks - 1;
+}
+
+/**
+ * Builds the coefficient tables. The output of phase p lies p / polyphase_phases of the way
+ * between the second and third taps, at a distance t from each tap. Tap weights are the
+ * low-pass impulse response cutoff * sinc(cutoff * t) times the Lanczos window sinc(t / a).
+ * Every phase is normalised to unity gain so that a constant input passes through unchanged.
+ */
+PolyphaseTable MakePolyphaseTable() {
+    const auto sinc = [](double x) {
+        return x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+    };
+
+    PolyphaseTable table{};
+    for (std::size_t bank = 0; bank < polyphase_banks; bank++) {
+        const double cutoff = 1.0 / polyphase_bank_rates[bank];
+        for (std::size_t phase = 0; phase < polyphase_phases; phase++) {
+            const double fraction = static_cast<double>(phase) / polyphase_phases;
+
+            std::array<double, polyphase_taps> weights{};
+            double sum = 0.0;
+            for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+                const double t = static_cast<double>(tap) - 1.0 - fraction;
+                const double window = sinc(t / polyphase_lanczos_a);
+                weights[tap] = cutoff * sinc(cutoff * t) * window;
+                sum += weights[tap];
+            }
+
+            // Round to Q15 and give the rounding error to the largest tap, so that every phase
+            // has exactly the same gain. 32767 is used as unity as the centre tap of phase 0
+            // would not fit otherwise.
+            auto& coeffs = table[bank][phase];
+            s32 total = 0;
+            std::size_t largest = 0;
+            for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+                coeffs[tap] = static_cast<s16>(std::lround(weights[tap] / sum * 32767.0));
+                total += coeffs[tap];
+                if (weights[tap] > weights[largest]) {
+                    largest = tap;
+                }
+            }
+            coeffs[largest] = static_cast<s16>(
+                std::clamp<s32>(coeffs[largest] + (32767 - total), -32768, 32767));
+        }
+    }
+    return table;
+}
+
+const PolyphaseTable& GetPolyphaseTable() {
+    static const PolyphaseTable table = MakePolyphaseTable();
+    return table;
+}
+
+/// Applies one phase of the filter to four adjacent stereo samples.
+Sample PolyphaseKernel(const Sample* x, const std::array<s16, polyphase_taps>& coeffs) {
+#if BORKED3DS_ARCH(x86_64)
+    // x holds L0 R0 L1 R1 L2 R2 L3 R3; regroup it to L0 L1 R0 R1 L2 L3 R2 R3 so that madd pairs
+    // up taps of the same channel against c0 c1 c0 c1 c2 c3 c2 c3.
+    __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));
+    samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+    samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(coeffs.data()));
+    c = _mm_unpacklo_epi32(c, c);
+    __m128i sum = _mm_madd_epi16(samples, c);
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 14)), 15);
+    const s32 packed = _mm_cvtsi128_si32(_mm_packs_epi32(sum, sum));
+    Sample result;
+    std::memcpy(result.data(), &packed, sizeof(result));
+    return result;
+#elif BORKED3DS_ARCH(arm64)
+    const int16x4x2_t samples = vld2_s16(x->data());
+    const int16x4_t c = vld1_s16(coeffs.data());
+    const int32x4_t left = vmull_s16(samples.val[0], c);
+    const int32x4_t right = vmull_s16(samples.val[1], c);
+    const int32x4_t pairs = vpaddq_s32(left, right);
+    const int16x4_t sum = vqrshrn_n_s32(vpaddq_s32(pairs, pairs), 15);
+    const s32 packed = vget_lane_s32(vreinterpret_s32_s16(sum), 0);
+    Sample result;
+    std::memcpy(result.data(), &packed, sizeof(result));
+    return result;
+#else
+    s32 left = 0;
+    s32 right = 0;
+    for (std::size_t tap = 0; tap < polyphase_taps; tap++) {
+        left += x[tap][0] * coeffs[tap];
+        right += x[tap][1] * coeffs[tap];
+    }
+    return Sample{
+        static_cast<s16>(std::clamp<s32>((left + (1 << 14)) >> 15, -32768, 32767)),
+        static_cast<s16>(std::clamp<s32>((right + (1 << 14)) >> 15, -32768, 32767)),
+    };
+#endif
+}
+
+} // Anonymous namespace
+
+void Polyphase(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+               StereoFrame16& output, std::size_t& outputi) {
+    const auto& bank = GetPolyphaseTable()[PolyphaseBank(rate)];
+    StepOverSamples<polyphase_taps>(
+        state, input, inputi, rate, output, outputi, [&bank](u64 fraction, const Sample* x) {
+            return PolyphaseKernel(x, bank[fraction >> (24 - polyphase_phase_bits)]);
+        });
 }
 
 } // namespace AudioCore::AudioInterp
@@ -6,45 +6,76 @@
 #pragma once
 
 #include <array>
-#include <deque>
+#include <span>
+#include <vector>
 #include "audio_core/audio_types.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
 /// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+using StereoBuffer16 = std::vector<std::array<s16, 2>>;
+
+/// A read-only view of signed PCM16 stereo samples.
+using StereoSpan16 = std::span<const std::array<s16, 2>>;
 
 struct State {
     /// Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    std::array<s16, 2> xn3 = {}; ///< x[n-3], only used by polyphase interpolation
     /// Current fractional position.
     u64 fposition = 0;
 };
 
+/**
+ * Returns an upper bound of the number of input samples any of the interpolators reads to produce
+ * `output_count` samples, starting from `state`. This holds across buffer boundaries, as the
+ * history is carried over from one buffer to the next.
+ * @param state Interpolation state.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ * @param output_count The number of samples to produce.
+ */
+std::size_t MaxInputSamples(const State& state, float rate, std::size_t output_count);
+
 /**
  * No interpolation. This is equivalent to a zero-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
  * @param input Input buffer.
+ * @param inputi The index of input to start reading from. Advanced past the consumed samples.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-          std::size_t& outputi);
+void None(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+          StereoFrame16& output, std::size_t& outputi);
 
 /**
  * Linear interpolation. This is equivalent to a first-order hold. There is a two-sample predelay.
  * @param state Interpolation state.
  * @param input Input buffer.
+ * @param inputi The index of input to start reading from. Advanced past the consumed samples.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Linear(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+            StereoFrame16& output, std::size_t& outputi);
+
+/**
+ * Polyphase interpolation. This is a four-tap windowed-sinc filter with 256 phases. The filter
+ * cutoff is lowered when decimating. There is a two-sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param inputi The index of input to start reading from. Advanced past the consumed samples.
  * @param rate Stretch factor. Must be a positive non-zero value.
  *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
  * @param output The resampled audio buffer.
  * @param outputi The index of output to start writing to.
  */
-void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
-            std::size_t& outputi);
+void Polyphase(State& state, StereoSpan16 input, std::size_t& inputi, float rate,
+               StereoFrame16& output, std::size_t& outputi);
 
 } // namespace AudioCore::AudioInterp
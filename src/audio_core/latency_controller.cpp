@@ -0,0 +1,80 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include "audio_core/latency_controller.h"
+
+namespace AudioCore {
+
+namespace {
+/// Lowest target latency regardless of callback size, in seconds.
+constexpr double min_latency = 0.020;
+/// Largest deviation of the resampling ratio from 1.0. 0.5% is well below audible pitch change.
+constexpr double max_correction = 0.005;
+/// Correction applied per unit of relative fill error.
+constexpr double correction_gain = 0.01;
+/// Time constant of the fill level low-pass filter, in seconds.
+constexpr double level_time_scale = 0.25;
+/// Time without underruns before the target starts shrinking, in seconds.
+constexpr double stable_period = 10.0;
+} // Anonymous namespace
+
+LatencyController::LatencyController(std::size_t max_level_) : max_level(max_level_) {}
+
+void LatencyController::SetSampleRate(unsigned int sample_rate_) {
+    sample_rate = sample_rate_;
+    Reset();
+}
+
+void LatencyController::Reset() {
+    target_level = 0;
+    smoothed_level = 0.0;
+    ratio = 1.0;
+    stable_time = 0.0;
+    underrun_pending = false;
+}
+
+std::size_t LatencyController::MinimumTarget(std::size_t num_frames) const {
+    // Two callbacks worth of audio lets the producer refill one while the other is consumed.
+    const auto min_frames = static_cast<std::size_t>(min_latency * sample_rate);
+    return std::min(std::max(min_frames, num_frames * 2), max_level);
+}
+
+double LatencyController::Update(std::size_t fill_level, std::size_t num_frames) {
+    const std::size_t min_target = MinimumTarget(num_frames);
+    const double time_delta = static_cast<double>(num_frames) / sample_rate;
+
+    if (target_level == 0) {
+        target_level = min_target;
+        smoothed_level = static_cast<double>(fill_level);
+    }
+
+    if (underrun_pending) {
+        // Underruns are audible, so back off quickly by one callback's worth of latency.
+        target_level = std::min(target_level + num_frames, max_level);
+        stable_time = 0.0;
+        underrun_pending = false;
+    } else {
+        stable_time += time_delta;
+        if (stable_time >= stable_period) {
+            target_level = std::max(target_level - (target_level - min_target) / 4, min_target);
+            stable_time = 0.0;
+        }
+    }
+    target_level = std::max(target_level, min_target);
+
+    const double gain = 1.0 - std::exp(-time_delta / level_time_scale);
+    smoothed_level += gain * (static_cast<double>(fill_level) - smoothed_level);
+
+    const double error = (smoothed_level - static_cast<double>(target_level)) / target_level;
+    ratio = 1.0 + std::clamp(error * correction_gain, -max_correction, max_correction);
+    return ratio;
+}
+
+void LatencyController::ReportUnderrun() {
+    underrun_pending = true;
+}
+
+} // namespace AudioCore
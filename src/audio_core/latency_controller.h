@@ -0,0 +1,65 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "audio_core/audio_types.h"
+
+namespace AudioCore {
+
+/**
+ * Keeps the audio output buffer close to a target fill level.
+ *
+ * The host audio clock and the emulated DSP clock never run at exactly the same rate, so instead
+ * of letting the buffer slowly drain or overflow, the output is resampled by a ratio within a
+ * fraction of a percent of 1.0 (inaudible as a pitch change) that pushes the fill level back
+ * towards the target. The target itself grows when the buffer underruns and shrinks again after
+ * a stable period, trading latency for robustness only when the host actually needs it.
+ *
+ * Only used from the audio callback thread.
+ */
+class LatencyController {
+public:
+    /// @param max_level Largest fill level (in frames) the target may grow to
+    explicit LatencyController(std::size_t max_level);
+
+    void SetSampleRate(unsigned int sample_rate);
+
+    void Reset();
+
+    /**
+     * Updates the controller at the start of an audio callback.
+     * @param fill_level Frames currently buffered
+     * @param num_frames Frames requested by the callback
+     * @returns The number of input frames to consume per output frame
+     */
+    double Update(std::size_t fill_level, std::size_t num_frames);
+
+    /// Reports that the previous callback ran out of input.
+    void ReportUnderrun();
+
+    [[nodiscard]] std::size_t GetTargetLevel() const {
+        return target_level;
+    }
+
+    [[nodiscard]] double GetRatio() const {
+        return ratio;
+    }
+
+private:
+    std::size_t MinimumTarget(std::size_t num_frames) const;
+
+    std::size_t max_level;
+    unsigned int sample_rate = native_sample_rate;
+
+    std::size_t target_level = 0;
+    double smoothed_level = 0.0;
+    double ratio = 1.0;
+    /// Seconds since the last underrun, used to decide when to lower the target again.
+    double stable_time = 0.0;
+    bool underrun_pending = false;
+};
+
+} // namespace AudioCore
@@ -3,8 +3,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <functional>
 #include <thread>
 #include <teakra/teakra.h>
 #include "audio_core/lle/lle.h"
@@ -142,40 +145,141 @@ struct DspLle::Impl final {
     Core::TimingEventType* teakra_slice_event;
     std::atomic<bool> loaded = false;
 
+    static constexpr u32 DspDataOffset = 0x40000;
+    static constexpr u32 TeakraSlice = 16384;
+    static constexpr u32 MinTeakraSlice = 4096;
+    static constexpr u32 MaxTeakraSlice = 65536;
+
+    // In multithreaded mode Teakra runs on its own thread and is pipelined against the ARM side:
+    // every slice event grants it more cycles without waiting, and Teakra trails behind by at most
+    // two slices. Only interactions that observe or modify DSP state (registers, semaphore, pipes,
+    // and interrupts raised by the DSP) wait for it to catch up.
     const bool multithread;
     std::thread teakra_thread;
-    Common::Barrier teakra_slice_barrier{2};
     std::atomic<bool> stop_signal = false;
-    std::size_t stop_generation;
-
-    static constexpr u32 DspDataOffset = 0x40000;
-    static constexpr u32 TeakraSlice = 16384;
+    Common::Event work_event;
+    Common::Event caught_up_event;
+    /// Cycles handed to the Teakra thread. Only written from the emulation thread.
+    std::atomic<u64> cycles_granted = 0;
+    /// Cycles the Teakra thread has finished running.
+    std::atomic<u64> cycles_run = 0;
+
+    /// Slice size, adapted to how often the ARM side interacts with the DSP.
+    std::atomic<u32> slice_cycles = TeakraSlice;
+    u64 last_interaction_cycles = 0;
+    u64 interaction_interval = TeakraSlice * 2;
+
+    /// Interrupts raised on the Teakra thread, delivered from the emulation thread.
+    enum InterruptIndex : u32 {
+        RecvData0,
+        RecvData1,
+        RecvData2,
+        Semaphore,
+        NumInterrupts,
+    };
+    std::array<std::function<void()>, NumInterrupts> interrupt_handlers;
+    std::atomic<u32> pending_interrupts = 0;
+    bool dispatching_interrupts = false;
 
     void TeakraThread() {
+        Common::SetCurrentThreadName("Teakra");
         while (true) {
-            BORKED3DS_PROFILE("Audio", "Teakra");
-            teakra.Run(TeakraSlice);
-            teakra_slice_barrier.Sync();
-            if (stop_signal) {
-                if (stop_generation == teakra_slice_barrier.Generation())
+            const u64 target = cycles_granted.load(std::memory_order_acquire);
+            const u64 done = cycles_run.load(std::memory_order_relaxed);
+            if (done >= target) {
+                if (stop_signal) {
                     break;
+                }
+                work_event.Wait();
+                continue;
             }
+
+            {
+                BORKED3DS_PROFILE("Audio", "Teakra");
+                teakra.Run(static_cast<unsigned>(target - done));
+            }
+            cycles_run.store(target, std::memory_order_release);
+            caught_up_event.Set();
         }
         stop_signal = false;
     }
 
     void StopTeakraThread() {
         if (teakra_thread.joinable()) {
-            stop_generation = teakra_slice_barrier.Generation() + 1;
             stop_signal = true;
-            teakra_slice_barrier.Sync();
+            work_event.Set();
             teakra_thread.join();
         }
     }
 
+    void GrantCycles(u64 cycles) {
+        cycles_granted.store(cycles_granted.load(std::memory_order_relaxed) + cycles,
+                             std::memory_order_release);
+        work_event.Set();
+    }
+
+    /// Blocks the emulation thread until Teakra has run at least `cycles` cycles.
+    void WaitForTeakra(u64 cycles) {
+        if (cycles_run.load(std::memory_order_acquire) >= cycles) {
+            return;
+        }
+        BORKED3DS_PROFILE("Audio", "Teakra wait");
+        while (cycles_run.load(std::memory_order_acquire) < cycles) {
+            caught_up_event.Wait();
+        }
+    }
+
+    /// Brings Teakra up to date before the ARM side touches DSP state, and delivers any
+    /// interrupts it raised in the meantime.
+    void SyncTeakra() {
+        if (!multithread) {
+            return;
+        }
+        const u64 granted = cycles_granted.load(std::memory_order_relaxed);
+        WaitForTeakra(granted);
+
+        // Slices much longer than the gap between interactions only make each sync wait longer,
+        // while much shorter ones cost wakeups for nothing.
+        if (granted != last_interaction_cycles) {
+            interaction_interval =
+                (interaction_interval * 7 + (granted - last_interaction_cycles)) / 8;
+            last_interaction_cycles = granted;
+            slice_cycles = static_cast<u32>(std::clamp<u64>(
+                std::bit_floor(interaction_interval), MinTeakraSlice, MaxTeakraSlice));
+        }
+
+        DispatchPendingInterrupts();
+    }
+
+    void RaiseInterrupt(InterruptIndex index) {
+        if (multithread) {
+            pending_interrupts.fetch_or(1U << index, std::memory_order_release);
+        } else if (interrupt_handlers[index]) {
+            interrupt_handlers[index]();
+        }
+    }
+
+    void DispatchPendingInterrupts() {
+        // Handlers may read pipes themselves, which syncs again; the outer loop picks up anything
+        // raised while they run.
+        if (dispatching_interrupts) {
+            return;
+        }
+        dispatching_interrupts = true;
+        while (const u32 pending = pending_interrupts.exchange(0, std::memory_order_acquire)) {
+            for (u32 index = 0; index < NumInterrupts; index++) {
+                if ((pending & (1U << index)) != 0 && interrupt_handlers[index]) {
+                    interrupt_handlers[index]();
+                }
+            }
+        }
+        dispatching_interrupts = false;
+    }
+
     void RunTeakraSlice() {
         if (multithread) {
-            teakra_slice_barrier.Sync();
+            GrantCycles(slice_cycles);
+            SyncTeakra();
         } else {
             BORKED3DS_PROFILE("Audio", "Teakra");
             teakra.Run(TeakraSlice);
@@ -183,8 +287,24 @@ struct DspLle::Impl final {
     }
 
     void TeakraSliceEvent(u64 late) {
-        RunTeakraSlice();
-        u64 next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
+        u64 next;
+        if (multithread) {
+            // Interrupts raised during the previous grant are delivered before the next one, so
+            // that Teakra keeps running alongside the ARM side while their handlers run.
+            if (pending_interrupts.load(std::memory_order_acquire) != 0) {
+                SyncTeakra();
+            }
+            GrantCycles(slice_cycles);
+            const u64 granted = cycles_granted.load(std::memory_order_relaxed);
+            const u64 window = static_cast<u64>(slice_cycles) * 2;
+            if (granted - cycles_run.load(std::memory_order_acquire) > window) {
+                WaitForTeakra(granted - window);
+            }
+            next = slice_cycles * 2; // DSP runs at clock rate half of the CPU rate
+        } else {
+            RunTeakraSlice();
+            next = TeakraSlice * 2; // DSP runs at clock rate half of the CPU rate
+        }
         if (next < late)
             next = 0;
         else
@@ -330,12 +450,16 @@ struct DspLle::Impl final {
 
         // TODO: load special segment
 
-        core_timing.ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
-
         if (multithread) {
+            cycles_granted = 0;
+            cycles_run = 0;
+            last_interaction_cycles = 0;
+            pending_interrupts = 0;
             teakra_thread = std::thread(&Impl::TeakraThread, this);
         }
 
+        core_timing.ScheduleEvent(TeakraSlice, teakra_slice_event, 0);
+
         // Wait for initialization
         if (dsp.recv_data_on_start) {
             for (u8 i = 0; i < 3; ++i) {
@@ -351,6 +475,9 @@ struct DspLle::Impl final {
             RunTeakraSlice();
         pipe_base_waddr = teakra.RecvData(2);
 
+        // Interrupts raised during initialization are ignored, as they would have been had they
+        // been delivered straight away.
+        pending_interrupts = 0;
         loaded = true;
     }
 
@@ -360,6 +487,7 @@ struct DspLle::Impl final {
             return;
         }
 
+        SyncTeakra();
         loaded = false;
 
         // Send finalization signal via command/reply register 2
@@ -381,6 +509,7 @@ struct DspLle::Impl final {
 };
 
 u16 DspLle::RecvData(u32 register_number) {
+    impl->SyncTeakra();
     while (!impl->teakra.RecvDataIsReady(register_number)) {
         impl->RunTeakraSlice();
     }
@@ -388,22 +517,27 @@ u16 DspLle::RecvData(u32 register_number) {
 }
 
 bool DspLle::RecvDataIsReady(u32 register_number) const {
+    impl->SyncTeakra();
     return impl->teakra.RecvDataIsReady(register_number);
 }
 
 void DspLle::SetSemaphore(u16 semaphore_value) {
+    impl->SyncTeakra();
     impl->teakra.SetSemaphore(semaphore_value);
 }
 
 std::vector<u8> DspLle::PipeRead(DspPipe pipe_number, std::size_t length) {
+    impl->SyncTeakra();
     return impl->ReadPipe(static_cast<u8>(pipe_number), static_cast<u16>(length));
 }
 
 std::size_t DspLle::GetPipeReadableSize(DspPipe pipe_number) const {
+    impl->SyncTeakra();
     return impl->GetPipeReadableSize(static_cast<u8>(pipe_number));
 }
 
 void DspLle::PipeWrite(DspPipe pipe_number, std::span<const u8> buffer) {
+    impl->SyncTeakra();
     impl->WritePipe(static_cast<u8>(pipe_number), buffer);
 }
 
@@ -413,18 +547,21 @@ std::array<u8, Memory::DSP_RAM_SIZE>& DspLle::GetDspMemory() {
 
 void DspLle::SetInterruptHandler(
     std::function<void(Service::DSP::InterruptType type, DspPipe pipe)> handler) {
-    impl->teakra.SetRecvDataHandler(0, [this, handler]() {
+    // The handlers are swapped out while Teakra may be raising interrupts on its own thread.
+    impl->SyncTeakra();
+
+    impl->interrupt_handlers[Impl::RecvData0] = [this, handler]() {
         if (!impl->loaded) {
             return;
         }
         handler(Service::DSP::InterruptType::Zero, static_cast<DspPipe>(0));
-    });
-    impl->teakra.SetRecvDataHandler(1, [this, handler]() {
+    };
+    impl->interrupt_handlers[Impl::RecvData1] = [this, handler]() {
         if (!impl->loaded) {
             return;
         }
         handler(Service::DSP::InterruptType::One, static_cast<DspPipe>(0));
-    });
+    };
 
     auto ProcessPipeEvent = [this, handler](bool event_from_data) {
         if (!impl->loaded)
@@ -456,8 +593,8 @@ void DspLle::SetInterruptHandler(
         }
     };
 
-    impl->teakra.SetRecvDataHandler(2, [ProcessPipeEvent]() { ProcessPipeEvent(true); });
-    impl->teakra.SetSemaphoreHandler([ProcessPipeEvent]() { ProcessPipeEvent(false); });
+    impl->interrupt_handlers[Impl::RecvData2] = [ProcessPipeEvent]() { ProcessPipeEvent(true); };
+    impl->interrupt_handlers[Impl::Semaphore] = [ProcessPipeEvent]() { ProcessPipeEvent(false); };
 }
 
 void DspLle::LoadComponent(std::span<const u8> buffer) {
@@ -498,6 +635,10 @@ DspLle::DspLle(Core::System& system, Memory::MemorySystem& memory, Core::Timing&
         std::memcpy(memory.GetFCRAMPointer(address - Memory::FCRAM_PADDR), &value, sizeof(u32));
     };
     impl->teakra.SetAHBMCallback(ahbm);
+    impl->teakra.SetRecvDataHandler(0, [this]() { impl->RaiseInterrupt(Impl::RecvData0); });
+    impl->teakra.SetRecvDataHandler(1, [this]() { impl->RaiseInterrupt(Impl::RecvData1); });
+    impl->teakra.SetRecvDataHandler(2, [this]() { impl->RaiseInterrupt(Impl::RecvData2); });
+    impl->teakra.SetSemaphoreHandler([this]() { impl->RaiseInterrupt(Impl::Semaphore); });
     impl->teakra.SetAudioCallback(
         [this](std::array<s16, 2> sample) { OutputSample(std::move(sample)); });
 }
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
+#include <span>
 #include "common/common_types.h"
 
 namespace AudioCore {
@@ -31,6 +33,16 @@ public:
      * @param sample_count Number of samples.
      */
     virtual void SetCallback(std::function<void(s16*, std::size_t)> cb) = 0;
+
+    /// Whether this sink is paced by a real-time clock. Sinks that are not are handed samples
+    /// through PushSamples as soon as they are produced, instead of pulling them through the
+    /// callback at the device rate.
+    [[nodiscard]] virtual bool IsRealTime() const {
+        return true;
+    }
+
+    /// Receives samples exactly as produced by the DSP. Only called when IsRealTime() is false.
+    virtual void PushSamples(std::span<const std::array<s16, 2>> samples) {}
 };
 
 } // namespace AudioCore
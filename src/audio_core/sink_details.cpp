@@ -7,6 +7,7 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include "audio_core/file_sink.h"
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
 #ifdef ANDROID
@@ -60,6 +61,12 @@ constexpr std::array sink_details = {
                     return std::make_unique<NullSink>(device_id);
                 },
                 [] { return std::vector<std::string>{"None"}; }},
+    // Never auto-selected: only renders to a file when explicitly asked to.
+    SinkDetails{SinkType::File, "File",
+                [](std::string_view device_id) -> std::unique_ptr<Sink> {
+                    return std::make_unique<FileSink>(device_id);
+                },
+                [] { return std::vector<std::string>{auto_device_name}; }},
 };
 } // Anonymous namespace
 
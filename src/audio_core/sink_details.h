@@ -22,6 +22,7 @@ enum class SinkType : u32 {
     OpenAL = 3,
     SDL2 = 4,
     Oboe = 5,
+    File = 6,
 };
 
 struct SinkDetails {
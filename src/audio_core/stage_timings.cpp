@@ -0,0 +1,63 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/stage_timings.h"
+
+namespace AudioCore {
+
+namespace {
+constexpr std::size_t num_stages = static_cast<std::size_t>(AudioStage::Count);
+
+std::array<std::atomic<u64>, num_stages> stage_calls{};
+std::array<std::atomic<u64>, num_stages> stage_nanoseconds{};
+} // Anonymous namespace
+
+namespace detail {
+std::atomic<bool> stage_timing_enabled = false;
+
+void RecordStage(AudioStage stage, std::chrono::nanoseconds duration) {
+    const auto index = static_cast<std::size_t>(stage);
+    stage_calls[index].fetch_add(1, std::memory_order_relaxed);
+    stage_nanoseconds[index].fetch_add(static_cast<u64>(duration.count()),
+                                       std::memory_order_relaxed);
+}
+} // namespace detail
+
+std::string_view GetStageName(AudioStage stage) {
+    switch (stage) {
+    case AudioStage::SourceDecode:
+        return "Source decode";
+    case AudioStage::Interpolation:
+        return "Interpolation";
+    case AudioStage::Mixing:
+        return "Mixing";
+    case AudioStage::Stretch:
+        return "Stretch";
+    default:
+        return "Invalid";
+    }
+}
+
+void SetStageTimingEnabled(bool enabled) {
+    detail::stage_timing_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+StageTimings GetStageTimings() {
+    StageTimings timings;
+    for (std::size_t i = 0; i < num_stages; i++) {
+        timings[i].calls = stage_calls[i].load(std::memory_order_relaxed);
+        timings[i].total =
+            std::chrono::nanoseconds{stage_nanoseconds[i].load(std::memory_order_relaxed)};
+    }
+    return timings;
+}
+
+void ResetStageTimings() {
+    for (std::size_t i = 0; i < num_stages; i++) {
+        stage_calls[i].store(0, std::memory_order_relaxed);
+        stage_nanoseconds[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,80 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string_view>
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/profiling.h"
+
+namespace AudioCore {
+
+/// Stages of the audio pipeline whose cost can be measured independently.
+enum class AudioStage : u32 {
+    SourceDecode,
+    Interpolation,
+    Mixing,
+    Stretch,
+    Count,
+};
+
+struct StageTiming {
+    u64 calls = 0;
+    std::chrono::nanoseconds total{};
+};
+
+using StageTimings = std::array<StageTiming, static_cast<std::size_t>(AudioStage::Count)>;
+
+[[nodiscard]] std::string_view GetStageName(AudioStage stage);
+
+/// Enables or disables collecting stage timings. Collection is off by default, in which case a
+/// stage timer costs a single relaxed load.
+void SetStageTimingEnabled(bool enabled);
+
+/// Returns the timings accumulated since the last reset.
+[[nodiscard]] StageTimings GetStageTimings();
+
+void ResetStageTimings();
+
+namespace detail {
+extern std::atomic<bool> stage_timing_enabled;
+void RecordStage(AudioStage stage, std::chrono::nanoseconds duration);
+} // namespace detail
+
+/// Adds the lifetime of this object to the timing of a stage.
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(AudioStage stage_)
+        : stage(stage_), enabled(detail::stage_timing_enabled.load(std::memory_order_relaxed)) {
+        if (enabled) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedStageTimer() {
+        if (enabled) {
+            detail::RecordStage(stage, std::chrono::steady_clock::now() - start);
+        }
+    }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    AudioStage stage;
+    bool enabled;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace AudioCore
+
+/// Marks a scope as belonging to an audio pipeline stage, both for the profiler and for the stage
+/// timings reported by headless rendering.
+#define BORKED3DS_AUDIO_STAGE(stage, text)                                                         \
+    BORKED3DS_PROFILE("Audio", text);                                                              \
+    const ::AudioCore::ScopedStageTimer CONCAT2(audio_stage_timer_, __LINE__)(stage)
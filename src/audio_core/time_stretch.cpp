@@ -13,6 +13,7 @@
 #include <SoundTouch.h>
 
 #include "audio_core/audio_types.h"
+#include "audio_core/stage_timings.h"
 #include "audio_core/time_stretch.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -34,6 +35,7 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
 
 std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
                                    std::size_t num_out) {
+    BORKED3DS_AUDIO_STAGE(AudioStage::Stretch, "Stretch");
     const double time_delta = static_cast<double>(num_out) / native_sample_rate; // seconds
     double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
 
@@ -68,6 +68,8 @@ static void PrintHelp(const char* argv0) {
         << "Usage: " << argv0
         << " [options] <filename>\n"
            "-a, --movie-record-author=[author] Sets the author of the TAS movie to be recorded\n"
+           "-A, --dump-audio=[path]    Render audio to the specified WAV or FLAC file instead "
+           "of playing it\n"
            "-d, --dump-video=[path]    Dump video recording of emulator playback to the specified "
            "file path\n"
            "-f, --fullscreen     Start in fullscreen mode\n"
@@ -195,6 +197,7 @@ int main(int argc, char** argv) {
     std::string movie_record_author;
     std::string movie_play;
     std::string dump_video;
+    std::string dump_audio;
 
     char* endarg;
 #ifdef _WIN32
@@ -223,6 +226,7 @@ int main(int argc, char** argv) {
         {"author-record-movie", required_argument, 0, 'a'},
         {"play-movie", required_argument, 0, 'p'},
         {"dump-video", required_argument, 0, 'd'},
+        {"dump-audio", required_argument, 0, 'A'},
         {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
@@ -230,7 +234,7 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "a:d:fg:hi:m:p:r:v", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "A:a:d:fg:hi:m:p:r:v", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -248,8 +252,8 @@ int main(int argc, char** argv) {
                 const auto cia_progress = [](std::size_t written, std::size_t total) {
                     LOG_INFO(Frontend, "{:02d}%", (written * 100 / total));
                 };
-                if (Service::AM::InstallCIA(std::string(optarg), cia_progress) !=
-                    Service::AM::InstallStatus::Success)
+                if (Service::AM::InstallCIA(Core::System::GetInstance(), std::string(optarg),
+                                            cia_progress) != Service::AM::InstallStatus::Success)
                     errno = EINVAL;
                 if (errno != 0)
                     exit(1);
@@ -299,6 +303,9 @@ int main(int argc, char** argv) {
             case 'd':
                 dump_video = optarg;
                 break;
+            case 'A':
+                dump_audio = optarg;
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
@@ -347,6 +354,10 @@ int main(int argc, char** argv) {
     // Apply the command line arguments
     Settings::values.gdbstub_port = gdb_port;
     Settings::values.use_gdbstub = use_gdbstub;
+    if (!dump_audio.empty()) {
+        Settings::values.output_type = AudioCore::SinkType::File;
+        Settings::values.output_device = dump_audio;
+    }
     system.ApplySettings();
 
     // Register frontend applets
@@ -142,12 +142,14 @@ void Config::ReadValues() {
 
     // Core
     ReadSetting("Core", Settings::values.use_cpu_jit);
+    ReadSetting("Core", Settings::values.parallel_cpu_cores);
     ReadSetting("Core", Settings::values.frame_skip);
     ReadSetting("Core", Settings::values.cpu_clock_percentage);
     ReadSetting("Core", Settings::values.enable_custom_cpu_ticks);
     ReadSetting("Core", Settings::values.custom_cpu_ticks);
     ReadSetting("Core", Settings::values.core_downcount_hack);
     ReadSetting("Core", Settings::values.priority_boost);
+    ReadSetting("Core", Settings::values.fs_timing_profile);
 
     // Renderer
     ReadSetting("Renderer", Settings::values.graphics_api);
@@ -232,14 +234,18 @@ void Config::ReadValues() {
     ReadSetting("Audio", Settings::values.audio_emulation);
     ReadSetting("Audio", Settings::values.enable_audio_stretching);
     ReadSetting("Audio", Settings::values.enable_realtime_audio);
+    ReadSetting("Audio", Settings::values.polyphase_interpolation);
     ReadSetting("Audio", Settings::values.volume);
     ReadSetting("Audio", Settings::values.output_type);
     ReadSetting("Audio", Settings::values.output_device);
+    ReadSetting("Audio", Settings::values.deterministic_audio);
     ReadSetting("Audio", Settings::values.input_type);
     ReadSetting("Audio", Settings::values.input_device);
 
     // Data Storage
     ReadSetting("Data Storage", Settings::values.use_virtual_sd);
+    ReadSetting("Data Storage", Settings::values.romfs_cache_size);
+    ReadSetting("Data Storage", Settings::values.cache_decompressed_code);
     ReadSetting("Data Storage", Settings::values.use_custom_storage);
 
     if (Settings::values.use_custom_storage) {
@@ -92,6 +92,13 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Execute each emulated CPU core on its own host thread (experimental, requires the JIT)
+# Only affects New 3DS titles that use the extra cores. Kernel calls are still serialized.
+# Only used with the software renderer and when no movie is recorded or played back, as the
+# timing of the cores then depends on the host and is not reproducible.
+# 0 (default): Off, 1: On
+parallel_cpu_cores =
+
 # The amount of frames to skip (power of two)
 # 0 (default): No frameskip, 1: x2 frameskip, 2: x4 frameskip, 3: x8 frameskip, 4: x16 frameskip.
 frame_skip =
@@ -119,6 +126,12 @@ core_downcount_hack =
 # 0 (default): Off, 1: On
 priority_boost =
 
+# How long emulated file system reads and file opens take.
+# Fast keeps the fixed cost of every request but drops the time spent transferring data and waiting
+# for other requests, which shortens loading screens. Games that time their loading can misbehave.
+# 0 (default): Accurate, 1: Fast
+fs_timing_profile =
+
 [Renderer]
 # Whether to render using OpenGL or Software
 # 0: Software, 1: OpenGL (default), 2: Vulkan
@@ -325,7 +338,7 @@ async_custom_loading =
 
 [Audio]
 # Whether to enable Audio DSP in HLE or LLE mode (Note: LLE mode has a heavy performance impact)
-# 0 (default): HLE, 1: LLE, 2: LLE Multithreaded
+# 0 (default): HLE, 1: LLE, 2: LLE Multithreaded, 3: HLE Multithreaded
 audio_emulation =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -338,18 +351,30 @@ enable_audio_stretching =
 # 0 (default): No, 1: Yes
 enable_realtime_audio =
 
+# Plays sources that request polyphase interpolation with a windowed-sinc filter instead of
+# linear interpolation (HLE only). Changes the audio output of most titles.
+# 0 (default): No, 1: Yes
+polyphase_interpolation =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
 
 # Which audio output type to use.
-# 0 (default): Auto-select, 1: No audio output, 2: Cubeb (if available), 3: OpenAL (if available), 4: SDL2 (if available)
+# 0 (default): Auto-select, 1: No audio output, 2: Cubeb (if available), 3: OpenAL (if available), 4: SDL2 (if available), 6: File
 output_type =
 
 # Which audio output device to use.
 # auto (default): Auto-select
+# For the File output type this is the file to render to; a .flac extension writes FLAC,
+# anything else WAV, and auto writes audio.wav to the dump directory.
 output_device =
 
+# Keeps the audio DSP on the emulation thread even when a multithreaded mode is selected, so that
+# audio rendered with the File output type is reproducible.
+# 0 (default): No, 1: Yes
+deterministic_audio =
+
 # Which audio input type to use.
 # 0 (default): Auto-select, 1: No audio input, 2: Static noise, 3: Cubeb (if available), 4: OpenAL (if available)
 input_type =
@@ -367,6 +392,14 @@ use_virtual_sd =
 # 1: Yes, 0 (default): No
 use_custom_storage =
 
+# Size of the cache of decrypted RomFS data, in MiB. 0 disables the cache.
+# 0 - 1024: Cache size (default: 16)
+romfs_cache_size =
+
+# Keeps decompressed game code in the cache directory so it is not decompressed on every boot
+# 0: No, 1 (default): Yes
+cache_decompressed_code =
+
 # The path of the virtual SD card directory.
 # empty (default) will use the user_path
 sdmc_directory =
@@ -291,10 +291,12 @@ void Config::ReadAudioValues() {
     ReadGlobalSetting(Settings::values.audio_emulation);
     ReadGlobalSetting(Settings::values.enable_audio_stretching);
     ReadGlobalSetting(Settings::values.enable_realtime_audio);
+    ReadGlobalSetting(Settings::values.deterministic_audio);
     ReadGlobalSetting(Settings::values.volume);
 
     if (global) {
         ReadBasicSetting(Settings::values.output_type);
+        ReadBasicSetting(Settings::values.polyphase_interpolation);
         ReadBasicSetting(Settings::values.output_device);
         ReadBasicSetting(Settings::values.input_type);
         ReadBasicSetting(Settings::values.input_device);
@@ -474,9 +476,11 @@ void Config::ReadCoreValues() {
     ReadGlobalSetting(Settings::values.custom_cpu_ticks);
     ReadGlobalSetting(Settings::values.core_downcount_hack);
     ReadGlobalSetting(Settings::values.priority_boost);
+    ReadGlobalSetting(Settings::values.fs_timing_profile);
 
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
+        ReadBasicSetting(Settings::values.parallel_cpu_cores);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -488,6 +492,8 @@ void Config::ReadDataStorageValues() {
 
     ReadBasicSetting(Settings::values.use_virtual_sd);
     ReadBasicSetting(Settings::values.use_custom_storage);
+    ReadBasicSetting(Settings::values.romfs_cache_size);
+    ReadBasicSetting(Settings::values.cache_decompressed_code);
 
     const std::string nand_dir =
         ReadSetting(QStringLiteral("nand_directory"), QStringLiteral("")).toString().toStdString();
@@ -936,10 +942,12 @@ void Config::SaveAudioValues() {
     WriteGlobalSetting(Settings::values.audio_emulation);
     WriteGlobalSetting(Settings::values.enable_audio_stretching);
     WriteGlobalSetting(Settings::values.enable_realtime_audio);
+    WriteGlobalSetting(Settings::values.deterministic_audio);
     WriteGlobalSetting(Settings::values.volume);
 
     if (global) {
         WriteBasicSetting(Settings::values.output_type);
+        WriteBasicSetting(Settings::values.polyphase_interpolation);
         WriteBasicSetting(Settings::values.output_device);
         WriteBasicSetting(Settings::values.input_type);
         WriteBasicSetting(Settings::values.input_device);
@@ -1058,9 +1066,11 @@ void Config::SaveCoreValues() {
     WriteGlobalSetting(Settings::values.custom_cpu_ticks);
     WriteGlobalSetting(Settings::values.core_downcount_hack);
     WriteGlobalSetting(Settings::values.priority_boost);
+    WriteGlobalSetting(Settings::values.fs_timing_profile);
 
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
+        WriteBasicSetting(Settings::values.parallel_cpu_cores);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -1072,6 +1082,8 @@ void Config::SaveDataStorageValues() {
 
     WriteBasicSetting(Settings::values.use_virtual_sd);
     WriteBasicSetting(Settings::values.use_custom_storage);
+    WriteBasicSetting(Settings::values.romfs_cache_size);
+    WriteBasicSetting(Settings::values.cache_decompressed_code);
     WriteSetting(QStringLiteral("nand_directory"),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)),
                  QStringLiteral(""));
@@ -160,8 +160,10 @@ void ConfigureAudio::SetVolumeIndicatorText(int percentage) {
 }
 
 void ConfigureAudio::SetHleFeaturesEnabled() {
-    const bool is_hle =
-        ui->emulation_combo_box->currentIndex() == static_cast<int>(Settings::AudioEmulation::HLE);
+    const auto emulation =
+        static_cast<Settings::AudioEmulation>(ui->emulation_combo_box->currentIndex());
+    const bool is_hle = emulation == Settings::AudioEmulation::HLE ||
+                        emulation == Settings::AudioEmulation::HLEMultithreaded;
 
     ui->toggle_audio_stretching->setEnabled(is_hle);
     ui->toggle_realtime_audio->setEnabled(is_hle);
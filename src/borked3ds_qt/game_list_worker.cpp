@@ -34,12 +34,11 @@ GameListWorker::GameListWorker(QVector<UISettings::GameDir>& game_dirs,
 
 GameListWorker::~GameListWorker() = default;
 
-void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
-                                             GameListDir* parent_dir,
-                                             Service::FS::MediaType media_type) {
-    const auto callback = [this, recursion, parent_dir,
-                           media_type](u64* num_entries_out, const std::string& directory,
-                                       const std::string& virtual_name) -> bool {
+void GameListWorker::CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                                      std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
@@ -48,79 +47,10 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
         const std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir && HasSupportedFileExtension(physical_name)) {
-            std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
-            if (!loader) {
-                return true;
-            }
-
-            bool executable = false;
-            const auto res = loader->IsExecutable(executable);
-            if (!executable && res != Loader::ResultStatus::ErrorEncrypted) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            loader->ReadProgramId(program_id);
-
-            u64 extdata_id = 0;
-            loader->ReadExtdataId(extdata_id);
-
-            std::vector<u8> smdh;
-            // Look for an update icon if available
-            if (!(program_id & ~0x00040000FFFFFFFF)) {
-                std::string update_path = Service::AM::GetTitleContentPath(
-                    Service::FS::MediaType::SDMC, program_id | 0x0000000E00000000);
-                if (FileUtil::Exists(update_path)) {
-                    std::unique_ptr<Loader::AppLoader> update_loader =
-                        Loader::GetLoader(update_path);
-                    if (update_loader) {
-                        update_loader->ReadIcon(smdh);
-                    }
-                }
-            }
-
-            if (!Loader::IsValidSMDH(smdh)) {
-                // Read the original smdh if there is no valid update smdh
-                loader->ReadIcon(smdh);
-            }
-
-            const auto system_title = ((program_id >> 32) & 0xFFFFFFFF) == 0x00040010;
-            if (Loader::IsValidSMDH(smdh)) {
-                if (system_title) {
-                    auto smdh_struct = reinterpret_cast<Loader::SMDH*>(smdh.data());
-                    if (!(smdh_struct->flags & Loader::SMDH::Flags::Visible)) {
-                        // Skip system titles without the visible flag.
-                        return true;
-                    }
-                }
-            } else if (UISettings::values.game_list_hide_no_icon || system_title) {
-                // Skip this invalid entry
-                return true;
-            }
-
-            auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
-
-            // The game list uses this as compatibility number for untested games
-            QString compatibility(QStringLiteral("99"));
-            if (it != compatibility_list.end())
-                compatibility = it->second.first;
-
-            emit EntryReady(
-                {
-                    new GameListItemPath(QString::fromStdString(physical_name), smdh, program_id,
-                                         extdata_id, media_type),
-                    new GameListItemCompat(compatibility),
-                    new GameListItemRegion(smdh),
-                    new GameListItem(
-                        QString::fromStdString(Loader::GetFileTypeString(loader->GetFileType()))),
-                    new GameListItemSize(FileUtil::GetSize(physical_name)),
-                    new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
-                },
-                parent_dir);
-
+            files.push_back(physical_name);
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
-            AddFstEntriesToGameList(physical_name, recursion - 1, parent_dir, media_type);
+            CollectGameFiles(physical_name, recursion - 1, files);
         }
 
         return true;
@@ -129,8 +59,79 @@ void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsign
     FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
+                                             GameListDir* parent_dir,
+                                             Service::FS::MediaType media_type) {
+    std::vector<std::string> files;
+    CollectGameFiles(dir_path, recursion, files);
+
+    // Only files that are new or changed since the last scan are opened, in parallel.
+    const auto games = metadata_index.Lookup(files, stop_processing);
+
+    // Look for update icons if available, these come from the index as well.
+    std::vector<std::string> update_paths(files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        const u64 program_id = games[i]->program_id;
+        if (games[i]->has_loader && !(program_id & ~0x00040000FFFFFFFF)) {
+            update_paths[i] = Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC,
+                                                               program_id | 0x0000000E00000000);
+        }
+    }
+    const auto updates = metadata_index.Lookup(update_paths, stop_processing);
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        if (stop_processing) {
+            return;
+        }
+
+        const auto& game = *games[i];
+        if (!game.has_loader || (!game.executable && !game.encrypted)) {
+            continue;
+        }
+        const u64 program_id = game.program_id;
+
+        // Use the original smdh if there is no valid update smdh
+        const std::vector<u8>& smdh =
+            Loader::IsValidSMDH(updates[i]->smdh) ? updates[i]->smdh : game.smdh;
+
+        const auto system_title = ((program_id >> 32) & 0xFFFFFFFF) == 0x00040010;
+        if (Loader::IsValidSMDH(smdh)) {
+            if (system_title) {
+                auto smdh_struct = reinterpret_cast<const Loader::SMDH*>(smdh.data());
+                if (!(smdh_struct->flags & Loader::SMDH::Flags::Visible)) {
+                    // Skip system titles without the visible flag.
+                    continue;
+                }
+            }
+        } else if (UISettings::values.game_list_hide_no_icon || system_title) {
+            // Skip this invalid entry
+            continue;
+        }
+
+        auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
+
+        // The game list uses this as compatibility number for untested games
+        QString compatibility(QStringLiteral("99"));
+        if (it != compatibility_list.end())
+            compatibility = it->second.first;
+
+        emit EntryReady(
+            {
+                new GameListItemPath(QString::fromStdString(files[i]), smdh, program_id,
+                                     game.extdata_id, media_type),
+                new GameListItemCompat(compatibility),
+                new GameListItemRegion(smdh),
+                new GameListItem(QString::fromStdString(Loader::GetFileTypeString(game.file_type))),
+                new GameListItemSize(game.size),
+                new GameListItemPlayTime(play_time_manager.GetPlayTime(program_id)),
+            },
+            parent_dir);
+    }
+}
+
 void GameListWorker::run() {
     stop_processing = false;
+    metadata_index.Load();
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("INSTALLED")) {
             QString games_path =
@@ -170,6 +171,9 @@ void GameListWorker::run() {
         }
     }
 
+    if (!stop_processing) {
+        metadata_index.Save();
+    }
     emit Finished(watch_list);
 }
 
@@ -7,12 +7,14 @@
 #include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 #include <QList>
 #include <QObject>
 #include <QRunnable>
 #include <QString>
 #include <QVector>
 #include "borked3ds_qt/compatibility_list.h"
+#include "borked3ds_qt/game_metadata_index.h"
 #include "borked3ds_qt/play_time_manager.h"
 #include "common/common_types.h"
 
@@ -60,10 +62,16 @@ private:
     void AddFstEntriesToGameList(const std::string& dir_path, unsigned int recursion,
                                  GameListDir* parent_dir, Service::FS::MediaType media_type);
 
+    /// Appends the supported files in dir_path and its subdirectories to files.
+    void CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                          std::vector<std::string>& files);
+
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
     const PlayTime::PlayTimeManager& play_time_manager;
 
     QStringList watch_list;
     std::atomic_bool stop_processing;
+
+    GameMetadataIndex metadata_index;
 };
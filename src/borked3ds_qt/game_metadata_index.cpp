@@ -0,0 +1,235 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentMap>
+#include "borked3ds_qt/game_metadata_index.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/loader/loader.h"
+
+namespace {
+
+constexpr u32 INDEX_MAGIC = Loader::MakeMagic('B', '3', 'G', 'L');
+// Increase whenever the layout of an entry or what is stored in it changes.
+constexpr u32 INDEX_VERSION = 1;
+
+enum MetadataFlags : u8 {
+    HasLoader = 1 << 0,
+    Executable = 1 << 1,
+};
+
+std::string GetIndexPath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) +
+           "game_list" DIR_SEP "metadata_index.bin";
+}
+
+class IndexWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBytes(const void* bytes, std::size_t size) {
+        Write(static_cast<u32>(size));
+        data.insert(data.end(), static_cast<const u8*>(bytes),
+                    static_cast<const u8*>(bytes) + size);
+    }
+
+    std::vector<u8> data;
+};
+
+class IndexReader {
+public:
+    explicit IndexReader(std::vector<u8> data_) : data{std::move(data_)} {}
+
+    template <typename T>
+    std::optional<T> Read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.size() - position < sizeof(T)) {
+            return std::nullopt;
+        }
+        T value;
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    std::optional<std::vector<u8>> ReadBytes() {
+        const auto size = Read<u32>();
+        if (!size || data.size() - position < *size) {
+            return std::nullopt;
+        }
+        std::vector<u8> bytes(data.begin() + position, data.begin() + position + *size);
+        position += *size;
+        return bytes;
+    }
+
+private:
+    std::vector<u8> data;
+    std::size_t position = 0;
+};
+
+/// Reads what the game list needs from a file, the slow part of a scan.
+std::shared_ptr<const GameMetadataIndex::Metadata> ReadMetadata(const std::string& path,
+                                                                u64 size) {
+    auto metadata = std::make_shared<GameMetadataIndex::Metadata>();
+    metadata->size = size;
+
+    std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(path);
+    if (!loader) {
+        return metadata;
+    }
+    metadata->has_loader = true;
+    metadata->encrypted =
+        loader->IsExecutable(metadata->executable) == Loader::ResultStatus::ErrorEncrypted;
+    loader->ReadProgramId(metadata->program_id);
+    loader->ReadExtdataId(metadata->extdata_id);
+    loader->ReadIcon(metadata->smdh);
+    metadata->file_type = loader->GetFileType();
+    return metadata;
+}
+
+} // Anonymous namespace
+
+GameMetadataIndex::GameMetadataIndex() = default;
+
+GameMetadataIndex::~GameMetadataIndex() = default;
+
+void GameMetadataIndex::Load() {
+    entries.clear();
+    const std::string path = GetIndexPath();
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        return;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_WARNING(Frontend, "Could not read game list index {}", path);
+        return;
+    }
+
+    IndexReader reader{std::move(data)};
+    if (reader.Read<u32>() != INDEX_MAGIC || reader.Read<u32>() != INDEX_VERSION) {
+        return;
+    }
+    const auto count = reader.Read<u32>();
+    for (u32 i = 0; count && i < *count; ++i) {
+        const auto entry_path = reader.ReadBytes();
+        const auto modified = reader.Read<s64>();
+        const auto size = reader.Read<u64>();
+        const auto program_id = reader.Read<u64>();
+        const auto extdata_id = reader.Read<u64>();
+        const auto file_type = reader.Read<u32>();
+        const auto flags = reader.Read<u8>();
+        auto smdh = reader.ReadBytes();
+        if (!entry_path || !modified || !size || !program_id || !extdata_id || !file_type ||
+            !flags || !smdh) {
+            LOG_WARNING(Frontend, "Game list index {} is truncated, ignoring it", path);
+            entries.clear();
+            return;
+        }
+
+        auto metadata = std::make_shared<Metadata>();
+        metadata->has_loader = (*flags & HasLoader) != 0;
+        metadata->executable = (*flags & Executable) != 0;
+        metadata->size = *size;
+        metadata->program_id = *program_id;
+        metadata->extdata_id = *extdata_id;
+        metadata->file_type = static_cast<Loader::FileType>(*file_type);
+        metadata->smdh = std::move(*smdh);
+        entries.insert_or_assign(std::string(entry_path->begin(), entry_path->end()),
+                                 Entry{*modified, std::move(metadata)});
+    }
+}
+
+std::vector<std::shared_ptr<const GameMetadataIndex::Metadata>> GameMetadataIndex::Lookup(
+    const std::vector<std::string>& paths, const std::atomic_bool& cancel) {
+    static const auto empty = std::make_shared<const Metadata>();
+
+    std::vector<std::shared_ptr<const Metadata>> results(paths.size(), empty);
+    std::vector<s64> modified(paths.size());
+
+    // Checking whether a file changed is a stat, which can be slow on network storage as well, so
+    // it happens on the thread pool along with reading the files that did change. The index is
+    // only read here.
+    std::vector<std::size_t> indices(paths.size());
+    std::iota(indices.begin(), indices.end(), std::size_t{0});
+    QtConcurrent::blockingMap(indices, [&](std::size_t i) {
+        if (cancel || paths[i].empty()) {
+            return;
+        }
+        const QFileInfo info(QString::fromStdString(paths[i]));
+        if (!info.isFile()) {
+            return;
+        }
+        const u64 size = static_cast<u64>(info.size());
+        modified[i] = info.lastModified().toMSecsSinceEpoch();
+
+        const auto it = entries.find(paths[i]);
+        if (it != entries.end() && it->second.modified == modified[i] &&
+            it->second.metadata->size == size) {
+            results[i] = it->second.metadata;
+            return;
+        }
+        results[i] = ReadMetadata(paths[i], size);
+    });
+
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        if (results[i] == empty) {
+            continue;
+        }
+        // Files that failed to decrypt are read again next time, the keys might be there by then.
+        if (results[i]->encrypted) {
+            entries.erase(paths[i]);
+            continue;
+        }
+        entries.insert_or_assign(paths[i], Entry{modified[i], results[i], true});
+    }
+    return results;
+}
+
+void GameMetadataIndex::Save() const {
+    IndexWriter writer;
+    writer.Write(INDEX_MAGIC);
+    writer.Write(INDEX_VERSION);
+    const auto count_position = writer.data.size();
+    writer.Write(u32{0});
+
+    u32 count = 0;
+    for (const auto& [path, entry] : entries) {
+        if (!entry.used) {
+            continue;
+        }
+        const Metadata& metadata = *entry.metadata;
+        writer.WriteBytes(path.data(), path.size());
+        writer.Write(entry.modified);
+        writer.Write(metadata.size);
+        writer.Write(metadata.program_id);
+        writer.Write(metadata.extdata_id);
+        writer.Write(static_cast<u32>(metadata.file_type));
+        writer.Write(static_cast<u8>((metadata.has_loader ? HasLoader : 0) |
+                                     (metadata.executable ? Executable : 0)));
+        writer.WriteBytes(metadata.smdh.data(), metadata.smdh.size());
+        ++count;
+    }
+    std::memcpy(writer.data.data() + count_position, &count, sizeof(count));
+
+    const std::string path = GetIndexPath();
+    FileUtil::CreateFullPath(path);
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(writer.data.data(), writer.data.size()) !=
+                              writer.data.size()) {
+        LOG_WARNING(Frontend, "Could not write game list index {}", path);
+    }
+}
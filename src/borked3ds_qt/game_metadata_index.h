@@ -0,0 +1,63 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Loader {
+enum class FileType;
+}
+
+/**
+ * On-disk index of what the game list reads from each file, so that a rescan only opens files that
+ * are new or have changed since the last scan. Entries are keyed by path and checked against the
+ * size and modification time of the file.
+ */
+class GameMetadataIndex {
+public:
+    struct Metadata {
+        /// Whether any loader recognized the file. Nothing else is filled in if not.
+        bool has_loader = false;
+        bool executable = false;
+        /// The file is encrypted and could not be decrypted with the keys available.
+        bool encrypted = false;
+        u64 size = 0;
+        u64 program_id = 0;
+        u64 extdata_id = 0;
+        Loader::FileType file_type{};
+        std::vector<u8> smdh;
+    };
+
+    GameMetadataIndex();
+    ~GameMetadataIndex();
+
+    /// Loads the index written by the last Save, replacing the current entries.
+    void Load();
+
+    /**
+     * Returns the metadata of each file. Files that are not in the index, or have changed, are read
+     * on the global thread pool. Missing files and empty paths get empty metadata.
+     * @param cancel stops reading new files once set, those files also get empty metadata
+     */
+    std::vector<std::shared_ptr<const Metadata>> Lookup(const std::vector<std::string>& paths,
+                                                        const std::atomic_bool& cancel);
+
+    /// Writes the index to disk, keeping only the files looked up since it was loaded.
+    void Save() const;
+
+private:
+    struct Entry {
+        s64 modified;
+        std::shared_ptr<const Metadata> metadata;
+        bool used = false;
+    };
+
+    std::unordered_map<std::string, Entry> entries;
+};
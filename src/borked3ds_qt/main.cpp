@@ -1397,7 +1397,8 @@ void GMainWindow::BootGame(const QString& filename) {
 
     const bool is_artic = filename.startsWith(QString::fromStdString("articbase://"));
 
-    if (!is_artic && filename.endsWith(QStringLiteral(".cia"))) {
+    if (!is_artic && (filename.endsWith(QStringLiteral(".cia")) ||
+                      filename.endsWith(QStringLiteral(".zcia")))) {
         const auto answer = QMessageBox::question(
             this, tr("CIA must be installed before usage"),
             tr("Before using this CIA, you must install it. Do you want to install it now?"),
@@ -2216,7 +2217,7 @@ void GMainWindow::OnMenuLoadFile() {
 void GMainWindow::OnMenuInstallCIA() {
     QStringList filepaths = QFileDialog::getOpenFileNames(
         this, tr("Load Files"), UISettings::values.roms_path,
-        tr("3DS Installation File (*.CIA*)") + QStringLiteral(";;") + tr("All Files (*.*)"));
+        tr("3DS Installation File (*.CIA* *.ZCIA*)") + QStringLiteral(";;") + tr("All Files (*.*)"));
 
     if (filepaths.isEmpty()) {
         return;
@@ -2248,14 +2249,18 @@ void GMainWindow::InstallCIA(QStringList filepaths) {
     progress_bar->setMaximum(INT_MAX);
 
     (void)QtConcurrent::run([&, filepaths] {
-        Service::AM::InstallStatus status;
         const auto cia_progress = [&](std::size_t written, std::size_t total) {
             emit UpdateProgress(written, total);
         };
+        const auto cia_report = [&](std::size_t index, Service::AM::InstallStatus status) {
+            emit CIAInstallReport(status, filepaths[static_cast<qsizetype>(index)]);
+        };
+        std::vector<std::string> paths;
+        paths.reserve(filepaths.size());
         for (const auto& current_path : filepaths) {
-            status = Service::AM::InstallCIA(current_path.toStdString(), cia_progress);
-            emit CIAInstallReport(status, current_path);
+            paths.push_back(current_path.toStdString());
         }
+        Service::AM::InstallCIAs(system, paths, cia_progress, cia_report);
         emit CIAInstallFinished();
     });
 }
@@ -3238,6 +3243,9 @@ void GMainWindow::UpdateStatusBar() {
     }
     game_fps_label->setText(tr("Game: %1 FPS").arg(results.game_fps, 0, 'f', 0));
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    volume_button->setToolTip(tr("Audio output underruns: %1\nDropped audio frames: %2")
+                                  .arg(results.audio_underruns)
+                                  .arg(results.audio_dropped_frames));
 
     if (show_artic_label) {
         artic_traffic_label->setVisible(true);
@@ -3508,8 +3516,8 @@ static bool IsSingleFileDropEvent(const QMimeData* mime) {
     return mime->hasUrls() && mime->urls().length() == 1;
 }
 
-static const std::array<std::string, 8> AcceptedExtensions = {"cci",  "3ds", "cxi", "bin",
-                                                              "3dsx", "app", "elf", "axf"};
+static const std::array<std::string, 11> AcceptedExtensions = {
+    "cci", "3ds", "cxi", "bin", "3dsx", "app", "elf", "axf", "zcci", "z3ds", "zcxi"};
 
 static bool IsCorrectFileExtension(const QMimeData* mime) {
     const QString& filename = mime->urls().at(0).toLocalFile();
@@ -3944,7 +3952,8 @@ int main(int argc, char* argv[]) {
 #endif
                 return 0;
             case 'i': {
-                Service::AM::InstallStatus result = Service::AM::InstallCIA(std::string(optarg));
+                Service::AM::InstallStatus result = Service::AM::InstallCIA(
+                    Core::System::GetInstance(), std::string(optarg));
                 if (result != Service::AM::InstallStatus::Success) {
                     std::string failure_reason;
 
@@ -0,0 +1,420 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/async_file_reader.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+#include "common/thread_worker.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <atomic>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+// IORING_OP_READ and IORING_OP_READ_FIXED on regular files need Linux 5.6.
+#ifdef IORING_FEAT_RW_CUR_POS
+#define HAVE_IO_URING
+#endif
+#endif
+
+namespace FileUtil {
+
+class AsyncFileReader::Impl {
+public:
+    virtual ~Impl() = default;
+    virtual Backend GetBackend() const = 0;
+    virtual void Submit(std::span<Request> requests) = 0;
+};
+
+class AsyncFileReader::ThreadedImpl final : public Impl {
+public:
+    ThreadedImpl()
+        : worker(std::clamp(std::thread::hardware_concurrency() / 2, 2U, 4U), "AsyncFileReader") {}
+
+    ~ThreadedImpl() override {
+        worker.WaitForRequests();
+    }
+
+    Backend GetBackend() const override {
+        return Backend::Threaded;
+    }
+
+    void Submit(std::span<Request> requests) override {
+        for (auto& request : requests) {
+            worker.QueueWork([request = std::move(request)]() mutable {
+                const std::size_t read = request.file->ReadAtBytes(
+                    static_cast<u8*>(request.data), request.length, request.offset);
+                // ReadAtBytes returns SIZE_MAX when the read fails.
+                request.callback(read > request.length ? -EIO : static_cast<s64>(read));
+            });
+        }
+    }
+
+private:
+    Common::ThreadWorker worker;
+};
+
+#ifdef HAVE_IO_URING
+
+namespace {
+
+int IoUringSetup(u32 entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd, u32 to_submit, u32 min_complete, u32 flags) {
+    return static_cast<int>(
+        syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int fd, u32 opcode, const void* arg, u32 nr_args) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+u32 LoadAcquire(u32* value) {
+    return std::atomic_ref<u32>(*value).load(std::memory_order_acquire);
+}
+
+void StoreRelease(u32* value, u32 new_value) {
+    std::atomic_ref<u32>(*value).store(new_value, std::memory_order_release);
+}
+
+} // Anonymous namespace
+
+class AsyncFileReader::IoUringImpl final : public Impl {
+public:
+    static std::unique_ptr<IoUringImpl> Create(u32 queue_depth) {
+        std::unique_ptr<IoUringImpl> impl(new IoUringImpl);
+        if (!impl->Init(queue_depth)) {
+            return nullptr;
+        }
+        return impl;
+    }
+
+    ~IoUringImpl() override {
+        if (completion_thread.joinable()) {
+            std::unique_lock lock{mutex};
+            slot_freed.wait(lock, [this] { return free_slots.size() == in_flight.size(); });
+            stopping = true;
+
+            // Wake the completion thread up with a no-op.
+            io_uring_sqe& sqe = NextSqe();
+            sqe.opcode = IORING_OP_NOP;
+            sqe.user_data = wake_user_data;
+            pending_submissions++;
+            Flush();
+            lock.unlock();
+
+            completion_thread.join();
+        }
+        fallback.reset();
+
+        if (sqes != MAP_FAILED) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) {
+            munmap(cq_ring, cq_ring_size);
+        }
+        if (sq_ring != MAP_FAILED) {
+            munmap(sq_ring, sq_ring_size);
+        }
+        if (ring_fd >= 0) {
+            close(ring_fd);
+        }
+    }
+
+    Backend GetBackend() const override {
+        return Backend::IoUring;
+    }
+
+    void Submit(std::span<Request> requests) override {
+        std::unique_lock lock{mutex};
+        for (auto& request : requests) {
+            // Compressed files are decompressed on the CPU, the kernel cannot read them directly.
+            if (request.file->IsCompressed() || request.file->GetFd() < 0) {
+                if (!fallback) {
+                    fallback = std::make_unique<ThreadedImpl>();
+                }
+                fallback->Submit(std::span(&request, 1));
+                continue;
+            }
+
+            if (free_slots.empty()) {
+                // Every slot is taken, let the kernel start on what has been queued so far.
+                Flush();
+                slot_freed.wait(lock, [this] { return !free_slots.empty(); });
+            }
+            const u32 slot = free_slots.back();
+            free_slots.pop_back();
+
+            InFlight& entry = in_flight[slot];
+            entry.callback = std::move(request.callback);
+            entry.data = request.data;
+            entry.fixed_buffer = -1;
+
+            io_uring_sqe& sqe = NextSqe();
+            sqe.fd = request.file->GetFd();
+            sqe.off = request.offset;
+            sqe.len = static_cast<u32>(request.length);
+            sqe.user_data = slot;
+            if (request.length <= fixed_buffer_size && !free_fixed_buffers.empty()) {
+                entry.fixed_buffer = free_fixed_buffers.back();
+                free_fixed_buffers.pop_back();
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.addr = reinterpret_cast<u64>(FixedBuffer(entry.fixed_buffer));
+                sqe.buf_index = static_cast<u16>(entry.fixed_buffer);
+            } else {
+                sqe.opcode = IORING_OP_READ;
+                sqe.addr = reinterpret_cast<u64>(request.data);
+            }
+            pending_submissions++;
+        }
+        Flush();
+    }
+
+private:
+    static constexpr std::size_t fixed_buffer_size = 64 * 1024;
+    static constexpr std::size_t num_fixed_buffers = 16;
+    static constexpr u64 wake_user_data = ~0ULL;
+
+    struct InFlight {
+        Callback callback;
+        void* data;
+        /// Registered buffer the data is read into, or -1 when it is read into data directly.
+        s32 fixed_buffer;
+    };
+
+    IoUringImpl() = default;
+
+    bool Init(u32 queue_depth) {
+        io_uring_params params{};
+        ring_fd = IoUringSetup(queue_depth, &params);
+        if (ring_fd < 0) {
+            LOG_INFO(Common_Filesystem, "io_uring is unavailable: {}", std::strerror(errno));
+            return false;
+        }
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            LOG_INFO(Common_Filesystem, "io_uring does not support file reads on this kernel");
+            return false;
+        }
+
+        sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+        cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+        }
+        sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ring == MAP_FAILED) {
+            return false;
+        }
+        cq_ring = single_mmap ? sq_ring
+                              : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            return false;
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, ring_fd,
+                                               IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+
+        const auto sq_field = [this](u32 offset) {
+            return reinterpret_cast<u32*>(static_cast<u8*>(sq_ring) + offset);
+        };
+        const auto cq_field = [this](u32 offset) {
+            return reinterpret_cast<u32*>(static_cast<u8*>(cq_ring) + offset);
+        };
+        sq_tail = sq_field(params.sq_off.tail);
+        sq_mask = *sq_field(params.sq_off.ring_mask);
+        sq_array = sq_field(params.sq_off.array);
+        cq_head = cq_field(params.cq_off.head);
+        cq_tail = cq_field(params.cq_off.tail);
+        cq_mask = *cq_field(params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(static_cast<u8*>(cq_ring) + params.cq_off.cqes);
+
+        // Keeping at most sq_entries reads in flight means neither ring can overflow.
+        in_flight.resize(params.sq_entries);
+        for (u32 slot = params.sq_entries; slot-- > 0;) {
+            free_slots.push_back(slot);
+        }
+
+        // Registered buffers save the kernel from mapping the destination pages on every read. They
+        // count against RLIMIT_MEMLOCK, so reads go straight to the destination without them.
+        fixed_buffer_memory.resize(fixed_buffer_size * num_fixed_buffers);
+        std::vector<iovec> iovecs(num_fixed_buffers);
+        for (std::size_t i = 0; i < num_fixed_buffers; i++) {
+            iovecs[i] = {FixedBuffer(static_cast<s32>(i)), fixed_buffer_size};
+        }
+        if (IoUringRegister(ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(),
+                            static_cast<u32>(iovecs.size())) == 0) {
+            for (s32 i = num_fixed_buffers; i-- > 0;) {
+                free_fixed_buffers.push_back(i);
+            }
+        } else {
+            LOG_INFO(Common_Filesystem, "Could not register io_uring buffers: {}",
+                     std::strerror(errno));
+            fixed_buffer_memory.clear();
+        }
+
+        completion_thread = std::jthread([this] { CompletionLoop(); });
+        return true;
+    }
+
+    u8* FixedBuffer(s32 index) {
+        return fixed_buffer_memory.data() + static_cast<std::size_t>(index) * fixed_buffer_size;
+    }
+
+    /// Returns a cleared entry at the tail of the submission queue. Must hold mutex.
+    io_uring_sqe& NextSqe() {
+        const u32 index = sq_tail_local & sq_mask;
+        io_uring_sqe& sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sq_array[index] = index;
+        sq_tail_local++;
+        return sqe;
+    }
+
+    /// Hands all queued entries to the kernel. Must hold mutex.
+    void Flush() {
+        StoreRelease(sq_tail, sq_tail_local);
+        while (pending_submissions != 0) {
+            const int submitted = IoUringEnter(ring_fd, pending_submissions, 0, 0);
+            if (submitted >= 0) {
+                pending_submissions -= static_cast<u32>(submitted);
+            } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                LOG_CRITICAL(Common_Filesystem, "io_uring submission failed: {}",
+                             std::strerror(errno));
+                return;
+            }
+        }
+    }
+
+    void CompletionLoop() {
+        Common::SetCurrentThreadName("AsyncFileReader");
+        std::vector<std::pair<Callback, s64>> completed;
+        while (true) {
+            if (IoUringEnter(ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR &&
+                errno != EAGAIN && errno != EBUSY) {
+                LOG_CRITICAL(Common_Filesystem, "io_uring wait failed: {}", std::strerror(errno));
+                return;
+            }
+
+            bool woken = false;
+            {
+                std::scoped_lock lock{mutex};
+                u32 head = *cq_head;
+                const u32 tail = LoadAcquire(cq_tail);
+                for (; head != tail; head++) {
+                    const io_uring_cqe& cqe = cqes[head & cq_mask];
+                    if (cqe.user_data == wake_user_data) {
+                        woken = true;
+                        continue;
+                    }
+                    const u32 slot = static_cast<u32>(cqe.user_data);
+                    InFlight& entry = in_flight[slot];
+                    if (entry.fixed_buffer >= 0) {
+                        if (cqe.res > 0) {
+                            std::memcpy(entry.data, FixedBuffer(entry.fixed_buffer),
+                                        static_cast<std::size_t>(cqe.res));
+                        }
+                        free_fixed_buffers.push_back(entry.fixed_buffer);
+                    }
+                    completed.emplace_back(std::move(entry.callback), cqe.res);
+                    free_slots.push_back(slot);
+                }
+                StoreRelease(cq_head, head);
+            }
+            slot_freed.notify_all();
+
+            for (auto& [callback, result] : completed) {
+                callback(std::move(result));
+            }
+            completed.clear();
+
+            if (woken && stopping) {
+                return;
+            }
+        }
+    }
+
+    int ring_fd = -1;
+    void* sq_ring = MAP_FAILED;
+    void* cq_ring = MAP_FAILED;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sq_ring_size = 0;
+    std::size_t cq_ring_size = 0;
+    std::size_t sqes_size = 0;
+
+    u32* sq_tail = nullptr;
+    u32* sq_array = nullptr;
+    u32 sq_mask = 0;
+    u32* cq_head = nullptr;
+    u32* cq_tail = nullptr;
+    u32 cq_mask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable slot_freed;
+    u32 sq_tail_local = 0;
+    u32 pending_submissions = 0;
+    std::vector<InFlight> in_flight;
+    std::vector<u32> free_slots;
+    std::vector<u8> fixed_buffer_memory;
+    std::vector<s32> free_fixed_buffers;
+    bool stopping = false;
+
+    /// Serves reads the kernel cannot do by itself.
+    std::unique_ptr<ThreadedImpl> fallback;
+    std::jthread completion_thread;
+};
+
+#endif
+
+AsyncFileReader::AsyncFileReader(Backend preferred_backend, u32 queue_depth) {
+#ifdef HAVE_IO_URING
+    if (preferred_backend == Backend::IoUring) {
+        impl = IoUringImpl::Create(queue_depth);
+    }
+#endif
+    if (!impl) {
+        impl = std::make_unique<ThreadedImpl>();
+    }
+}
+
+AsyncFileReader::~AsyncFileReader() = default;
+
+AsyncFileReader& AsyncFileReader::Get() {
+    static AsyncFileReader reader;
+    return reader;
+}
+
+AsyncFileReader::Backend AsyncFileReader::GetBackend() const {
+    return impl->GetBackend();
+}
+
+void AsyncFileReader::Submit(Request request) {
+    impl->Submit(std::span(&request, 1));
+}
+
+void AsyncFileReader::Submit(std::span<Request> requests) {
+    impl->Submit(requests);
+}
+
+} // namespace FileUtil
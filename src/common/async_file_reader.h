@@ -0,0 +1,70 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <span>
+#include "common/common_types.h"
+#include "common/unique_function.h"
+
+namespace FileUtil {
+
+class IOFile;
+
+/**
+ * Reads from files without blocking the caller. Completion callbacks run on a thread owned by the
+ * reader and should not block.
+ *
+ * On Linux, reads are submitted to an io_uring, so any number of reads can be in flight without a
+ * thread per read. Small reads go through a set of buffers registered with the kernel. Everywhere
+ * else, or if io_uring is unavailable, reads are served by pread on worker threads.
+ */
+class AsyncFileReader {
+public:
+    enum class Backend {
+        IoUring,
+        Threaded,
+    };
+
+    /// Receives the number of bytes read, or a negative errno value if the read failed.
+    using Callback = Common::UniqueFunction<void, s64>;
+
+    struct Request {
+        /// Must stay open until the callback has run.
+        IOFile* file;
+        void* data;
+        std::size_t length;
+        u64 offset;
+        Callback callback;
+    };
+
+    /// Falls back to the threaded backend if the preferred one cannot be set up.
+    explicit AsyncFileReader(Backend preferred_backend = Backend::IoUring, u32 queue_depth = 64);
+
+    /// Waits for all submitted reads to complete.
+    ~AsyncFileReader();
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    /// Returns the reader shared by the emulator.
+    static AsyncFileReader& Get();
+
+    [[nodiscard]] Backend GetBackend() const;
+
+    void Submit(Request request);
+
+    /// Submits several reads at once, with a single system call where the backend allows it.
+    void Submit(std::span<Request> requests);
+
+private:
+    class Impl;
+    class IoUringImpl;
+    class ThreadedImpl;
+
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace FileUtil
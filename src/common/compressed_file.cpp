@@ -0,0 +1,403 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include "common/compressed_file.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scope_exit.h"
+#include "common/thread_worker.h"
+#include "common/zstd_compression.h"
+
+namespace FileUtil {
+
+namespace {
+
+/// Decompressed frames kept per open container, 4 MiB with the default frame size.
+constexpr std::size_t frame_cache_size = 16;
+/// Frames decompressed ahead of sequential reads.
+constexpr u32 prefetch_frames = 2;
+constexpr u32 min_frame_size = 4 * 1024;
+constexpr u32 max_frame_size = 16 * 1024 * 1024;
+
+Common::ThreadWorker& PrefetchWorker() {
+    static Common::ThreadWorker worker(
+        std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u), "CompressedFilePrefetch");
+    return worker;
+}
+
+u64 FrameCount(u64 size, u32 frame_size) {
+    return (size + frame_size - 1) / frame_size;
+}
+
+} // Anonymous namespace
+
+std::unique_ptr<CompressedFileReader> CompressedFileReader::Open(RawReadFunc raw_read) {
+    CompressedFileHeader header;
+    if (raw_read(&header, sizeof(header), 0) != sizeof(header) ||
+        header.magic != compressed_file_magic) {
+        return nullptr;
+    }
+
+    if (header.version != compressed_file_version) {
+        LOG_ERROR(Common_Filesystem, "Unsupported compressed file version {}",
+                  static_cast<u32>(header.version));
+        return nullptr;
+    }
+    if (header.frame_size < min_frame_size || header.frame_size > max_frame_size ||
+        header.num_frames != FrameCount(header.uncompressed_size, header.frame_size)) {
+        LOG_ERROR(Common_Filesystem, "Invalid compressed file header");
+        return nullptr;
+    }
+
+    std::vector<CompressedFrameEntry> index(header.num_frames);
+    const std::size_t index_size = index.size() * sizeof(CompressedFrameEntry);
+    if (raw_read(index.data(), index_size, sizeof(header)) != index_size) {
+        LOG_ERROR(Common_Filesystem, "Compressed file index is truncated");
+        return nullptr;
+    }
+
+    return std::unique_ptr<CompressedFileReader>(
+        new CompressedFileReader(std::move(raw_read), header, std::move(index)));
+}
+
+CompressedFileReader::CompressedFileReader(RawReadFunc raw_read_,
+                                           const CompressedFileHeader& header_,
+                                           std::vector<CompressedFrameEntry> index_)
+    : raw_read(std::move(raw_read_)), header(header_), index(std::move(index_)) {}
+
+CompressedFileReader::~CompressedFileReader() {
+    // Prefetches hold on to this reader, wait for them to drain before it goes away.
+    std::unique_lock lock{cache_mutex};
+    closing = true;
+    frame_ready.wait(lock, [this] { return prefetches_in_flight == 0; });
+}
+
+std::size_t CompressedFileReader::ReadAt(void* data, std::size_t length, u64 offset) {
+    if (offset >= GetSize() || length == 0) {
+        return 0;
+    }
+    length = static_cast<std::size_t>(std::min<u64>(length, GetSize() - offset));
+
+    u8* const out = static_cast<u8*>(data);
+    const u32 first_frame = static_cast<u32>(offset / header.frame_size);
+    u32 frame = first_frame;
+    std::size_t done = 0;
+    while (done < length) {
+        const FrameData frame_data = GetFrame(frame);
+        const std::size_t frame_offset =
+            static_cast<std::size_t>(offset + done - static_cast<u64>(frame) * header.frame_size);
+        if (!frame_data || frame_offset >= frame_data->size()) {
+            break;
+        }
+        const std::size_t chunk = std::min(length - done, frame_data->size() - frame_offset);
+        std::memcpy(out + done, frame_data->data() + frame_offset, chunk);
+        done += chunk;
+        frame++;
+    }
+
+    if (done == 0) {
+        return 0;
+    }
+
+    // Only prefetch for reads that continue where the previous one stopped, random access would
+    // just thrash the cache.
+    const u32 last_frame = frame - 1;
+    bool sequential;
+    {
+        std::scoped_lock lock{cache_mutex};
+        sequential = first_frame == last_frame_read || first_frame == last_frame_read + 1;
+        last_frame_read = last_frame;
+    }
+    if (sequential) {
+        Prefetch(last_frame + 1, prefetch_frames);
+    }
+
+    return done;
+}
+
+std::size_t CompressedFileReader::Read(void* data, std::size_t length) {
+    const std::size_t read = ReadAt(data, length, position);
+    position += read;
+    return read;
+}
+
+bool CompressedFileReader::Seek(s64 off, int origin) {
+    s64 base;
+    switch (origin) {
+    case SEEK_SET:
+        base = 0;
+        break;
+    case SEEK_CUR:
+        base = static_cast<s64>(position);
+        break;
+    case SEEK_END:
+        base = static_cast<s64>(GetSize());
+        break;
+    default:
+        return false;
+    }
+
+    if (base + off < 0) {
+        return false;
+    }
+    position = static_cast<u64>(base + off);
+    return true;
+}
+
+bool CompressedFileReader::Verify(const std::function<void(std::size_t, std::size_t)>& progress) {
+    for (u32 frame = 0; frame < header.num_frames; frame++) {
+        const FrameData frame_data = DecompressFrame(frame);
+        if (!frame_data) {
+            return false;
+        }
+        if (Common::ComputeHash64(frame_data->data(), frame_data->size()) != index[frame].hash) {
+            LOG_ERROR(Common_Filesystem, "Compressed file frame {} does not match its hash", frame);
+            return false;
+        }
+        if (progress) {
+            progress(frame + 1, header.num_frames);
+        }
+    }
+    return true;
+}
+
+CompressedFileReader::Stats CompressedFileReader::GetStats() const {
+    std::scoped_lock lock{cache_mutex};
+    return stats;
+}
+
+CompressedFileReader::FrameData CompressedFileReader::GetFrame(u32 frame) {
+    {
+        std::unique_lock lock{cache_mutex};
+        while (true) {
+            const auto it = std::find_if(cache.begin(), cache.end(),
+                                         [frame](const auto& entry) { return entry.first == frame; });
+            if (it != cache.end()) {
+                cache.splice(cache.begin(), cache, it);
+                stats.cache_hits++;
+                return it->second;
+            }
+            // Another thread, most likely a prefetch, is already decompressing this frame.
+            if (std::find(frames_in_flight.begin(), frames_in_flight.end(), frame) ==
+                frames_in_flight.end()) {
+                break;
+            }
+            frame_ready.wait(lock);
+        }
+        frames_in_flight.push_back(frame);
+        stats.cache_misses++;
+    }
+
+    FrameData frame_data = DecompressFrame(frame);
+    InsertFrame(frame, frame_data);
+    return frame_data;
+}
+
+CompressedFileReader::FrameData CompressedFileReader::DecompressFrame(u32 frame) {
+    if (frame >= header.num_frames) {
+        return nullptr;
+    }
+
+    const CompressedFrameEntry& entry = index[frame];
+    const u64 frame_start = static_cast<u64>(frame) * header.frame_size;
+    const std::size_t frame_length =
+        static_cast<std::size_t>(std::min<u64>(header.frame_size, GetSize() - frame_start));
+    if (entry.size > frame_length) {
+        LOG_ERROR(Common_Filesystem, "Compressed file frame {} has invalid size {}", frame,
+                  static_cast<u32>(entry.size));
+        return nullptr;
+    }
+
+    std::vector<u8> stored(entry.size);
+    if (raw_read(stored.data(), stored.size(), entry.offset) != stored.size()) {
+        LOG_ERROR(Common_Filesystem, "Could not read compressed file frame {}", frame);
+        return nullptr;
+    }
+
+    if (entry.flags & CompressedFrameEntry::Stored) {
+        if (stored.size() != frame_length) {
+            LOG_ERROR(Common_Filesystem, "Compressed file frame {} is truncated", frame);
+            return nullptr;
+        }
+        return std::make_shared<const std::vector<u8>>(std::move(stored));
+    }
+
+    std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(stored);
+    if (decompressed.size() != frame_length) {
+        LOG_ERROR(Common_Filesystem, "Could not decompress compressed file frame {}", frame);
+        return nullptr;
+    }
+    return std::make_shared<const std::vector<u8>>(std::move(decompressed));
+}
+
+void CompressedFileReader::InsertFrame(u32 frame, FrameData frame_data) {
+    {
+        std::scoped_lock lock{cache_mutex};
+        std::erase(frames_in_flight, frame);
+        if (frame_data) {
+            stats.frames_decompressed++;
+            cache.emplace_front(frame, std::move(frame_data));
+            if (cache.size() > frame_cache_size) {
+                cache.pop_back();
+            }
+        }
+    }
+    frame_ready.notify_all();
+}
+
+void CompressedFileReader::Prefetch(u32 first_frame, u32 count) {
+    const u32 end_frame = std::min(first_frame + count, static_cast<u32>(header.num_frames));
+    for (u32 frame = first_frame; frame < end_frame; frame++) {
+        {
+            std::scoped_lock lock{cache_mutex};
+            const bool cached =
+                std::any_of(cache.begin(), cache.end(),
+                            [frame](const auto& entry) { return entry.first == frame; });
+            const bool in_flight = std::find(frames_in_flight.begin(), frames_in_flight.end(),
+                                             frame) != frames_in_flight.end();
+            if (closing || cached || in_flight) {
+                continue;
+            }
+            frames_in_flight.push_back(frame);
+            prefetches_in_flight++;
+        }
+
+        PrefetchWorker().QueueWork([this, frame] {
+            bool skip;
+            {
+                std::scoped_lock lock{cache_mutex};
+                skip = closing;
+            }
+            FrameData frame_data = skip ? nullptr : DecompressFrame(frame);
+            const bool prefetched = frame_data != nullptr;
+            InsertFrame(frame, std::move(frame_data));
+
+            std::scoped_lock lock{cache_mutex};
+            if (prefetched) {
+                stats.frames_prefetched++;
+            }
+            prefetches_in_flight--;
+            frame_ready.notify_all();
+        });
+    }
+}
+
+bool CompressFile(const std::string& source_path, const std::string& dest_path,
+                  const CompressOptions& options, const std::function<void(u64, u64)>& progress) {
+    if (options.frame_size < min_frame_size || options.frame_size > max_frame_size) {
+        LOG_ERROR(Common_Filesystem, "Invalid frame size {}", options.frame_size);
+        return false;
+    }
+
+    IOFile source(source_path, "rb");
+    if (!source.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Could not open {}", source_path);
+        return false;
+    }
+
+    const u64 size = source.GetSize();
+    const u64 num_frames = FrameCount(size, options.frame_size);
+    if (num_frames > std::numeric_limits<u32>::max()) {
+        LOG_ERROR(Common_Filesystem, "{} is too large to compress", source_path);
+        return false;
+    }
+
+    IOFile dest(dest_path, "wb");
+    if (!dest.IsOpen()) {
+        LOG_ERROR(Common_Filesystem, "Could not create {}", dest_path);
+        return false;
+    }
+
+    // A partly written container would be taken for a truncated image, so remove it on failure.
+    bool success = false;
+    SCOPE_EXIT({
+        if (!success) {
+            dest.Close();
+            Delete(dest_path);
+        }
+    });
+
+    CompressedFileHeader header{};
+    header.magic = compressed_file_magic;
+    header.version = compressed_file_version;
+    header.frame_size = options.frame_size;
+    header.num_frames = static_cast<u32>(num_frames);
+    header.uncompressed_size = size;
+
+    // The index is written once all frames are compressed, reserve space for it up front.
+    std::vector<CompressedFrameEntry> index(header.num_frames);
+    dest.WriteObject(header);
+    dest.WriteArray(index.data(), index.size());
+    u64 offset = sizeof(header) + index.size() * sizeof(CompressedFrameEntry);
+
+    const u32 num_threads =
+        options.num_threads != 0 ? options.num_threads
+                                 : std::max(std::thread::hardware_concurrency(), 1u);
+
+    // Frames are compressed in batches of a few per thread, and written out in order.
+    const u32 batch_size = num_threads * 4;
+    std::vector<std::vector<u8>> frames(batch_size);
+    std::vector<std::vector<u8>> compressed(batch_size);
+    std::vector<u64> hashes(batch_size);
+    Common::ThreadWorker workers(num_threads, "CompressFile");
+
+    for (u32 first = 0; first < header.num_frames; first += batch_size) {
+        const u32 count = std::min(batch_size, header.num_frames - first);
+        for (u32 i = 0; i < count; i++) {
+            const u64 frame_start = static_cast<u64>(first + i) * options.frame_size;
+            frames[i].resize(
+                static_cast<std::size_t>(std::min<u64>(options.frame_size, size - frame_start)));
+            if (source.ReadBytes(frames[i].data(), frames[i].size()) != frames[i].size()) {
+                LOG_ERROR(Common_Filesystem, "Could not read {}", source_path);
+                return false;
+            }
+            workers.QueueWork([&, i] {
+                compressed[i] =
+                    Common::Compression::CompressDataZSTD(frames[i], options.compression_level);
+                hashes[i] = Common::ComputeHash64(frames[i].data(), frames[i].size());
+            });
+        }
+        workers.WaitForRequests();
+
+        for (u32 i = 0; i < count; i++) {
+            CompressedFrameEntry& entry = index[first + i];
+            const bool store = compressed[i].empty() || compressed[i].size() >= frames[i].size();
+            const std::vector<u8>& data = store ? frames[i] : compressed[i];
+            entry.offset = offset;
+            entry.size = static_cast<u32>(data.size());
+            entry.flags = store ? CompressedFrameEntry::Stored : 0;
+            entry.hash = hashes[i];
+            if (dest.WriteBytes(data.data(), data.size()) != data.size()) {
+                LOG_ERROR(Common_Filesystem, "Could not write {}", dest_path);
+                return false;
+            }
+            offset += data.size();
+        }
+
+        if (progress) {
+            progress(std::min<u64>(static_cast<u64>(first + count) * options.frame_size, size),
+                     size);
+        }
+    }
+
+    if (!dest.Seek(sizeof(header), SEEK_SET) ||
+        dest.WriteArray(index.data(), index.size()) != index.size() || !dest.Close()) {
+        LOG_ERROR(Common_Filesystem, "Could not write {}", dest_path);
+        return false;
+    }
+    success = true;
+    return true;
+}
+
+bool IsCompressedFile(const std::string& path) {
+    const IOFile file(path, "rb");
+    return file.IsCompressed();
+}
+
+} // namespace FileUtil
@@ -0,0 +1,167 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "common/swap.h"
+
+namespace FileUtil {
+
+/**
+ * Seekable compressed container for ROM images (NCSD, NCCH, CIA, ...). The image is split into
+ * fixed size frames that are compressed independently with Zstandard. The header is followed by an
+ * index of all frames, so any range of the image can be read by decompressing only the frames it
+ * covers. Frames that do not compress, such as encrypted content, are stored as they are.
+ *
+ * IOFile opens these containers transparently when a file is opened with "rb", so everything that
+ * reads ROMs through IOFile sees the original image.
+ */
+constexpr std::array<u8, 4> compressed_file_magic{'B', '3', 'D', 'Z'};
+constexpr u32 compressed_file_version = 1;
+constexpr u32 compressed_file_default_frame_size = 256 * 1024;
+
+struct CompressedFileHeader {
+    std::array<u8, 4> magic;
+    u32_le version;
+    u32_le frame_size;
+    u32_le num_frames;
+    u64_le uncompressed_size;
+    u64_le reserved;
+};
+static_assert(sizeof(CompressedFileHeader) == 0x20, "CompressedFileHeader has incorrect size");
+
+struct CompressedFrameEntry {
+    enum Flags : u32 {
+        /// The frame is stored uncompressed.
+        Stored = 1 << 0,
+    };
+
+    u64_le offset;
+    u32_le size;
+    u32_le flags;
+    /// Hash of the uncompressed frame, checked when verifying the container.
+    u64_le hash;
+};
+static_assert(sizeof(CompressedFrameEntry) == 0x18, "CompressedFrameEntry has incorrect size");
+
+/**
+ * Reads the original image out of a compressed container. Decompressed frames are kept in a small
+ * cache, and sequential reads prefetch the following frames on background threads. ReadAt may be
+ * called from several threads at once.
+ */
+class CompressedFileReader {
+public:
+    /// Reads length bytes at offset from the container file, returning the number of bytes read.
+    using RawReadFunc = std::function<std::size_t(void* data, std::size_t length, u64 offset)>;
+
+    struct Stats {
+        u64 frames_decompressed = 0;
+        u64 frames_prefetched = 0;
+        u64 cache_hits = 0;
+        u64 cache_misses = 0;
+    };
+
+    /// Returns nullptr if the file is not a valid compressed container.
+    static std::unique_ptr<CompressedFileReader> Open(RawReadFunc raw_read);
+
+    ~CompressedFileReader();
+
+    CompressedFileReader(const CompressedFileReader&) = delete;
+    CompressedFileReader& operator=(const CompressedFileReader&) = delete;
+
+    /// Size of the original image.
+    [[nodiscard]] u64 GetSize() const {
+        return header.uncompressed_size;
+    }
+
+    [[nodiscard]] u32 GetFrameSize() const {
+        return header.frame_size;
+    }
+
+    [[nodiscard]] u32 GetNumFrames() const {
+        return header.num_frames;
+    }
+
+    /// Returns the number of bytes read, which is less than length only at the end of the image.
+    std::size_t ReadAt(void* data, std::size_t length, u64 offset);
+
+    /// Reads the container file itself, bypassing decompression.
+    std::size_t ReadRaw(void* data, std::size_t length, u64 offset) {
+        return raw_read(data, length, offset);
+    }
+
+    // Sequential access, with the same semantics as the stdio functions backing IOFile.
+    std::size_t Read(void* data, std::size_t length);
+    bool Seek(s64 off, int origin);
+    [[nodiscard]] u64 Tell() const {
+        return position;
+    }
+
+    /**
+     * Decompresses every frame and checks it against the hash stored when it was compressed.
+     * @param progress Called with the number of frames checked and the total number of frames.
+     */
+    bool Verify(const std::function<void(std::size_t, std::size_t)>& progress = {});
+
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    using FrameData = std::shared_ptr<const std::vector<u8>>;
+
+    CompressedFileReader(RawReadFunc raw_read, const CompressedFileHeader& header,
+                         std::vector<CompressedFrameEntry> index);
+
+    /// Returns the contents of a frame, from the cache if possible.
+    FrameData GetFrame(u32 frame);
+    FrameData DecompressFrame(u32 frame);
+    void InsertFrame(u32 frame, FrameData data);
+    void Prefetch(u32 first_frame, u32 count);
+
+    RawReadFunc raw_read;
+    CompressedFileHeader header;
+    std::vector<CompressedFrameEntry> index;
+
+    u64 position = 0;
+
+    mutable std::mutex cache_mutex;
+    std::condition_variable frame_ready;
+    /// Most recently used first.
+    std::list<std::pair<u32, FrameData>> cache;
+    /// Frames currently being decompressed by some thread.
+    std::vector<u32> frames_in_flight;
+    u32 prefetches_in_flight = 0;
+    u32 last_frame_read = 0;
+    bool closing = false;
+    Stats stats;
+};
+
+struct CompressOptions {
+    u32 frame_size = compressed_file_default_frame_size;
+    s32 compression_level = 12;
+    /// Number of threads compressing frames, 0 to use all hardware threads.
+    u32 num_threads = 0;
+};
+
+/**
+ * Compresses a ROM image into a compressed container.
+ * @param progress Called with the number of bytes compressed and the size of the image.
+ * @returns true on success.
+ */
+bool CompressFile(const std::string& source_path, const std::string& dest_path,
+                  const CompressOptions& options = {},
+                  const std::function<void(u64, u64)>& progress = {});
+
+/// Returns whether the file at path is a compressed container.
+bool IsCompressedFile(const std::string& path);
+
+} // namespace FileUtil
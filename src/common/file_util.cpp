@@ -15,6 +15,7 @@
 #include "common/assert.h"
 #include "common/common_funcs.h"
 #include "common/common_paths.h"
+#include "common/compressed_file.h"
 #include "common/error.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
@@ -411,6 +412,24 @@ u64 GetSize(const std::string& filename) {
     return 0;
 }
 
+std::optional<s64> GetModificationTime(const std::string& filename) {
+    struct stat buf;
+#ifdef _WIN32
+    if (_wstat64(Common::UTF8ToUTF16W(filename).c_str(), &buf) == 0)
+#elif ANDROID
+    // The storage access framework does not report modification times
+    return std::nullopt;
+#else
+    if (stat(filename.c_str(), &buf) == 0)
+#endif
+    {
+        return static_cast<s64>(buf.st_mtime);
+    }
+
+    LOG_ERROR(Common_Filesystem, "Stat failed {}: {}", filename, GetLastErrorMsg());
+    return std::nullopt;
+}
+
 u64 GetSize(const int fd) {
     struct stat buf;
     if (fstat(fd, &buf) != 0) {
@@ -1081,6 +1100,7 @@ IOFile& IOFile::operator=(IOFile&& other) noexcept {
 
 void IOFile::Swap(IOFile& other) noexcept {
     std::swap(m_file, other.m_file);
+    std::swap(m_compressed, other.m_compressed);
     std::swap(m_fd, other.m_fd);
     std::swap(m_good, other.m_good);
     std::swap(filename, other.filename);
@@ -1134,10 +1154,15 @@ bool IOFile::Open() {
     m_good = m_file != nullptr;
 #endif
 
+    if (m_good && openmode == "rb") {
+        OpenCompressed();
+    }
+
     return m_good;
 }
 
 bool IOFile::Close() {
+    m_compressed.reset();
     if (!IsOpen() || 0 != std::fclose(m_file))
         m_good = false;
 
@@ -1146,6 +1171,9 @@ bool IOFile::Close() {
 }
 
 u64 IOFile::GetSize() const {
+    if (m_compressed)
+        return m_compressed->GetSize();
+
     if (IsOpen())
         return FileUtil::GetSize(m_file);
 
@@ -1153,6 +1181,13 @@ u64 IOFile::GetSize() const {
 }
 
 bool IOFile::Seek(s64 off, int origin) {
+    if (m_compressed) {
+        if (!m_compressed->Seek(off, origin))
+            m_good = false;
+
+        return m_good;
+    }
+
     if (!IsOpen() || 0 != fseeko(m_file, off, origin))
         m_good = false;
 
@@ -1160,6 +1195,9 @@ bool IOFile::Seek(s64 off, int origin) {
 }
 
 u64 IOFile::Tell() const {
+    if (m_compressed)
+        return m_compressed->Tell();
+
     if (IsOpen())
         return ftello(m_file);
 
@@ -1185,9 +1223,17 @@ std::size_t IOFile::ReadImpl(void* data, std::size_t length, std::size_t data_si
 
     DEBUG_ASSERT(data != nullptr);
 
+    if (m_compressed) {
+        return ReadCompressed(data, data_size * length) / data_size;
+    }
+
     return std::fread(data, data_size, length, m_file);
 }
 
+std::size_t IOFile::ReadCompressed(void* data, std::size_t size) const {
+    return m_compressed->Read(data, size);
+}
+
 #ifdef _WIN32
 static std::size_t pread(int fd, void* buf, std::size_t count, uint64_t offset) {
     long unsigned int read_bytes = 0;
@@ -1222,9 +1268,22 @@ std::size_t IOFile::ReadAtImpl(void* data, std::size_t length, std::size_t data_
 
     DEBUG_ASSERT(data != nullptr);
 
+    if (m_compressed) {
+        return m_compressed->ReadAt(data, data_size * length, offset);
+    }
+
     return pread(fileno(m_file), data, data_size * length, offset);
 }
 
+void IOFile::OpenCompressed() {
+    // The reader keeps its own offset and reads the container with pread, so the stdio position
+    // of m_file is never used while it is open.
+    m_compressed = CompressedFileReader::Open(
+        [file = m_file](void* data, std::size_t length, u64 offset) {
+            return static_cast<std::size_t>(pread(fileno(file), data, length, offset));
+        });
+}
+
 std::size_t IOFile::WriteImpl(const void* data, std::size_t length, std::size_t data_size) {
     if (!IsOpen()) {
         m_good = false;
@@ -10,6 +10,7 @@
 #include <functional>
 #include <ios>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
@@ -112,6 +113,10 @@ private:
 // Overloaded GetSize, accepts FILE*
 [[nodiscard]] u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or std::nullopt if
+// it is not available
+[[nodiscard]] std::optional<s64> GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -268,6 +273,8 @@ enum class DirectorySeparator {
     std::string_view path,
     DirectorySeparator directory_separator = DirectorySeparator::ForwardSlash);
 
+class CompressedFileReader;
+
 // simple wrapper for cstdlib file functions to
 // hopefully will make error checking easier
 // and make forgetting an fclose() harder
@@ -378,6 +385,10 @@ public:
             return 0;
         }
 
+        if (m_compressed) {
+            return ReadCompressed(data.data(), data.size_bytes()) / sizeof(T);
+        }
+
         return std::fread(data.data(), sizeof(T), data.size(), m_file);
     }
 
@@ -411,6 +422,15 @@ public:
         return nullptr != m_file;
     }
 
+    /// Whether the file is a compressed container, which is read as the image it holds.
+    [[nodiscard]] bool IsCompressed() const {
+        return m_compressed != nullptr;
+    }
+
+    [[nodiscard]] CompressedFileReader* GetCompressedReader() const {
+        return m_compressed.get();
+    }
+
     // m_good is set to false when a read, write or other function fails
     [[nodiscard]] bool IsGood() const {
         return m_good;
@@ -445,10 +465,13 @@ private:
     std::size_t ReadAtImpl(void* data, std::size_t length, std::size_t data_size,
                            std::size_t offset);
     std::size_t WriteImpl(const void* data, std::size_t length, std::size_t data_size);
+    std::size_t ReadCompressed(void* data, std::size_t size) const;
 
     bool Open();
+    void OpenCompressed();
 
     std::FILE* m_file = nullptr;
+    std::unique_ptr<CompressedFileReader> m_compressed;
     int m_fd = -1;
     bool m_good = true;
 
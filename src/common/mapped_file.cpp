@@ -0,0 +1,103 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <utility>
+
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+#include "common/error.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+
+namespace FileUtil {
+
+MappedFile::MappedFile(const std::string& path) {
+    IOFile file(path, "rb");
+    if (!file.IsOpen() || file.IsCompressed()) {
+        return;
+    }
+
+    const u64 file_size = file.GetSize();
+    if (file_size == 0) {
+        // Empty files cannot be mapped, but there is nothing to read from them either.
+        is_open = true;
+        return;
+    }
+
+#ifdef _WIN32
+    const auto handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.GetFd()));
+    mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Could not map {}: {}", path, Common::GetLastErrorMsg());
+        return;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Could not map {}: {}", path, Common::GetLastErrorMsg());
+        CloseHandle(mapping);
+        mapping = nullptr;
+        return;
+    }
+#else
+    void* view = mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, file.GetFd(), 0);
+    if (view == MAP_FAILED) {
+        LOG_WARNING(Common_Filesystem, "Could not map {}: {}", path, Common::GetLastErrorMsg());
+        return;
+    }
+#endif
+
+    data = static_cast<const u8*>(view);
+    size = static_cast<std::size_t>(file_size);
+    is_open = true;
+}
+
+MappedFile::~MappedFile() {
+    Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data{std::exchange(other.data, nullptr)}, size{std::exchange(other.size, 0)},
+      is_open{std::exchange(other.is_open, false)}
+#ifdef _WIN32
+      ,
+      mapping{std::exchange(other.mapping, nullptr)}
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Unmap();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+        is_open = std::exchange(other.is_open, false);
+#ifdef _WIN32
+        mapping = std::exchange(other.mapping, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void MappedFile::Unmap() {
+    if (data != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        munmap(const_cast<u8*>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+    is_open = false;
+}
+
+} // namespace FileUtil
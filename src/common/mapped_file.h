@@ -0,0 +1,54 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <span>
+#include <string>
+#include "common/common_types.h"
+
+namespace FileUtil {
+
+/**
+ * A read-only view of a whole file mapped into memory. Reads are served from the page cache
+ * without a system call, and the view does not hold a file descriptor open.
+ *
+ * The file must not be truncated while it is mapped.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    /// Maps the file at path. Compressed containers are not mapped, as they are read as the image
+    /// they hold.
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool IsOpen() const {
+        return is_open;
+    }
+
+    [[nodiscard]] std::span<const u8> GetData() const {
+        return {data, size};
+    }
+
+private:
+    void Unmap();
+
+    const u8* data = nullptr;
+    std::size_t size = 0;
+    bool is_open = false;
+#ifdef _WIN32
+    void* mapping = nullptr;
+#endif
+};
+
+} // namespace FileUtil
@@ -122,4 +122,132 @@ private:
     std::array<T, granularity * capacity> m_data;
 };
 
+/// MPSC ring buffer
+/// Any number of threads may push concurrently while a single thread pops. Producers reserve a
+/// contiguous run of slots with a CAS on the write index and then publish each slot through its
+/// own sequence number, so neither side ever blocks on the other.
+/// @tparam T            Element type
+/// @tparam capacity     Number of slots in ring buffer
+/// @tparam granularity  Slot size in terms of number of elements
+template <typename T, std::size_t capacity, std::size_t granularity = 1>
+class MPSCRingBuffer {
+    /// A "slot" is made of `granularity` elements of `T`.
+    static constexpr std::size_t slot_size = granularity * sizeof(T);
+    // T must be safely memcpy-able and have a trivial default constructor.
+    static_assert(std::is_trivial_v<T>);
+    // Ensure capacity is sensible.
+    static_assert(capacity < std::numeric_limits<std::size_t>::max() / 2 / granularity);
+    static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+    // Ensure lock-free.
+    static_assert(std::atomic_size_t::is_always_lock_free);
+
+public:
+    MPSCRingBuffer() {
+        // A slot at position `pos` is published once its sequence reads `pos + 1`.
+        for (std::size_t i = 0; i < capacity; i++) {
+            m_sequence[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Pushes slots into the ring buffer. Safe to call from several threads at once.
+    /// @param new_slots   Pointer to the slots to push
+    /// @param slot_count  Number of slots to push
+    /// @returns The number of slots actually pushed
+    std::size_t Push(const void* new_slots, std::size_t slot_count) {
+        std::size_t write_index = m_write_index.load(std::memory_order_relaxed);
+        std::size_t push_count;
+        do {
+            const std::size_t slots_free =
+                capacity + m_read_index.load(std::memory_order_acquire) - write_index;
+            push_count = std::min(slot_count, slots_free);
+            if (push_count == 0) {
+                return 0;
+            }
+        } while (!m_write_index.compare_exchange_weak(write_index, write_index + push_count,
+                                                      std::memory_order_relaxed));
+
+        const std::size_t pos = write_index % capacity;
+        const std::size_t first_copy = std::min(capacity - pos, push_count);
+        const std::size_t second_copy = push_count - first_copy;
+
+        const char* in = static_cast<const char*>(new_slots);
+        std::memcpy(m_data.data() + pos * granularity, in, first_copy * slot_size);
+        in += first_copy * slot_size;
+        std::memcpy(m_data.data(), in, second_copy * slot_size);
+
+        for (std::size_t i = 0; i < push_count; i++) {
+            const std::size_t slot = write_index + i;
+            m_sequence[slot % capacity].store(slot + 1, std::memory_order_release);
+        }
+
+        return push_count;
+    }
+
+    std::size_t Push(std::span<const T> input) {
+        return Push(input.data(), input.size() / granularity);
+    }
+
+    /// Pops slots from the ring buffer. Stops at the first slot that has been reserved by a
+    /// producer but not yet published.
+    /// @param output     Where to store the popped slots
+    /// @param max_slots  Maximum number of slots to pop
+    /// @returns The number of slots actually popped
+    std::size_t Pop(void* output, std::size_t max_slots = ~std::size_t(0)) {
+        const std::size_t read_index = m_read_index.load(std::memory_order_relaxed);
+        const std::size_t slots_reserved =
+            m_write_index.load(std::memory_order_relaxed) - read_index;
+        const std::size_t max_count = std::min(slots_reserved, max_slots);
+
+        std::size_t pop_count = 0;
+        while (pop_count < max_count) {
+            const std::size_t slot = read_index + pop_count;
+            if (m_sequence[slot % capacity].load(std::memory_order_acquire) != slot + 1) {
+                break;
+            }
+            pop_count++;
+        }
+
+        const std::size_t pos = read_index % capacity;
+        const std::size_t first_copy = std::min(capacity - pos, pop_count);
+        const std::size_t second_copy = pop_count - first_copy;
+
+        char* out = static_cast<char*>(output);
+        std::memcpy(out, m_data.data() + pos * granularity, first_copy * slot_size);
+        out += first_copy * slot_size;
+        std::memcpy(out, m_data.data(), second_copy * slot_size);
+
+        m_read_index.store(read_index + pop_count, std::memory_order_release);
+
+        return pop_count;
+    }
+
+    /// @returns Number of slots used, including ones still being written by a producer
+    [[nodiscard]] std::size_t Size() const {
+        return m_write_index.load(std::memory_order_relaxed) -
+               m_read_index.load(std::memory_order_relaxed);
+    }
+
+    /// @returns Maximum size of ring buffer
+    [[nodiscard]] constexpr std::size_t Capacity() const {
+        return capacity;
+    }
+
+private:
+#ifdef __cpp_lib_hardware_interference_size
+    static constexpr std::size_t padding_size =
+        std::hardware_destructive_interference_size - sizeof(std::atomic_size_t);
+#else
+    static constexpr std::size_t padding_size = 128 - sizeof(std::atomic_size_t);
+#endif
+
+    std::atomic_size_t m_read_index{0};
+    char padding1[padding_size];
+
+    std::atomic_size_t m_write_index{0};
+    char padding2[padding_size];
+
+    std::array<std::atomic_size_t, capacity> m_sequence;
+    std::array<T, granularity * capacity> m_data;
+};
+
 } // namespace Common
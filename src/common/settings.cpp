@@ -21,6 +21,8 @@ std::string_view GetAudioEmulationName(AudioEmulation emulation) {
         return "LLE";
     case AudioEmulation::LLEMultithreaded:
         return "LLE Multithreaded";
+    case AudioEmulation::HLEMultithreaded:
+        return "HLE Multithreaded";
     default:
         return "Invalid";
     }
@@ -71,6 +73,17 @@ std::string_view GetTextureFilterName(TextureFilter filter) {
     }
 }
 
+std::string_view GetFSTimingProfileName(FSTimingProfile profile) {
+    switch (profile) {
+    case FSTimingProfile::Accurate:
+        return "Accurate";
+    case FSTimingProfile::Fast:
+        return "Fast";
+    default:
+        return "Invalid";
+    }
+}
+
 std::string_view GetTextureSamplingName(TextureSampling sampling) {
     switch (sampling) {
     case TextureSampling::GameControlled:
@@ -96,11 +109,14 @@ void LogSettings() {
 
     LOG_INFO(Config, "Borked3DS Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
+    log_setting("Core_ParallelCpuCores", values.parallel_cpu_cores.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
     log_setting("Core_EnableCustomCPUTicks", values.enable_custom_cpu_ticks.GetValue());
     log_setting("Core_CustomCPUTicks", values.custom_cpu_ticks.GetValue());
     log_setting("Core_DowncountHack", values.core_downcount_hack.GetValue());
     log_setting("Core_PriorityBoost", values.priority_boost.GetValue());
+    log_setting("Core_FSTimingProfile",
+                GetFSTimingProfileName(values.fs_timing_profile.GetValue()));
     log_setting("Controller_UseArticController", values.use_artic_base_controller.GetValue());
     log_setting("Renderer_UseGLES", values.use_gles.GetValue());
     log_setting("Renderer_GraphicsAPI", GetGraphicsAPIName(values.graphics_api.GetValue()));
@@ -156,10 +172,12 @@ void LogSettings() {
     log_setting("Audio_Emulation", GetAudioEmulationName(values.audio_emulation.GetValue()));
     log_setting("Audio_OutputType", values.output_type.GetValue());
     log_setting("Audio_OutputDevice", values.output_device.GetValue());
+    log_setting("Audio_Deterministic", values.deterministic_audio.GetValue());
     log_setting("Audio_InputType", values.input_type.GetValue());
     log_setting("Audio_InputDevice", values.input_device.GetValue());
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching.GetValue());
     log_setting("Audio_EnableRealtime", values.enable_realtime_audio.GetValue());
+    log_setting("Audio_PolyphaseInterpolation", values.polyphase_interpolation.GetValue());
     using namespace Service::CAM;
     log_setting("Camera_OuterRightName", values.camera_name[OuterRightCamera]);
     log_setting("Camera_OuterRightConfig", values.camera_config[OuterRightCamera]);
@@ -172,6 +190,8 @@ void LogSettings() {
     log_setting("Camera_OuterLeftFlip", values.camera_flip[OuterLeftCamera]);
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd.GetValue());
     log_setting("DataStorage_HideImages", values.hide_images.GetValue());
+    log_setting("DataStorage_RomFSCacheSize", values.romfs_cache_size.GetValue());
+    log_setting("DataStorage_CacheDecompressedCode", values.cache_decompressed_code.GetValue());
     log_setting("DataStorage_UseCustomStorage", values.use_custom_storage.GetValue());
     if (values.use_custom_storage) {
         log_setting("DataStorage_SdmcDir", FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir));
@@ -213,6 +233,7 @@ void RestoreGlobalState(bool is_powered_on) {
     values.audio_emulation.SetGlobal(true);
     values.enable_audio_stretching.SetGlobal(true);
     values.enable_realtime_audio.SetGlobal(true);
+    values.deterministic_audio.SetGlobal(true);
     values.volume.SetGlobal(true);
 
     // Core
@@ -221,6 +242,7 @@ void RestoreGlobalState(bool is_powered_on) {
     values.custom_cpu_ticks.SetGlobal(true);
     values.core_downcount_hack.SetGlobal(true);
     values.priority_boost.SetGlobal(true);
+    values.fs_timing_profile.SetGlobal(true);
     values.is_new_3ds.SetGlobal(true);
     values.lle_applets.SetGlobal(true);
 
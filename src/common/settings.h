@@ -34,6 +34,11 @@ enum class InitTicks : u32 {
     Fixed = 1,
 };
 
+enum class FSTimingProfile : u32 {
+    Accurate = 0, ///< Access times measured on hardware
+    Fast = 1,     ///< Only the fixed cost of each request, file sizes do not affect load times
+};
+
 /** Defines the layout option for desktop and mobile landscape */
 enum class LayoutOption : u32 {
     Default,
@@ -90,6 +95,7 @@ enum class AudioEmulation : u32 {
     HLE = 0,
     LLE = 1,
     LLEMultithreaded = 2,
+    HLEMultithreaded = 3,
 };
 
 enum class OptimizeSpirv : u32 {
@@ -468,6 +474,7 @@ struct Values {
 
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
+    Setting<bool> parallel_cpu_cores{false, "parallel_cpu_cores"};
     SwitchableSetting<u8> frame_skip{0, "frame_skip"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
@@ -478,6 +485,8 @@ struct Values {
     Setting<bool> use_virtual_sd{true, "use_virtual_sd"};
     Setting<bool> use_custom_storage{false, "use_custom_storage"};
     Setting<bool> hide_images{false, "hide_images"};
+    Setting<u32, true> romfs_cache_size{16, 0, 1024, "romfs_cache_size"};
+    Setting<bool> cache_decompressed_code{true, "cache_decompressed_code"};
 
     // System
     SwitchableSetting<s32> region_value{REGION_VALUE_AUTO_SELECT, "region_value"};
@@ -597,6 +606,8 @@ struct Values {
     SwitchableSetting<AudioEmulation> audio_emulation{AudioEmulation::HLE, "audio_emulation"};
     SwitchableSetting<bool> enable_audio_stretching{true, "enable_audio_stretching"};
     SwitchableSetting<bool> enable_realtime_audio{false, "enable_realtime_audio"};
+    SwitchableSetting<bool> deterministic_audio{false, "deterministic_audio"};
+    Setting<bool> polyphase_interpolation{false, "polyphase_interpolation"};
     SwitchableSetting<float, true> volume{1.f, 0.f, 1.f, "volume"};
     Setting<AudioCore::SinkType> output_type{AudioCore::SinkType::Auto, "output_type"};
     Setting<std::string> output_device{"auto", "output_device"};
@@ -624,6 +635,8 @@ struct Values {
     SwitchableSetting<bool> skip_cpu_write{false, "skip_cpu_write"};
     SwitchableSetting<bool> core_downcount_hack{false, "core_downcount_hack"};
     SwitchableSetting<bool> priority_boost{false, "priority_boost"};
+    SwitchableSetting<FSTimingProfile> fs_timing_profile{FSTimingProfile::Accurate,
+                                                         "fs_timing_profile"};
     SwitchableSetting<bool> upscaling_hack{false, "upscaling_hack"};
 
     // Miscellaneous
@@ -7,6 +7,7 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <deque>
 #include <boost/serialization/deque.hpp>
 #include <boost/serialization/split_member.hpp>
@@ -25,15 +26,13 @@ struct ThreadQueueList {
     // Number of priority levels. (Valid levels are [0..NUM_QUEUES).)
     static constexpr Priority NUM_QUEUES = N;
 
-    ThreadQueueList() {
-        first = nullptr;
-    }
+    static_assert(NUM_QUEUES <= 64, "Non-empty priority levels are tracked in a 64-bit mask");
 
     // Only for debugging, returns priority level.
     [[nodiscard]] Priority contains(const T& uid) const {
         for (Priority i = 0; i < NUM_QUEUES; ++i) {
             const Queue& cur = queues[i];
-            if (std::find(cur.data.cbegin(), cur.data.cend(), uid) != cur.data.cend()) {
+            if (std::find(cur.cbegin(), cur.cend(), uid) != cur.cend()) {
                 return i;
             }
         }
@@ -42,167 +41,160 @@ struct ThreadQueueList {
     }
 
     [[nodiscard]] T get_first() const {
-        const Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                return cur->data.front();
-            }
-            cur = cur->next_nonempty;
+        if (nonempty_mask == 0) {
+            return T();
         }
-
-        return T();
+        return queues[std::countr_zero(nonempty_mask)].front();
     }
 
     T pop_first() {
-        Queue* cur = first;
-        while (cur != nullptr) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        if (nonempty_mask == 0) {
+            return T();
         }
-
-        return T();
+        return pop_front(static_cast<Priority>(std::countr_zero(nonempty_mask)));
     }
 
     T pop_first_better(Priority priority) {
-        Queue* cur = first;
-        Queue* stop = &queues[priority];
-        while (cur < stop) {
-            if (!cur->data.empty()) {
-                auto tmp = std::move(cur->data.front());
-                cur->data.pop_front();
-                return tmp;
-            }
-            cur = cur->next_nonempty;
+        // Only consider the levels strictly better (lower) than the given priority.
+        const u64 mask = nonempty_mask & LevelsBelow(priority);
+        if (mask == 0) {
+            return T();
         }
+        return pop_front(static_cast<Priority>(std::countr_zero(mask)));
+    }
 
-        return T();
+    /**
+     * Pops the first element, in priority then insertion order, that satisfies the predicate.
+     * Elements that are skipped keep their position in the queue.
+     */
+    template <typename Predicate>
+    T pop_first_if(Predicate&& pred) {
+        return pop_first_in(nonempty_mask, pred);
+    }
+
+    /// Same as pop_first_if, restricted to the levels strictly better than the given priority.
+    template <typename Predicate>
+    T pop_first_better_if(Priority priority, Predicate&& pred) {
+        return pop_first_in(nonempty_mask & LevelsBelow(priority), pred);
     }
 
     void push_front(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_front(thread_id);
+        queues[priority].push_front(thread_id);
+        nonempty_mask |= LevelBit(priority);
     }
 
     void push_back(Priority priority, const T& thread_id) {
-        Queue* cur = &queues[priority];
-        cur->data.push_back(thread_id);
+        queues[priority].push_back(thread_id);
+        nonempty_mask |= LevelBit(priority);
     }
 
     void move(const T& thread_id, Priority old_priority, Priority new_priority) {
         remove(old_priority, thread_id);
-        prepare(new_priority);
         push_back(new_priority, thread_id);
     }
 
     void remove(Priority priority, const T& thread_id) {
-        Queue* const cur = &queues[priority];
-        const auto iter = std::remove(cur->data.begin(), cur->data.end(), thread_id);
-        cur->data.erase(iter, cur->data.end());
+        Queue& cur = queues[priority];
+        const auto iter = std::remove(cur.begin(), cur.end(), thread_id);
+        cur.erase(iter, cur.end());
+        UpdateLevel(priority);
     }
 
     void rotate(Priority priority) {
-        Queue* cur = &queues[priority];
+        Queue& cur = queues[priority];
 
-        if (cur->data.size() > 1) {
-            cur->data.push_back(std::move(cur->data.front()));
-            cur->data.pop_front();
+        if (cur.size() > 1) {
+            cur.push_back(std::move(cur.front()));
+            cur.pop_front();
         }
     }
 
     void clear() {
         queues.fill(Queue());
-        first = nullptr;
+        nonempty_mask = 0;
     }
 
     [[nodiscard]] bool empty(Priority priority) const {
-        const Queue* cur = &queues[priority];
-        return cur->data.empty();
-    }
-
-    void prepare(Priority priority) {
-        Queue* cur = &queues[priority];
-        if (cur->next_nonempty == UnlinkedTag())
-            link(priority);
+        return (nonempty_mask & LevelBit(priority)) == 0;
     }
 
 private:
-    struct Queue {
-        // Points to the next active priority, skipping over ones that have never been used.
-        Queue* next_nonempty = UnlinkedTag();
-        // Double-ended queue of threads in this priority level
-        std::deque<T> data;
-    };
-
-    /// Special tag used to mark priority levels that have never been used.
-    static Queue* UnlinkedTag() {
-        return reinterpret_cast<Queue*>(1);
-    }
-
-    void link(Priority priority) {
-        Queue* cur = &queues[priority];
-
-        for (int i = priority - 1; i >= 0; --i) {
-            if (queues[i].next_nonempty != UnlinkedTag()) {
-                cur->next_nonempty = queues[i].next_nonempty;
-                queues[i].next_nonempty = cur;
-                return;
-            }
-        }
+    // Double-ended queue of threads in a priority level
+    using Queue = std::deque<T>;
 
-        cur->next_nonempty = first;
-        first = cur;
+    static constexpr u64 LevelBit(Priority priority) {
+        return u64{1} << priority;
     }
 
-    // The first queue that's ever been used.
-    Queue* first;
-    // The priority level queues of thread ids.
-    std::array<Queue, NUM_QUEUES> queues;
+    static constexpr u64 LevelsBelow(Priority priority) {
+        return priority >= 64 ? ~u64{0} : LevelBit(priority) - 1;
+    }
 
-    s64 ToIndex(const Queue* q) const {
-        if (q == nullptr) {
-            return -2;
-        } else if (q == UnlinkedTag()) {
-            return -1;
+    void UpdateLevel(Priority priority) {
+        if (queues[priority].empty()) {
+            nonempty_mask &= ~LevelBit(priority);
         } else {
-            return q - queues.data();
+            nonempty_mask |= LevelBit(priority);
         }
     }
 
-    Queue* ToPointer(s64 idx) {
-        if (idx == -1) {
-            return UnlinkedTag();
-        } else if (idx < 0) {
-            return nullptr;
-        } else {
-            return &queues[idx];
+    T pop_front(Priority priority) {
+        Queue& cur = queues[priority];
+        auto tmp = std::move(cur.front());
+        cur.pop_front();
+        UpdateLevel(priority);
+        return tmp;
+    }
+
+    template <typename Predicate>
+    T pop_first_in(u64 mask, Predicate& pred) {
+        while (mask != 0) {
+            const auto priority = static_cast<Priority>(std::countr_zero(mask));
+            Queue& cur = queues[priority];
+            const auto iter = std::find_if(cur.begin(), cur.end(), pred);
+            if (iter != cur.end()) {
+                auto tmp = std::move(*iter);
+                cur.erase(iter);
+                UpdateLevel(priority);
+                return tmp;
+            }
+            mask &= mask - 1;
         }
+
+        return T();
     }
 
+    // Bit i is set when the priority level i has at least one element.
+    u64 nonempty_mask = 0;
+    // The priority level queues of thread ids.
+    std::array<Queue, NUM_QUEUES> queues;
+
+    // The serialized layout predates the mask and stores, per level, a link to the next level in
+    // use. The links are written as a chain of the non-empty levels and ignored when loading.
+    static constexpr s64 NullLink = -2;
+
     friend class boost::serialization::access;
     template <class Archive>
     void save(Archive& ar, const unsigned int file_version) const {
-        const s64 idx = ToIndex(first);
-        ar << idx;
+        const s64 first = nonempty_mask == 0 ? NullLink : std::countr_zero(nonempty_mask);
+        ar << first;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            const s64 idx1 = ToIndex(queues[i].next_nonempty);
-            ar << idx1;
-            ar << queues[i].data;
+            const u64 next_mask = nonempty_mask & ~LevelsBelow(static_cast<Priority>(i + 1));
+            const s64 next = next_mask == 0 ? NullLink : std::countr_zero(next_mask);
+            ar << next;
+            ar << queues[i];
         }
     }
 
     template <class Archive>
     void load(Archive& ar, const unsigned int file_version) {
-        s64 idx;
-        ar >> idx;
-        first = ToPointer(idx);
+        s64 link;
+        ar >> link;
+        nonempty_mask = 0;
         for (std::size_t i = 0; i < NUM_QUEUES; i++) {
-            ar >> idx;
-            queues[i].next_nonempty = ToPointer(idx);
-            ar >> queues[i].data;
+            ar >> link;
+            ar >> queues[i];
+            UpdateLevel(static_cast<Priority>(i));
         }
     }
 
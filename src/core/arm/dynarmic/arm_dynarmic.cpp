@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <cstring>
+#include <mutex>
 #include <dynarmic/interface/A32/a32.h>
 #include <dynarmic/interface/optimization_flags.h>
 #include "common/assert.h"
@@ -16,6 +17,7 @@
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/gdbstub/gdbstub.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/svc.h"
 #include "core/memory.h"
 
@@ -28,51 +30,51 @@ public:
     ~DynarmicUserCallbacks() = default;
 
     u8 MemoryRead8(VAddr vaddr) override {
-        return memory.Read8(vaddr);
+        return WithCoreBound([&] { return memory.Read8(vaddr); });
     }
 
     u16 MemoryRead16(VAddr vaddr) override {
-        return memory.Read16(vaddr);
+        return WithCoreBound([&] { return memory.Read16(vaddr); });
     }
 
     u32 MemoryRead32(VAddr vaddr) override {
-        return memory.Read32(vaddr);
+        return WithCoreBound([&] { return memory.Read32(vaddr); });
     }
 
     u64 MemoryRead64(VAddr vaddr) override {
-        return memory.Read64(vaddr);
+        return WithCoreBound([&] { return memory.Read64(vaddr); });
     }
 
     void MemoryWrite8(VAddr vaddr, u8 value) override {
-        memory.Write8(vaddr, value);
+        WithCoreBound([&] { memory.Write8(vaddr, value); });
     }
 
     void MemoryWrite16(VAddr vaddr, u16 value) override {
-        memory.Write16(vaddr, value);
+        WithCoreBound([&] { memory.Write16(vaddr, value); });
     }
 
     void MemoryWrite32(VAddr vaddr, u32 value) override {
-        memory.Write32(vaddr, value);
+        WithCoreBound([&] { memory.Write32(vaddr, value); });
     }
 
     void MemoryWrite64(VAddr vaddr, u64 value) override {
-        memory.Write64(vaddr, value);
+        WithCoreBound([&] { memory.Write64(vaddr, value); });
     }
 
     bool MemoryWriteExclusive8(u32 vaddr, u8 value, u8 expected) override {
-        return memory.WriteExclusive8(vaddr, value, expected);
+        return WithCoreBound([&] { return memory.WriteExclusive8(vaddr, value, expected); });
     }
 
     bool MemoryWriteExclusive16(u32 vaddr, u16 value, u16 expected) override {
-        return memory.WriteExclusive16(vaddr, value, expected);
+        return WithCoreBound([&] { return memory.WriteExclusive16(vaddr, value, expected); });
     }
 
     bool MemoryWriteExclusive32(u32 vaddr, u32 value, u32 expected) override {
-        return memory.WriteExclusive32(vaddr, value, expected);
+        return WithCoreBound([&] { return memory.WriteExclusive32(vaddr, value, expected); });
     }
 
     bool MemoryWriteExclusive64(u32 vaddr, u64 value, u64 expected) override {
-        return memory.WriteExclusive64(vaddr, value, expected);
+        return WithCoreBound([&] { return memory.WriteExclusive64(vaddr, value, expected); });
     }
 
     void InterpreterFallback(VAddr pc, std::size_t num_instructions) override {
@@ -82,10 +84,14 @@ public:
     }
 
     void CallSVC(u32 swi) override {
-        svc_context.CallSVC(swi);
+        WithCoreBound([&] { svc_context.CallSVC(swi); });
     }
 
     void ExceptionRaised(VAddr pc, Dynarmic::A32::Exception exception) override {
+        WithCoreBound([&] { HandleException(pc, exception); });
+    }
+
+    void HandleException(VAddr pc, Dynarmic::A32::Exception exception) {
         switch (exception) {
         case Dynarmic::A32::Exception::UndefinedInstruction:
         case Dynarmic::A32::Exception::UnpredictableInstruction:
@@ -130,6 +136,21 @@ public:
         return Core::TicksForInstruction(is_thumb, instruction);
     }
 
+    /**
+     * Runs an operation that may touch shared HLE state. When the cores execute in parallel this
+     * serializes it through the HLE lock and makes this core the running one for its duration.
+     * Guest memory accesses that hit the page table never get here and run fully in parallel.
+     */
+    template <typename Func>
+    auto WithCoreBound(Func&& func) {
+        if (!parent.system.IsRunningCoresInParallel()) {
+            return func();
+        }
+        std::scoped_lock lock{parent.system.Kernel().GetHLELock()};
+        parent.system.BindRunningCore(parent);
+        return func();
+    }
+
     ARM_Dynarmic& parent;
     Kernel::SVCContext svc_context;
     Memory::MemorySystem& memory;
@@ -147,7 +168,10 @@ ARM_Dynarmic::ARM_Dynarmic(Core::System& system_, Memory::MemorySystem& memory_,
 ARM_Dynarmic::~ARM_Dynarmic() = default;
 
 void ARM_Dynarmic::Run() {
-    ASSERT(memory.GetCurrentPageTable() == current_page_table);
+    // The memory system only tracks the page table of the core bound last, which is not
+    // necessarily this one when the cores execute in parallel.
+    ASSERT(system.IsRunningCoresInParallel() ||
+           memory.GetCurrentPageTable() == current_page_table);
     BORKED3DS_PROFILE("Dynarmic", "ARM JIT");
 
     jit->Run();
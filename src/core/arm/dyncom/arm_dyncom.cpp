@@ -33,12 +33,15 @@ void ARM_DynCom::Step() {
 }
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    // The translation cache is shared by all cores, the other cores notice the new epoch and drop
+    // their blocks on their next dispatch.
+    ResetTransCache();
+    state->InvalidateBlockCache();
+    state->block_cache_epoch = trans_cache_epoch;
 }
 
-void ARM_DynCom::InvalidateCacheRange(u32, std::size_t) {
-    ClearInstructionCache();
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, std::size_t length) {
+    state->InvalidateBlockCacheRange(start_address, length);
 }
 
 void ARM_DynCom::SetPageTable(const std::shared_ptr<Memory::PageTable>& page_table) {
@@ -863,7 +863,7 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, std::size_t& bb_start, u3
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->CacheBlock(pc_start, bb_start);
 
     return KEEP_GOING;
 }
@@ -883,7 +883,7 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, std::size_t& bb_start, u
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    cpu->CacheBlock(pc_start, bb_start);
 
     return KEEP_GOING;
 }
@@ -946,6 +946,16 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
 #define INC_PC(l) ptr += sizeof(arm_inst) + l
 #define INC_PC_STUB ptr += sizeof(arm_inst)
 
+// Continues at the block a direct branch links to, or falls back to DISPATCH and asks it to fill in
+// the link once the block has been looked up. Pending interrupts still go through DISPATCH.
+#define GOTO_LINKED_BLOCK(link)                                                                    \
+    if ((link).generation == cpu->block_cache_generation && cpu->NirqSig) {                        \
+        ptr = (link).ptr;                                                                          \
+        goto ENTER_BLOCK;                                                                          \
+    }                                                                                              \
+    pending_link = &(link);                                                                        \
+    goto DISPATCH
+
 #ifdef ANDROID
 #define GDB_BP_CHECK
 #else
@@ -1623,6 +1633,8 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     unsigned int num_instrs = 0;
 
     std::size_t ptr;
+    // Block link of the direct branch that last went through DISPATCH, if any
+    block_link* pending_link = nullptr;
 
     LOAD_NZCVT;
 DISPATCH: {
@@ -1637,18 +1649,37 @@ DISPATCH: {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
+    // Another core reset the shared translation cache, our blocks are gone
+    if (cpu->block_cache_epoch != trans_cache_epoch) {
+        cpu->InvalidateBlockCache();
+        cpu->block_cache_epoch = trans_cache_epoch;
+        pending_link = nullptr;
+    }
+
     // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
-    } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    if (!cpu->FindCachedBlock(cpu->Reg[15], ptr)) {
+        if (trans_cache_buf_top > TRANS_CACHE_SIZE - TRANS_CACHE_BLOCK_RESERVE) {
+            LOG_DEBUG(Core_ARM11, "Translation cache full, flushing");
+            ResetTransCache();
+            cpu->InvalidateBlockCache();
+            cpu->block_cache_epoch = trans_cache_epoch;
+            pending_link = nullptr;
+        }
+        if (cpu->NumInstrsToExecute != 1) {
+            if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        } else {
+            if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
+                goto END;
+        }
     }
 
+    if (pending_link) {
+        *pending_link = {ptr, cpu->block_cache_generation};
+        pending_link = nullptr;
+    }
+}
+ENTER_BLOCK: {
 #ifndef ANDROID
     // Find breakpoint if one exists within the block
     if (GDBStub::IsConnected()) {
@@ -1767,11 +1798,12 @@ BBL_INST: {
         }
         SET_PC;
         INC_PC(sizeof(bbl_inst));
-        goto DISPATCH;
+        GOTO_LINKED_BLOCK(inst_cream->taken);
     }
+    bbl_inst* inst_cream = (bbl_inst*)inst_base->component;
     cpu->Reg[15] += cpu->GetInstructionSize();
     INC_PC(sizeof(bbl_inst));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken);
 }
 BIC_INST: {
     bic_inst* inst_cream = (bic_inst*)inst_base->component;
@@ -4321,18 +4353,18 @@ B_2_THUMB: {
     b_2_thumb* inst_cream = (b_2_thumb*)inst_base->component;
     cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
     INC_PC(sizeof(b_2_thumb));
-    goto DISPATCH;
+    GOTO_LINKED_BLOCK(inst_cream->taken);
 }
 B_COND_THUMB: {
     b_cond_thumb* inst_cream = (b_cond_thumb*)inst_base->component;
 
-    if (CondPassed(cpu, inst_cream->cond))
-        cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
-    else
-        cpu->Reg[15] += 2;
-
     INC_PC(sizeof(b_cond_thumb));
-    goto DISPATCH;
+    if (CondPassed(cpu, inst_cream->cond)) {
+        cpu->Reg[15] = cpu->Reg[15] + 4 + inst_cream->imm;
+        GOTO_LINKED_BLOCK(inst_cream->taken);
+    }
+    cpu->Reg[15] += 2;
+    GOTO_LINKED_BLOCK(inst_cream->not_taken);
 }
 BL_1_THUMB: {
     bl_1_thumb* inst_cream = (bl_1_thumb*)inst_base->component;
@@ -22,6 +22,14 @@ enum class TransExtData {
     SINGLE_STEP = (1 << 8)
 };
 
+// Location of a direct branch target in the translation cache. Lets the interpreter jump straight
+// into the next block instead of looking it up again. A link is only valid while its generation
+// matches ARMul_State::block_cache_generation.
+struct block_link {
+    std::size_t ptr;
+    u64 generation;
+};
+
 struct arm_inst {
     unsigned int idx;
     unsigned int cond;
@@ -86,8 +94,8 @@ struct eor_inst {
 struct bbl_inst {
     unsigned int L;
     int signed_immed_24;
-    unsigned int next_addr;
-    unsigned int jmp_addr;
+    block_link taken;
+    block_link not_taken;
 };
 
 struct bx_inst {
@@ -451,10 +459,13 @@ struct setend_inst {
 
 struct b_2_thumb {
     unsigned int imm;
+    block_link taken;
 };
 struct b_cond_thumb {
     unsigned int imm;
     unsigned int cond;
+    block_link taken;
+    block_link not_taken;
 };
 
 struct bl_1_thumb {
@@ -496,3 +507,13 @@ extern const std::size_t arm_instruction_trans_len;
 #define TRANS_CACHE_SIZE (64 * 1024 * 2000)
 extern char trans_cache_buf[TRANS_CACHE_SIZE];
 extern std::size_t trans_cache_buf_top;
+
+// Bumped every time the translation cache is reset. Translations are shared between cores, so each
+// core compares this against the epoch its block cache was built in to drop stale entries.
+extern u64 trans_cache_epoch;
+
+// Leave at least this much room in the translation cache before translating a new block. A block
+// never crosses a page so this comfortably fits the largest possible one.
+#define TRANS_CACHE_BLOCK_RESERVE (1024 * 1024)
+
+void ResetTransCache();
@@ -14,10 +14,51 @@
 ARMul_State::ARMul_State(Core::System& system_, Memory::MemorySystem& memory_,
                          PrivilegeMode initial_mode)
     : system{system_}, memory{memory_} {
+    fast_block_lookup.fill({INVALID_BLOCK_PC, 0});
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
 
+bool ARMul_State::FindCachedBlock(u32 pc, std::size_t& ptr) {
+    FastBlockLookupEntry& entry = fast_block_lookup[FastBlockLookupIndex(pc)];
+    if (entry.pc == pc) {
+        ptr = entry.ptr;
+        return true;
+    }
+
+    const auto itr = instruction_cache.find(pc);
+    if (itr == instruction_cache.end()) {
+        return false;
+    }
+    entry = {pc, itr->second};
+    ptr = itr->second;
+    return true;
+}
+
+void ARMul_State::CacheBlock(u32 pc, std::size_t ptr) {
+    instruction_cache[pc] = ptr;
+    fast_block_lookup[FastBlockLookupIndex(pc)] = {pc, ptr};
+}
+
+void ARMul_State::InvalidateBlockCache() {
+    instruction_cache.clear();
+    fast_block_lookup.fill({INVALID_BLOCK_PC, 0});
+    ++block_cache_generation;
+}
+
+void ARMul_State::InvalidateBlockCacheRange(u32 start_address, std::size_t length) {
+    // Blocks never cross a page boundary, so a block overlapping the range must start in one of the
+    // pages the range touches.
+    const u64 start = start_address & ~u32{0xFFF};
+    const u64 end = static_cast<u64>(start_address) + length;
+    std::erase_if(instruction_cache, [start, end](const auto& entry) {
+        return entry.first >= start && entry.first < end;
+    });
+    fast_block_lookup.fill({INVALID_BLOCK_PC, 0});
+    // Blocks outside the range may still link into the dropped ones
+    ++block_cache_generation;
+}
+
 void ARMul_State::ChangePrivilegeMode(u32 new_mode) {
     if (Mode == new_mode)
         return;
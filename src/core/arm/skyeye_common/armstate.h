@@ -252,13 +252,41 @@ public:
     unsigned bigendSig;
     unsigned syscallSig;
 
+    // Looks up the translated block starting at pc, returns false if it has not been translated
+    bool FindCachedBlock(u32 pc, std::size_t& ptr);
+    // Records the translation cache offset of the block starting at pc
+    void CacheBlock(u32 pc, std::size_t ptr);
+    // Drops every cached block, e.g. after the translation cache was reset
+    void InvalidateBlockCache();
+    // Drops the cached blocks overlapping the given guest address range
+    void InvalidateBlockCacheRange(u32 start_address, std::size_t length);
+
     // TODO(bunnei): Move this cache to a better place - it should be per codeset (likely per
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
     std::unordered_map<u32, std::size_t> instruction_cache;
 
+    // Incremented whenever cached blocks are dropped, invalidating all block links
+    u64 block_cache_generation = 1;
+    // Value of trans_cache_epoch when instruction_cache was last known to be valid
+    u64 block_cache_epoch = 0;
+
 private:
     void ResetMPCoreCP15Registers();
 
+    // Direct-mapped front for instruction_cache, indexed by the low bits of the PC. Bit 0 of a PC
+    // is never set, so an all-ones PC marks an empty entry.
+    struct FastBlockLookupEntry {
+        u32 pc;
+        std::size_t ptr;
+    };
+    static constexpr std::size_t FAST_BLOCK_LOOKUP_SIZE = 0x1000;
+    static constexpr u32 INVALID_BLOCK_PC = 0xFFFFFFFF;
+    std::array<FastBlockLookupEntry, FAST_BLOCK_LOOKUP_SIZE> fast_block_lookup;
+
+    static constexpr std::size_t FastBlockLookupIndex(u32 pc) {
+        return (pc >> 1) & (FAST_BLOCK_LOOKUP_SIZE - 1);
+    }
+
     // Defines a reservation granule of 2 words, which protects the first 2 words starting at the
     // tag. This is the smallest granule allowed by the v7 spec, and is coincidentally just large
     // enough to support LDR/STREXD.
@@ -24,7 +24,9 @@
 #include "core/cheats/cheats.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/cpu_core_threads.h"
 #include "core/dumping/backend.h"
+#include "core/file_sys/delay_generator.h"
 #include "core/frontend/image_interface.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/global.h"
@@ -56,6 +58,7 @@
 namespace Core {
 
 /*static*/ System System::s_instance;
+/*static*/ thread_local ARM_Interface* System::thread_core = nullptr;
 
 template <>
 Core::System& Global() {
@@ -239,27 +242,10 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
             kernel->GetThreadManager(cpu_core->GetID()).Reschedule();
             max_slice = std::min(max_slice, cpu_core->GetTimer().GetMaxSliceLength());
         }
-        for (auto& cpu_core : cpu_cores) {
-            cpu_core->GetTimer().SetNextSlice(max_slice);
-            auto start_ticks = cpu_core->GetTimer().GetTicks();
-            LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
-                      cpu_core->GetTimer().GetDowncount());
-            running_core = cpu_core.get();
-            kernel->SetRunningCPU(running_core);
-            // If we don't have a currently active thread then don't execute instructions,
-            // instead advance to the next event and try to yield to the next thread
-            if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
-                LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
-                cpu_core->GetTimer().Idle();
-                PrepareReschedule();
-            } else {
-                if (tight_loop) {
-                    cpu_core->Run();
-                } else {
-                    cpu_core->Step();
-                }
-            }
-            max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
+        if (cpu_core_threads && tight_loop && !GDBStub::IsServerEnabled()) {
+            RunCoresInParallel(max_slice);
+        } else {
+            RunCoresSequentially(max_slice, tight_loop);
         }
     }
 
@@ -272,6 +258,73 @@ System::ResultStatus System::RunLoop(bool tight_loop) {
     return status;
 }
 
+void System::RunCoresSequentially(s64 max_slice, bool tight_loop) {
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+        auto start_ticks = cpu_core->GetTimer().GetTicks();
+        LOG_TRACE(Core_ARM11, "Core {} running for {} ticks", cpu_core->GetID(),
+                  cpu_core->GetTimer().GetDowncount());
+        running_core = cpu_core.get();
+        kernel->SetRunningCPU(running_core);
+        // If we don't have a currently active thread then don't execute instructions,
+        // instead advance to the next event and try to yield to the next thread
+        if (kernel->GetCurrentThreadManager().GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+        } else {
+            if (tight_loop) {
+                cpu_core->Run();
+            } else {
+                cpu_core->Step();
+            }
+        }
+        max_slice = cpu_core->GetTimer().GetTicks() - start_ticks;
+    }
+}
+
+void System::RunCoresInParallel(s64 max_slice) {
+    // Idle cores only advance their timer, deal with them here so that the host threads only have
+    // to execute guest code.
+    for (auto& cpu_core : cpu_cores) {
+        cpu_core->GetTimer().SetNextSlice(max_slice);
+        LOG_TRACE(Core_ARM11, "Core {} running for {} ticks (parallel)", cpu_core->GetID(),
+                  cpu_core->GetTimer().GetDowncount());
+        if (kernel->GetThreadManager(cpu_core->GetID()).GetCurrentThread() == nullptr) {
+            LOG_TRACE(Core_ARM11, "Core {} idling", cpu_core->GetID());
+            running_core = cpu_core.get();
+            kernel->SetRunningCPU(running_core);
+            cpu_core->GetTimer().Idle();
+            PrepareReschedule();
+        }
+    }
+
+    // Unlike the sequential path, a core that stops early can't shorten the slices of the cores
+    // that run after it. Any core that ends up behind is brought back in sync by the delayed path
+    // at the start of the next RunLoop.
+    running_cores_in_parallel = true;
+    cpu_core_threads->RunSlice([this](std::size_t core_id) {
+        auto& cpu_core = cpu_cores[core_id];
+        thread_core = cpu_core.get();
+        timing->BindThreadTimer(core_id);
+        if (cpu_core->GetTimer().GetDowncount() > 0) {
+            cpu_core->Run();
+        }
+        timing->UnbindThreadTimer();
+        thread_core = nullptr;
+    });
+    running_cores_in_parallel = false;
+
+    // The cores leave the kernel bound to whichever of them entered it last, restore the usual
+    // state expected by the sequential code.
+    running_core = cpu_cores[0].get();
+    kernel->SetRunningCPU(running_core);
+}
+
+void System::BindRunningCore(ARM_Interface& core) {
+    kernel->BindRunningCPU(&core);
+}
+
 bool System::SendSignal(System::Signal signal, u32 param) {
     std::scoped_lock lock{signal_mutex};
     if (current_signal != signal && current_signal != Signal::None) {
@@ -558,13 +611,23 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
 }
 
 void System::PrepareReschedule() {
-    running_core->PrepareReschedule();
+    GetRunningCore().PrepareReschedule();
     reschedule_pending = true;
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
-                                  : PerfStats::Results{};
+    if (!perf_stats || !timing) {
+        return {};
+    }
+    PerfStats::Results results = perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
+    results.romfs_cache_hits = romfs_cache_hits.exchange(0, std::memory_order_relaxed);
+    results.romfs_cache_misses = romfs_cache_misses.exchange(0, std::memory_order_relaxed);
+    if (dsp_core) {
+        const AudioCore::AudioOutputStats audio = dsp_core->GetOutputStats();
+        results.audio_underruns = audio.underruns;
+        results.audio_dropped_frames = audio.dropped_frames;
+    }
+    return results;
 }
 
 PerfStats::Results System::GetLastPerfStats() {
@@ -628,15 +691,45 @@ System::ResultStatus System::Init(Frontend::EmuWindow& emu_window,
     kernel->SetCPUs(cpu_cores);
     kernel->SetRunningCPU(cpu_cores[0].get());
 
+    if (Settings::values.parallel_cpu_cores && num_cores > 1) {
+#if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
+        if (!Settings::values.use_cpu_jit) {
+            LOG_WARNING(Core, "Parallel CPU cores requested, but only supported by the JIT");
+        } else if (Settings::values.graphics_api.GetValue() != Settings::GraphicsAPI::Software) {
+            // The SVCs, MMIO and slow memory accesses of a core run on that core's host thread,
+            // which has no graphics context for the GPU, GSP and rasterizer work they trigger.
+            LOG_WARNING(Core, "Parallel CPU cores requested, but only supported by the software "
+                              "renderer");
+        } else if (movie.GetPlayMode() == Movie::PlayMode::Recording ||
+                   movie.GetPlayMode() == Movie::PlayMode::Playing) {
+            // How far the cores get relative to each other depends on the host, so a movie would
+            // not play back the same.
+            LOG_WARNING(Core, "Parallel CPU cores requested, but not deterministic enough for "
+                              "movies");
+        } else {
+            cpu_core_threads = std::make_unique<CpuCoreThreads>(num_cores);
+        }
+#else
+        LOG_WARNING(Core, "Parallel CPU cores requested, but Dynarmic not available");
+#endif
+    }
+
     if (Settings::values.core_downcount_hack) {
         SetDowncountHack(true, num_cores);
     }
 
     const auto audio_emulation = Settings::values.audio_emulation.GetValue();
-    if (audio_emulation == Settings::AudioEmulation::HLE) {
-        dsp_core = std::make_unique<AudioCore::DspHle>(*this);
+    // Deterministic audio keeps the DSP on the emulation thread, so that the rendered output
+    // does not depend on how the host schedules the DSP thread.
+    const bool allow_dsp_thread = !Settings::values.deterministic_audio.GetValue();
+    if (audio_emulation == Settings::AudioEmulation::HLE ||
+        audio_emulation == Settings::AudioEmulation::HLEMultithreaded) {
+        const bool multithread =
+            allow_dsp_thread && audio_emulation == Settings::AudioEmulation::HLEMultithreaded;
+        dsp_core = std::make_unique<AudioCore::DspHle>(*this, multithread);
     } else {
-        const bool multithread = audio_emulation == Settings::AudioEmulation::LLEMultithreaded;
+        const bool multithread =
+            allow_dsp_thread && audio_emulation == Settings::AudioEmulation::LLEMultithreaded;
         dsp_core = std::make_unique<AudioCore::DspLle>(*this, multithread);
     }
 
@@ -788,7 +881,9 @@ void System::Shutdown(bool is_deserializing) {
     is_powered_on = false;
 
     gpu.reset();
+    FileSys::DeviceQueue::Reset();
     if (!is_deserializing) {
+        FileSys::FSTimingStats::Get().LogAndReset(title_id);
         lle_modules.clear();
         GDBStub::Shutdown();
         perf_stats.reset();
@@ -802,6 +897,7 @@ void System::Shutdown(bool is_deserializing) {
     service_manager.reset();
     dsp_core.reset();
     kernel.reset();
+    cpu_core_threads.reset();
     cpu_cores.clear();
     exclusive_monitor.reset();
     timing.reset();
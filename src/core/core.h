@@ -74,6 +74,7 @@ class AppLoader;
 namespace Core {
 
 class ARM_Interface;
+class CpuCoreThreads;
 class ExclusiveMonitor;
 class Timing;
 
@@ -178,6 +179,13 @@ public:
         }
     }
 
+    /// Called from file I/O threads, so the counts are kept here rather than in perf_stats, which
+    /// may be destroyed while a read completes.
+    void ReportRomFSCacheAccess(u32 hits, u32 misses) {
+        romfs_cache_hits.fetch_add(hits, std::memory_order_relaxed);
+        romfs_cache_misses.fetch_add(misses, std::memory_order_relaxed);
+    }
+
     void ReportPerfArticEvent(PerfStats::PerfArticEventBits event, bool set) {
         if (perf_stats) {
             perf_stats->ReportPerfArticEvent(event, set);
@@ -194,9 +202,26 @@ public:
      */
 
     [[nodiscard]] ARM_Interface& GetRunningCore() {
-        return *running_core;
+        return thread_core ? *thread_core : *running_core;
     };
 
+    /**
+     * Returns true while the emulated CPU cores are executing a slice in parallel, each on its own
+     * host thread.
+     */
+    [[nodiscard]] bool IsRunningCoresInParallel() const {
+        return running_cores_in_parallel;
+    }
+
+    /**
+     * Makes the given core the running core of the kernel. While the cores execute in parallel, a
+     * core must hold the HLE lock and bind itself before touching any shared HLE state (SVCs,
+     * MMIO, slow memory paths). The running core and timer seen by each host thread are its own
+     * already, so only the kernel state is switched.
+     * @param core The core that is about to enter the HLE.
+     */
+    void BindRunningCore(ARM_Interface& core);
+
     /**
      * Gets a reference to the emulated CPU.
      * @param core_id The id of the core requested.
@@ -395,6 +420,16 @@ private:
     /// Reschedule the core emulation
     void Reschedule();
 
+    /// Runs one slice of every core on the emulation thread, one core after the other
+    void RunCoresSequentially(s64 max_slice, bool tight_loop);
+
+    /**
+     * Runs one slice of every core at the same time, each core on its own host thread. This is not
+     * deterministic: the order in which cores enter the HLE, and the ticks a core sees for the
+     * others (see Timing::GetTimerTicks), depend on how the host schedules the threads.
+     */
+    void RunCoresInParallel(s64 max_slice);
+
     /// AppLoader used to load the current executing application
     std::unique_ptr<Loader::AppLoader> app_loader;
 
@@ -405,6 +440,13 @@ private:
     std::vector<std::shared_ptr<ARM_Interface>> cpu_cores;
     ARM_Interface* running_core = nullptr;
 
+    /// The core executing on this host thread while the cores run in parallel
+    static thread_local ARM_Interface* thread_core;
+
+    /// Host threads for executing the CPU cores in parallel, when enabled
+    std::unique_ptr<CpuCoreThreads> cpu_core_threads;
+    bool running_cores_in_parallel = false;
+
     /// DSP core
     std::unique_ptr<AudioCore::DspInterface> dsp_core;
 
@@ -453,6 +495,10 @@ private:
 
     std::atomic_bool is_powered_on{};
 
+    /// RomFS page cache hits and misses since the performance stats were last reset.
+    std::atomic<u32> romfs_cache_hits{};
+    std::atomic<u32> romfs_cache_misses{};
+
     SaveStateStatus save_state_status = SaveStateStatus::NONE;
     SaveStateStatus save_state_request_status = SaveStateStatus::NONE;
     u32 save_state_slot = 0;
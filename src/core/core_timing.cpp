@@ -13,6 +13,8 @@
 
 namespace Core {
 
+thread_local Timing::Timer* Timing::bound_timer = nullptr;
+
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
 bool Timing::Event::operator>(const Timing::Event& right) const {
     return std::tie(time, fifo_order) > std::tie(right.time, right.fifo_order);
@@ -62,21 +64,25 @@ TimingEventType* Timing::RegisterEvent(const std::string& name, TimedCallback ca
     return event_type;
 }
 
-void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                           std::uintptr_t user_data, std::size_t core_id, bool thread_safe_mode) {
+Timing::EventHandle Timing::ScheduleEvent(s64 cycles_into_future,
+                                          const TimingEventType* event_type,
+                                          std::uintptr_t user_data, std::size_t core_id,
+                                          bool thread_safe_mode) {
     if (event_queue_locked) {
-        return;
+        return 0;
     }
 
     ASSERT(event_type != nullptr);
+    Timer* const current = CurrentTimer();
     Timing::Timer* timer = nullptr;
     if (core_id == std::numeric_limits<std::size_t>::max()) {
-        timer = current_timer;
+        timer = current;
     } else {
         ASSERT(core_id < timers.size());
         timer = timers.at(core_id).get();
     }
 
+    const EventHandle handle = next_event_handle++;
     if (thread_safe_mode) {
         // Events scheduled in thread safe mode come after blocking operations with
         // unpredictable timings in the host machine, so there is no need to be cycle accurate.
@@ -84,74 +90,94 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
         // of MAX_SLICE_LENGTH * 2 cycles into the future.
         cycles_into_future = std::max(static_cast<s64>(MAX_SLICE_LENGTH * 2), cycles_into_future);
 
-        timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                   user_data, event_type});
+        timer->ts_queue.Push(PendingChange{
+            PendingChange::Kind::Schedule,
+            Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0, user_data,
+                  event_type, handle}});
     } else {
-        s64 timeout = timer->GetTicks() + cycles_into_future;
-        if (current_timer == timer) {
+        s64 timeout = GetTimerTicks(*timer) + cycles_into_future;
+        if (current == timer) {
             // If this event needs to be scheduled before the next advance(), force one early
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->PushEvent(Event{timeout, 0, user_data, event_type, handle});
         } else {
-            timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
-                                       user_data, event_type});
+            timer->ts_queue.Push(PendingChange{PendingChange::Kind::Schedule,
+                                               Event{timeout, 0, user_data, event_type, handle}});
         }
     }
+    return handle;
 }
 
 void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t user_data) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+    ApplyToTimers({PendingChange::Kind::Unschedule, Event{0, 0, user_data, event_type}});
+}
+
+void Timing::UnscheduleEvent(EventHandle handle) {
+    if (event_queue_locked || handle == 0) {
+        return;
     }
-    // TODO:remove events from ts_queue
+    ApplyToTimers({PendingChange::Kind::Cancel, Event{0, 0, 0, nullptr, handle}});
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
     if (event_queue_locked) {
         return;
     }
-    for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+    ApplyToTimers({PendingChange::Kind::Remove, Event{0, 0, 0, event_type}});
+}
+
+void Timing::ApplyToTimers(const PendingChange& change) {
+    for (auto& timer : timers) {
+        if (bound_timer && bound_timer != timer.get()) {
+            // Another host thread is running the core that owns this timer. It applies the change
+            // itself, before any of its events can fire in Advance().
+            timer->ts_queue.Push(change);
+        } else {
+            // Earlier changes pushed from other threads go first, to keep them in order.
+            timer->MoveEvents();
+            timer->ApplyChange(change);
         }
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
     current_timer = timers[core_id].get();
 }
 
+void Timing::BindThreadTimer(std::size_t core_id) {
+    bound_timer = timers.at(core_id).get();
+}
+
+void Timing::UnbindThreadTimer() {
+    bound_timer = nullptr;
+}
+
 s64 Timing::GetTicks() const {
-    return current_timer->GetTicks();
+    return CurrentTimer()->GetTicks();
+}
+
+u64 Timing::GetTimerTicks(const Timer& timer) const {
+    const Timer* current = CurrentTimer();
+    if (!bound_timer || &timer == current) {
+        return timer.GetTicks();
+    }
+    // The other core is running on its own host thread and only its executed_ticks is stable
+    // during the slice. Assume it has come as far into the slice as the calling core.
+    return static_cast<u64>(timer.executed_ticks) + current->GetTicks() -
+           static_cast<u64>(current->executed_ticks);
 }
 
 s64 Timing::GetGlobalTicks() const {
-    const auto& timer =
-        std::max_element(timers.cbegin(), timers.cend(), [](const auto& a, const auto& b) {
-            return a->GetTicks() < b->GetTicks();
-        });
-    return (*timer)->GetTicks();
+    u64 ticks = 0;
+    for (const auto& timer : timers) {
+        ticks = std::max(ticks, GetTimerTicks(*timer));
+    }
+    return static_cast<s64>(ticks);
 }
 
 std::chrono::microseconds Timing::GetGlobalTimeUs() const {
@@ -196,11 +222,118 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 }
 
 void Timing::Timer::MoveEvents() {
-    for (Event ev; ts_queue.Pop(ev);) {
-        ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+    for (PendingChange change; ts_queue.Pop(change);) {
+        ApplyChange(std::move(change));
+    }
+}
+
+void Timing::Timer::ApplyChange(PendingChange change) {
+    const Event& target = change.event;
+    switch (change.kind) {
+    case PendingChange::Kind::Schedule:
+        PushEvent(std::move(change.event));
+        break;
+    case PendingChange::Kind::Unschedule:
+        RemoveEventsIf([&](const Event& e) {
+            return e.type == target.type && e.user_data == target.user_data;
+        });
+        break;
+    case PendingChange::Kind::Remove:
+        RemoveEventsIf([&](const Event& e) { return e.type == target.type; });
+        break;
+    case PendingChange::Kind::Cancel:
+        CancelEvent(target.handle);
+        break;
+    }
+}
+
+void Timing::Timer::PushEvent(Event evt) {
+    evt.fifo_order = event_fifo_id++;
+    event_queue.emplace_back();
+    PlaceEvent(event_queue.size() - 1, std::move(evt));
+    SiftUp(event_queue.size() - 1);
+}
+
+Timing::Event Timing::Timer::RemoveEventAt(std::size_t index) {
+    ASSERT(index < event_queue.size());
+    Event evt = std::move(event_queue[index]);
+    if (evt.handle != 0) {
+        handle_indices.erase(evt.handle);
+    }
+    const std::size_t last = event_queue.size() - 1;
+    if (index != last) {
+        PlaceEvent(index, std::move(event_queue[last]));
+    }
+    event_queue.pop_back();
+    if (index < event_queue.size()) {
+        // The moved element may belong either above or below its new position.
+        if (index > 0 && event_queue[index] < event_queue[(index - 1) / 2]) {
+            SiftUp(index);
+        } else {
+            SiftDown(index);
+        }
+    }
+    return evt;
+}
+
+void Timing::Timer::CancelEvent(EventHandle handle) {
+    const auto it = handle_indices.find(handle);
+    if (it != handle_indices.end()) {
+        RemoveEventAt(it->second);
+    }
+}
+
+template <typename Predicate>
+void Timing::Timer::RemoveEventsIf(Predicate&& pred) {
+    // Walk backwards so that elements moved into a freed slot from the tail have already been
+    // visited, or are sifted up into a slot before the cursor that we will still visit.
+    for (std::size_t i = event_queue.size(); i-- > 0;) {
+        if (i < event_queue.size() && pred(event_queue[i])) {
+            RemoveEventAt(i);
+            // A sift-up may have placed an unvisited element at or above i, re-check this slot.
+            ++i;
+        }
+    }
+}
+
+void Timing::Timer::PlaceEvent(std::size_t index, Event evt) {
+    if (evt.handle != 0) {
+        handle_indices.insert_or_assign(evt.handle, index);
+    }
+    event_queue[index] = std::move(evt);
+}
+
+void Timing::Timer::SiftUp(std::size_t index) {
+    Event evt = std::move(event_queue[index]);
+    while (index > 0) {
+        const std::size_t parent = (index - 1) / 2;
+        if (!(evt < event_queue[parent])) {
+            break;
+        }
+        PlaceEvent(index, std::move(event_queue[parent]));
+        index = parent;
+    }
+    PlaceEvent(index, std::move(evt));
+}
+
+void Timing::Timer::SiftDown(std::size_t index) {
+    const std::size_t size = event_queue.size();
+    Event evt = std::move(event_queue[index]);
+    while (true) {
+        std::size_t child = index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && event_queue[child + 1] < event_queue[child]) {
+            ++child;
+        }
+        if (!(event_queue[child] < evt)) {
+            break;
+        }
+        PlaceEvent(index, std::move(event_queue[child]));
+        index = child;
     }
+    PlaceEvent(index, std::move(evt));
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
@@ -225,9 +358,7 @@ void Timing::Timer::Advance() {
     is_timer_sane = true;
 
     while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+        Event evt = RemoveEventAt(0);
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
         } else {
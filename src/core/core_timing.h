@@ -18,6 +18,7 @@
  *   ScheduleEvent(periodInCycles - cyclesLate, callback, "whatever")
  */
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <limits>
@@ -143,11 +144,16 @@ struct TimingEventType {
 class Timing {
 
 public:
+    /// Identifies a single scheduled event, see UnscheduleEvent(EventHandle). Handles are not kept
+    /// in savestates, events restored from one can only be cancelled by type.
+    using EventHandle = u64;
+
     struct Event {
         s64 time;
         u64 fifo_order;
         std::uintptr_t user_data;
         const TimingEventType* type;
+        EventHandle handle = 0;
 
         bool operator>(const Event& right) const;
         bool operator<(const Event& right) const;
@@ -184,6 +190,20 @@ public:
     // scheduled and repated.
     static constexpr int MAX_SLICE_LENGTH = BASE_CLOCK_RATE_ARM11 / 234;
 
+    /// A change to a timer's event queue made by a thread that doesn't own the timer. Changes are
+    /// applied in the order they were pushed, the next time the owner drains its ts_queue.
+    struct PendingChange {
+        enum class Kind : u8 {
+            Schedule,
+            Unschedule, ///< Matches event.type and event.user_data
+            Remove,     ///< Matches event.type
+            Cancel,     ///< Matches event.handle
+        };
+
+        Kind kind;
+        Event event;
+    };
+
     class Timer {
     public:
         Timer(s64 base_ticks = 0);
@@ -214,15 +234,42 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
+
+        /// Inserts an event into the queue, assigning it the next fifo order. O(log n)
+        void PushEvent(Event evt);
+
+        /// Removes and returns the event at the given queue position, restoring the heap
+        /// invariant. O(log n)
+        Event RemoveEventAt(std::size_t index);
+
+        /// Removes the event with the given handle, if it is still queued. O(log n)
+        void CancelEvent(EventHandle handle);
+
+        /// Removes every queued event matching the predicate. The queue is scanned once and each
+        /// match is sifted out in place, so the heap is never rebuilt as a whole.
+        template <typename Predicate>
+        void RemoveEventsIf(Predicate&& pred);
+
+        void ApplyChange(PendingChange change);
+
+        /// Stores the event at the given queue position and records where its handle is.
+        void PlaceEvent(std::size_t index, Event evt);
+
+        void SiftUp(std::size_t index);
+        void SiftDown(std::size_t index);
+
+        // The queue is a binary min-heap laid out like std::make_heap/push_heap/pop_heap with
+        // std::greater<>. We don't use std::priority_queue because we need to be able to
+        // serialize, unserialize and erase arbitrary events (RemoveEvent()) regardless of the
+        // queue order. These aren't accommodated by the standard adaptor class.
         std::vector<Event> event_queue;
+        // Position in event_queue of each queued event with a handle, kept up to date as events
+        // move through the heap.
+        std::unordered_map<EventHandle, std::size_t> handle_indices;
         u64 event_fifo_id = 0;
-        // the queue for storing the events from other threads threadsafe until they will be added
-        // to the event_queue by the emu thread
-        Common::MPSCQueue<Event> ts_queue;
+        // Changes made from other threads, applied by the thread that owns the timer: the emu
+        // thread between slices, or the core's own host thread while the cores run in parallel.
+        Common::MPSCQueue<PendingChange> ts_queue;
         // Are we in a function that has been called from Advance()
         // If events are sheduled from a function that gets called from Advance(),
         // don't change slice_length and downcount.
@@ -246,6 +293,9 @@ public:
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
             ar & event_queue;
+            if (Archive::is_loading::value) {
+                handle_indices.clear();
+            }
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
@@ -266,18 +316,32 @@ public:
 
     // Make sure to use thread_safe_mode = true if called from a different thread than the
     // emulator thread, such as coroutines.
-    void ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
-                       std::uintptr_t user_data = 0,
-                       std::size_t core_id = std::numeric_limits<std::size_t>::max(),
-                       bool thread_safe_mode = false);
+    // Returns a handle that cancels this event alone, or 0 if the event was not scheduled.
+    EventHandle ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_type,
+                              std::uintptr_t user_data = 0,
+                              std::size_t core_id = std::numeric_limits<std::size_t>::max(),
+                              bool thread_safe_mode = false);
 
+    /// Removes every queued event of the given type and user data. This scans the queues.
     void UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t user_data);
 
+    /// Removes the event ScheduleEvent returned the handle for, if it has not fired yet. O(log n)
+    void UnscheduleEvent(EventHandle handle);
+
     /// We only permit one event of each type in the queue at a time.
     void RemoveEvent(const TimingEventType* event_type);
 
     void SetCurrentTimer(std::size_t core_id);
 
+    /**
+     * Makes the timer of the given core the current one for the calling host thread only, taking
+     * precedence over SetCurrentTimer. Used while the cores run in parallel, one per host thread.
+     */
+    void BindThreadTimer(std::size_t core_id);
+
+    /// Undoes BindThreadTimer for the calling host thread.
+    void UnbindThreadTimer();
+
     s64 GetTicks() const;
 
     s64 GetGlobalTicks() const;
@@ -304,9 +368,28 @@ private:
     // elements remain stable regardless of rehashes/resizing.
     std::unordered_map<std::string, TimingEventType> event_types = {};
 
+    Timer* CurrentTimer() const {
+        return bound_timer ? bound_timer : current_timer;
+    }
+
+    /**
+     * Returns the ticks of the given timer as seen from the calling thread. While the cores run in
+     * parallel, the ticks of another core are an estimate, so the result is not deterministic.
+     */
+    u64 GetTimerTicks(const Timer& timer) const;
+
+    /// Applies the change to every timer, queueing it for timers owned by another running core.
+    void ApplyToTimers(const PendingChange& change);
+
     std::vector<std::shared_ptr<Timer>> timers;
     Timer* current_timer = nullptr;
 
+    // Events are scheduled from several host threads, so handles are taken atomically.
+    std::atomic<EventHandle> next_event_handle = 1;
+
+    /// The timer of the core running on this host thread while the cores run in parallel
+    static thread_local Timer* bound_timer;
+
     // When true, the event queue can't be modified. Used while deserializing to workaround
     // destructor side effects.
     bool event_queue_locked = false;
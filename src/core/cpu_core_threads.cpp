@@ -0,0 +1,49 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <fmt/format.h>
+#include "core/cpu_core_threads.h"
+
+namespace Core {
+
+CpuCoreThreads::CpuCoreThreads(std::size_t num_cores)
+    : slice_start{num_cores}, slice_end{num_cores} {
+    workers.reserve(num_cores - 1);
+    for (std::size_t core_id = 1; core_id < num_cores; ++core_id) {
+        workers.emplace_back(
+            [this, core_id](std::stop_token stop_token) { WorkerLoop(stop_token, core_id); });
+    }
+}
+
+CpuCoreThreads::~CpuCoreThreads() {
+    for (auto& worker : workers) {
+        worker.request_stop();
+    }
+}
+
+void CpuCoreThreads::RunSlice(const std::function<void(std::size_t)>& func) {
+    // The barriers order the write of slice_func before the workers read it, and every write the
+    // workers do to their cores before we return.
+    slice_func = &func;
+    slice_start.Sync();
+    func(0);
+    slice_end.Sync();
+    slice_func = nullptr;
+}
+
+void CpuCoreThreads::WorkerLoop(std::stop_token stop_token, std::size_t core_id) {
+    const std::string name = fmt::format("CPUCore_{}", core_id);
+    Common::SetCurrentThreadName(name.c_str());
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::High);
+
+    while (slice_start.Sync(stop_token)) {
+        (*slice_func)(core_id);
+        if (!slice_end.Sync(stop_token)) {
+            return;
+        }
+    }
+}
+
+} // namespace Core
@@ -0,0 +1,41 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+
+namespace Core {
+
+/**
+ * Host threads used to execute the emulated ARM11 cores in parallel. Each core beyond the first
+ * gets its own host thread, the first core runs on the thread calling RunSlice (the emulation
+ * thread). The cores only meet at slice boundaries, anything a core does in between that touches
+ * shared HLE state must be serialized by the caller through the kernel HLE lock.
+ */
+class CpuCoreThreads {
+public:
+    explicit CpuCoreThreads(std::size_t num_cores);
+    ~CpuCoreThreads();
+
+    CpuCoreThreads(const CpuCoreThreads&) = delete;
+    CpuCoreThreads& operator=(const CpuCoreThreads&) = delete;
+
+    /// Runs func(core_id) for every core concurrently and returns once all of them are done.
+    void RunSlice(const std::function<void(std::size_t)>& func);
+
+private:
+    void WorkerLoop(std::stop_token stop_token, std::size_t core_id);
+
+    Common::Barrier slice_start;
+    Common::Barrier slice_end;
+    const std::function<void(std::size_t)>* slice_func = nullptr;
+    std::vector<std::jthread> workers;
+};
+
+} // namespace Core
@@ -213,6 +213,11 @@ public:
         return delay_generator->GetOpenDelayNs();
     }
 
+    /// Device the delays of this archive are modelled on.
+    StorageDevice GetStorageDevice() const {
+        return delay_generator ? delay_generator->GetDevice() : StorageDevice::GameCard;
+    }
+
     virtual Result SetSaveDataSecureValue(u32 secure_value_slot, u64 secure_value, bool flush) {
 
         // TODO: Generate and Save the Secure Value
@@ -66,26 +66,16 @@ private:
     friend class boost::serialization::access;
 };
 
-class ExtSaveDataDelayGenerator : public DelayGenerator {
+class ExtSaveDataDelayGenerator : public DeviceDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // This is the delay measured for a savedata read,
-        // not for extsaveData
-        // For now we will take that
-        static constexpr u64 slope(183);
-        static constexpr u64 offset(524879);
-        static constexpr u64 minimum(631826);
-        u64 ipc_delay_nanoseconds =
-            std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return ipc_delay_nanoseconds;
-    }
+    ExtSaveDataDelayGenerator() : DeviceDelayGenerator(StorageDevice::SDCard) {}
 
     u64 GetOpenDelayNs() override {
         // This is the delay measured on N3DS with
         // https://gist.github.com/FearlessTobi/929b68489f4abb2c6cf81d56970a20b4
         // from the results the average of each length was taken.
         static constexpr u64 IPCDelayNanoseconds(3085068);
-        return IPCDelayNanoseconds;
+        return ProfileOpenDelayNs(IPCDelayNanoseconds);
     }
 
     SERIALIZE_DELAY_GENERATOR
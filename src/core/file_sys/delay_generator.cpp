@@ -5,29 +5,128 @@
 
 #include <algorithm>
 #include "common/archives.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/file_sys/delay_generator.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::DefaultDelayGenerator)
 
 namespace FileSys {
 
+namespace {
+
+// Reads were measured on O3DS and O2DS with
+// https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
+// and opens with
+// https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e (game card) and
+// https://gist.github.com/FearlessTobi/c37e143c314789251f98f2c45cd706d2 (SD card).
+// From the results the average of each length was taken.
+constexpr DeviceTiming GameCardTiming{
+    .read_overhead_ns = 582778,
+    .read_ns_per_byte = 94,
+    .minimum_read_ns = 663124,
+    .open_ns = 9438006,
+};
+
+constexpr DeviceTiming SDCardTiming{
+    .read_overhead_ns = 524879,
+    .read_ns_per_byte = 183,
+    .minimum_read_ns = 631826,
+    .open_ns = 269082,
+};
+
+/// Emulated tick at which each device finishes the reads queued on it.
+std::array<std::atomic<u64>, 2> device_busy_until{};
+
+bool IsFastProfile() {
+    return Settings::values.fs_timing_profile.GetValue() == Settings::FSTimingProfile::Fast;
+}
+
+} // Anonymous namespace
+
+const DeviceTiming& GetDeviceTiming(StorageDevice device) {
+    return device == StorageDevice::SDCard ? SDCardTiming : GameCardTiming;
+}
+
 DelayGenerator::~DelayGenerator() = default;
 
-u64 DefaultDelayGenerator::GetReadDelayNs(std::size_t length) {
-    // This is the delay measured for a romfs read.
-    // For now we will take that as a default
-    static constexpr u64 slope(94);
-    static constexpr u64 offset(582778);
-    static constexpr u64 minimum(663124);
-    u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-    return IPCDelayNanoseconds;
-}
-
-u64 DefaultDelayGenerator::GetOpenDelayNs() {
-    // This is the delay measured for a romfs open.
-    // For now we will take that as a default
-    static constexpr u64 IPCDelayNanoseconds(9438006);
-    return IPCDelayNanoseconds;
+u64 DeviceDelayGenerator::GetReadDelayNs(std::size_t length) {
+    const DeviceTiming& timing = GetDeviceTiming(device);
+    if (IsFastProfile()) {
+        return timing.read_overhead_ns;
+    }
+    return std::max<u64>(static_cast<u64>(length) * timing.read_ns_per_byte +
+                             timing.read_overhead_ns,
+                         timing.minimum_read_ns);
+}
+
+u64 DeviceDelayGenerator::GetOpenDelayNs() {
+    return ProfileOpenDelayNs(GetDeviceTiming(device).open_ns);
+}
+
+u64 DeviceDelayGenerator::ProfileOpenDelayNs(u64 measured_ns) const {
+    // An open is a single request, on the fast profile it costs as much as the smallest read.
+    return IsFastProfile() ? GetDeviceTiming(device).read_overhead_ns : measured_ns;
+}
+
+u64 DeviceQueue::Reserve(StorageDevice device, u64 service_ticks, u64 now_ticks) {
+    if (IsFastProfile()) {
+        return 0;
+    }
+    auto& busy_until = device_busy_until[static_cast<std::size_t>(device)];
+    u64 previous = busy_until.load(std::memory_order_relaxed);
+    u64 start;
+    do {
+        start = std::max(now_ticks, previous);
+    } while (!busy_until.compare_exchange_weak(previous, start + service_ticks,
+                                               std::memory_order_relaxed));
+    return start - now_ticks;
+}
+
+void DeviceQueue::Reset() {
+    for (auto& busy_until : device_busy_until) {
+        busy_until.store(0, std::memory_order_relaxed);
+    }
+}
+
+void FSTimingStats::RecordRead(StorageDevice device, std::size_t length, u64 modelled_ns,
+                               u64 host_ns) {
+    DeviceStats& stats = devices[static_cast<std::size_t>(device)];
+    stats.reads.fetch_add(1, std::memory_order_relaxed);
+    stats.bytes.fetch_add(length, std::memory_order_relaxed);
+    stats.guest_ns.fetch_add(std::max(modelled_ns, host_ns), std::memory_order_relaxed);
+    stats.host_ns.fetch_add(host_ns, std::memory_order_relaxed);
+}
+
+void FSTimingStats::RecordOpen(StorageDevice device, u64 modelled_ns) {
+    DeviceStats& stats = devices[static_cast<std::size_t>(device)];
+    stats.opens.fetch_add(1, std::memory_order_relaxed);
+    stats.guest_ns.fetch_add(modelled_ns, std::memory_order_relaxed);
+}
+
+void FSTimingStats::LogAndReset(u64 title_id) {
+    static constexpr std::array<const char*, 2> device_names{"game card", "SD card"};
+    for (std::size_t i = 0; i < devices.size(); i++) {
+        DeviceStats& stats = devices[i];
+        const u64 reads = stats.reads.exchange(0);
+        const u64 opens = stats.opens.exchange(0);
+        const u64 bytes = stats.bytes.exchange(0);
+        const u64 guest_ns = stats.guest_ns.exchange(0);
+        const u64 host_ns = stats.host_ns.exchange(0);
+        if (reads == 0 && opens == 0) {
+            continue;
+        }
+        LOG_INFO(Service_FS,
+                 "FS timing for {:016X} on the {}: {} opens, {} reads of {} KiB, guest waited "
+                 "{} ms, host I/O took {} ms",
+                 title_id, device_names[i], opens, reads, bytes / 1024, guest_ns / 1000000,
+                 host_ns / 1000000);
+    }
+}
+
+FSTimingStats& FSTimingStats::Get() {
+    static FSTimingStats stats;
+    return stats;
 }
 
 } // namespace FileSys
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
@@ -20,12 +22,34 @@ private:
 
 namespace FileSys {
 
+/// Storage device the data of an archive lives on.
+enum class StorageDevice : u32 {
+    GameCard,
+    SDCard,
+};
+
+/// Access times of a storage device, as seen by a guest FS request.
+struct DeviceTiming {
+    /// Paid by every read: the IPC round trip, the FS process and seeking to the data.
+    u64 read_overhead_ns;
+    /// Transfer time per byte.
+    u64 read_ns_per_byte;
+    /// No read completes faster than this.
+    u64 minimum_read_ns;
+    u64 open_ns;
+};
+
+const DeviceTiming& GetDeviceTiming(StorageDevice device);
+
 class DelayGenerator {
 public:
     virtual ~DelayGenerator();
     virtual u64 GetReadDelayNs(std::size_t length) = 0;
     virtual u64 GetOpenDelayNs() = 0;
 
+    /// Device the delays are modelled on.
+    virtual StorageDevice GetDevice() const = 0;
+
     // TODO (B3N30): Add getter for all other file/directory io operations
 private:
     template <class Archive>
@@ -33,14 +57,83 @@ private:
     friend class boost::serialization::access;
 };
 
-class DefaultDelayGenerator : public DelayGenerator {
+/**
+ * Delays of a storage device under the configured Settings::FSTimingProfile. The device is fixed
+ * by each subclass, so it does not need to be serialized.
+ */
+class DeviceDelayGenerator : public DelayGenerator {
 public:
+    explicit DeviceDelayGenerator(StorageDevice device_) : device(device_) {}
+
     u64 GetReadDelayNs(std::size_t length) override;
     u64 GetOpenDelayNs() override;
 
+    StorageDevice GetDevice() const override {
+        return device;
+    }
+
+protected:
+    /// Applies the timing profile to an open delay measured for a specific archive.
+    u64 ProfileOpenDelayNs(u64 measured_ns) const;
+
+private:
+    StorageDevice device;
+};
+
+class DefaultDelayGenerator : public DeviceDelayGenerator {
+public:
+    DefaultDelayGenerator() : DeviceDelayGenerator(StorageDevice::GameCard) {}
+
     SERIALIZE_DELAY_GENERATOR
 };
 
+/**
+ * Models the requests in flight on each storage device. The hardware serves one request at a
+ * time, so a read issued while the device is busy also waits for the reads ahead of it. Only used
+ * on the accurate timing profile. Time is counted in emulated CPU ticks, so the waits are the
+ * same on every run.
+ */
+class DeviceQueue {
+public:
+    /**
+     * Occupies the device for service_ticks once the reads queued so far are done.
+     * @param now_ticks Emulated time at which the read is issued.
+     * @returns The number of ticks the read waits for the device.
+     */
+    static u64 Reserve(StorageDevice device, u64 service_ticks, u64 now_ticks);
+
+    /// Empties the queues. Called whenever the emulated clock starts over.
+    static void Reset();
+};
+
+/**
+ * Guest-visible FS load time of the running title against the host time spent on the same
+ * requests. Logged when the emulation session ends.
+ */
+class FSTimingStats {
+public:
+    void RecordRead(StorageDevice device, std::size_t length, u64 modelled_ns, u64 host_ns);
+    void RecordOpen(StorageDevice device, u64 modelled_ns);
+
+    /// Logs the totals for the title and clears them.
+    void LogAndReset(u64 title_id);
+
+    static FSTimingStats& Get();
+
+private:
+    struct DeviceStats {
+        std::atomic<u64> reads{0};
+        std::atomic<u64> bytes{0};
+        std::atomic<u64> opens{0};
+        /// Time the guest waited, the larger of the modelled delay and the host time.
+        std::atomic<u64> guest_ns{0};
+        /// Time the host spent reading.
+        std::atomic<u64> host_ns{0};
+    };
+
+    std::array<DeviceStats, 2> devices;
+};
+
 } // namespace FileSys
 
 BOOST_CLASS_EXPORT_KEY(FileSys::DefaultDelayGenerator);
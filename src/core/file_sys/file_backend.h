@@ -10,6 +10,7 @@
 #include <memory>
 #include <boost/serialization/unique_ptr.hpp>
 #include "common/common_types.h"
+#include "common/unique_function.h"
 #include "core/hle/result.h"
 #include "delay_generator.h"
 
@@ -63,6 +64,11 @@ public:
         return delay_generator->GetOpenDelayNs();
     }
 
+    /// Device the delays of this file are modelled on.
+    StorageDevice GetStorageDevice() const {
+        return delay_generator ? delay_generator->GetDevice() : StorageDevice::GameCard;
+    }
+
     /**
      * Get the size of the file in bytes
      * @return Size of the file in bytes
@@ -101,6 +107,29 @@ public:
         return false;
     }
 
+    /// Receives the result of ReadAsync.
+    using ReadCallback = Common::UniqueFunction<void, ResultVal<std::size_t>>;
+
+    /**
+     * Whether ReadAsync completes reads without blocking the calling thread.
+     */
+    virtual bool SupportsAsyncRead() const {
+        return false;
+    }
+
+    /**
+     * Read data from the file without waiting for it
+     * @param offset Offset in bytes to start reading data from
+     * @param length Length in bytes of data to read from file
+     * @param buffer Buffer to read data into, must stay valid until callback is called
+     * @param callback Receives the number of bytes read or an error code, possibly from another
+     * thread
+     */
+    virtual void ReadAsync(u64 offset, std::size_t length, u8* buffer,
+                           ReadCallback callback) const {
+        callback(Read(offset, length, buffer));
+    }
+
 protected:
     std::unique_ptr<DelayGenerator> delay_generator;
 
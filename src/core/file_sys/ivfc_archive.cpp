@@ -102,6 +102,12 @@ ResultVal<std::size_t> IVFCFile::Read(const u64 offset, const std::size_t length
     return romfs_file->ReadFile(offset, length, buffer);
 }
 
+void IVFCFile::ReadAsync(const u64 offset, const std::size_t length, u8* buffer,
+                         ReadCallback callback) const {
+    LOG_TRACE(Service_FS, "called offset={}, length={}", offset, length);
+    romfs_file->ReadFileAsync(offset, length, buffer, std::move(callback));
+}
+
 ResultVal<std::size_t> IVFCFile::Write(const u64 offset, const std::size_t length, const bool flush,
                                        const bool update_timestamp, const u8* buffer) {
     LOG_ERROR(Service_FS, "Attempted to write to IVFC file");
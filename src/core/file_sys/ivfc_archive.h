@@ -21,71 +21,23 @@
 
 namespace FileSys {
 
-class IVFCDelayGenerator : public DelayGenerator {
-    u64 GetReadDelayNs(std::size_t length) override {
-        // This is the delay measured for a romfs read.
-        // For now we will take that as a default
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured for a romfs open.
-        // For now we will take that as a default
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+class IVFCDelayGenerator : public DeviceDelayGenerator {
+public:
+    IVFCDelayGenerator() : DeviceDelayGenerator(StorageDevice::GameCard) {}
 
     SERIALIZE_DELAY_GENERATOR
 };
 
-class RomFSDelayGenerator : public DelayGenerator {
+class RomFSDelayGenerator : public DeviceDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // The delay was measured on O3DS and O2DS with
-        // https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
-        // from the results the average of each length was taken.
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured on O3DS and O2DS with
-        // https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e
-        // from the results the average of each length was taken.
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+    RomFSDelayGenerator() : DeviceDelayGenerator(StorageDevice::GameCard) {}
 
     SERIALIZE_DELAY_GENERATOR
 };
 
-class ExeFSDelayGenerator : public DelayGenerator {
+class ExeFSDelayGenerator : public DeviceDelayGenerator {
 public:
-    u64 GetReadDelayNs(std::size_t length) override {
-        // The delay was measured on O3DS and O2DS with
-        // https://gist.github.com/B3n30/ac40eac20603f519ff106107f4ac9182
-        // from the results the average of each length was taken.
-        static constexpr u64 slope(94);
-        static constexpr u64 offset(582778);
-        static constexpr u64 minimum(663124);
-        u64 IPCDelayNanoseconds = std::max<u64>(static_cast<u64>(length) * slope + offset, minimum);
-        return IPCDelayNanoseconds;
-    }
-
-    u64 GetOpenDelayNs() override {
-        // This is the delay measured on O3DS and O2DS with
-        // https://gist.github.com/FearlessTobi/eb1d70619c65c7e6f02141d71e79a36e
-        // from the results the average of each length was taken.
-        static constexpr u64 IPCDelayNanoseconds(9438006);
-        return IPCDelayNanoseconds;
-    }
+    ExeFSDelayGenerator() : DeviceDelayGenerator(StorageDevice::GameCard) {}
 
     SERIALIZE_DELAY_GENERATOR
 };
@@ -140,6 +92,13 @@ public:
         return romfs_file->CacheReady(file_offset, length);
     }
 
+    bool SupportsAsyncRead() const override {
+        return romfs_file->SupportsAsyncRead();
+    }
+
+    void ReadAsync(u64 offset, std::size_t length, u8* buffer,
+                   ReadCallback callback) const override;
+
 private:
     std::shared_ptr<RomFSReader> romfs_file;
 
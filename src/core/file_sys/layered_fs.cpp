@@ -10,10 +10,13 @@
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/hash.h"
+#include "common/mapped_file.h"
 #include "common/string_util.h"
 #include "common/swap.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/patch.h"
+#include "core/loader/loader.h"
 
 SERIALIZE_EXPORT_IMPL(FileSys::LayeredFS)
 
@@ -25,6 +28,8 @@ struct FileRelocationInfo {
     std::string replace_file_path; // Type 1
     std::vector<u8> patched_file;  // Type 2
     u64 size;                      // Relocated file size
+
+    FileUtil::MappedFile replace_file; // Type 1, mapped when loading
 };
 struct LayeredFS::File {
     std::string name;
@@ -55,6 +60,54 @@ struct FileMetadata {
 };
 static_assert(sizeof(FileMetadata) == 0x20, "Size of FileMetadata is not correct");
 
+namespace {
+
+constexpr u32 INDEX_MAGIC = Loader::MakeMagic('B', '3', 'L', 'F');
+// Increase whenever the layout of the index or the way the RomFS is rebuilt changes.
+constexpr u32 INDEX_VERSION = 1;
+
+template <typename T>
+bool ReadValue(FileUtil::IOFile& file, T& value) {
+    return file.ReadArray(&value, 1) == 1;
+}
+
+template <typename T>
+bool ReadVector(FileUtil::IOFile& file, std::vector<T>& data) {
+    u64 size;
+    if (!ReadValue(file, size) || size > (file.GetSize() - file.Tell()) / sizeof(T)) {
+        return false;
+    }
+    data.resize(size);
+    return file.ReadArray(data.data(), data.size()) == data.size();
+}
+
+bool ReadString(FileUtil::IOFile& file, std::string& string) {
+    std::vector<char> data;
+    if (!ReadVector(file, data)) {
+        return false;
+    }
+    string.assign(data.begin(), data.end());
+    return true;
+}
+
+template <typename T>
+void WriteVector(FileUtil::IOFile& file, std::span<const T> data) {
+    file.WriteObject(static_cast<u64>(data.size()));
+    file.WriteArray(data.data(), data.size());
+}
+
+void CollectEntries(const FileUtil::FSTEntry& parent,
+                    std::vector<const FileUtil::FSTEntry*>& entries) {
+    for (const auto& entry : parent.children) {
+        entries.push_back(&entry);
+        if (entry.isDirectory) {
+            CollectEntries(entry, entries);
+        }
+    }
+}
+
+} // Anonymous namespace
+
 LayeredFS::LayeredFS() = default;
 
 LayeredFS::LayeredFS(std::shared_ptr<RomFSReader> romfs_, std::string patch_path_,
@@ -69,9 +122,21 @@ void LayeredFS::Load() {
 
     ASSERT_MSG(header.header_length == sizeof(header), "Header size is incorrect");
 
+    // Read all metadata at once rather than each entry on its own
+    original_metadata.resize(header.file_data_offset);
+    romfs->ReadFile(0, original_metadata.size(), original_metadata.data());
+
+    const auto index_key = load_relocations ? GetIndexKey() : std::nullopt;
+    if (index_key && LoadIndex(*index_key)) {
+        original_metadata = {};
+        MapReplacementFiles();
+        return;
+    }
+
     // TODO: is root always the first directory in table?
     root.parent = &root;
     LoadDirectory(root, 0);
+    original_metadata = {};
 
     if (load_relocations) {
         LoadRelocations();
@@ -79,14 +144,32 @@ void LayeredFS::Load() {
     }
 
     RebuildMetadata();
+
+    if (index_key) {
+        SaveIndex(*index_key);
+    }
+    MapReplacementFiles();
+}
+
+void LayeredFS::MapReplacementFiles() {
+    // Reads may run on several threads at once, so nothing is mapped lazily by ReadFile.
+    // Replacement files must not be truncated while the game runs: touching a mapped page past
+    // the new end of a file raises SIGBUS. On Windows the mappings also keep the files from being
+    // modified or deleted until the game is closed.
+    for (const auto& [data_offset, file] : data_offsets) {
+        auto& relocation = file->relocation;
+        if (relocation.type == 1) {
+            relocation.replace_file = FileUtil::MappedFile(relocation.replace_file_path);
+        }
+    }
 }
 
 LayeredFS::~LayeredFS() = default;
 
 u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
     DirectoryMetadata metadata;
-    romfs->ReadFile(header.directory_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ReadOriginalMetadata(header.directory_metadata_table.offset + offset, sizeof(metadata),
+                         &metadata);
 
     current.name = ReadName(header.directory_metadata_table.offset + offset + sizeof(metadata),
                             metadata.name_length);
@@ -112,8 +195,7 @@ u32 LayeredFS::LoadDirectory(Directory& current, u32 offset) {
 
 u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     FileMetadata metadata;
-    romfs->ReadFile(header.file_metadata_table.offset + offset, sizeof(metadata),
-                    reinterpret_cast<u8*>(&metadata));
+    ReadOriginalMetadata(header.file_metadata_table.offset + offset, sizeof(metadata), &metadata);
 
     auto file = std::make_unique<File>();
     file->name = ReadName(header.file_metadata_table.offset + offset + sizeof(metadata),
@@ -129,9 +211,14 @@ u32 LayeredFS::LoadFile(Directory& parent, u32 offset) {
     return metadata.next_sibling_offset;
 }
 
+void LayeredFS::ReadOriginalMetadata(u32 offset, std::size_t length, void* dest) const {
+    ASSERT_MSG(offset + length <= original_metadata.size(), "Metadata out of bound");
+    std::memcpy(dest, original_metadata.data() + offset, length);
+}
+
 std::string LayeredFS::ReadName(u32 offset, u32 name_length) {
     std::vector<u16_le> buffer(name_length / sizeof(u16_le));
-    romfs->ReadFile(offset, name_length, reinterpret_cast<u8*>(buffer.data()));
+    ReadOriginalMetadata(offset, buffer.size() * sizeof(u16_le), buffer.data());
 
     std::u16string name(buffer.size(), 0);
     std::transform(buffer.begin(), buffer.end(), name.begin(), [](u16_le character) {
@@ -403,7 +490,7 @@ void LayeredFS::BuildFiles() {
         metadata.file_data_length = file->relocation.size;
         current_data_offset += Common::AlignUp(metadata.file_data_length, 16);
         if (metadata.file_data_length != 0) {
-            data_offset_map.emplace(metadata.file_data_offset, file);
+            data_offsets.emplace_back(metadata.file_data_offset, file);
         }
 
         const auto bucket =
@@ -484,6 +571,146 @@ void LayeredFS::RebuildMetadata() {
                 header.file_metadata_table.length);
 }
 
+std::optional<u64> LayeredFS::GetIndexKey() const {
+    u64 key = Common::HashCombine(INDEX_VERSION, romfs->GetSize());
+    key = Common::HashCombine(
+        key, Common::ComputeHash64(original_metadata.data(), original_metadata.size()));
+
+    for (std::string path : {patch_path, patch_ext_path}) {
+        if (!FileUtil::Exists(path)) {
+            key = Common::HashCombine(key, 0);
+            continue;
+        }
+        if (path.back() == '/' || path.back() == '\\') {
+            path.pop_back();
+        }
+
+        FileUtil::FSTEntry tree;
+        FileUtil::ScanDirectoryTree(path, tree, 256);
+        std::vector<const FileUtil::FSTEntry*> entries;
+        CollectEntries(tree, entries);
+        std::sort(entries.begin(), entries.end(), [](const auto* a, const auto* b) {
+            return a->physicalName < b->physicalName;
+        });
+
+        key = Common::HashCombine(key, entries.size());
+        for (const auto* entry : entries) {
+            const auto name = std::string_view{entry->physicalName}.substr(path.size());
+            key = Common::HashCombine(key, Common::ComputeHash64(name.data(), name.size()));
+            if (entry->isDirectory) {
+                continue;
+            }
+            const auto modification_time = FileUtil::GetModificationTime(entry->physicalName);
+            if (!modification_time) {
+                return std::nullopt;
+            }
+            key = Common::HashCombine(key, entry->size);
+            key = Common::HashCombine(key, static_cast<u64>(*modification_time));
+        }
+    }
+    return key;
+}
+
+std::string LayeredFS::GetIndexPath() const {
+    return fmt::format("{}layered_fs{}{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::CacheDir), DIR_SEP,
+                       Common::ComputeHash64(patch_path.data(), patch_path.size()));
+}
+
+bool LayeredFS::LoadIndex(u64 key) {
+    FileUtil::IOFile file(GetIndexPath(), "rb");
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    u32 magic, version;
+    u64 index_key;
+    if (!ReadValue(file, magic) || magic != INDEX_MAGIC || !ReadValue(file, version) ||
+        version != INDEX_VERSION || !ReadValue(file, index_key) || index_key != key) {
+        return false;
+    }
+
+    std::vector<u8> index_metadata;
+    u64 data_size, num_files;
+    if (!ReadVector(file, index_metadata) || !ReadValue(file, data_size) ||
+        !ReadValue(file, num_files)) {
+        return false;
+    }
+
+    std::vector<std::unique_ptr<File>> files;
+    std::vector<std::pair<u64, File*>> offsets;
+    for (u64 i = 0; i < num_files; i++) {
+        auto entry = std::make_unique<File>();
+        auto& relocation = entry->relocation;
+        u64 data_offset;
+        if (!ReadValue(file, data_offset) || !ReadString(file, entry->path) ||
+            !ReadValue(file, relocation.type) || !ReadValue(file, relocation.size) ||
+            !ReadValue(file, relocation.original_offset) ||
+            !ReadString(file, relocation.replace_file_path) ||
+            !ReadVector(file, relocation.patched_file)) {
+            return false;
+        }
+
+        const bool valid_offset = offsets.empty() || data_offset > offsets.back().first;
+        const bool valid_relocation =
+            (relocation.type == 0 &&
+             relocation.original_offset + relocation.size <= romfs->GetSize()) ||
+            relocation.type == 1 ||
+            (relocation.type == 2 && relocation.patched_file.size() == relocation.size);
+        if (!valid_offset || !valid_relocation || data_offset + relocation.size > data_size) {
+            LOG_WARNING(Service_FS, "LayeredFS index is corrupted, rebuilding");
+            return false;
+        }
+
+        entry->name = entry->path.substr(entry->path.find_last_of('/') + 1);
+        offsets.emplace_back(data_offset, entry.get());
+        files.push_back(std::move(entry));
+    }
+
+    metadata = std::move(index_metadata);
+    current_data_offset = data_size;
+    data_offsets = std::move(offsets);
+    indexed_files = std::move(files);
+    LOG_INFO(Service_FS, "LayeredFS loaded {} files from the index", indexed_files.size());
+    return true;
+}
+
+void LayeredFS::SaveIndex(u64 key) const {
+    const auto path = GetIndexPath();
+    if (!FileUtil::CreateFullPath(path)) {
+        return;
+    }
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen()) {
+        LOG_WARNING(Service_FS, "Could not write LayeredFS index {}", path);
+        return;
+    }
+
+    file.WriteObject(INDEX_MAGIC);
+    file.WriteObject(INDEX_VERSION);
+    file.WriteObject(key);
+    WriteVector<u8>(file, metadata);
+    file.WriteObject(current_data_offset);
+    file.WriteObject(static_cast<u64>(data_offsets.size()));
+    for (const auto& [data_offset, entry] : data_offsets) {
+        const auto& relocation = entry->relocation;
+        file.WriteObject(data_offset);
+        WriteVector<char>(file, entry->path);
+        file.WriteObject(relocation.type);
+        file.WriteObject(relocation.size);
+        file.WriteObject(relocation.original_offset);
+        WriteVector<char>(file, relocation.replace_file_path);
+        WriteVector<u8>(file, relocation.patched_file);
+    }
+
+    if (!file.IsGood()) {
+        LOG_WARNING(Service_FS, "Could not write LayeredFS index {}", path);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
 std::size_t LayeredFS::GetSize() const {
     return metadata.size() + current_data_offset;
 }
@@ -503,8 +730,14 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
     }
 
     // Read files
-    auto current = (--data_offset_map.upper_bound(offset));
-    while (read_size < length) {
+    auto current = std::upper_bound(
+        data_offsets.begin(), data_offsets.end(), offset,
+        [](std::size_t value, const std::pair<u64, File*>& entry) { return value < entry.first; });
+    if (current == data_offsets.begin()) {
+        return read_size;
+    }
+    --current;
+    while (read_size < length && current != data_offsets.end()) {
         const auto relative_offset = offset - current->first;
         std::size_t to_read{};
         if (current->second->relocation.size > relative_offset) {
@@ -518,18 +751,23 @@ std::size_t LayeredFS::ReadFile(std::size_t offset, std::size_t length, u8* buff
             to_read;
 
         // Read the file in different ways depending on relocation type
-        auto& relocation = current->second->relocation;
+        const auto& relocation = current->second->relocation;
         if (relocation.type == 0) { // none
             romfs->ReadFile(relocation.original_offset + relative_offset, to_read,
                             buffer + read_size);
         } else if (relocation.type == 1) { // replace
-            FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
-            if (replace_file) {
-                replace_file.Seek(relative_offset, SEEK_SET);
-                replace_file.ReadBytes(buffer + read_size, to_read);
+            const auto data = relocation.replace_file.GetData();
+            if (relative_offset + to_read <= data.size()) {
+                std::memcpy(buffer + read_size, data.data() + relative_offset, to_read);
             } else {
-                LOG_ERROR(Service_FS, "Could not open replacement file for {}",
-                          current->second->path);
+                FileUtil::IOFile replace_file(relocation.replace_file_path, "rb");
+                if (replace_file) {
+                    replace_file.Seek(relative_offset, SEEK_SET);
+                    replace_file.ReadBytes(buffer + read_size, to_read);
+                } else {
+                    LOG_ERROR(Service_FS, "Could not open replacement file for {}",
+                              current->second->path);
+                }
             }
         } else if (relocation.type == 2) { // patch
             std::memcpy(buffer + read_size, relocation.patched_file.data() + relative_offset,
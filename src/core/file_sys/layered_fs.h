@@ -5,8 +5,8 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -42,6 +42,9 @@ static_assert(sizeof(RomFSHeader) == 0x28, "Size of RomFSHeader is not correct")
  * patch_ext_path: Path for RomFS extensions. Files present in this path:
  *  - When with an extension of ".stub", remove the corresponding file in the RomFS.
  *  - When with an extension of ".ips" or ".bps", patch the file in the RomFS.
+ *
+ * The rebuilt metadata and the file layout are kept in an index in the cache directory, which is
+ * reused as long as the RomFS and the files in both paths are unchanged.
  */
 class LayeredFS : public RomFSReader {
 public:
@@ -72,6 +75,9 @@ private:
         Directory* parent;
     };
 
+    // Copies from the metadata of the original RomFS
+    void ReadOriginalMetadata(u32 offset, std::size_t length, void* dest) const;
+
     std::string ReadName(u32 offset, u32 name_length);
 
     // Loads the current directory, then its children.
@@ -107,6 +113,17 @@ private:
 
     void RebuildMetadata();
 
+    // Returns the key of the index for the current RomFS and mod files, or std::nullopt if their
+    // state cannot be determined
+    std::optional<u64> GetIndexKey() const;
+
+    std::string GetIndexPath() const;
+    bool LoadIndex(u64 key);
+    void SaveIndex(u64 key) const;
+
+    // Maps the files that replace RomFS files, once the file layout is known
+    void MapReplacementFiles();
+
     void Load();
 
     std::shared_ptr<RomFSReader> romfs;
@@ -118,8 +135,10 @@ private:
     Directory root;
     std::unordered_map<std::string, File*> file_path_map;
     std::unordered_map<std::string, Directory*> directory_path_map;
-    std::map<u64, File*> data_offset_map; // assigned data offset -> file
-    std::vector<u8> metadata;             // Includes header, hash table and metadata
+    std::vector<u8> original_metadata; // metadata of the original RomFS, only kept while loading
+    std::vector<std::pair<u64, File*>> data_offsets; // assigned data offset -> file, sorted
+    std::vector<std::unique_ptr<File>> indexed_files; // files loaded from the index
+    std::vector<u8> metadata;                         // Includes header, hash table and metadata
 
     // Used for rebuilding header
     std::vector<u32_le> directory_hash_table;
@@ -6,17 +6,20 @@
 #include <cstring>
 #include <memory>
 #include <span>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
-#include <cryptopp/sha.h>
+#include <type_traits>
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/core.h"
 #include "core/file_sys/layered_fs.h"
 #include "core/file_sys/ncch_container.h"
 #include "core/file_sys/patch.h"
 #include "core/file_sys/seed_db.h"
+#include "core/hw/aes/cipher.h"
 #include "core/hw/aes/key.h"
+#include "core/hw/sha/sha.h"
 #include "core/loader/loader.h"
 
 namespace FileSys {
@@ -32,85 +35,138 @@ u64 GetModId(u64 program_id) {
     return program_id;
 }
 
-/**
- * Get the decompressed size of an LZSS compressed ExeFS file
- * @param buffer Buffer of compressed file
- * @param size Size of compressed buffer
- * @return Size of decompressed buffer
- */
-static std::size_t LZSS_GetDecompressedSize(std::span<const u8> buffer) {
+std::size_t LZSS_GetDecompressedSize(std::span<const u8> buffer) {
     u32 offset_size;
+    if (buffer.size() < sizeof(offset_size))
+        return 0;
     std::memcpy(&offset_size, buffer.data() + buffer.size() - sizeof(u32), sizeof(u32));
     return offset_size + buffer.size();
 }
 
-/**
- * Decompress ExeFS file (compressed with LZSS)
- * @param compressed Compressed buffer
- * @param compressed_size Size of compressed buffer
- * @param decompressed Decompressed buffer
- * @param decompressed_size Size of decompressed buffer
- * @return True on success, otherwise false
- */
-static bool LZSS_Decompress(std::span<const u8> compressed, std::span<u8> decompressed) {
+bool LZSS_Decompress(std::span<const u8> compressed, std::span<u8> decompressed) {
+    if (compressed.size() < 8 || decompressed.size() < compressed.size())
+        return false;
+
     const u8* footer = compressed.data() + compressed.size() - 8;
 
     u32 buffer_top_and_bottom;
     std::memcpy(&buffer_top_and_bottom, footer, sizeof(u32));
 
+    const std::size_t buffer_top = (buffer_top_and_bottom >> 24) & 0xFF;
+    const std::size_t buffer_bottom = buffer_top_and_bottom & 0xFFFFFF;
+    if (buffer_top > compressed.size() || buffer_bottom > compressed.size())
+        return false;
+
+    u8* const data = decompressed.data();
     std::size_t out = decompressed.size();
-    std::size_t index = compressed.size() - ((buffer_top_and_bottom >> 24) & 0xFF);
-    std::size_t stop_index = compressed.size() - (buffer_top_and_bottom & 0xFFFFFF);
+    std::size_t index = compressed.size() - buffer_top;
+    const std::size_t stop_index = compressed.size() - buffer_bottom;
 
-    std::memset(decompressed.data(), 0, decompressed.size());
-    std::memcpy(decompressed.data(), compressed.data(), compressed.size());
+    // The output is written back to front, so only the head needs to be copied up front.
+    std::memcpy(data, compressed.data(), compressed.size());
 
     while (index > stop_index) {
         u8 control = compressed[--index];
 
-        for (unsigned i = 0; i < 8; i++) {
-            if (index <= stop_index)
-                break;
-            if (index <= 0)
-                break;
-            if (out <= 0)
-                break;
-
-            if (control & 0x80) {
-                // Check if compression is out of bounds
-                if (index < 2)
-                    return false;
-                index -= 2;
-
-                u32 segment_offset = compressed[index] | (compressed[index + 1] << 8);
-                u32 segment_size = ((segment_offset >> 12) & 15) + 3;
-                segment_offset &= 0x0FFF;
-                segment_offset += 2;
-
-                // Check if compression is out of bounds
-                if (out < segment_size)
-                    return false;
-
-                for (unsigned j = 0; j < segment_size; j++) {
-                    // Check if compression is out of bounds
-                    if (out + segment_offset >= decompressed.size())
-                        return false;
-
-                    u8 data = decompressed[out + segment_offset];
-                    decompressed[--out] = data;
-                }
+        for (unsigned i = 0; i < 8 && index > stop_index && out > 0; i++, control <<= 1) {
+            if (!(control & 0x80)) {
+                data[--out] = compressed[--index];
+                continue;
+            }
+
+            // Check if compression is out of bounds
+            if (index < 2)
+                return false;
+            index -= 2;
+
+            const u32 segment = compressed[index] | (compressed[index + 1] << 8);
+            const std::size_t segment_size = ((segment >> 12) & 15) + 3;
+            const std::size_t distance = (segment & 0x0FFF) + 3;
+
+            // Check if compression is out of bounds
+            if (out < segment_size || out + distance > decompressed.size())
+                return false;
+
+            out -= segment_size;
+            u8* dest = data + out;
+            const u8* source = dest + distance;
+            if (distance >= segment_size) {
+                std::memcpy(dest, source, segment_size);
             } else {
-                // Check if compression is out of bounds
-                if (out < 1)
-                    return false;
-                decompressed[--out] = compressed[--index];
+                // The segment repeats bytes it has just written, so copy them back to front.
+                for (std::size_t j = segment_size; j-- > 0;) {
+                    dest[j] = source[j];
+                }
             }
-            control <<= 1;
         }
     }
+
+    // Anything between the compressed head and the decompressed data is zero filled.
+    if (out > compressed.size()) {
+        std::memset(data + compressed.size(), 0, out - compressed.size());
+    }
     return true;
 }
 
+using SectionHash = std::array<u8, 0x20>;
+
+/// Identifies the compressed .code section a cached decompressed one was made from.
+struct CodeCacheKey {
+    /// Hash of the section stored in the ExeFS header
+    SectionHash section_hash;
+    /// Size and hash of the compressed section as read, in case the header hash is stale
+    u64 compressed_size;
+    u64 compressed_hash;
+
+    bool operator==(const CodeCacheKey&) const = default;
+};
+static_assert(std::has_unique_object_representations_v<CodeCacheKey>,
+              "CodeCacheKey is written to the cache as is");
+
+/**
+ * Decompressed .code sections are cached per title in a single file, which holds the key of the
+ * compressed section it was made from, a hash of the code and then the code itself.
+ */
+static std::string GetCodeCachePath(u64 program_id) {
+    return fmt::format("{}code/{:016X}.bin", FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+                       program_id);
+}
+
+static bool LoadCachedCode(u64 program_id, const CodeCacheKey& key, std::vector<u8>& code) {
+    FileUtil::IOFile file(GetCodeCachePath(program_id), "rb");
+    if (!file.IsOpen())
+        return false;
+
+    CodeCacheKey cached_key;
+    u64 code_hash;
+    if (!file.ReadArray(&cached_key, 1) || cached_key != key || !file.ReadArray(&code_hash, 1))
+        return false;
+
+    const u64 code_size = file.GetSize() - file.Tell();
+    code.resize(code_size);
+    if (file.ReadBytes(code.data(), code.size()) != code.size() ||
+        Common::ComputeHash64(code.data(), code.size()) != code_hash) {
+        LOG_WARNING(Service_FS, "Ignoring corrupted code cache for title {:016X}", program_id);
+        return false;
+    }
+    return true;
+}
+
+static void StoreCachedCode(u64 program_id, const CodeCacheKey& key, const std::vector<u8>& code) {
+    const std::string path = GetCodeCachePath(program_id);
+    if (!FileUtil::CreateFullPath(path))
+        return;
+
+    FileUtil::IOFile file(path, "wb");
+    const u64 code_hash = Common::ComputeHash64(code.data(), code.size());
+    if (!file.IsOpen() || !file.WriteArray(&key, 1) || !file.WriteArray(&code_hash, 1) ||
+        file.WriteBytes(code.data(), code.size()) != code.size()) {
+        LOG_WARNING(Service_FS, "Could not write the code cache for title {:016X}", program_id);
+        file.Close();
+        FileUtil::Delete(path);
+    }
+}
+
 NCCHContainer::NCCHContainer(const std::string& filepath, u32 ncch_offset, u32 partition)
     : ncch_offset(ncch_offset), partition(partition), filepath(filepath) {
     file = FileUtil::IOFile(filepath, "rb");
@@ -227,56 +283,41 @@ Loader::ResultStatus NCCHContainer::Load() {
                         std::array<u8, 32> input;
                         std::memcpy(input.data(), key_y_primary.data(), key_y_primary.size());
                         std::memcpy(input.data() + key_y_primary.size(), seed.data(), seed.size());
-                        CryptoPP::SHA256 sha;
-                        std::array<u8, CryptoPP::SHA256::DIGESTSIZE> hash;
-                        sha.CalculateDigest(hash.data(), input.data(), input.size());
+                        const auto hash = HW::SHA::ComputeSHA256(input);
                         std::memcpy(key_y_secondary.data(), hash.data(), key_y_secondary.size());
                     }
                 }
 
-                SetKeyY(KeySlotID::NCCHSecure1, key_y_primary);
-                if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
+                // The keys are generated without setting the KeyY of the shared key slots, so
+                // NCCHs can be loaded on different threads (such as by the game list).
+                const auto primary = GenerateNormalKey(KeySlotID::NCCHSecure1, key_y_primary);
+                if (!primary) {
                     LOG_ERROR(Service_FS, "Secure1 KeyX missing");
                     failed_to_decrypt = true;
                 }
-                primary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                primary_key = primary.value_or(AESKey{});
 
-                switch (ncch_header.secondary_key_slot) {
-                case 0:
-                    LOG_DEBUG(Service_FS, "Secure1 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure1, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure1)) {
-                        LOG_ERROR(Service_FS, "Secure1 KeyX missing");
+                const auto generate_secondary_key = [&](KeySlotID slot_id, const char* name) {
+                    LOG_DEBUG(Service_FS, "{} crypto", name);
+                    const auto key = GenerateNormalKey(slot_id, key_y_secondary);
+                    if (!key) {
+                        LOG_ERROR(Service_FS, "{} KeyX missing", name);
                         failed_to_decrypt = true;
                     }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure1);
+                    secondary_key = key.value_or(AESKey{});
+                };
+                switch (ncch_header.secondary_key_slot) {
+                case 0:
+                    generate_secondary_key(KeySlotID::NCCHSecure1, "Secure1");
                     break;
                 case 1:
-                    LOG_DEBUG(Service_FS, "Secure2 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure2, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure2)) {
-                        LOG_ERROR(Service_FS, "Secure2 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure2);
+                    generate_secondary_key(KeySlotID::NCCHSecure2, "Secure2");
                     break;
                 case 10:
-                    LOG_DEBUG(Service_FS, "Secure3 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure3, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure3)) {
-                        LOG_ERROR(Service_FS, "Secure3 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure3);
+                    generate_secondary_key(KeySlotID::NCCHSecure3, "Secure3");
                     break;
                 case 11:
-                    LOG_DEBUG(Service_FS, "Secure4 crypto");
-                    SetKeyY(KeySlotID::NCCHSecure4, key_y_secondary);
-                    if (!IsNormalKeyAvailable(KeySlotID::NCCHSecure4)) {
-                        LOG_ERROR(Service_FS, "Secure4 KeyX missing");
-                        failed_to_decrypt = true;
-                    }
-                    secondary_key = GetNormalKey(KeySlotID::NCCHSecure4);
+                    generate_secondary_key(KeySlotID::NCCHSecure4, "Secure4");
                     break;
                 }
             }
@@ -349,10 +390,9 @@ Loader::ResultStatus NCCHContainer::Load() {
                         LOG_ERROR(Service_FS, "Failed to decrypt");
                         return Loader::ResultStatus::ErrorEncrypted;
                     }
-                    CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exheader_header);
-                    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(
-                        primary_key.data(), primary_key.size(), exheader_ctr.data())
-                        .ProcessData(data, data, sizeof(exheader_header));
+                    HW::AES::GetCTRCipher(primary_key)
+                        ->Transform(exheader_ctr, 0, reinterpret_cast<u8*>(&exheader_header),
+                                    sizeof(exheader_header));
                 }
             }
 
@@ -421,10 +461,9 @@ Loader::ResultStatus NCCHContainer::Load() {
                 return Loader::ResultStatus::Error;
 
             if (is_encrypted) {
-                CryptoPP::byte* data = reinterpret_cast<CryptoPP::byte*>(&exefs_header);
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption(primary_key.data(),
-                                                              primary_key.size(), exefs_ctr.data())
-                    .ProcessData(data, data, sizeof(exefs_header));
+                HW::AES::GetCTRCipher(primary_key)
+                    ->Transform(exefs_ctr, 0, reinterpret_cast<u8*>(&exefs_header),
+                                sizeof(exefs_header));
             }
 
             exefs_file = FileUtil::IOFile(filepath, "rb");
@@ -533,9 +572,8 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 key = secondary_key;
             }
 
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption dec(key.data(), key.size(),
-                                                              exefs_ctr.data());
-            dec.Seek(section.offset + sizeof(ExeFs_Header));
+            const auto cipher = is_encrypted ? HW::AES::GetCTRCipher(key) : nullptr;
+            const u64 crypto_offset = section.offset + sizeof(ExeFs_Header);
 
             if (strcmp(section.name, ".code") == 0 && is_compressed) {
                 // Section is compressed, read compressed .code section...
@@ -545,7 +583,26 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                     return Loader::ResultStatus::Error;
 
                 if (is_encrypted) {
-                    dec.ProcessData(&temp_buffer[0], &temp_buffer[0], section.size);
+                    cipher->Transform(exefs_ctr, crypto_offset, temp_buffer.data(),
+                                      section.size);
+                }
+
+                // The ExeFS header stores the section hashes in reverse order
+                CodeCacheKey cache_key{};
+                std::memcpy(cache_key.section_hash.data(),
+                            exefs_header.hashes[kMaxSections - 1 - section_number],
+                            cache_key.section_hash.size());
+                // Homebrew may leave the hashes empty, which says nothing about the contents.
+                const bool use_cache = Settings::values.cache_decompressed_code.GetValue() &&
+                                       cache_key.section_hash != SectionHash{};
+                if (use_cache) {
+                    // Hashing the section is much cheaper than decompressing it, and catches
+                    // sections that were patched without updating the ExeFS header.
+                    cache_key.compressed_size = temp_buffer.size();
+                    cache_key.compressed_hash =
+                        Common::ComputeHash64(temp_buffer.data(), temp_buffer.size());
+                    if (LoadCachedCode(ncch_header.program_id, cache_key, buffer))
+                        return Loader::ResultStatus::Success;
                 }
 
                 // Decompress .code section...
@@ -553,13 +610,16 @@ Loader::ResultStatus NCCHContainer::LoadSectionExeFS(const char* name, std::vect
                 if (!LZSS_Decompress(temp_buffer, buffer)) {
                     return Loader::ResultStatus::ErrorInvalidFormat;
                 }
+                if (use_cache) {
+                    StoreCachedCode(ncch_header.program_id, cache_key, buffer);
+                }
             } else {
                 // Section is uncompressed...
                 buffer.resize(section.size);
                 if (exefs_file.ReadBytes(buffer.data(), section.size) != section.size)
                     return Loader::ResultStatus::Error;
                 if (is_encrypted) {
-                    dec.ProcessData(buffer.data(), buffer.data(), section.size);
+                    cipher->Transform(exefs_ctr, crypto_offset, buffer.data(), section.size);
                 }
             }
 
@@ -7,6 +7,7 @@
 
 #include <cstddef>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include "common/bit_field.h"
@@ -221,6 +222,21 @@ static_assert(sizeof(ExHeader_Header) == 0x800, "ExHeader structure size is wron
 
 namespace FileSys {
 
+/**
+ * Get the decompressed size of an LZSS compressed ExeFS file
+ * @param buffer Buffer of compressed file
+ * @return Size of decompressed buffer, 0 if the buffer is too short to hold the size
+ */
+std::size_t LZSS_GetDecompressedSize(std::span<const u8> buffer);
+
+/**
+ * Decompress ExeFS file (compressed with LZSS)
+ * @param compressed Compressed buffer
+ * @param decompressed Decompressed buffer, of the size given by LZSS_GetDecompressedSize
+ * @return True on success, otherwise false
+ */
+bool LZSS_Decompress(std::span<const u8> compressed, std::span<u8> decompressed);
+
 /**
  * Helper which implements an interface to deal with NCCH containers which can
  * contain ExeFS archives or RomFS archives for games or other applications.
@@ -0,0 +1,59 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "core/file_sys/romfs_page_cache.h"
+
+namespace FileSys {
+
+RomFSPageCache::RomFSPageCache(std::size_t capacity_bytes)
+    : shard_capacity((capacity_bytes / page_size + num_shards - 1) / num_shards) {}
+
+RomFSPageCache::Page RomFSPageCache::Find(u64 page_offset) {
+    auto& shard = GetShard(page_offset);
+    std::scoped_lock lock{shard.mutex};
+    const auto it = shard.lookup.find(page_offset);
+    if (it == shard.lookup.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    shard.pages.splice(shard.pages.begin(), shard.pages, it->second);
+    return it->second->second;
+}
+
+bool RomFSPageCache::Contains(u64 page_offset) const {
+    const auto& shard = GetShard(page_offset);
+    std::scoped_lock lock{shard.mutex};
+    return shard.lookup.contains(page_offset);
+}
+
+void RomFSPageCache::Insert(u64 page_offset, Page page) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    auto& shard = GetShard(page_offset);
+    std::scoped_lock lock{shard.mutex};
+    if (const auto it = shard.lookup.find(page_offset); it != shard.lookup.end()) {
+        // Another reader cached the page first, keep its copy.
+        shard.pages.splice(shard.pages.begin(), shard.pages, it->second);
+        return;
+    }
+    if (shard.pages.size() >= shard_capacity) {
+        shard.lookup.erase(shard.pages.back().first);
+        shard.pages.pop_back();
+    }
+    shard.pages.emplace_front(page_offset, std::move(page));
+    shard.lookup.emplace(page_offset, shard.pages.begin());
+}
+
+void RomFSPageCache::Clear() {
+    for (auto& shard : shards) {
+        std::scoped_lock lock{shard.mutex};
+        shard.pages.clear();
+        shard.lookup.clear();
+    }
+}
+
+} // namespace FileSys
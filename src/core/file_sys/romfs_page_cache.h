@@ -0,0 +1,81 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * LRU cache of fixed size pages of a RomFS image, holding the data already decrypted. The cache is
+ * split into shards, each with its own lock, so concurrent readers only contend when they touch
+ * pages of the same shard. Consecutive pages land in different shards.
+ */
+class RomFSPageCache {
+public:
+    static constexpr std::size_t page_size = 8 * 1024;
+
+    /// Contents of a page. Only the last page of an image may be shorter than page_size.
+    using Page = std::shared_ptr<const std::vector<u8>>;
+
+    struct Stats {
+        u64 hits = 0;
+        u64 misses = 0;
+    };
+
+    /// A capacity smaller than a page disables the cache.
+    explicit RomFSPageCache(std::size_t capacity_bytes);
+
+    [[nodiscard]] bool IsEnabled() const {
+        return shard_capacity != 0;
+    }
+
+    /// Returns the page starting at page_offset, or nullptr if it is not cached.
+    Page Find(u64 page_offset);
+
+    /// Like Find, but does not count as an access.
+    [[nodiscard]] bool Contains(u64 page_offset) const;
+
+    /// Caches a page, evicting the least recently used page of its shard if the shard is full.
+    void Insert(u64 page_offset, Page page);
+
+    void Clear();
+
+    [[nodiscard]] Stats GetStats() const {
+        return {hits.load(std::memory_order_relaxed), misses.load(std::memory_order_relaxed)};
+    }
+
+private:
+    static constexpr std::size_t num_shards = 16;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        /// Most recently used first.
+        std::list<std::pair<u64, Page>> pages;
+        std::unordered_map<u64, std::list<std::pair<u64, Page>>::iterator> lookup;
+    };
+
+    Shard& GetShard(u64 page_offset) {
+        return shards[(page_offset / page_size) % num_shards];
+    }
+
+    const Shard& GetShard(u64 page_offset) const {
+        return shards[(page_offset / page_size) % num_shards];
+    }
+
+    std::array<Shard, num_shards> shards;
+    std::size_t shard_capacity;
+    std::atomic<u64> hits{0};
+    std::atomic<u64> misses{0};
+};
+
+} // namespace FileSys
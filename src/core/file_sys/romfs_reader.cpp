@@ -1,9 +1,11 @@
 #include <algorithm>
+#include <cstring>
 #include <vector>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
 #include "common/archives.h"
+#include "common/async_file_reader.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
+#include "core/core.h"
 #include "core/file_sys/archive_artic.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/romfs_reader.h"
@@ -14,81 +16,206 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+static std::size_t ConfiguredCacheSize() {
+    return static_cast<std::size_t>(Settings::values.romfs_cache_size.GetValue()) * 1024 * 1024;
+}
+
+DirectRomFSReader::DirectRomFSReader() : cache(ConfiguredCacheSize()) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size),
+      cache(ConfiguredCacheSize()) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr),
+      cipher(HW::AES::GetCTRCipher(key)), file_offset(file_offset), crypto_offset(crypto_offset),
+      data_size(data_size), cache(ConfiguredCacheSize()) {}
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
 
     const auto segments = BreakupRead(offset, length);
+    const bool sequential =
+        next_sequential_offset.exchange(offset + length, std::memory_order_relaxed) == offset;
     std::size_t read_progress = 0;
 
     // Skip cache if the read is too big
-    if (segments.size() == 1 && segments[0].second > cache_line_size) {
+    if (!cache.IsEnabled() || (segments.size() == 1 && segments[0].second > cache_line_size)) {
         length = file.ReadAtBytes(buffer, length, file_offset + offset);
-        if (is_encrypted) {
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-            d.Seek(crypto_offset + offset);
-            d.ProcessData(buffer, buffer, length);
-        }
+        Decrypt(buffer, length, offset);
         LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
         return length;
     }
 
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
+    u32 hits = 0;
+    u32 misses = 0;
     for (const auto& seg : segments) {
-        std::size_t read_size = cache_line_size;
         std::size_t page = OffsetToPage(seg.first);
         // Check if segment is in cache
-        auto cache_entry = cache.request(page);
-        if (!cache_entry.first) {
+        auto data = cache.Find(page);
+        if (!data) {
             // If not found, read from disk and cache the data
-            read_size = file.ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
-            if (is_encrypted && read_size) {
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-                d.Seek(crypto_offset + page);
-                d.ProcessData(cache_entry.second.data(), cache_entry.second.data(), read_size);
-            }
+            data = LoadPages(page, sequential ? read_ahead_pages : 1);
+            misses++;
             LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
         } else {
+            hits++;
             LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
         }
+        const std::size_t read_size = data->size();
         std::size_t copy_amount =
             (read_size > (seg.first - page))
                 ? std::min((seg.first - page) + seg.second, read_size) - (seg.first - page)
                 : 0;
-        std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
-                    copy_amount);
+        std::memcpy(buffer + read_progress, data->data() + (seg.first - page), copy_amount);
         read_progress += copy_amount;
     }
+    Core::System::GetInstance().ReportRomFSCacheAccess(hits, misses);
     return read_progress;
 }
 
+RomFSPageCache::Page DirectRomFSReader::LoadPages(std::size_t page, std::size_t count) {
+    // Pages already in the cache are not read again, so the decrypted data of a page is only
+    // produced once while it stays cached.
+    std::size_t num_pages = 1;
+    while (num_pages < count && page + num_pages * cache_line_size < data_size &&
+           !cache.Contains(page + num_pages * cache_line_size)) {
+        num_pages++;
+    }
+
+    const std::size_t length = std::min<std::size_t>(num_pages * cache_line_size,
+                                                     static_cast<std::size_t>(data_size) - page);
+    std::vector<u8> data(length);
+    std::size_t read_size = file.ReadAtBytes(data.data(), length, file_offset + page);
+    if (read_size > length) {
+        // The file is not open.
+        read_size = 0;
+    }
+    Decrypt(data.data(), read_size, page);
+    return InsertPages(page, data, read_size);
+}
+
+void DirectRomFSReader::Decrypt(u8* data, std::size_t length, std::size_t offset) const {
+    if (!is_encrypted || length == 0) {
+        return;
+    }
+    cipher->Transform(ctr, crypto_offset + offset, data, length);
+}
+
+RomFSPageCache::Page DirectRomFSReader::InsertPages(std::size_t page, const std::vector<u8>& data,
+                                                    std::size_t read_size) {
+    if (read_size == 0) {
+        return std::make_shared<const std::vector<u8>>();
+    }
+
+    RomFSPageCache::Page first_page;
+    for (std::size_t start = 0; start < read_size; start += cache_line_size) {
+        const std::size_t end = std::min(start + cache_line_size, read_size);
+        auto contents =
+            std::make_shared<const std::vector<u8>>(data.begin() + start, data.begin() + end);
+        if (start == 0) {
+            first_page = contents;
+        }
+        cache.Insert(page + start, std::move(contents));
+    }
+    return first_page;
+}
+
 bool DirectRomFSReader::AllowsCachedReads() const {
     return true;
 }
 
+bool DirectRomFSReader::SupportsAsyncRead() const {
+    // Compressed images are decompressed on the CPU, the threaded reader has no advantage over the
+    // service's own async section there.
+    return FileUtil::AsyncFileReader::Get().GetBackend() ==
+               FileUtil::AsyncFileReader::Backend::IoUring &&
+           !file.IsCompressed();
+}
+
+void DirectRomFSReader::ReadFileAsync(std::size_t offset, std::size_t length, u8* buffer,
+                                      ReadCallback callback) {
+    length = std::min(length, static_cast<std::size_t>(data_size) - offset);
+    if (length == 0 || CacheReady(offset, length)) {
+        callback(ReadFile(offset, length, buffer));
+        return;
+    }
+
+    const bool sequential =
+        next_sequential_offset.exchange(offset + length, std::memory_order_relaxed) == offset;
+
+    // Same policy as ReadFile: big reads go straight to the buffer, small ones through the cache.
+    if (!cache.IsEnabled() || length > cache_line_size) {
+        FileUtil::AsyncFileReader::Get().Submit({
+            &file,
+            buffer,
+            length,
+            file_offset + offset,
+            [this, buffer, offset, callback = std::move(callback)](s64 result) {
+                if (result < 0) {
+                    LOG_ERROR(Service_FS, "RomFS read at offset {:#x} failed: {}", offset,
+                              std::strerror(static_cast<int>(-result)));
+                    callback(ResultUnknown);
+                    return;
+                }
+                const auto read_size = static_cast<std::size_t>(result);
+                Decrypt(buffer, read_size, offset);
+                callback(read_size);
+            },
+        });
+        return;
+    }
+
+    // The pages covering the read, extended by the read-ahead when the access is sequential.
+    const std::size_t first_page = OffsetToPage(offset);
+    const std::size_t num_pages = std::max<std::size_t>(
+        (OffsetToPage(offset + length - 1) - first_page) / cache_line_size + 1,
+        sequential ? read_ahead_pages : 1);
+    const std::size_t read_length = std::min<std::size_t>(
+        num_pages * cache_line_size, static_cast<std::size_t>(data_size) - first_page);
+    auto data = std::make_shared<std::vector<u8>>(read_length);
+
+    FileUtil::AsyncFileReader::Get().Submit({
+        &file,
+        data->data(),
+        read_length,
+        file_offset + first_page,
+        [this, data, first_page, offset, length, buffer,
+         callback = std::move(callback)](s64 result) {
+            Core::System::GetInstance().ReportRomFSCacheAccess(0, 1);
+            if (result < 0) {
+                LOG_ERROR(Service_FS, "RomFS read at offset {:#x} failed: {}", first_page,
+                          std::strerror(static_cast<int>(-result)));
+                callback(ResultUnknown);
+                return;
+            }
+            const auto read_size = static_cast<std::size_t>(result);
+            Decrypt(data->data(), read_size, first_page);
+            InsertPages(first_page, *data, read_size);
+
+            const std::size_t into = offset - first_page;
+            std::size_t copy_amount = read_size > into ? std::min(length, read_size - into) : 0;
+            std::memcpy(buffer, data->data() + into, copy_amount);
+            callback(copy_amount);
+        },
+    });
+}
+
 bool DirectRomFSReader::CacheReady(std::size_t file_offset, std::size_t length) {
     auto segments = BreakupRead(file_offset, length);
-    if (segments.size() == 1 && segments[0].second > cache_line_size) {
+    if (!cache.IsEnabled() || (segments.size() == 1 && segments[0].second > cache_line_size)) {
         return false;
-    } else {
-        // TODO(PabloMK7): Since the LRU cache is not thread safe, a lock must be used.
-        // However, this completely breaks the point of using a cache, because
-        // smaller reads may be blocked by bigger reads. For now, always return
-        // data being in cache to prevent the need of a lock, and only read data
-        // asynchronously if it is too big to use the cache.
-        /*
-        std::shared_lock<std::shared_mutex> read_guard(cache_mutex);
-        for (auto it = segments.begin(); it != segments.end(); it++) {
-            if (!cache.contains(OffsetToPage(it->first)))
-                return false;
-        }
-        */
-        return true;
     }
+    return std::all_of(segments.begin(), segments.end(), [this](const auto& segment) {
+        return cache.Contains(OffsetToPage(segment.first));
+    });
 }
 
 std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
@@ -1,15 +1,18 @@
 #pragma once
 
 #include <array>
-#include <shared_mutex>
+#include <atomic>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "common/static_lru_cache.h"
+#include "common/unique_function.h"
 #include "core/file_sys/artic_cache.h"
+#include "core/file_sys/romfs_page_cache.h"
+#include "core/hle/result.h"
+#include "core/hw/aes/cipher.h"
 #include "network/artic_base/artic_base_client.h"
 
 namespace Loader {
@@ -30,6 +33,20 @@ public:
     virtual bool AllowsCachedReads() const = 0;
     virtual bool CacheReady(std::size_t file_offset, std::size_t length) = 0;
 
+    /// Receives the number of bytes read, or an error if the host read failed.
+    using ReadCallback = Common::UniqueFunction<void, ResultVal<std::size_t>>;
+
+    /// Whether ReadFileAsync completes reads without blocking the calling thread.
+    virtual bool SupportsAsyncRead() const {
+        return false;
+    }
+
+    /// Reads like ReadFile and passes the result to callback, possibly from another thread.
+    virtual void ReadFileAsync(std::size_t offset, std::size_t length, u8* buffer,
+                               ReadCallback callback) {
+        callback(ReadFile(offset, length, buffer));
+    }
+
 private:
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {}
@@ -41,15 +58,11 @@ private:
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
     ~DirectRomFSReader() override = default;
 
@@ -63,29 +76,54 @@ public:
 
     bool CacheReady(std::size_t file_offset, std::size_t length) override;
 
+    bool SupportsAsyncRead() const override;
+
+    void ReadFileAsync(std::size_t offset, std::size_t length, u8* buffer,
+                       ReadCallback callback) override;
+
 private:
     bool is_encrypted;
     FileUtil::IOFile file;
     std::array<u8, 16> key;
     std::array<u8, 16> ctr;
+    /// Expanded from key once, instead of on every cache miss.
+    std::shared_ptr<const HW::AES::CTRCipher> cipher;
     u64 file_offset;
     u64 crypto_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
-    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    static constexpr std::size_t cache_line_size = RomFSPageCache::page_size;
+    /// Number of pages read with a single request when a miss follows a sequential read.
+    static constexpr std::size_t read_ahead_pages = 8;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::shared_mutex cache_mutex;
+    RomFSPageCache cache;
+    /// End of the previous read, used to detect sequential access.
+    std::atomic<u64> next_sequential_offset{0};
 
-    DirectRomFSReader() = default;
+    DirectRomFSReader();
 
     std::size_t OffsetToPage(std::size_t offset) {
         return Common::AlignDown<std::size_t>(offset, cache_line_size);
     }
 
+    /**
+     * Reads and decrypts up to count pages starting at page, stopping early at pages that are
+     * already cached, and inserts them into the cache.
+     * @returns The first page read.
+     */
+    RomFSPageCache::Page LoadPages(std::size_t page, std::size_t count);
+
+    /// Decrypts data read from offset in place.
+    void Decrypt(u8* data, std::size_t length, std::size_t offset) const;
+
+    /**
+     * Splits read_size bytes of decrypted data starting at page into pages and inserts them into
+     * the cache.
+     * @returns The first page.
+     */
+    RomFSPageCache::Page InsertPages(std::size_t page, const std::vector<u8>& data,
+                                     std::size_t read_size);
+
     std::vector<std::pair<std::size_t, std::size_t>> BreakupRead(std::size_t offset,
                                                                  std::size_t length);
 
@@ -99,6 +137,9 @@ private:
         ar & file_offset;
         ar & crypto_offset;
         ar & data_size;
+        if (Archive::is_loading::value && is_encrypted) {
+            cipher = HW::AES::GetCTRCipher(key);
+        }
     }
     friend class boost::serialization::access;
 };
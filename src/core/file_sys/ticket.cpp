@@ -46,12 +46,14 @@ std::optional<std::array<u8, 16>> Ticket::GetTitleKey() const {
     HW::AES::InitKeys();
     std::array<u8, 16> ctr{};
     std::memcpy(ctr.data(), &ticket_body.title_id, sizeof(u64));
-    HW::AES::SelectCommonKeyIndex(ticket_body.common_key_index);
-    if (!HW::AES::IsNormalKeyAvailable(HW::AES::KeySlotID::TicketCommonKey)) {
+    // Tickets of CIAs installed at the same time are decrypted on different threads, so the
+    // common key is generated without selecting it into the shared key slot.
+    const auto common_key = HW::AES::GenerateCommonKey(ticket_body.common_key_index);
+    if (!common_key) {
         LOG_ERROR(Service_FS, "CommonKey {} missing", ticket_body.common_key_index);
         return {};
     }
-    auto key = HW::AES::GetNormalKey(HW::AES::KeySlotID::TicketCommonKey);
+    const auto& key = *common_key;
     auto title_key = ticket_body.title_key;
     CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption{key.data(), key.size(), ctr.data()}.ProcessData(
         title_key.data(), title_key.data(), title_key.size());
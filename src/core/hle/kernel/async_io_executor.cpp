@@ -0,0 +1,217 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fmt/format.h>
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/kernel/async_io_executor.h"
+
+namespace Kernel {
+
+/// Upper bound for queues whose work may block, only there to contain runaway guests.
+constexpr std::size_t MaxBlockingThreadsPerQueue = 64;
+
+struct AsyncIOExecutor::Task {
+    enum class State { Queued, Running, Done, Cancelled };
+
+    std::mutex mutex;
+    std::condition_variable state_changed;
+    State state = State::Queued;
+    Common::UniqueFunction<void> work;
+    /// Set instead of work for requests queued with SubmitDeferred.
+    Common::UniqueFunction<void, Completion> start;
+    Clock::time_point submit_time;
+};
+
+struct AsyncIOExecutor::Queue {
+    bool may_block;
+    std::priority_queue<QueuedTask> pending;
+    std::condition_variable work_available;
+    std::vector<std::jthread> threads;
+    std::size_t idle_threads = 0;
+    bool stopping = false;
+    QueueStats stats;
+};
+
+AsyncIOExecutor::TaskHandle::TaskHandle(std::shared_ptr<Task> task_) : task(std::move(task_)) {}
+
+AsyncIOExecutor::TaskHandle::~TaskHandle() {
+    if (!task) {
+        return;
+    }
+    std::unique_lock lock{task->mutex};
+    if (task->state == Task::State::Queued) {
+        task->state = Task::State::Cancelled;
+        return;
+    }
+    task->state_changed.wait(lock, [this] {
+        return task->state == Task::State::Done || task->state == Task::State::Cancelled;
+    });
+}
+
+AsyncIOExecutor::AsyncIOExecutor(std::size_t max_threads_per_queue_)
+    : max_threads_per_queue(max_threads_per_queue_) {}
+
+AsyncIOExecutor::~AsyncIOExecutor() {
+    decltype(queues) stopped_queues;
+    {
+        std::unique_lock lock{mutex};
+        // Their completions reference the queues.
+        deferred_done.wait(lock, [this] { return running_deferred == 0; });
+
+        for (auto& [name, queue] : queues) {
+            queue->stopping = true;
+            queue->work_available.notify_all();
+
+            // Requests that never started are dropped, release whoever waits on them.
+            while (!queue->pending.empty()) {
+                const auto task = queue->pending.top().task;
+                queue->pending.pop();
+                std::scoped_lock task_lock{task->mutex};
+                task->state = Task::State::Cancelled;
+                task->state_changed.notify_all();
+            }
+
+            const auto& stats = queue->stats;
+            if (stats.completed != 0) {
+                using std::chrono::microseconds;
+                const auto to_us = [](Clock::duration duration) {
+                    return std::chrono::duration_cast<microseconds>(duration).count();
+                };
+                const auto completed = static_cast<s64>(stats.completed);
+                LOG_INFO(Kernel,
+                         "Async queue {}: {} requests on {} threads, wait avg {} us max {} us, "
+                         "run avg {} us, max depth {}",
+                         name, stats.completed, queue->threads.size(),
+                         to_us(stats.total_wait) / completed, to_us(stats.max_wait),
+                         to_us(stats.total_run) / completed, stats.max_queue_depth);
+            }
+        }
+        stopped_queues = std::move(queues);
+    }
+    // Joins the worker threads, which need the lock to exit.
+    stopped_queues.clear();
+}
+
+AsyncIOExecutor::TaskHandle AsyncIOExecutor::Submit(std::string_view queue_name, bool may_block,
+                                                    u32 priority,
+                                                    Common::UniqueFunction<void> work) {
+    auto task = std::make_shared<Task>();
+    task->work = std::move(work);
+    return Enqueue(queue_name, may_block, priority, std::move(task));
+}
+
+AsyncIOExecutor::TaskHandle AsyncIOExecutor::SubmitDeferred(
+    std::string_view queue_name, bool may_block, u32 priority,
+    Common::UniqueFunction<void, Completion> start) {
+    auto task = std::make_shared<Task>();
+    task->start = std::move(start);
+    return Enqueue(queue_name, may_block, priority, std::move(task));
+}
+
+AsyncIOExecutor::TaskHandle AsyncIOExecutor::Enqueue(std::string_view queue_name, bool may_block,
+                                                     u32 priority, std::shared_ptr<Task> task) {
+    task->submit_time = Clock::now();
+
+    std::scoped_lock lock{mutex};
+    auto it = queues.find(queue_name);
+    if (it == queues.end()) {
+        auto queue = std::make_unique<Queue>();
+        queue->may_block = may_block;
+        queue->stats.name = queue_name;
+        it = queues.emplace(std::string(queue_name), std::move(queue)).first;
+    }
+    Queue& queue = *it->second;
+
+    queue.pending.push({priority, next_sequence++, task});
+    queue.stats.submitted++;
+    queue.stats.max_queue_depth = std::max(queue.stats.max_queue_depth, queue.pending.size());
+
+    const std::size_t max_threads =
+        queue.may_block ? MaxBlockingThreadsPerQueue : max_threads_per_queue;
+    if (queue.idle_threads < queue.pending.size() && queue.threads.size() < max_threads) {
+        queue.threads.emplace_back([this, &queue] { WorkerLoop(queue); });
+    } else {
+        queue.work_available.notify_one();
+    }
+    return TaskHandle(std::move(task));
+}
+
+std::vector<AsyncIOExecutor::QueueStats> AsyncIOExecutor::GetStats() const {
+    std::scoped_lock lock{mutex};
+    std::vector<QueueStats> stats;
+    stats.reserve(queues.size());
+    for (const auto& [name, queue] : queues) {
+        auto& queue_stats = stats.emplace_back(queue->stats);
+        queue_stats.queue_depth = queue->pending.size();
+        queue_stats.num_threads = queue->threads.size();
+    }
+    return stats;
+}
+
+void AsyncIOExecutor::WorkerLoop(Queue& queue) {
+    std::unique_lock lock{mutex};
+    Common::SetCurrentThreadName(fmt::format("AsyncIO:{}", queue.stats.name).c_str());
+
+    while (true) {
+        queue.idle_threads++;
+        queue.work_available.wait(lock,
+                                  [&queue] { return queue.stopping || !queue.pending.empty(); });
+        queue.idle_threads--;
+        if (queue.stopping) {
+            return;
+        }
+
+        const auto task = queue.pending.top().task;
+        queue.pending.pop();
+        {
+            std::scoped_lock task_lock{task->mutex};
+            if (task->state == Task::State::Cancelled) {
+                queue.stats.cancelled++;
+                continue;
+            }
+            task->state = Task::State::Running;
+        }
+
+        const auto start_time = Clock::now();
+        const auto wait = start_time - task->submit_time;
+        queue.stats.total_wait += wait;
+        queue.stats.max_wait = std::max(queue.stats.max_wait, wait);
+
+        if (task->start) {
+            running_deferred++;
+            lock.unlock();
+            auto start = std::move(task->start);
+            start([this, &queue, task, start_time] {
+                std::scoped_lock completion_lock{mutex};
+                FinishTask(queue, *task, start_time);
+                if (--running_deferred == 0) {
+                    deferred_done.notify_all();
+                }
+            });
+            lock.lock();
+            continue;
+        }
+
+        lock.unlock();
+        task->work();
+        // Release whatever the work captured before anyone waiting on the task is released.
+        task->work = Common::UniqueFunction<void>{};
+        lock.lock();
+
+        FinishTask(queue, *task, start_time);
+    }
+}
+
+void AsyncIOExecutor::FinishTask(Queue& queue, Task& task, Clock::time_point start_time) {
+    queue.stats.completed++;
+    queue.stats.total_run += Clock::now() - start_time;
+
+    std::scoped_lock task_lock{task.mutex};
+    task.state = Task::State::Done;
+    task.state_changed.notify_all();
+}
+
+} // namespace Kernel
@@ -0,0 +1,132 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+
+namespace Kernel {
+
+/**
+ * Runs the asynchronous sections of HLE service requests (see HLERequestContext::RunAsync) on
+ * persistent host threads instead of starting a thread per request.
+ *
+ * Each service submits to its own named queue. Queues start their threads on demand and keep them
+ * for later requests. Within a queue, requests from higher priority guest threads run first, and
+ * requests of the same priority run in submission order. Queues whose work always completes, like
+ * file reads, are limited to a few threads. Queues whose work may block indefinitely, like socket
+ * operations, keep starting threads as long as every thread is busy, since a queued request could
+ * otherwise wait forever behind a blocked one.
+ */
+class AsyncIOExecutor {
+    struct Task;
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct QueueStats {
+        std::string name;
+        u64 submitted = 0;
+        u64 completed = 0;
+        u64 cancelled = 0;
+        /// Requests waiting for a thread.
+        std::size_t queue_depth = 0;
+        std::size_t max_queue_depth = 0;
+        std::size_t num_threads = 0;
+        /// Time requests spent waiting for a thread.
+        Clock::duration total_wait{};
+        Clock::duration max_wait{};
+        /// Time spent running requests.
+        Clock::duration total_run{};
+    };
+
+    /**
+     * Owns a submitted request. Destroying the handle cancels the request if it has not started
+     * yet, and waits for it to finish otherwise, so whatever the request references can be freed
+     * afterwards.
+     */
+    class TaskHandle {
+    public:
+        TaskHandle() = default;
+        explicit TaskHandle(std::shared_ptr<Task> task);
+        ~TaskHandle();
+
+        TaskHandle(TaskHandle&&) = default;
+        TaskHandle& operator=(TaskHandle&&) = default;
+
+    private:
+        std::shared_ptr<Task> task;
+    };
+
+    explicit AsyncIOExecutor(std::size_t max_threads_per_queue);
+    ~AsyncIOExecutor();
+
+    AsyncIOExecutor(const AsyncIOExecutor&) = delete;
+    AsyncIOExecutor& operator=(const AsyncIOExecutor&) = delete;
+
+    /**
+     * Queues work to run on a host thread.
+     * @param queue_name Name of the queue, requests of one service share a queue.
+     * @param may_block Whether work on this queue may block indefinitely.
+     * @param priority Priority of the requesting guest thread, lower values run first.
+     */
+    [[nodiscard]] TaskHandle Submit(std::string_view queue_name, bool may_block, u32 priority,
+                                    Common::UniqueFunction<void> work);
+
+    /// Signals the end of work queued with SubmitDeferred. May be called from any thread.
+    using Completion = Common::UniqueFunction<void>;
+
+    /**
+     * Queues work that only starts an operation completing elsewhere, like a read submitted to the
+     * host kernel. The thread is released as soon as start returns, while the request counts as
+     * running until the completion it receives is called.
+     */
+    [[nodiscard]] TaskHandle SubmitDeferred(std::string_view queue_name, bool may_block,
+                                            u32 priority,
+                                            Common::UniqueFunction<void, Completion> start);
+
+    [[nodiscard]] std::vector<QueueStats> GetStats() const;
+
+private:
+    struct Queue;
+
+    struct QueuedTask {
+        u32 priority;
+        u64 sequence;
+        std::shared_ptr<Task> task;
+
+        bool operator<(const QueuedTask& other) const {
+            // std::priority_queue pops the largest element first.
+            return std::tie(priority, sequence) > std::tie(other.priority, other.sequence);
+        }
+    };
+
+    TaskHandle Enqueue(std::string_view queue_name, bool may_block, u32 priority,
+                       std::shared_ptr<Task> task);
+    void WorkerLoop(Queue& queue);
+    /// Records a finished request and releases whoever waits on it. Must hold mutex.
+    void FinishTask(Queue& queue, Task& task, Clock::time_point start_time);
+
+    mutable std::mutex mutex;
+    /// Signalled when the last deferred request completes.
+    std::condition_variable deferred_done;
+    std::size_t running_deferred = 0;
+    std::map<std::string, std::unique_ptr<Queue>, std::less<>> queues;
+    std::size_t max_threads_per_queue;
+    u64 next_sequence = 0;
+};
+
+} // namespace Kernel
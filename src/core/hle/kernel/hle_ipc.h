@@ -12,6 +12,7 @@
 #include <future>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 #include <boost/serialization/export.hpp>
@@ -20,6 +21,7 @@
 #include "common/settings.h"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
+#include "core/hle/kernel/async_io_executor.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
 
@@ -70,6 +72,18 @@ public:
      */
     virtual void ClientDisconnected(std::shared_ptr<ServerSession> server_session);
 
+    /// Where the asynchronous sections of this handler's requests run, see RunAsync.
+    struct AsyncQueueInfo {
+        /// Requests of handlers returning the same name share a queue and its threads.
+        std::string_view name;
+        /// Whether async sections may block indefinitely, e.g. waiting on a socket.
+        bool may_block;
+    };
+
+    virtual AsyncQueueInfo GetAsyncQueue() const {
+        return {"HLE", false};
+    }
+
     /// Empty placeholder structure for services with no per-session data. The session data classes
     /// in each service must inherit from this.
     struct SessionDataBase {
@@ -264,10 +278,8 @@ private:
     class AsyncWakeUpCallback : public WakeupCallback {
     public:
         explicit AsyncWakeUpCallback(KernelSystem& kernel, ResultFunctor res_functor,
-                                     std::future<void> fut)
-            : kernel(kernel), functor(res_functor) {
-            future = std::move(fut);
-        }
+                                     AsyncIOExecutor::TaskHandle task)
+            : kernel(kernel), functor(res_functor), task(std::move(task)) {}
 
         void WakeUp(std::shared_ptr<Kernel::Thread> thread, Kernel::HLERequestContext& ctx,
                     Kernel::ThreadWakeupReason reason) override {
@@ -282,7 +294,7 @@ private:
     private:
         KernelSystem& kernel;
         ResultFunctor functor;
-        std::future<void> future;
+        AsyncIOExecutor::TaskHandle task;
     };
 
 public:
@@ -293,7 +305,8 @@ public:
      * while the one performing the blocking operation waits.
      * @param async_section Callable that takes Kernel::HLERequestContext& as argument
      * and returns the amount of nanoseconds to wait before calling result_function.
-     * This callable is ran asynchronously.
+     * This callable is ran asynchronously on the kernel's AsyncIOExecutor, in the queue of the
+     * session's handler.
      * @param result_function Callable that takes Kernel::HLERequestContext& as argument
      * and doesn't return anything. This callable is ran from the emulator thread
      * and can be used to set the IPC result.
@@ -306,21 +319,22 @@ public:
 
         if (!Settings::values.deterministic_async_operations && really_async) {
             kernel.ReportAsyncState(true);
-            this->SleepClientThread(
-                "RunAsync", std::chrono::nanoseconds(-1),
-                std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
-                    kernel, result_function,
-                    std::move(std::async(std::launch::async, [this, async_section] {
-                        s64 sleep_for = async_section(*this);
-                        this->thread->WakeAfterDelay(sleep_for, true);
-                    }))));
+            const auto queue = session->hle_handler->GetAsyncQueue();
+            auto task = kernel.GetAsyncIOExecutor().Submit(
+                queue.name, queue.may_block, thread->GetPriority(), [this, async_section] {
+                    s64 sleep_for = async_section(*this);
+                    this->thread->WakeAfterDelay(sleep_for, true);
+                });
+            this->SleepClientThread("RunAsync", std::chrono::nanoseconds(-1),
+                                    std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                        kernel, result_function, std::move(task)));
 
         } else {
             s64 sleep_for = async_section(*this);
             if (sleep_for > 0) {
                 kernel.ReportAsyncState(true);
                 auto parallel_wakeup = std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
-                    kernel, result_function, std::move(std::future<void>()));
+                    kernel, result_function, AsyncIOExecutor::TaskHandle());
                 this->SleepClientThread("RunAsync", std::chrono::nanoseconds(sleep_for),
                                         parallel_wakeup);
             } else {
@@ -329,6 +343,44 @@ public:
         }
     }
 
+    /// Called once an operation started by RunAsyncIO is done, with the amount of nanoseconds to
+    /// wait before calling result_function.
+    using AsyncIODone = Common::UniqueFunction<void, s64>;
+
+    /**
+     * Like RunAsync, for operations that complete on their own, like reads submitted to an
+     * AsyncFileReader. No host thread is held while the operation is in flight.
+     * @param start_section Callable that takes Kernel::HLERequestContext& and an AsyncIODone. It
+     * starts the operation, which must call the AsyncIODone exactly once, from any thread.
+     * @param result_function Callable that takes Kernel::HLERequestContext& as argument
+     * and doesn't return anything. This callable is ran from the emulator thread.
+     */
+    template <typename StartFunctor, typename ResultFunctor>
+    void RunAsyncIO(StartFunctor start_section, ResultFunctor result_function) {
+        if (Settings::values.deterministic_async_operations) {
+            std::promise<s64> done;
+            start_section(*this, [&done](s64 sleep_for) { done.set_value(sleep_for); });
+            RunAsync([sleep_for = done.get_future().get()](
+                         Kernel::HLERequestContext&) { return sleep_for; },
+                     result_function, false);
+            return;
+        }
+
+        kernel.ReportAsyncState(true);
+        const auto queue = session->hle_handler->GetAsyncQueue();
+        auto task = kernel.GetAsyncIOExecutor().SubmitDeferred(
+            queue.name, queue.may_block, thread->GetPriority(),
+            [this, start_section](AsyncIOExecutor::Completion completion) {
+                start_section(*this, [this, completion = std::move(completion)](s64 sleep_for) {
+                    this->thread->WakeAfterDelay(sleep_for, true);
+                    completion();
+                });
+            });
+        this->SleepClientThread("RunAsyncIO", std::chrono::nanoseconds(-1),
+                                std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
+                                    kernel, result_function, std::move(task)));
+    }
+
     /**
      * Resolves a object id from the request command buffer into a pointer to an object. See the
      * "HLE handle protocol" section in the class documentation for more details.
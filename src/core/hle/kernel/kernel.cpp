@@ -3,11 +3,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/unordered_map.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/archives.h"
 #include "common/serialization/atomic.h"
+#include "core/hle/kernel/async_io_executor.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
@@ -42,6 +45,8 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
     }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    async_io_executor = std::make_unique<AsyncIOExecutor>(
+        std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 2, 4));
     stored_processes.assign(num_cores, nullptr);
 
     next_thread_id = 1;
@@ -108,6 +113,21 @@ void KernelSystem::SetRunningCPU(Core::ARM_Interface* cpu) {
     }
 }
 
+void KernelSystem::BindRunningCPU(Core::ARM_Interface* cpu) {
+    if (current_cpu == cpu) {
+        return;
+    }
+    if (current_process) {
+        stored_processes[current_cpu->GetID()] = current_process;
+    }
+    // Each host thread has its own timer bound while the cores run in parallel.
+    current_cpu = cpu;
+    if (const auto& process = stored_processes[current_cpu->GetID()]) {
+        current_process = process;
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+    }
+}
+
 ThreadManager& KernelSystem::GetThreadManager(u32 core_id) {
     return *thread_managers[core_id];
 }
@@ -152,6 +172,10 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+AsyncIOExecutor& KernelSystem::GetAsyncIOExecutor() {
+    return *async_io_executor;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
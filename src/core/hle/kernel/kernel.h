@@ -49,6 +49,7 @@ class Recorder;
 namespace Kernel {
 
 class AddressArbiter;
+class AsyncIOExecutor;
 class Event;
 class Mutex;
 class CodeSet;
@@ -286,6 +287,13 @@ public:
 
     void SetRunningCPU(Core::ARM_Interface* cpu);
 
+    /**
+     * Lightweight variant of SetRunningCPU used while the CPU cores execute in parallel. The core
+     * may be in the middle of executing guest code, so only the kernel side state is switched and
+     * the core's own page table is left untouched.
+     */
+    void BindRunningCPU(Core::ARM_Interface* cpu);
+
     ThreadManager& GetThreadManager(u32 core_id);
     const ThreadManager& GetThreadManager(u32 core_id) const;
 
@@ -305,6 +313,8 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    AsyncIOExecutor& GetAsyncIOExecutor();
+
     std::shared_ptr<MemoryRegionInfo> GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -374,6 +384,9 @@ private:
 
     std::atomic<int> pending_async_operations{};
 
+    // Destructed after the threads, whose pending requests may still be running on it.
+    std::unique_ptr<AsyncIOExecutor> async_io_executor;
+
     // Note: keep the member order below in order to perform correct destruction.
     // Thread manager is destructed before process list in order to Stop threads and clear thread
     // info from their parent processes first. Timer manager is destructed after process list
@@ -4,17 +4,25 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
 #include <cstring>
-#include <cryptopp/aes.h>
-#include <cryptopp/modes.h>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <thread>
 #include <fmt/format.h>
 #include "common/alignment.h"
 #include "common/archives.h"
+#include "common/async_file_reader.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/string_util.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/ncch_container.h"
@@ -31,6 +39,8 @@
 #include "core/hle/service/am/am_u.h"
 #include "core/hle/service/fs/archive.h"
 #include "core/hle/service/fs/fs_user.h"
+#include "core/hw/aes/cipher.h"
+#include "core/hw/sha/sha.h"
 #include "core/loader/loader.h"
 #include "core/loader/smdh.h"
 #include "core/nus_download.h"
@@ -111,14 +121,201 @@ u32 CTCert::GetDeviceID() const {
     return 0;
 }
 
-class CIAFile::DecryptionState {
+namespace {
+
+// Content data is written out in blocks of this size, instead of in whatever pieces it arrives in.
+constexpr std::size_t CONTENT_WRITE_SIZE = 0x100000;
+// How much received content data a CIAFile may hold before writes to it wait for the pipeline.
+constexpr std::size_t MAX_BUFFERED_CONTENT = 0x2000000;
+
+/// Contents of every CIA being installed are decrypted, hashed and written out on these threads.
+Common::ThreadWorker& GetInstallWorkers() {
+    static Common::ThreadWorker workers(std::max(std::thread::hardware_concurrency(), 2U),
+                                        "CIAInstall");
+    return workers;
+}
+
+} // Anonymous namespace
+
+/**
+ * Processes the data of one content in order. Each content gets its own AES-CBC and SHA-256
+ * state, so different contents are processed on different threads at the same time.
+ */
+class CIAFile::ContentWriter {
 public:
-    std::vector<CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption> content;
+    ContentWriter(InstallPipeline& pipeline_, std::string path_,
+                  const std::array<u8, 0x20>& expected_hash_, bool keep_open_)
+        : pipeline{pipeline_}, path{std::move(path_)}, expected_hash{expected_hash_},
+          keep_open{keep_open_} {}
+
+    bool Open() {
+        file = FileUtil::IOFile(path, "wb");
+        if (!file.IsOpen()) {
+            return false;
+        }
+        if (!keep_open) {
+            file.Close();
+        }
+        write_buffer.reserve(CONTENT_WRITE_SIZE);
+        return true;
+    }
+
+    void SetKey(const std::array<u8, 16>& key, const std::array<u8, 16>& ctr) {
+        decryption.emplace(key, ctr);
+    }
+
+    /// Queues data following what was pushed before. The last piece also verifies the content.
+    void Push(std::vector<u8> data, bool last);
+
+    /// Waits for all pushed data to be processed.
+    void Wait() {
+        std::unique_lock lock{mutex};
+        idle.wait(lock, [this] { return !scheduled; });
+    }
+
+    /// Whether everything pushed so far was written out, and the content matched its hash.
+    bool Succeeded() const {
+        return !failed;
+    }
+
+private:
+    struct Piece {
+        std::vector<u8> data;
+        bool last;
+    };
+
+    void Drain();
+    void Process(Piece& piece);
+    void WriteOut();
+
+    InstallPipeline& pipeline;
+    std::string path;
+    std::array<u8, 0x20> expected_hash;
+    bool keep_open;
+
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::deque<Piece> pending;
+    bool scheduled = false;
+
+    // Only touched by the thread draining the queue.
+    FileUtil::IOFile file;
+    std::optional<HW::AES::CBCDecryptor> decryption;
+    HW::SHA::SHA256 sha;
+    std::vector<u8> write_buffer;
+    bool failed = false;
+};
+
+/// Limits how much content data is waiting to be processed, and owns the content writers.
+class CIAFile::InstallPipeline {
+public:
+    std::vector<std::unique_ptr<ContentWriter>> contents;
+
+    /// Waits until there is room for another size bytes of content data.
+    void Reserve(std::size_t size) {
+        std::unique_lock lock{mutex};
+        room.wait(lock, [this, size] {
+            return buffered == 0 || buffered + size <= MAX_BUFFERED_CONTENT;
+        });
+        buffered += size;
+    }
+
+    void Release(std::size_t size) {
+        {
+            std::scoped_lock lock{mutex};
+            buffered -= size;
+        }
+        room.notify_all();
+    }
+
+    /// Waits for every content to be processed, returns whether all of them succeeded.
+    bool Wait() {
+        bool succeeded = true;
+        for (auto& content : contents) {
+            content->Wait();
+            succeeded &= content->Succeeded();
+        }
+        return succeeded;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable room;
+    std::size_t buffered = 0;
 };
 
+void CIAFile::ContentWriter::Push(std::vector<u8> data, bool last) {
+    std::scoped_lock lock{mutex};
+    pending.push_back({std::move(data), last});
+    if (!scheduled) {
+        scheduled = true;
+        GetInstallWorkers().QueueWork([this] { Drain(); });
+    }
+}
+
+void CIAFile::ContentWriter::Drain() {
+    while (true) {
+        Piece piece;
+        {
+            std::scoped_lock lock{mutex};
+            if (pending.empty()) {
+                scheduled = false;
+                idle.notify_all();
+                return;
+            }
+            piece = std::move(pending.front());
+            pending.pop_front();
+        }
+        const std::size_t piece_size = piece.data.size();
+        Process(piece);
+        pipeline.Release(piece_size);
+    }
+}
+
+void CIAFile::ContentWriter::Process(Piece& piece) {
+    if (failed) {
+        return;
+    }
+
+    if (decryption) {
+        decryption->Decrypt(piece.data.data(), piece.data.size());
+    }
+    sha.Update(piece.data.data(), piece.data.size());
+
+    if (write_buffer.empty() && piece.data.size() >= CONTENT_WRITE_SIZE) {
+        std::swap(write_buffer, piece.data);
+    } else {
+        write_buffer.insert(write_buffer.end(), piece.data.begin(), piece.data.end());
+    }
+    if (write_buffer.size() >= CONTENT_WRITE_SIZE || piece.last) {
+        WriteOut();
+    }
+
+    if (piece.last && !failed) {
+        if (sha.Final() != expected_hash) {
+            LOG_ERROR(Service_AM, "Content {} does not match the hash in the title metadata.",
+                      path);
+            failed = true;
+        }
+    }
+}
+
+void CIAFile::ContentWriter::WriteOut() {
+    if (!keep_open) {
+        file = FileUtil::IOFile(path, "ab+");
+    }
+    if (file.WriteBytes(write_buffer.data(), write_buffer.size()) != write_buffer.size()) {
+        LOG_ERROR(Service_AM, "Could not write to content {}.", path);
+        failed = true;
+    }
+    if (!keep_open) {
+        file.Close();
+    }
+    write_buffer.clear();
+}
+
 CIAFile::CIAFile(Core::System& system_, Service::FS::MediaType media_type)
-    : system(system_), media_type(media_type),
-      decryption_state(std::make_unique<DecryptionState>()) {}
+    : system(system_), media_type(media_type), pipeline(std::make_unique<InstallPipeline>()) {}
 
 CIAFile::~CIAFile() {
     Close();
@@ -187,35 +384,33 @@ Result CIAFile::WriteTitleMetadata() {
     auto content_count = container.GetTitleMetadata().GetContentCount();
     content_written.resize(content_count);
 
-    content_files.clear();
-    for (std::size_t i = 0; i < content_count; i++) {
-        auto path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
-        auto& file = content_files.emplace_back(path, "wb");
-        if (!file.IsOpen()) {
-            LOG_ERROR(Service_AM, "Could not open output file '{}' for content {}.", path, i);
+    std::optional<std::array<u8, 16>> title_key;
+    if (tmd.HasEncryptedContent()) {
+        title_key = container.GetTicket().GetTitleKey();
+        if (!title_key) {
+            LOG_ERROR(Service_AM, "Could not read title key from ticket for encrypted CIA.");
             // TODO: Correct error code.
             return FileSys::ResultFileNotFound;
         }
-        if (content_count > MAX_CONTENT_COUNT)
-            file.Close();
+    } else {
+        LOG_INFO(Service_AM,
+                 "Title has no encrypted content, skipping initializing decryption state.");
     }
 
-    if (container.GetTitleMetadata().HasEncryptedContent()) {
-        if (auto title_key = container.GetTicket().GetTitleKey()) {
-            decryption_state->content.resize(content_count);
-            for (std::size_t i = 0; i < content_count; ++i) {
-                auto ctr = tmd.GetContentCTRByIndex(i);
-                decryption_state->content[i].SetKeyWithIV(title_key->data(), title_key->size(),
-                                                          ctr.data());
-            }
-        } else {
-            LOG_ERROR(Service_AM, "Could not read title key from ticket for encrypted CIA.");
+    pipeline->Wait();
+    pipeline->contents.clear();
+    for (std::size_t i = 0; i < content_count; i++) {
+        auto path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
+        auto& content = pipeline->contents.emplace_back(std::make_unique<ContentWriter>(
+            *pipeline, path, tmd.GetContentHashByIndex(i), content_count <= MAX_CONTENT_COUNT));
+        if (!content->Open()) {
+            LOG_ERROR(Service_AM, "Could not open output file '{}' for content {}.", path, i);
             // TODO: Correct error code.
             return FileSys::ResultFileNotFound;
         }
-    } else {
-        LOG_INFO(Service_AM,
-                 "Title has no encrypted content, skipping initializing decryption state.");
+        if ((tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0) {
+            content->SetKey(*title_key, tmd.GetContentCTRByIndex(i));
+        }
     }
 
     install_state = CIAInstallState::TMDLoaded;
@@ -243,34 +438,23 @@ ResultVal<std::size_t> CIAFile::WriteContentData(u64 offset, std::size_t length,
 
             // Figure out how much of this content ID we have just recieved/can write out
             const u64 available_to_write = std::min(offset_max, range_max) - range_min;
-
-            // Since the incoming TMD has already been written, we can use GetTitleContentPath
-            // to get the content paths to write to.
-            FileSys::TitleMetadata tmd = container.GetTitleMetadata();
-            auto& file = content_files[i];
-            if (content_written.size() > MAX_CONTENT_COUNT) {
-                auto path = GetTitleContentPath(media_type, tmd.GetTitleID(), i, is_update);
-                FileUtil::IOFile fp(path, "ab+");
-                file = std::move(fp);
+            if (available_to_write == 0) {
+                continue;
             }
 
             std::vector<u8> temp(buffer + (range_min - offset),
                                  buffer + (range_min - offset) + available_to_write);
 
-            if ((tmd.GetContentTypeByIndex(i) & FileSys::TMDContentTypeFlag::Encrypted) != 0) {
-                decryption_state->content[i].ProcessData(temp.data(), temp.data(), temp.size());
-            }
-
-            file.WriteBytes(temp.data(), temp.size());
-
             // Keep tabs on how much of this content ID has been written so new range_min
             // values can be calculated.
             content_written[i] += available_to_write;
-            LOG_DEBUG(Service_AM, "Wrote {:x} to content {}, total {:x}", available_to_write, i,
+            LOG_DEBUG(Service_AM, "Queued {:x} for content {}, total {:x}", available_to_write, i,
                       content_written[i]);
-            if (content_written.size() > MAX_CONTENT_COUNT) {
-                file.Close();
-            }
+
+            // Decryption, hashing and writing happen on the install workers, which hold on to
+            // the data until then. Wait here if they have fallen too far behind.
+            pipeline->Reserve(temp.size());
+            pipeline->contents[i]->Push(std::move(temp), content_written[i] >= size);
         }
     }
 
@@ -360,6 +544,7 @@ bool CIAFile::SetSize(u64 size) const {
 }
 
 bool CIAFile::Close() {
+    const bool contents_ok = pipeline->Wait();
     bool complete =
         install_state >= CIAInstallState::TMDLoaded &&
         content_written.size() == container.GetTitleMetadata().GetContentCount() &&
@@ -371,10 +556,16 @@ bool CIAFile::Close() {
     // Install aborted
     if (!complete) {
         LOG_ERROR(Service_AM, "CIAFile closed prematurely, aborting install...");
-        FileUtil::DeleteDir(GetTitlePath(media_type, container.GetTitleMetadata().GetTitleID()));
+        AbortInstall();
         return true;
     }
 
+    if (!contents_ok) {
+        LOG_ERROR(Service_AM, "CIA contents could not be installed, aborting install...");
+        AbortInstall();
+        return false;
+    }
+
     // Clean up older content data if we installed newer content on top
     std::string old_tmd_path =
         GetTitleMetadataPath(media_type, container.GetTitleMetadata().GetTitleID(), false);
@@ -419,6 +610,33 @@ bool CIAFile::Close() {
 
 void CIAFile::Flush() const {}
 
+void CIAFile::AbortInstall() {
+    // Nothing was written before the TMD was loaded.
+    if (install_state < CIAInstallState::TMDLoaded) {
+        return;
+    }
+
+    // Close the content files before removing them.
+    pipeline->Wait();
+    pipeline->contents.clear();
+
+    // Remove the contents and the TMD of this install, the paths of the contents are looked up
+    // through the TMD. A version of the title installed before is left in place.
+    const u64 title_id = container.GetTitleMetadata().GetTitleID();
+    for (std::size_t i = 0; i < content_written.size(); i++) {
+        FileUtil::Delete(GetTitleContentPath(media_type, title_id, i, is_update));
+    }
+    FileUtil::Delete(GetTitleMetadataPath(media_type, title_id, is_update));
+
+    // These are only removed if nothing else is left in them.
+    const std::string title_path = GetTitlePath(media_type, title_id);
+    FileUtil::DeleteDir(title_path + "content/");
+    FileUtil::DeleteDir(title_path);
+
+    // Closing the file again must not remove what is installed now.
+    install_state = CIAInstallState::InstallStarted;
+}
+
 TicketFile::TicketFile() {}
 
 TicketFile::~TicketFile() {
@@ -458,7 +676,107 @@ bool TicketFile::Close() {
 
 void TicketFile::Flush() const {}
 
-InstallStatus InstallCIA(const std::string& path,
+namespace {
+
+// InstallCIA reads the CIA in blocks of this size, with this many blocks in flight at once.
+constexpr std::size_t CIA_READ_SIZE = 0x100000;
+constexpr std::size_t CIA_READ_AHEAD = 4;
+
+/// Reads a file front to back, reading the next few blocks while the current one is installed.
+class CIAReadAhead {
+public:
+    explicit CIAReadAhead(FileUtil::IOFile& file_) : file{file_}, size{file_.GetSize()} {
+        for (auto& block : blocks) {
+            block.data.resize(CIA_READ_SIZE);
+            Submit(block);
+        }
+    }
+
+    ~CIAReadAhead() {
+        // Reads still in flight write into the blocks.
+        for (auto& block : blocks) {
+            if (block.result.valid()) {
+                block.result.wait();
+            }
+        }
+    }
+
+    /// Returns the next block of the file, or an empty span at the end or if a read failed.
+    std::span<const u8> Next() {
+        // The block returned last time has been consumed, reuse it for the next read.
+        if (current) {
+            Submit(*current);
+        }
+        current = &blocks[next_block++ % blocks.size()];
+        if (!current->result.valid()) {
+            return {};
+        }
+        const s64 bytes_read = current->result.get();
+        if (bytes_read <= 0) {
+            return {};
+        }
+        return {current->data.data(), static_cast<std::size_t>(bytes_read)};
+    }
+
+private:
+    struct Block {
+        std::vector<u8> data;
+        std::future<s64> result;
+    };
+
+    void Submit(Block& block) {
+        if (submitted >= size) {
+            block.result = {};
+            return;
+        }
+        const std::size_t length = static_cast<std::size_t>(
+            std::min<u64>(block.data.size(), size - submitted));
+        std::promise<s64> promise;
+        block.result = promise.get_future();
+        FileUtil::AsyncFileReader::Get().Submit(
+            {&file, block.data.data(), length, submitted,
+             [promise = std::move(promise)](s64 bytes_read) mutable {
+                 promise.set_value(bytes_read);
+             }});
+        submitted += length;
+    }
+
+    FileUtil::IOFile& file;
+    u64 size;
+    u64 submitted = 0;
+    std::array<Block, CIA_READ_AHEAD> blocks;
+    Block* current = nullptr;
+    std::size_t next_block = 0;
+};
+
+/// Keeps two installs of the same title from running at the same time.
+class TitleInstallLock {
+public:
+    explicit TitleInstallLock(u64 title_id_) : title_id{title_id_} {
+        std::unique_lock lock{mutex};
+        released.wait(lock, [this] { return !installing.contains(title_id); });
+        installing.insert(title_id);
+    }
+
+    ~TitleInstallLock() {
+        {
+            std::scoped_lock lock{mutex};
+            installing.erase(title_id);
+        }
+        released.notify_all();
+    }
+
+private:
+    u64 title_id;
+
+    static inline std::mutex mutex;
+    static inline std::condition_variable released;
+    static inline std::set<u64> installing;
+};
+
+} // Anonymous namespace
+
+InstallStatus InstallCIA(Core::System& system, const std::string& path,
                          std::function<ProgressCallback>&& update_callback) {
     LOG_INFO(Service_AM, "Installing {}...", path);
 
@@ -469,9 +787,9 @@ InstallStatus InstallCIA(const std::string& path,
 
     FileSys::CIAContainer container;
     if (container.Load(path) == Loader::ResultStatus::Success) {
+        TitleInstallLock title_lock{container.GetTitleMetadata().GetTitleID()};
         Service::AM::CIAFile installFile(
-            Core::System::GetInstance(),
-            Service::AM::GetTitleMediaType(container.GetTitleMetadata().GetTitleID()));
+            system, Service::AM::GetTitleMediaType(container.GetTitleMetadata().GetTitleID()));
 
         bool title_key_available = container.GetTicket().GetTitleKey().has_value();
         if (!title_key_available && container.GetTitleMetadata().HasEncryptedContent()) {
@@ -486,13 +804,19 @@ InstallStatus InstallCIA(const std::string& path,
             return InstallStatus::ErrorFailedToOpenFile;
         }
 
-        std::array<u8, 0x10000> buffer;
+        // The next blocks are read while one is handed to the CIAFile, which in turn decrypts,
+        // hashes and writes out each content on the install workers.
+        CIAReadAhead reader{file};
         auto file_size = file.GetSize();
         std::size_t total_bytes_read = 0;
         while (total_bytes_read != file_size) {
-            std::size_t bytes_read = file.ReadBytes(buffer.data(), buffer.size());
-            auto result = installFile.Write(static_cast<u64>(total_bytes_read), bytes_read, true,
-                                            false, static_cast<u8*>(buffer.data()));
+            const auto block = reader.Next();
+            if (block.empty()) {
+                LOG_ERROR(Service_AM, "Could not read CIA file '{}'.", path);
+                return InstallStatus::ErrorAborted;
+            }
+            auto result = installFile.Write(static_cast<u64>(total_bytes_read), block.size(), true,
+                                            false, block.data());
 
             if (update_callback) {
                 update_callback(total_bytes_read, file_size);
@@ -502,19 +826,22 @@ InstallStatus InstallCIA(const std::string& path,
                           result.Code().raw);
                 return InstallStatus::ErrorAborted;
             }
-            total_bytes_read += bytes_read;
+            total_bytes_read += block.size();
+        }
+        if (!installFile.Close()) {
+            return InstallStatus::ErrorInvalid;
         }
-        installFile.Close();
 
         LOG_INFO(Service_AM, "Installed {} successfully.", path);
 
         const FileUtil::DirectoryEntryCallable callback =
-            [&callback](u64* num_entries_out, const std::string& directory,
-                        const std::string& virtual_name) -> bool {
+            [&system, &callback](u64* num_entries_out, const std::string& directory,
+                                 const std::string& virtual_name) -> bool {
             const std::string physical_name = directory + DIR_SEP + virtual_name;
             const bool is_dir = FileUtil::IsDirectory(physical_name);
             if (!is_dir) {
-                std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(physical_name);
+                std::unique_ptr<Loader::AppLoader> loader =
+                    Loader::GetLoader(system, physical_name);
                 if (!loader) {
                     return true;
                 }
@@ -545,6 +872,55 @@ InstallStatus InstallCIA(const std::string& path,
     return InstallStatus::ErrorInvalid;
 }
 
+std::vector<InstallStatus> InstallCIAs(Core::System& system, std::span<const std::string> paths,
+                                       std::function<ProgressCallback>&& update_callback,
+                                       std::function<InstallReportCallback>&& report_callback,
+                                       std::size_t max_parallel) {
+    if (max_parallel == 0) {
+        // Decryption and hashing already run on the install workers, the installs themselves
+        // mostly wait on the disk.
+        max_parallel = std::clamp<std::size_t>(std::thread::hardware_concurrency() / 2, 1, 4);
+    }
+
+    std::vector<InstallStatus> statuses(paths.size(), InstallStatus::ErrorAborted);
+    std::vector<std::size_t> file_written(paths.size());
+    std::size_t total_written = 0;
+    std::size_t total_size = 0;
+    for (const auto& path : paths) {
+        total_size += FileUtil::GetSize(path);
+    }
+
+    std::mutex callback_mutex;
+    std::atomic<std::size_t> next_path = 0;
+    const auto install_next = [&] {
+        for (std::size_t i = next_path++; i < paths.size(); i = next_path++) {
+            const auto progress = [&, i](std::size_t written, std::size_t) {
+                std::scoped_lock lock{callback_mutex};
+                total_written += written - file_written[i];
+                file_written[i] = written;
+                if (update_callback) {
+                    update_callback(total_written, total_size);
+                }
+            };
+            statuses[i] = InstallCIA(system, paths[i], progress);
+
+            std::scoped_lock lock{callback_mutex};
+            if (report_callback) {
+                report_callback(i, statuses[i]);
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t i = 1; i < std::min(max_parallel, paths.size()); ++i) {
+            threads.emplace_back(install_next);
+        }
+        install_next();
+    }
+    return statuses;
+}
+
 InstallStatus InstallFromNus(u64 title_id, int version) {
     LOG_DEBUG(Service_AM, "Downloading {:X}", title_id);
 
@@ -8,6 +8,7 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <boost/serialization/array.hpp>
@@ -117,10 +118,18 @@ public:
                                  const u8* buffer) override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
+
+    /**
+     * Waits for all content data to be written out and finalizes the install.
+     * @returns false if a content failed to be written or did not match its hash in the TMD
+     */
     bool Close() override;
     void Flush() const override;
 
 private:
+    /// Removes what was written of an install that did not complete.
+    void AbortInstall();
+
     Core::System& system;
 
     // Whether it's installing an update, and what step of installation it is at
@@ -134,11 +143,12 @@ private:
     FileSys::CIAContainer container;
     std::vector<u8> data;
     std::vector<u64> content_written;
-    std::vector<FileUtil::IOFile> content_files;
     Service::FS::MediaType media_type;
 
-    class DecryptionState;
-    std::unique_ptr<DecryptionState> decryption_state;
+    // Decrypts, hashes and writes out content data in the background.
+    class ContentWriter;
+    class InstallPipeline;
+    std::unique_ptr<InstallPipeline> pipeline;
 };
 
 // A file handled returned for Tickets to be written into and subsequently installed.
@@ -162,13 +172,33 @@ private:
 
 /**
  * Installs a CIA file from a specified file path.
+ * @param system the system the title is installed for
  * @param path file path of the CIA file to install
  * @param update_callback callback function called during filesystem write
  * @returns bool whether the install was successful
  */
-InstallStatus InstallCIA(const std::string& path,
+InstallStatus InstallCIA(Core::System& system, const std::string& path,
                          std::function<ProgressCallback>&& update_callback = nullptr);
 
+// Report callback for InstallCIAs, receives the index of the installed file and its status
+using InstallReportCallback = void(std::size_t, InstallStatus);
+
+/**
+ * Installs several CIA files, running a few installs at once. Installs of the same title are
+ * still performed one after the other.
+ * @param system the system the titles are installed for
+ * @param paths file paths of the CIA files to install
+ * @param update_callback callback function called with the bytes written and total bytes of all
+ * files combined
+ * @param report_callback callback function called as each install finishes
+ * @param max_parallel how many files to install at once, 0 picks a default based on the CPU
+ * @returns the status of each install, in the same order as paths
+ */
+std::vector<InstallStatus> InstallCIAs(
+    Core::System& system, std::span<const std::string> paths,
+    std::function<ProgressCallback>&& update_callback = nullptr,
+    std::function<InstallReportCallback>&& report_callback = nullptr, std::size_t max_parallel = 0);
+
 /**
  * Downloads and installs title form the Nintendo Update Service.
  * @param title_id the title_id to download
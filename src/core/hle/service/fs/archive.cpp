@@ -112,6 +112,8 @@ ArchiveManager::OpenFileFromArchive(ArchiveHandle archive_handle, const FileSys:
     }
 
     const std::chrono::nanoseconds open_timeout_ns{archive->GetOpenDelayNs()};
+    FileSys::FSTimingStats::Get().RecordOpen(archive->GetStorageDevice(),
+                                             static_cast<u64>(open_timeout_ns.count()));
     auto backend = archive->OpenFile(path, mode, attributes);
     if (backend.Failed()) {
         return std::make_pair(backend.Code(), open_timeout_ns);
@@ -7,6 +7,7 @@
 #include "common/archives.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/file_sys/errors.h"
 #include "core/file_sys/file_backend.h"
 #include "core/hle/ipc_helpers.h"
@@ -21,6 +22,21 @@ SERIALIZE_EXPORT_IMPL(Service::FS::FileSessionSlot)
 
 namespace Service::FS {
 
+namespace {
+
+/**
+ * Time a read takes on the storage device, including the wait for the reads issued before it.
+ * The wait is reserved when the request arrives, in emulated time.
+ */
+u64 ReserveReadDelayNs(Core::Timing& timing, FileSys::FileBackend& backend, std::size_t length) {
+    const u64 service_ns = backend.GetReadDelayNs(length);
+    const u64 wait_ticks = FileSys::DeviceQueue::Reserve(
+        backend.GetStorageDevice(), static_cast<u64>(nsToCycles(service_ns)), timing.GetTicks());
+    return service_ns + cyclesToNs(static_cast<s64>(wait_ticks));
+}
+
+} // Anonymous namespace
+
 template <class Archive>
 void File::serialize(Archive& ar, const unsigned int) {
     ar& boost::serialization::base_object<Kernel::SessionRequestHandler>(*this);
@@ -80,19 +96,26 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     if (!backend->AllowsCachedReads()) {
         auto& buffer = rp.PopMappedBuffer();
         IPC::RequestBuilder rb = rp.MakeBuilder(2, 2);
-        std::unique_ptr<u8*> data = std::make_unique<u8*>(static_cast<u8*>(operator new(length)));
-        const auto read = backend->Read(offset, length, *data);
+        std::vector<u8> data(length);
+        const auto read_start = std::chrono::steady_clock::now();
+        const auto read = backend->Read(offset, length, data.data());
+        const auto host_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - read_start)
+                                 .count();
         if (read.Failed()) {
             rb.Push(read.Code());
             rb.Push<u32>(0);
         } else {
-            buffer.Write(*data, 0, *read);
+            buffer.Write(data.data(), 0, *read);
             rb.Push(ResultSuccess);
             rb.Push<u32>(static_cast<u32>(*read));
         }
         rb.PushMappedBuffer(buffer);
 
-        std::chrono::nanoseconds read_timeout_ns{backend->GetReadDelayNs(length)};
+        const u64 read_delay = ReserveReadDelayNs(kernel.timing, *backend, length);
+        FileSys::FSTimingStats::Get().RecordRead(backend->GetStorageDevice(), length, read_delay,
+                                                 static_cast<u64>(host_ns));
+        std::chrono::nanoseconds read_timeout_ns{read_delay};
         ctx.SleepClientThread("file::read", read_timeout_ns, nullptr);
         return;
     }
@@ -103,11 +126,13 @@ void File::Read(Kernel::HLERequestContext& ctx) {
         u64 offset;
         std::chrono::steady_clock::time_point pre_timer;
         bool cache_ready;
+        FileSys::StorageDevice device;
+        u64 read_delay;
 
         // Output
         Result ret{0};
         Kernel::MappedBuffer* buffer;
-        std::unique_ptr<u8*> data;
+        std::vector<u8> data;
         std::size_t read_size;
     };
 
@@ -116,54 +141,86 @@ void File::Read(Kernel::HLERequestContext& ctx) {
     async_data->length = length;
     async_data->offset = offset;
     async_data->cache_ready = backend->CacheReady(offset, length);
+    async_data->device = backend->GetStorageDevice();
+    async_data->read_delay = ReserveReadDelayNs(kernel.timing, *backend, length);
     if (!async_data->cache_ready) {
         async_data->pre_timer = std::chrono::steady_clock::now();
     }
 
     // LOG_DEBUG(Service_FS, "cache={}, offset={}, length={}", cache_ready, offset, length);
-    ctx.RunAsync(
-        [this, async_data](Kernel::HLERequestContext& ctx) {
-            async_data->data =
-                std::make_unique<u8*>(static_cast<u8*>(operator new(async_data->length)));
-            const auto read =
-                backend->Read(async_data->offset, async_data->length, *async_data->data);
-            if (read.Failed()) {
-                async_data->ret = read.Code();
-                async_data->read_size = 0;
-            } else {
-                async_data->ret = ResultSuccess;
-                async_data->read_size = *read;
+    const auto store_result = [async_data](const ResultVal<std::size_t>& read) {
+        if (read.Failed()) {
+            async_data->ret = read.Code();
+            async_data->read_size = 0;
+        } else {
+            async_data->ret = ResultSuccess;
+            async_data->read_size = *read;
+        }
+    };
+    // Time left until the read has taken as long as it would on hardware.
+    const auto remaining_delay = [async_data] {
+        const auto device = async_data->device;
+        const auto read_delay = static_cast<s64>(async_data->read_delay);
+        if (!async_data->cache_ready) {
+            const auto time_took = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - async_data->pre_timer)
+                                       .count();
+            /*
+            if (time_took > read_delay) {
+                LOG_DEBUG(Service_FS, "Took longer! length={}, time_took={}, read_delay={}",
+                          async_data->length, time_took, read_delay);
             }
+            */
+            FileSys::FSTimingStats::Get().RecordRead(device, async_data->length,
+                                                     static_cast<u64>(read_delay),
+                                                     static_cast<u64>(time_took));
+            return static_cast<s64>((read_delay > time_took) ? (read_delay - time_took) : 0);
+        } else {
+            FileSys::FSTimingStats::Get().RecordRead(device, async_data->length,
+                                                     static_cast<u64>(read_delay), 0);
+            return static_cast<s64>(read_delay);
+        }
+    };
+    const auto reply = [async_data](Kernel::HLERequestContext& ctx) {
+        IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
+        if (async_data->ret.IsError()) {
+            rb.Push(async_data->ret);
+            rb.Push<u32>(0);
+        } else {
+            async_data->buffer->Write(async_data->data.data(), 0, async_data->read_size);
+            rb.Push(ResultSuccess);
+            rb.Push<u32>(static_cast<u32>(async_data->read_size));
+        }
+        rb.PushMappedBuffer(*async_data->buffer);
+    };
 
-            const auto read_delay = static_cast<s64>(backend->GetReadDelayNs(async_data->length));
-            if (!async_data->cache_ready) {
-                const auto time_took = std::chrono::duration_cast<std::chrono::nanoseconds>(
-                                           std::chrono::steady_clock::now() - async_data->pre_timer)
-                                           .count();
-                /*
-                if (time_took > read_delay) {
-                    LOG_DEBUG(Service_FS, "Took longer! length={}, time_took={}, read_delay={}",
-                              async_data->length, time_took, read_delay);
-                }
-                */
-                return static_cast<s64>((read_delay > time_took) ? (read_delay - time_took) : 0);
-            } else {
-                return static_cast<s64>(read_delay);
-            }
-        },
-        [async_data](Kernel::HLERequestContext& ctx) {
-            IPC::RequestBuilder rb(ctx, 0x0802, 2, 2);
-            if (async_data->ret.IsError()) {
-                rb.Push(async_data->ret);
-                rb.Push<u32>(0);
-            } else {
-                async_data->buffer->Write(*async_data->data, 0, async_data->read_size);
-                rb.Push(ResultSuccess);
-                rb.Push<u32>(static_cast<u32>(async_data->read_size));
-            }
-            rb.PushMappedBuffer(*async_data->buffer);
+    // Reads that go to the host file without holding a thread while they are in flight.
+    if (!async_data->cache_ready && backend->SupportsAsyncRead()) {
+        async_data->data.resize(length);
+        ctx.RunAsyncIO(
+            [this, async_data, store_result,
+             remaining_delay](Kernel::HLERequestContext& ctx,
+                              Kernel::HLERequestContext::AsyncIODone done) {
+                backend->ReadAsync(
+                    async_data->offset, async_data->length, async_data->data.data(),
+                    [store_result, remaining_delay,
+                     done = std::move(done)](ResultVal<std::size_t> read) {
+                        store_result(read);
+                        done(remaining_delay());
+                    });
+            },
+            reply);
+        return;
+    }
+
+    ctx.RunAsync(
+        [this, async_data, store_result, remaining_delay](Kernel::HLERequestContext& ctx) {
+            async_data->data.resize(async_data->length);
+            store_result(
+                backend->Read(async_data->offset, async_data->length, async_data->data.data()));
+            return remaining_delay();
         },
-        !async_data->cache_ready);
+        reply, !async_data->cache_ready);
 }
 
 void File::Write(Kernel::HLERequestContext& ctx) {
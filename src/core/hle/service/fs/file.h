@@ -48,6 +48,11 @@ public:
         return "Path: " + path.DebugStr();
     }
 
+    // File reads share their threads with the requests of the fs:USER service.
+    AsyncQueueInfo GetAsyncQueue() const override {
+        return {"fs:USER", false};
+    }
+
     FileSys::Path path;                            ///< Path of the file
     std::unique_ptr<FileSys::FileBackend> backend; ///< File backend interface
 
@@ -340,6 +340,11 @@ class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
     HTTP_C();
 
+    // Requests wait for the server to respond, possibly without a timeout.
+    AsyncQueueInfo GetAsyncQueue() const override {
+        return {"http:C", true};
+    }
+
     const ClCertAData& GetClCertA() const {
         return ClCertA;
     }
@@ -69,6 +69,10 @@ public:
 
     void HandleSyncRequest(Kernel::HLERequestContext& context) override;
 
+    AsyncQueueInfo GetAsyncQueue() const override {
+        return {service_name, false};
+    }
+
     /// Retrieves name of a function based on the header code. For IPC Recorder.
     std::string GetFunctionName(IPC::Header header) const;
 
@@ -54,6 +54,11 @@ public:
     SOC_U();
     ~SOC_U();
 
+    // Socket calls such as accept, recv and poll can block until the network peer acts.
+    AsyncQueueInfo GetAsyncQueue() const override {
+        return {"soc:U", true};
+    }
+
     struct InterfaceInfo {
         u32 address;
         u32 netmask;
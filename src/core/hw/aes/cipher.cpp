@@ -0,0 +1,123 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <mutex>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+#include "core/hw/aes/cipher.h"
+
+namespace HW::AES {
+
+namespace {
+
+// Counter blocks encrypted per call into Crypto++, 4 KiB of keystream.
+constexpr std::size_t CTR_BATCH_BLOCKS = 256;
+
+// Number of key schedules kept by GetCTRCipher. Games use a handful of keys at a time.
+constexpr std::size_t MAX_CACHED_CIPHERS = 32;
+
+/// Adds value to a big-endian 128-bit counter.
+void AddToCounter(AESIV& counter, u64 value) {
+    for (std::size_t i = counter.size(); i-- > 0 && value != 0;) {
+        const u64 sum = counter[i] + (value & 0xFF);
+        counter[i] = static_cast<u8>(sum);
+        value = (value >> 8) + (sum >> 8);
+    }
+}
+
+void XorKeystream(const CryptoPP::AES::Encryption& aes, const AESIV& counter, std::size_t skip,
+                  u8* data, std::size_t length) {
+    AESIV keystream;
+    aes.ProcessBlock(counter.data(), keystream.data());
+    for (std::size_t i = 0; i < length; ++i) {
+        data[i] ^= keystream[skip + i];
+    }
+}
+
+} // Anonymous namespace
+
+struct CTRCipher::Impl {
+    /// Only copied from after construction, see Transform.
+    CryptoPP::AES::Encryption aes;
+};
+
+CTRCipher::CTRCipher(const AESKey& key) : impl(std::make_unique<Impl>()) {
+    impl->aes.SetKey(key.data(), key.size());
+}
+
+CTRCipher::~CTRCipher() = default;
+
+void CTRCipher::Transform(const AESIV& ctr, u64 offset, u8* data, std::size_t length) const {
+    // Crypto++ ciphers write to scratch space of their own while processing blocks, so every call
+    // works on a copy. Copying takes the expanded key schedule along instead of expanding it again.
+    CryptoPP::AES::Encryption aes{impl->aes};
+
+    AESIV counter = ctr;
+    AddToCounter(counter, offset / AES_BLOCK_SIZE);
+
+    // Finish the block the stream position falls into.
+    const std::size_t skip = offset % AES_BLOCK_SIZE;
+    if (skip != 0 && length != 0) {
+        const std::size_t head = std::min(length, AES_BLOCK_SIZE - skip);
+        XorKeystream(aes, counter, skip, data, head);
+        AddToCounter(counter, 1);
+        data += head;
+        length -= head;
+    }
+
+    alignas(16) std::array<u8, CTR_BATCH_BLOCKS * AES_BLOCK_SIZE> counters;
+    while (length >= AES_BLOCK_SIZE) {
+        const std::size_t blocks = std::min(length / AES_BLOCK_SIZE, CTR_BATCH_BLOCKS);
+        for (std::size_t i = 0; i < blocks; ++i) {
+            std::copy(counter.begin(), counter.end(), counters.begin() + i * AES_BLOCK_SIZE);
+            AddToCounter(counter, 1);
+        }
+        const std::size_t size = blocks * AES_BLOCK_SIZE;
+        aes.AdvancedProcessBlocks(counters.data(), data, data, size,
+                                  CryptoPP::BlockTransformation::BT_AllowParallel);
+        data += size;
+        length -= size;
+    }
+
+    if (length != 0) {
+        XorKeystream(aes, counter, 0, data, length);
+    }
+}
+
+std::shared_ptr<const CTRCipher> GetCTRCipher(const AESKey& key) {
+    static std::mutex mutex;
+    static std::map<AESKey, std::shared_ptr<const CTRCipher>> ciphers;
+
+    std::scoped_lock lock{mutex};
+    auto it = ciphers.find(key);
+    if (it != ciphers.end()) {
+        return it->second;
+    }
+    if (ciphers.size() >= MAX_CACHED_CIPHERS) {
+        // Ciphers still in use stay alive through their shared_ptr.
+        ciphers.clear();
+    }
+    return ciphers.emplace(key, std::make_shared<const CTRCipher>(key)).first->second;
+}
+
+struct CBCDecryptor::Impl {
+    CryptoPP::CBC_Mode<CryptoPP::AES>::Decryption decryption;
+};
+
+CBCDecryptor::CBCDecryptor(const AESKey& key, const AESIV& iv) : impl(std::make_unique<Impl>()) {
+    impl->decryption.SetKeyWithIV(key.data(), key.size(), iv.data());
+}
+
+CBCDecryptor::~CBCDecryptor() = default;
+
+void CBCDecryptor::Decrypt(u8* data, std::size_t length) {
+    // Blocks of CBC decryption do not depend on each other's output, so Crypto++ decrypts several
+    // at once here as well.
+    impl->decryption.ProcessData(data, data, length);
+}
+
+} // namespace HW::AES
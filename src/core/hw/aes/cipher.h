@@ -0,0 +1,60 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "common/common_types.h"
+#include "core/hw/aes/key.h"
+
+namespace HW::AES {
+
+/**
+ * AES-CTR with the key schedule expanded once. It keeps no stream position, and each Transform
+ * call works on its own copy of the Crypto++ cipher, so one cipher can be used by several threads
+ * decrypting different parts of a stream at the same time. Counter blocks are encrypted in
+ * batches, which lets Crypto++ use its pipelined AES-NI or ARMv8 crypto paths.
+ */
+class CTRCipher {
+public:
+    explicit CTRCipher(const AESKey& key);
+    ~CTRCipher();
+
+    CTRCipher(const CTRCipher&) = delete;
+    CTRCipher& operator=(const CTRCipher&) = delete;
+
+    /**
+     * Encrypts or decrypts data in place.
+     * @param ctr the counter at the start of the stream
+     * @param offset position of data in the stream, in bytes
+     */
+    void Transform(const AESIV& ctr, u64 offset, u8* data, std::size_t length) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+/// Returns a cipher for key, reusing the key schedule of earlier calls with the same key.
+std::shared_ptr<const CTRCipher> GetCTRCipher(const AESKey& key);
+
+/// AES-CBC decryption of a stream that arrives in pieces.
+class CBCDecryptor {
+public:
+    CBCDecryptor(const AESKey& key, const AESIV& iv);
+    ~CBCDecryptor();
+
+    CBCDecryptor(const CBCDecryptor&) = delete;
+    CBCDecryptor& operator=(const CBCDecryptor&) = delete;
+
+    /// Decrypts the next piece of the stream in place. length must be a multiple of the block size.
+    void Decrypt(u8* data, std::size_t length);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace HW::AES
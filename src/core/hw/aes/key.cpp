@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <boost/iostreams/device/file_descriptor.hpp>
@@ -86,6 +87,10 @@ std::optional<std::pair<std::size_t, char>> ParseKeySlotName(const std::string&
     }
 }
 
+AESKey ScrambleKey(const AESKey& x, const AESKey& y) {
+    return Lrot128(Add128(Xor128(Lrot128(x, 2), y), generator_constant), 87);
+}
+
 struct KeySlot {
     std::optional<AESKey> x;
     std::optional<AESKey> y;
@@ -107,7 +112,7 @@ struct KeySlot {
 
     void GenerateNormalKey() {
         if (x && y) {
-            normal = Lrot128(Add128(Xor128(Lrot128(*x, 2), *y), generator_constant), 87);
+            normal = ScrambleKey(*x, *y);
         } else {
             normal.reset();
         }
@@ -120,6 +125,8 @@ struct KeySlot {
     }
 };
 
+// Guards the key slots, which loaders and services on different threads use.
+std::mutex key_slot_mutex;
 std::array<KeySlot, KeySlotID::MaxKeySlotID> key_slots;
 std::array<std::optional<AESKey>, MaxCommonKeySlot> common_key_y_slots;
 std::array<std::optional<AESKey>, NumDlpNfcKeyYs> dlp_nfc_key_y_slots;
@@ -312,6 +319,7 @@ void LoadPresetKeys() {
 } // namespace
 
 void InitKeys(bool force) {
+    std::scoped_lock lock{key_slot_mutex};
     static bool initialized = false;
     if (initialized && !force) {
         return;
@@ -323,34 +331,61 @@ void InitKeys(bool force) {
 }
 
 void SetKeyX(std::size_t slot_id, const AESKey& key) {
+    std::scoped_lock lock{key_slot_mutex};
     key_slots.at(slot_id).SetKeyX(key);
 }
 
 void SetKeyY(std::size_t slot_id, const AESKey& key) {
+    std::scoped_lock lock{key_slot_mutex};
     key_slots.at(slot_id).SetKeyY(key);
 }
 
 void SetNormalKey(std::size_t slot_id, const AESKey& key) {
+    std::scoped_lock lock{key_slot_mutex};
     key_slots.at(slot_id).SetNormalKey(key);
 }
 
 bool IsKeyXAvailable(std::size_t slot_id) {
+    std::scoped_lock lock{key_slot_mutex};
     return key_slots.at(slot_id).x.has_value();
 }
 
 bool IsNormalKeyAvailable(std::size_t slot_id) {
+    std::scoped_lock lock{key_slot_mutex};
     return key_slots.at(slot_id).normal.has_value();
 }
 
 AESKey GetNormalKey(std::size_t slot_id) {
+    std::scoped_lock lock{key_slot_mutex};
     return key_slots.at(slot_id).normal.value_or(AESKey{});
 }
 
+std::optional<AESKey> GenerateNormalKey(std::size_t slot_id, const AESKey& key_y) {
+    std::scoped_lock lock{key_slot_mutex};
+    const auto& key_x = key_slots.at(slot_id).x;
+    if (!key_x) {
+        return std::nullopt;
+    }
+    return ScrambleKey(*key_x, key_y);
+}
+
+std::optional<AESKey> GenerateCommonKey(u8 index) {
+    std::scoped_lock lock{key_slot_mutex};
+    const auto& key_x = key_slots[KeySlotID::TicketCommonKey].x;
+    const auto& key_y = common_key_y_slots.at(index);
+    if (!key_x || !key_y) {
+        return std::nullopt;
+    }
+    return ScrambleKey(*key_x, *key_y);
+}
+
 void SelectCommonKeyIndex(u8 index) {
+    std::scoped_lock lock{key_slot_mutex};
     key_slots[KeySlotID::TicketCommonKey].SetKeyY(common_key_y_slots.at(index));
 }
 
 void SelectDlpNfcKeyYIndex(u8 index) {
+    std::scoped_lock lock{key_slot_mutex};
     key_slots[KeySlotID::DLPNFCDataKey].SetKeyY(dlp_nfc_key_y_slots.at(index));
 }
 
@@ -7,6 +7,7 @@
 
 #include <array>
 #include <cstddef>
+#include <optional>
 #include <vector>
 #include "common/common_types.h"
 
@@ -85,6 +86,20 @@ bool IsKeyXAvailable(std::size_t slot_id);
 bool IsNormalKeyAvailable(std::size_t slot_id);
 AESKey GetNormalKey(std::size_t slot_id);
 
+/**
+ * Generates the normal key a slot would hold with its KeyX and the given KeyY, without changing
+ * the slot. Unlike SetKeyY followed by GetNormalKey, threads using the same slot do not interfere.
+ * @returns the normal key, or nullopt if the slot has no KeyX
+ */
+std::optional<AESKey> GenerateNormalKey(std::size_t slot_id, const AESKey& key_y);
+
+/**
+ * Generates the ticket common key with the given index, the key that SelectCommonKeyIndex would
+ * put in the TicketCommonKey slot, without changing the slot.
+ * @returns the common key, or nullopt if its KeyX or KeyY is missing
+ */
+std::optional<AESKey> GenerateCommonKey(u8 index);
+
 void SelectCommonKeyIndex(u8 index);
 void SelectDlpNfcKeyYIndex(u8 index);
 
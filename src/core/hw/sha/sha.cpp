@@ -0,0 +1,36 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cryptopp/sha.h>
+#include "core/hw/sha/sha.h"
+
+namespace HW::SHA {
+
+static_assert(CryptoPP::SHA256::DIGESTSIZE == SHA256_HASH_SIZE);
+
+struct SHA256::Impl {
+    CryptoPP::SHA256 sha;
+};
+
+SHA256::SHA256() : impl(std::make_unique<Impl>()) {}
+
+SHA256::~SHA256() = default;
+
+void SHA256::Update(const u8* data, std::size_t length) {
+    impl->sha.Update(data, length);
+}
+
+SHA256Hash SHA256::Final() {
+    SHA256Hash hash;
+    impl->sha.Final(hash.data());
+    return hash;
+}
+
+SHA256Hash ComputeSHA256(std::span<const u8> data) {
+    SHA256Hash hash;
+    CryptoPP::SHA256().CalculateDigest(hash.data(), data.data(), data.size());
+    return hash;
+}
+
+} // namespace HW::SHA
@@ -0,0 +1,43 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include "common/common_types.h"
+
+namespace HW::SHA {
+
+constexpr std::size_t SHA256_HASH_SIZE = 0x20;
+
+using SHA256Hash = std::array<u8, SHA256_HASH_SIZE>;
+
+/**
+ * Incremental SHA-256. Crypto++ uses the SHA extensions of x86 and ARMv8 CPUs when they are
+ * available.
+ */
+class SHA256 {
+public:
+    SHA256();
+    ~SHA256();
+
+    SHA256(const SHA256&) = delete;
+    SHA256& operator=(const SHA256&) = delete;
+
+    void Update(const u8* data, std::size_t length);
+
+    /// Returns the hash of everything passed to Update, and starts over.
+    SHA256Hash Final();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+SHA256Hash ComputeSHA256(std::span<const u8> data);
+
+} // namespace HW::SHA
@@ -46,6 +46,11 @@ FileType IdentifyFile(const std::string& file_name) {
 FileType GuessFromExtension(const std::string& extension_) {
     std::string extension = Common::ToLower(extension_);
 
+    // Compressed containers prefix the extension of the image they hold with 'z'.
+    if (extension.size() > 2 && extension.starts_with(".z")) {
+        extension.erase(1, 1);
+    }
+
     if (extension == ".elf" || extension == ".axf")
         return FileType::ELF;
 
@@ -140,9 +145,12 @@ static std::unique_ptr<AppLoader> GetFileLoader(Core::System& system, FileUtil::
 }
 
 std::unique_ptr<AppLoader> GetLoader(const std::string& filename) {
+    return GetLoader(Core::System::GetInstance(), filename);
+}
+
+std::unique_ptr<AppLoader> GetLoader(Core::System& system, const std::string& filename) {
     if (filename.starts_with("articbase://")) {
-        return GetFileLoader(Core::System::GetInstance(), FileUtil::IOFile(), FileType::ARTIC,
-                             filename.substr(12), "");
+        return GetFileLoader(system, FileUtil::IOFile(), FileType::ARTIC, filename.substr(12), "");
     }
 
     FileUtil::IOFile file(filename, "rb");
@@ -165,7 +173,6 @@ std::unique_ptr<AppLoader> GetLoader(const std::string& filename) {
 
     LOG_DEBUG(Loader, "Loading file {} as {}...", filename, GetFileTypeString(type));
 
-    auto& system = Core::System::GetInstance();
     return GetFileLoader(system, std::move(file), type, filename_filename, filename);
 }
 
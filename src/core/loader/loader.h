@@ -302,4 +302,12 @@ protected:
  */
 std::unique_ptr<AppLoader> GetLoader(const std::string& filename);
 
+/**
+ * Identifies a bootable file and return a suitable loader
+ * @param system System the loader is created for
+ * @param filename String filename of bootable file
+ * @return best loader for this file
+ */
+std::unique_ptr<AppLoader> GetLoader(Core::System& system, const std::string& filename);
+
 } // namespace Loader
@@ -156,99 +156,163 @@ public:
         return system.GetRunningCore().GetPC();
     }
 
-    template <bool UNSAFE>
-    void ReadBlockImpl(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
-                       const std::size_t size) {
-        auto& page_table = *process.vm_manager.page_table;
-
+    /**
+     * Walks the range [addr, addr + size) of a page table and calls
+     * `visit(type, vaddr, host_ptr, size)` once for every run of consecutive pages sharing the same
+     * page type. Runs of `Memory` pages are also split wherever their backing memory stops being
+     * contiguous, so `host_ptr` covers the whole run. For any other page type it is null.
+     */
+    template <typename Visitor>
+    static void ForEachPageRun(PageTable& page_table, const VAddr addr,
+                               const std::size_t size, Visitor&& visit) {
         std::size_t remaining_size = size;
-        std::size_t page_index = src_addr >> BORKED3DS_PAGE_BITS;
-        std::size_t page_offset = src_addr & BORKED3DS_PAGE_MASK;
+        std::size_t page_index = addr >> BORKED3DS_PAGE_BITS;
+        std::size_t page_offset = addr & BORKED3DS_PAGE_MASK;
 
         while (remaining_size > 0) {
-            const std::size_t copy_amount =
-                std::min(BORKED3DS_PAGE_SIZE - page_offset, remaining_size);
-            const auto current_vaddr =
-                static_cast<VAddr>((page_index << BORKED3DS_PAGE_BITS) + page_offset);
-
-            switch (page_table.attributes[page_index]) {
-            case PageType::Unmapped: {
-                LOG_ERROR(
-                    HW_Memory,
-                    "unmapped ReadBlock @ 0x{:08X} (start address = 0x{:08X}, size = {}) at PC "
-                    "0x{:08X}",
-                    current_vaddr, src_addr, size, GetPC());
-                std::memset(dest_buffer, 0, copy_amount);
-                break;
-            }
-            case PageType::Memory: {
-                const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-                std::memcpy(dest_buffer, src_ptr, copy_amount);
-                break;
-            }
-            case PageType::RasterizerCachedMemory: {
-                if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Flush);
+            const PageType type = page_table.attributes[page_index];
+            u8* const run_base = page_table.pointers[page_index];
+            std::size_t run_size =
+                std::min<std::size_t>(BORKED3DS_PAGE_SIZE - page_offset, remaining_size);
+            std::size_t run_pages = 1;
+
+            while (run_size < remaining_size) {
+                const std::size_t next_page = page_index + run_pages;
+                if (page_table.attributes[next_page] != type) {
+                    break;
                 }
-                std::memcpy(dest_buffer, GetPointerForRasterizerCache(current_vaddr), copy_amount);
-                break;
-            }
-            default:
-                UNREACHABLE();
+                const u8* const next_base = page_table.pointers[next_page];
+                if (type == PageType::Memory &&
+                    next_base != run_base + run_pages * BORKED3DS_PAGE_SIZE) {
+                    break;
+                }
+                run_size += std::min<std::size_t>(BORKED3DS_PAGE_SIZE, remaining_size - run_size);
+                run_pages++;
             }
 
-            page_index++;
+            const auto run_vaddr =
+                static_cast<VAddr>((page_index << BORKED3DS_PAGE_BITS) + page_offset);
+            visit(type, run_vaddr, run_base ? run_base + page_offset : nullptr, run_size);
+
+            page_index += run_pages;
             page_offset = 0;
-            dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-            remaining_size -= copy_amount;
+            remaining_size -= run_size;
         }
     }
 
+    /// Calls `access(host_ptr, size)` for every page of a range of rasterizer cached memory.
+    template <typename Access>
+    void ForEachCachedPage(VAddr vaddr, std::size_t size, Access&& access) const {
+        while (size > 0) {
+            const std::size_t copy_amount =
+                std::min<std::size_t>(BORKED3DS_PAGE_SIZE - (vaddr & BORKED3DS_PAGE_MASK), size);
+            access(GetPointerForRasterizerCache(vaddr).GetPtr(), copy_amount);
+            vaddr += static_cast<VAddr>(copy_amount);
+            size -= copy_amount;
+        }
+    }
+
+    /**
+     * Reads the range [src_addr, src_addr + size) of a process' address space, handing the data
+     * to `sink(src_ptr, size)` in address order. Unmapped ranges are passed with a null `src_ptr`
+     * and must be zero filled by the sink. Rasterizer cached ranges are flushed once per run of
+     * pages instead of once per page.
+     */
+    template <bool UNSAFE, typename Sink>
+    void ReadBlockRuns(const Kernel::Process& process, const VAddr src_addr,
+                       const std::size_t size, Sink&& sink) {
+        ForEachPageRun(*process.vm_manager.page_table, src_addr, size,
+                       [&](PageType type, VAddr run_vaddr, u8* run_ptr, std::size_t run_size) {
+                           switch (type) {
+                           case PageType::Unmapped: {
+                               LOG_ERROR(HW_Memory,
+                                         "unmapped ReadBlock @ 0x{:08X} (start address = "
+                                         "0x{:08X}, size = {}) at PC 0x{:08X}",
+                                         run_vaddr, src_addr, size, GetPC());
+                               sink(nullptr, run_size);
+                               break;
+                           }
+                           case PageType::Memory: {
+                               sink(run_ptr, run_size);
+                               break;
+                           }
+                           case PageType::RasterizerCachedMemory: {
+                               if constexpr (!UNSAFE) {
+                                   RasterizerFlushVirtualRegion(
+                                       run_vaddr, static_cast<u32>(run_size), FlushMode::Flush);
+                               }
+                               ForEachCachedPage(run_vaddr, run_size, sink);
+                               break;
+                           }
+                           default:
+                               UNREACHABLE();
+                           }
+                       });
+    }
+
+    /**
+     * Writes the range [dest_addr, dest_addr + size) of a process' address space, asking
+     * `source(dest_ptr, size)` to fill it in address order. Unmapped ranges are passed with a null
+     * `dest_ptr` and must be skipped by the source. Rasterizer cached ranges are invalidated once
+     * per run of pages instead of once per page.
+     */
+    template <bool UNSAFE, typename Source>
+    void WriteBlockRuns(const Kernel::Process& process, const VAddr dest_addr,
+                        const std::size_t size, Source&& source) {
+        ForEachPageRun(*process.vm_manager.page_table, dest_addr, size,
+                       [&](PageType type, VAddr run_vaddr, u8* run_ptr, std::size_t run_size) {
+                           switch (type) {
+                           case PageType::Unmapped: {
+                               LOG_ERROR(HW_Memory,
+                                         "unmapped WriteBlock @ 0x{:08X} (start address = "
+                                         "0x{:08X}, size = {}) at PC 0x{:08X}",
+                                         run_vaddr, dest_addr, size, GetPC());
+                               source(nullptr, run_size);
+                               break;
+                           }
+                           case PageType::Memory: {
+                               source(run_ptr, run_size);
+                               break;
+                           }
+                           case PageType::RasterizerCachedMemory: {
+                               if constexpr (!UNSAFE) {
+                                   RasterizerFlushVirtualRegion(run_vaddr,
+                                                                static_cast<u32>(run_size),
+                                                                FlushMode::Invalidate);
+                               }
+                               ForEachCachedPage(run_vaddr, run_size, source);
+                               break;
+                           }
+                           default:
+                               UNREACHABLE();
+                           }
+                       });
+    }
+
+    template <bool UNSAFE>
+    void ReadBlockImpl(const Kernel::Process& process, const VAddr src_addr, void* dest_buffer,
+                       const std::size_t size) {
+        auto* dest = static_cast<u8*>(dest_buffer);
+        ReadBlockRuns<UNSAFE>(process, src_addr, size, [&dest](const u8* src, std::size_t length) {
+            if (src) {
+                std::memcpy(dest, src, length);
+            } else {
+                std::memset(dest, 0, length);
+            }
+            dest += length;
+        });
+    }
+
     template <bool UNSAFE>
     void WriteBlockImpl(const Kernel::Process& process, const VAddr dest_addr,
                         const void* src_buffer, const std::size_t size) {
-        auto& page_table = *process.vm_manager.page_table;
-        std::size_t remaining_size = size;
-        std::size_t page_index = dest_addr >> BORKED3DS_PAGE_BITS;
-        std::size_t page_offset = dest_addr & BORKED3DS_PAGE_MASK;
-
-        while (remaining_size > 0) {
-            const std::size_t copy_amount =
-                std::min(BORKED3DS_PAGE_SIZE - page_offset, remaining_size);
-            const auto current_vaddr =
-                static_cast<VAddr>((page_index << BORKED3DS_PAGE_BITS) + page_offset);
-            switch (page_table.attributes[page_index]) {
-            case PageType::Unmapped: {
-                LOG_ERROR(
-                    HW_Memory,
-                    "unmapped WriteBlock @ 0x{:08X} (start address = 0x{:08X}, size = {}) at PC "
-                    "0x{:08X}",
-                    current_vaddr, dest_addr, size, GetPC());
-                break;
-            }
-            case PageType::Memory: {
-                u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-                std::memcpy(dest_ptr, src_buffer, copy_amount);
-                break;
+        const auto* src = static_cast<const u8*>(src_buffer);
+        WriteBlockRuns<UNSAFE>(process, dest_addr, size, [&src](u8* dest, std::size_t length) {
+            if (dest) {
+                std::memcpy(dest, src, length);
             }
-            case PageType::RasterizerCachedMemory: {
-                if constexpr (!UNSAFE) {
-                    RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                                 FlushMode::Invalidate);
-                }
-                std::memcpy(GetPointerForRasterizerCache(current_vaddr), src_buffer, copy_amount);
-                break;
-            }
-            default:
-                UNREACHABLE();
-            }
-
-            page_index++;
-            page_offset = 0;
-            src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-            remaining_size -= copy_amount;
-        }
+            src += length;
+        });
     }
 
     MemoryRef GetPointerForRasterizerCache(VAddr addr) const {
@@ -844,42 +908,11 @@ void MemorySystem::WriteBlock(const VAddr dest_addr, const void* src_buffer,
 
 void MemorySystem::ZeroBlock(const Kernel::Process& process, const VAddr dest_addr,
                              const std::size_t size) {
-    auto& page_table = *process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = dest_addr >> BORKED3DS_PAGE_BITS;
-    std::size_t page_offset = dest_addr & BORKED3DS_PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(BORKED3DS_PAGE_SIZE - page_offset, remaining_size);
-        const auto current_vaddr =
-            static_cast<VAddr>((page_index << BORKED3DS_PAGE_BITS) + page_offset);
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped ZeroBlock @ 0x{:08X} (start address = 0x{:08X}, size = {}) at PC "
-                      "0x{:08X}",
-                      current_vaddr, dest_addr, size, impl->GetPC());
-            break;
-        }
-        case PageType::Memory: {
-            u8* dest_ptr = page_table.pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Invalidate);
-            std::memset(GetPointerForRasterizerCache(current_vaddr), 0, copy_amount);
-            break;
+    impl->WriteBlockRuns<false>(process, dest_addr, size, [](u8* dest, std::size_t length) {
+        if (dest) {
+            std::memset(dest, 0, length);
         }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
-    }
+    });
 }
 
 void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VAddr src_addr,
@@ -890,47 +923,16 @@ void MemorySystem::CopyBlock(const Kernel::Process& process, VAddr dest_addr, VA
 void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
                              const Kernel::Process& src_process, VAddr dest_addr, VAddr src_addr,
                              std::size_t size) {
-    auto& page_table = *src_process.vm_manager.page_table;
-    std::size_t remaining_size = size;
-    std::size_t page_index = src_addr >> BORKED3DS_PAGE_BITS;
-    std::size_t page_offset = src_addr & BORKED3DS_PAGE_MASK;
-
-    while (remaining_size > 0) {
-        const std::size_t copy_amount = std::min(BORKED3DS_PAGE_SIZE - page_offset, remaining_size);
-        const auto current_vaddr =
-            static_cast<VAddr>((page_index << BORKED3DS_PAGE_BITS) + page_offset);
-
-        switch (page_table.attributes[page_index]) {
-        case PageType::Unmapped: {
-            LOG_ERROR(HW_Memory,
-                      "unmapped CopyBlock @ 0x{:08X} (start address = 0x{:08X}, size = {}) at PC "
-                      "0x{:08X}",
-                      current_vaddr, src_addr, size, impl->GetPC());
-            ZeroBlock(dest_process, dest_addr, copy_amount);
-            break;
-        }
-        case PageType::Memory: {
-            const u8* src_ptr = page_table.pointers[page_index] + page_offset;
-            WriteBlock(dest_process, dest_addr, src_ptr, copy_amount);
-            break;
-        }
-        case PageType::RasterizerCachedMemory: {
-            RasterizerFlushVirtualRegion(current_vaddr, static_cast<u32>(copy_amount),
-                                         FlushMode::Flush);
-            WriteBlock(dest_process, dest_addr, GetPointerForRasterizerCache(current_vaddr),
-                       copy_amount);
-            break;
-        }
-        default:
-            UNREACHABLE();
-        }
-
-        page_index++;
-        page_offset = 0;
-        dest_addr += static_cast<VAddr>(copy_amount);
-        src_addr += static_cast<VAddr>(copy_amount);
-        remaining_size -= copy_amount;
-    }
+    impl->ReadBlockRuns<false>(src_process, src_addr, size,
+                               [&](const u8* src, std::size_t length) {
+                                   if (src) {
+                                       impl->WriteBlockImpl<false>(dest_process, dest_addr, src,
+                                                                   length);
+                                   } else {
+                                       ZeroBlock(dest_process, dest_addr, length);
+                                   }
+                                   dest_addr += static_cast<VAddr>(length);
+                               });
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) const {
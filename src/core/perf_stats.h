@@ -63,6 +63,13 @@ public:
         double artic_transmitted = 0;
         /// Artic base events
         PerfArticEvents artic_events{};
+        /// RomFS page cache hits and misses since the previous reset
+        u32 romfs_cache_hits = 0;
+        u32 romfs_cache_misses = 0;
+        /// Audio output callbacks that ran dry and frames dropped on a full output queue, since
+        /// the audio output was started
+        u64 audio_underruns = 0;
+        u64 audio_dropped_frames = 0;
     };
 
     void BeginSystemFrame();
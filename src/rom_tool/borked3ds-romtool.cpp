@@ -0,0 +1,269 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+#include <fmt/format.h>
+
+#include "common/common_types.h"
+#include "common/compressed_file.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/scm_rev.h"
+#include "common/string_util.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+static void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] compress <input> [output]\n"
+                 "       "
+              << argv0
+              << " [options] verify <compressed> [original]\n"
+                 "\n"
+                 "compress            Compresses a ROM image (.3ds, .cci, .cxi, .cia, ...). The\n"
+                 "                    output defaults to the input with a 'z' prefixed to its\n"
+                 "                    extension, e.g. game.3ds becomes game.z3ds\n"
+                 "verify              Checks every frame of a compressed image against its hash,\n"
+                 "                    compares it with the original image if one is given, and\n"
+                 "                    reports read throughput relative to reading the raw file\n"
+                 "-l, --level         Zstandard compression level, 1 to 22 (default 12)\n"
+                 "-f, --frame-size    Size of the independently compressed frames in KiB\n"
+                 "                    (default 256)\n"
+                 "-t, --threads       Number of compression threads (default: all)\n"
+                 "-h, --help          Display this help and exit\n"
+                 "-v, --version       Output version information and exit\n";
+}
+
+static void PrintVersion() {
+    std::cout << "Borked3DS ROM tool " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+static std::string DefaultOutputPath(const std::string& input) {
+    std::string path, filename, extension;
+    Common::SplitPath(input, &path, &filename, &extension);
+    if (extension.empty()) {
+        return input + ".z";
+    }
+    return path + filename + ".z" + extension.substr(1);
+}
+
+struct ReadResult {
+    u64 bytes = 0;
+    double seconds = 0.0;
+
+    double MiBPerSecond() const {
+        return seconds > 0.0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+};
+
+using ReadFunc = std::function<std::size_t(void* data, std::size_t length, u64 offset)>;
+
+/**
+ * Reads size bytes sequentially in large chunks.
+ * @param compare If not null, an uncompressed image the contents are compared with.
+ */
+static std::optional<ReadResult> ReadWhole(const ReadFunc& read, u64 size,
+                                           FileUtil::IOFile* compare = nullptr) {
+    constexpr std::size_t chunk_size = 1024 * 1024;
+    std::vector<u8> buffer(chunk_size);
+    std::vector<u8> expected(compare ? chunk_size : 0);
+
+    ReadResult result;
+    const auto start = std::chrono::steady_clock::now();
+    while (result.bytes < size) {
+        const std::size_t length =
+            static_cast<std::size_t>(std::min<u64>(chunk_size, size - result.bytes));
+        if (read(buffer.data(), length, result.bytes) != length) {
+            std::cout << "Read failed at offset " << result.bytes << "\n";
+            return std::nullopt;
+        }
+        if (compare) {
+            if (compare->ReadBytes(expected.data(), length) != length ||
+                std::memcmp(buffer.data(), expected.data(), length) != 0) {
+                std::cout << "Contents differ from the original near offset " << result.bytes
+                          << "\n";
+                return std::nullopt;
+            }
+        }
+        result.bytes += length;
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static int Compress(const std::string& input, const std::string& output,
+                    const FileUtil::CompressOptions& options) {
+    if (FileUtil::IsCompressedFile(input)) {
+        std::cout << input << " is already compressed\n";
+        return -1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const bool success =
+        FileUtil::CompressFile(input, output, options, [](u64 done, u64 total) {
+            std::cout << fmt::format("\rCompressing... {:3}%", total ? done * 100 / total : 100)
+                      << std::flush;
+        });
+    std::cout << "\n";
+    if (!success) {
+        std::cout << "Failed to compress " << input << "\n";
+        FileUtil::Delete(output);
+        return -1;
+    }
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const u64 input_size = FileUtil::GetSize(input);
+    const u64 output_size = FileUtil::GetSize(output);
+    std::cout << fmt::format("{} -> {}\n{} -> {} bytes ({:.1f}%) in {:.1f}s, {:.1f} MiB/s\n", input,
+                             output, input_size, output_size,
+                             input_size ? 100.0 * output_size / input_size : 100.0, seconds,
+                             seconds > 0.0 ? input_size / (1024.0 * 1024.0) / seconds : 0.0);
+    return 0;
+}
+
+static int Verify(const std::string& compressed_path, const std::string& original_path) {
+    FileUtil::IOFile file(compressed_path, "rb");
+    if (!file.IsOpen() || !file.IsCompressed()) {
+        std::cout << compressed_path << " is not a compressed image\n";
+        return -1;
+    }
+
+    auto& reader = *file.GetCompressedReader();
+    std::cout << fmt::format("{}: {} bytes in {} frames of {} KiB\n", compressed_path,
+                             reader.GetSize(), reader.GetNumFrames(),
+                             reader.GetFrameSize() / 1024);
+
+    const bool hashes_match = reader.Verify([](std::size_t done, std::size_t total) {
+        std::cout << fmt::format("\rVerifying... {:3}%", done * 100 / total) << std::flush;
+    });
+    std::cout << "\n";
+    if (!hashes_match) {
+        std::cout << "Verification failed\n";
+        return -1;
+    }
+
+    const auto read_image = [&file](void* data, std::size_t length, u64 offset) {
+        return file.ReadAtBytes(static_cast<u8*>(data), length, offset);
+    };
+
+    // Throughput is compared against reading the original image when one is given, and against
+    // reading the compressed file itself otherwise.
+    std::optional<ReadResult> raw_read;
+    if (!original_path.empty()) {
+        FileUtil::IOFile original(original_path, "rb");
+        if (!original.IsOpen() || original.GetSize() != reader.GetSize()) {
+            std::cout << "Size differs from " << original_path << "\n";
+            return -1;
+        }
+        if (!ReadWhole(read_image, reader.GetSize(), &original)) {
+            return -1;
+        }
+        std::cout << "Contents match " << original_path << "\n";
+
+        raw_read = ReadWhole(
+            [&original](void* data, std::size_t length, u64 offset) {
+                return original.ReadAtBytes(static_cast<u8*>(data), length, offset);
+            },
+            original.GetSize());
+    } else {
+        raw_read = ReadWhole(
+            [&reader](void* data, std::size_t length, u64 offset) {
+                return reader.ReadRaw(data, length, offset);
+            },
+            FileUtil::GetSize(compressed_path));
+    }
+    const auto compressed_read = ReadWhole(read_image, reader.GetSize());
+    if (!compressed_read || !raw_read) {
+        return -1;
+    }
+
+    const auto stats = reader.GetStats();
+    std::cout << fmt::format("Compressed read: {:.1f} MiB/s\nRaw read: {:.1f} MiB/s ({:.2f}x)\n",
+                             compressed_read->MiBPerSecond(), raw_read->MiBPerSecond(),
+                             raw_read->MiBPerSecond() > 0.0 ? compressed_read->MiBPerSecond() /
+                                                                  raw_read->MiBPerSecond()
+                                                            : 0.0);
+    std::cout << fmt::format("Frames decompressed: {} ({} prefetched), cache hits: {}\n",
+                             stats.frames_decompressed, stats.frames_prefetched,
+                             stats.cache_hits);
+    std::cout << "Verification succeeded\n";
+    return 0;
+}
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+    char* endarg;
+
+    FileUtil::CompressOptions options;
+
+    static struct option long_options[] = {
+        {"level", required_argument, 0, 'l'},
+        {"frame-size", required_argument, 0, 'f'},
+        {"threads", required_argument, 0, 't'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    int arg;
+    while ((arg = getopt_long(argc, argv, "l:f:t:hv", long_options, &option_index)) != -1) {
+        switch (static_cast<char>(arg)) {
+        case 'l':
+            options.compression_level = static_cast<s32>(strtol(optarg, &endarg, 0));
+            break;
+        case 'f':
+            options.frame_size = static_cast<u32>(strtoul(optarg, &endarg, 0) * 1024);
+            break;
+        case 't':
+            options.num_threads = static_cast<u32>(strtoul(optarg, &endarg, 0));
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            PrintVersion();
+            return 0;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+    const std::vector<std::string> arguments(argv + optind, argv + argc);
+
+    if (arguments.size() < 2 || arguments.size() > 3) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+
+    const std::string& command = arguments[0];
+    const std::string& input = arguments[1];
+    if (command == "compress") {
+        return Compress(input, arguments.size() == 3 ? arguments[2] : DefaultOutputPath(input),
+                        options);
+    }
+    if (command == "verify") {
+        return Verify(input, arguments.size() == 3 ? arguments[2] : std::string{});
+    }
+
+    PrintHelp(argv[0]);
+    return -1;
+}
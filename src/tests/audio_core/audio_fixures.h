@@ -13,3 +13,23 @@ constexpr std::array<u8, 41> fixure_buffer[41] = {
     {0xff, 0xf1, 0x4c, 0x80, 0x05, 0x3f, 0xfc, 0x21, 0x1a, 0x4e, 0xb0, 0x00, 0x00, 0x00,
      0x05, 0xfc, 0x4e, 0x1f, 0x08, 0x88, 0x00, 0x00, 0x00, 0xc4, 0x1a, 0x03, 0xfc, 0x9c,
      0x3e, 0x1d, 0x08, 0x84, 0x03, 0xd8, 0x3f, 0xe4, 0xe1, 0x20, 0x00, 0x0b, 0x38}};
+
+/// Three GC-ADPCM frames covering every predictor-scale combination used by the decoder tests,
+/// including ones that saturate.
+constexpr std::array<u8, 24> adpcm_fixture_data = {
+    0x23, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0x5C, 0xF0, 0x0F, 0x7F,
+    0x80, 0x18, 0x81, 0xE2, 0x4B, 0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC, 0xDE,
+};
+constexpr std::array<s16, 16> adpcm_fixture_coeffs = {
+    0x04AB, -0x0162, 0x0800, 0,       0x0F00, -0x0700, 0x0A00, -0x0400,
+    0x0C10, -0x05F0, 0x0200, 0x0100,  0x0E00, -0x0780, 0x0700, -0x0200,
+};
+constexpr s16 adpcm_fixture_yn1 = 100;
+constexpr s16 adpcm_fixture_yn2 = -50;
+/// Expected output of decoding adpcm_fixture_data with the values above.
+constexpr std::array<s16, 42> adpcm_fixture_samples = {
+    231,    354,    478,    611,    759,    929,    1126,   1354,   1490,   1553,   1560,
+    1526,   1464,   1386,   -3566,  -718,   -625,   -4342,  27508,  2238,   -28770, -6913,
+    -1228,  -32768, -32768, -8192,  -14336, 3584,   18092,  28715,  32767,  32767,  32767,
+    32767,  32767,  8703,   -25533, -32768, -32768, -32768, -31232, -26868,
+};
@@ -0,0 +1,136 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/codec.h"
+#include "audio_fixures.h"
+
+namespace AudioCore::Codec {
+
+TEST_CASE("Codec::DecodeADPCM matches the fixture", "[audio_core]") {
+    ADPCMState state{adpcm_fixture_yn1, adpcm_fixture_yn2};
+    StereoBuffer16 output(adpcm_fixture_samples.size());
+    DecodeADPCM(adpcm_fixture_data.data(), adpcm_fixture_samples.size(), adpcm_fixture_coeffs,
+                state, output);
+
+    for (std::size_t i = 0; i < adpcm_fixture_samples.size(); i++) {
+        REQUIRE(output[i][0] == adpcm_fixture_samples[i]);
+        REQUIRE(output[i][1] == adpcm_fixture_samples[i]);
+    }
+    REQUIRE(state.yn1 == adpcm_fixture_samples[41]);
+    REQUIRE(state.yn2 == adpcm_fixture_samples[40]);
+}
+
+TEST_CASE("Codec::DecodeADPCM handles partial frames", "[audio_core]") {
+    SECTION("odd sample counts decode the trailing nibble") {
+        ADPCMState state{adpcm_fixture_yn1, adpcm_fixture_yn2};
+        REQUIRE(ADPCMDecodedSize(17) == 18);
+        StereoBuffer16 output(ADPCMDecodedSize(17));
+        DecodeADPCM(adpcm_fixture_data.data(), 17, adpcm_fixture_coeffs, state, output);
+
+        for (std::size_t i = 0; i < output.size(); i++) {
+            REQUIRE(output[i][0] == adpcm_fixture_samples[i]);
+        }
+        REQUIRE(state.yn1 == adpcm_fixture_samples[17]);
+    }
+
+    SECTION("decoding frame by frame carries the state over") {
+        ADPCMState state{adpcm_fixture_yn1, adpcm_fixture_yn2};
+        StereoBuffer16 output(14);
+        for (std::size_t frame = 0; frame < 3; frame++) {
+            DecodeADPCM(adpcm_fixture_data.data() + frame * 8, 14, adpcm_fixture_coeffs, state,
+                        output);
+            for (std::size_t i = 0; i < output.size(); i++) {
+                REQUIRE(output[i][0] == adpcm_fixture_samples[frame * 14 + i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Codec::DecodePCM8", "[audio_core]") {
+    // Long enough to cover both the vectorised loop and the scalar tail.
+    std::vector<u8> data(2 * 37);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = static_cast<u8>(i * 37 + 0x7E);
+    }
+    const auto expected = [&](std::size_t i) { return static_cast<s16>(data[i] << 8); };
+
+    SECTION("mono") {
+        StereoBuffer16 output(37);
+        DecodePCM8(1, data.data(), output.size(), output);
+        for (std::size_t i = 0; i < output.size(); i++) {
+            REQUIRE(output[i][0] == expected(i));
+            REQUIRE(output[i][1] == expected(i));
+        }
+    }
+
+    SECTION("stereo") {
+        StereoBuffer16 output(37);
+        DecodePCM8(2, data.data(), output.size(), output);
+        for (std::size_t i = 0; i < output.size(); i++) {
+            REQUIRE(output[i][0] == expected(i * 2 + 0));
+            REQUIRE(output[i][1] == expected(i * 2 + 1));
+        }
+    }
+}
+
+TEST_CASE("Codec::DecodePCM16", "[audio_core]") {
+    std::vector<s16> samples(2 * 21);
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<s16>(i * 3119 - 32768);
+    }
+    const auto* const data = reinterpret_cast<const u8*>(samples.data());
+
+    SECTION("mono") {
+        StereoBuffer16 output(21);
+        DecodePCM16(1, data, output.size(), output);
+        for (std::size_t i = 0; i < output.size(); i++) {
+            REQUIRE(output[i][0] == samples[i]);
+            REQUIRE(output[i][1] == samples[i]);
+        }
+    }
+
+    SECTION("stereo") {
+        StereoBuffer16 output(21);
+        DecodePCM16(2, data, output.size(), output);
+        for (std::size_t i = 0; i < output.size(); i++) {
+            REQUIRE(output[i][0] == samples[i * 2 + 0]);
+            REQUIRE(output[i][1] == samples[i * 2 + 1]);
+        }
+    }
+}
+
+TEST_CASE("Codec[Benchmark]", "[.][audio_core][benchmark]") {
+    // About two seconds of audio, the size of a typical streamed music buffer.
+    constexpr std::size_t sample_count = 14 * 4680;
+    std::mt19937 rng(35);
+    std::vector<u8> data(sample_count * 2);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    StereoBuffer16 output(sample_count);
+
+    BENCHMARK("ADPCM") {
+        ADPCMState state{};
+        DecodeADPCM(data.data(), sample_count, adpcm_fixture_coeffs, state, output);
+        return state.yn1;
+    };
+
+    BENCHMARK("PCM8 mono") {
+        DecodePCM8(1, data.data(), sample_count, output);
+        return output[0][0];
+    };
+
+    BENCHMARK("PCM16 mono") {
+        DecodePCM16(1, data.data(), sample_count, output);
+        return output[0][0];
+    };
+}
+
+} // namespace AudioCore::Codec
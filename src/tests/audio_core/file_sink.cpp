@@ -0,0 +1,351 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/file_sink.h"
+#include "common/file_util.h"
+
+namespace AudioCore {
+
+static std::vector<std::array<s16, 2>> TestSamples(std::size_t count) {
+    std::vector<std::array<s16, 2>> samples(count);
+    for (std::size_t i = 0; i < count; i++) {
+        const double phase = static_cast<double>(i) * 0.02;
+        samples[i] = {static_cast<s16>(8000.0 * std::sin(phase)),
+                      static_cast<s16>(8000.0 * std::cos(phase * 3.0))};
+    }
+    return samples;
+}
+
+static std::vector<u8> RenderToFile(const std::string& path,
+                                    const std::vector<std::array<s16, 2>>& samples) {
+    {
+        FileSink sink(path);
+        REQUIRE_FALSE(sink.IsRealTime());
+        // Uneven chunks, as the DSP would push them.
+        std::size_t pos = 0;
+        for (std::size_t chunk = 1; pos < samples.size(); chunk = chunk * 7 % 500 + 1) {
+            const std::size_t count = std::min(chunk, samples.size() - pos);
+            sink.PushSamples({samples.data() + pos, count});
+            pos += count;
+        }
+    }
+
+    std::vector<u8> bytes;
+    {
+        FileUtil::IOFile file(path, "rb");
+        bytes.resize(file.GetSize());
+        file.ReadBytes(bytes.data(), bytes.size());
+    }
+    FileUtil::Delete(path);
+    return bytes;
+}
+
+static u32 ReadLE32(const u8* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<u32>(data[3]) << 24);
+}
+
+TEST_CASE("FileSink renders WAV", "[audio_core]") {
+    const auto path = (std::filesystem::temp_directory_path() / "file_sink_test.wav").string();
+    const auto samples = TestSamples(10000);
+    const std::vector<u8> bytes = RenderToFile(path, samples);
+
+    REQUIRE(bytes.size() == 44 + samples.size() * 4);
+    REQUIRE(std::memcmp(bytes.data(), "RIFF", 4) == 0);
+    REQUIRE(ReadLE32(bytes.data() + 4) == bytes.size() - 8);
+    REQUIRE(std::memcmp(bytes.data() + 8, "WAVEfmt ", 8) == 0);
+    REQUIRE(ReadLE32(bytes.data() + 24) == native_sample_rate);
+    REQUIRE(ReadLE32(bytes.data() + 40) == samples.size() * 4);
+    REQUIRE(std::memcmp(bytes.data() + 44, samples.data(), samples.size() * 4) == 0);
+}
+
+/// MSB-first bit reader over a FLAC stream.
+class BitReader {
+public:
+    explicit BitReader(const std::vector<u8>& bytes_) : bytes(bytes_) {}
+
+    u32 Read(u32 bits) {
+        u32 value = 0;
+        for (u32 i = 0; i < bits; i++) {
+            REQUIRE(position / 8 < bytes.size());
+            const u32 bit = (bytes[position / 8] >> (7 - position % 8)) & 1;
+            value = (value << 1) | bit;
+            position++;
+        }
+        return value;
+    }
+
+    s32 ReadSigned(u32 bits) {
+        if (bits == 0) {
+            return 0;
+        }
+        const u32 value = Read(bits);
+        return static_cast<s32>(value << (32 - bits)) >> (32 - bits);
+    }
+
+    u32 ReadUnary() {
+        u32 zeros = 0;
+        while (Read(1) == 0) {
+            zeros++;
+        }
+        return zeros;
+    }
+
+    s32 ReadRice(u32 parameter) {
+        const u32 value = (ReadUnary() << parameter) | Read(parameter);
+        return static_cast<s32>(value >> 1) ^ -static_cast<s32>(value & 1);
+    }
+
+    void AlignToByte() {
+        position = (position + 7) / 8 * 8;
+    }
+
+    [[nodiscard]] std::size_t BytePosition() const {
+        return position / 8;
+    }
+
+    [[nodiscard]] bool AtEnd() const {
+        return position >= bytes.size() * 8;
+    }
+
+private:
+    const std::vector<u8>& bytes;
+    std::size_t position = 0;
+};
+
+static u8 ReferenceCrc8(const u8* data, std::size_t size) {
+    u8 crc = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = static_cast<u8>((crc & 0x80) != 0 ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+static u16 ReferenceCrc16(const u8* data, std::size_t size) {
+    u16 crc = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        crc ^= static_cast<u16>(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = static_cast<u16>((crc & 0x8000) != 0 ? (crc << 1) ^ 0x8005 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+/// Decodes the Rice coded residual of a subframe and runs the given predictor over it.
+static void DecodeResidual(BitReader& reader, std::vector<s32>& out, std::size_t block_size,
+                           u32 order, const auto& predict) {
+    const u32 method = reader.Read(2);
+    REQUIRE(method <= 1);
+    const u32 parameter_bits = method == 0 ? 4 : 5;
+    const u32 partition_order = reader.Read(4);
+    const std::size_t partition_size = block_size >> partition_order;
+    for (std::size_t partition = 0; partition < (std::size_t{1} << partition_order);
+         partition++) {
+        const u32 parameter = reader.Read(parameter_bits);
+        const std::size_t count = partition == 0 ? partition_size - order : partition_size;
+        const bool escaped = parameter == (1U << parameter_bits) - 1;
+        const u32 escape_bits = escaped ? reader.Read(5) : 0;
+        for (std::size_t i = 0; i < count; i++) {
+            const s32 residual = escaped ? reader.ReadSigned(escape_bits)
+                                         : reader.ReadRice(parameter);
+            out.push_back(residual + predict(out.data() + out.size()));
+        }
+    }
+}
+
+static std::vector<s32> DecodeSubframe(BitReader& reader, std::size_t block_size, u32 bits) {
+    REQUIRE(reader.Read(1) == 0);
+    const u32 type = reader.Read(6);
+    if (reader.Read(1) != 0) {
+        bits -= reader.ReadUnary() + 1; // Wasted bits are not used by this stream.
+    }
+
+    std::vector<s32> out;
+    out.reserve(block_size);
+    if (type == 0x00) { // CONSTANT
+        out.assign(block_size, reader.ReadSigned(bits));
+    } else if (type == 0x01) { // VERBATIM
+        for (std::size_t i = 0; i < block_size; i++) {
+            out.push_back(reader.ReadSigned(bits));
+        }
+    } else if (type >= 0x08 && type <= 0x0C) { // FIXED
+        const u32 order = type - 0x08;
+        for (u32 i = 0; i < order; i++) {
+            out.push_back(reader.ReadSigned(bits));
+        }
+        DecodeResidual(reader, out, block_size, order, [order](const s32* x) {
+            switch (order) {
+            case 0:
+                return 0;
+            case 1:
+                return x[-1];
+            case 2:
+                return 2 * x[-1] - x[-2];
+            case 3:
+                return 3 * x[-1] - 3 * x[-2] + x[-3];
+            default:
+                return 4 * x[-1] - 6 * x[-2] + 4 * x[-3] - x[-4];
+            }
+        });
+    } else if (type >= 0x20) { // LPC
+        const u32 order = type - 0x1F;
+        for (u32 i = 0; i < order; i++) {
+            out.push_back(reader.ReadSigned(bits));
+        }
+        const u32 precision = reader.Read(4) + 1;
+        const s32 shift = reader.ReadSigned(5);
+        REQUIRE(shift >= 0);
+        std::vector<s32> coefficients(order);
+        for (auto& coefficient : coefficients) {
+            coefficient = reader.ReadSigned(precision);
+        }
+        DecodeResidual(reader, out, block_size, order, [&](const s32* x) {
+            s64 sum = 0;
+            for (u32 i = 0; i < order; i++) {
+                sum += static_cast<s64>(coefficients[i]) * x[-1 - static_cast<s32>(i)];
+            }
+            return static_cast<s32>(sum >> shift);
+        });
+    } else {
+        FAIL("Reserved subframe type " << type);
+    }
+    return out;
+}
+
+/// Reference decoder for 16 bit stereo FLAC streams with a single STREAMINFO block. Fails the
+/// test if the stream is malformed.
+static std::vector<std::array<s16, 2>> DecodeFlac(const std::vector<u8>& bytes) {
+    BitReader reader(bytes);
+    REQUIRE(reader.Read(32) == 0x664C6143); // "fLaC"
+    REQUIRE(reader.Read(1) == 1);           // Last metadata block
+    REQUIRE(reader.Read(7) == 0);           // STREAMINFO
+    REQUIRE(reader.Read(24) == 34);
+    reader.Read(16 + 16 + 24 + 24); // Block and frame size bounds
+    REQUIRE(reader.Read(20) == native_sample_rate);
+    REQUIRE(reader.Read(3) == 1);  // Two channels
+    REQUIRE(reader.Read(5) == 15); // 16 bits per sample
+    const u64 total_samples = (static_cast<u64>(reader.Read(4)) << 32) | reader.Read(32);
+    reader.Read(32);
+    reader.Read(32);
+    reader.Read(32);
+    reader.Read(32); // MD5
+
+    std::vector<std::array<s16, 2>> samples;
+    for (u32 frame_number = 0; !reader.AtEnd(); frame_number++) {
+        const std::size_t frame_start = reader.BytePosition();
+        REQUIRE(reader.Read(15) == 0x7FFC);
+        reader.Read(1); // Blocking strategy
+        const u32 block_size_code = reader.Read(4);
+        REQUIRE(reader.Read(4) == 0); // Sample rate from STREAMINFO
+        const u32 channel_assignment = reader.Read(4);
+        REQUIRE(reader.Read(3) == 4); // 16 bits per sample
+        REQUIRE(reader.Read(1) == 0);
+
+        // The frame number is coded like UTF-8.
+        u32 number = reader.Read(8);
+        u32 continuation_bytes = 0;
+        while (continuation_bytes < 6 && (number & (0x80 >> continuation_bytes)) != 0) {
+            continuation_bytes++;
+        }
+        if (continuation_bytes > 0) {
+            number &= 0x7F >> continuation_bytes;
+            for (u32 i = 1; i < continuation_bytes; i++) {
+                REQUIRE(reader.Read(2) == 0x2);
+                number = (number << 6) | reader.Read(6);
+            }
+        }
+        REQUIRE(number == frame_number);
+
+        std::size_t block_size;
+        if (block_size_code == 1) {
+            block_size = 192;
+        } else if (block_size_code >= 2 && block_size_code <= 5) {
+            block_size = std::size_t{576} << (block_size_code - 2);
+        } else if (block_size_code == 6) {
+            block_size = reader.Read(8) + 1;
+        } else if (block_size_code == 7) {
+            block_size = reader.Read(16) + 1;
+        } else {
+            REQUIRE(block_size_code >= 8);
+            block_size = std::size_t{256} << (block_size_code - 8);
+        }
+
+        const std::size_t header_end = reader.BytePosition();
+        REQUIRE(reader.Read(8) == ReferenceCrc8(bytes.data() + frame_start,
+                                                header_end - frame_start));
+
+        // Independent channels, or left/side, side/right and mid/side, where the side channel
+        // takes an extra bit.
+        REQUIRE(channel_assignment <= 10);
+        const bool side_first = channel_assignment == 9;
+        const bool side_second = channel_assignment == 8 || channel_assignment == 10;
+        std::vector<s32> first = DecodeSubframe(reader, block_size, 16 + side_first);
+        std::vector<s32> second = DecodeSubframe(reader, block_size, 16 + side_second);
+        reader.AlignToByte();
+        const std::size_t frame_end = reader.BytePosition();
+        REQUIRE(reader.Read(16) == ReferenceCrc16(bytes.data() + frame_start,
+                                                  frame_end - frame_start));
+
+        for (std::size_t i = 0; i < block_size; i++) {
+            s32 left = first[i];
+            s32 right = second[i];
+            if (channel_assignment == 8) {
+                right = left - second[i];
+            } else if (channel_assignment == 9) {
+                left = first[i] + second[i];
+            } else if (channel_assignment == 10) {
+                const s32 mid = (first[i] * 2) | (second[i] & 1);
+                left = (mid + second[i]) >> 1;
+                right = (mid - second[i]) >> 1;
+            }
+            samples.push_back({static_cast<s16>(left), static_cast<s16>(right)});
+        }
+    }
+    REQUIRE(samples.size() == total_samples);
+    return samples;
+}
+
+TEST_CASE("FileSink renders FLAC", "[audio_core]") {
+    const auto path = (std::filesystem::temp_directory_path() / "file_sink_test.flac").string();
+
+    SECTION("Smooth tones") {
+        // Three frames, the last one partial.
+        const auto samples = TestSamples(10000);
+        const std::vector<u8> bytes = RenderToFile(path, samples);
+        REQUIRE(DecodeFlac(bytes) == samples);
+        // Smooth tones compress well below the raw PCM size.
+        REQUIRE(bytes.size() < samples.size() * 4 / 2);
+    }
+
+    SECTION("Silence") {
+        const std::vector<std::array<s16, 2>> samples(5000, {-3, 7});
+        const std::vector<u8> bytes = RenderToFile(path, samples);
+        REQUIRE(DecodeFlac(bytes) == samples);
+    }
+
+    SECTION("Noise") {
+        // White noise does not compress, which exercises the verbatim subframes.
+        std::mt19937 rng(0xf1ac);
+        std::uniform_int_distribution<int> dist(-32768, 32767);
+        std::vector<std::array<s16, 2>> samples(9000);
+        for (auto& sample : samples) {
+            sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+        }
+        const std::vector<u8> bytes = RenderToFile(path, samples);
+        REQUIRE(DecodeFlac(bytes) == samples);
+    }
+}
+
+} // namespace AudioCore
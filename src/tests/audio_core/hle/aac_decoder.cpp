@@ -0,0 +1,130 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/aac_decoder.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "../audio_fixures.h"
+
+namespace AudioCore::HLE {
+
+namespace {
+std::shared_ptr<const DecodedAAC> MakeOutput(std::size_t samples) {
+    auto output = std::make_shared<DecodedAAC>();
+    output->channels[0].resize(samples);
+    output->channels[1].resize(samples);
+    return output;
+}
+} // Anonymous namespace
+
+TEST_CASE("AACDecodeCache evicts the least recently used output", "[audio_core][hle]") {
+    AACDecodeCache cache(100);
+
+    cache.Insert(1, MakeOutput(10));
+    cache.Insert(2, MakeOutput(10));
+    REQUIRE(cache.SizeBytes() == 80);
+
+    REQUIRE(cache.Find(1) != nullptr);
+    cache.Insert(3, MakeOutput(10));
+    REQUIRE(cache.Find(2) == nullptr);
+    REQUIRE(cache.Find(1) != nullptr);
+    REQUIRE(cache.Find(3) != nullptr);
+    REQUIRE(cache.Count() == 2);
+
+    // Large entries evict as many older ones as needed, and entries over capacity are not kept.
+    cache.Insert(4, MakeOutput(20));
+    REQUIRE(cache.Count() == 1);
+    REQUIRE(cache.SizeBytes() == 80);
+    cache.Insert(5, MakeOutput(30));
+    REQUIRE(cache.Find(5) == nullptr);
+    REQUIRE(cache.Find(4) != nullptr);
+
+    // Reinserting a key replaces its output.
+    cache.Insert(4, MakeOutput(5));
+    REQUIRE(cache.Count() == 1);
+    REQUIRE(cache.SizeBytes() == 20);
+}
+
+TEST_CASE("AACDecoder answers decode requests asynchronously", "[audio_core][hle]") {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    AACDecoder decoder(memory);
+
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    constexpr u32 dst_ch0 = 0x1000;
+    constexpr u32 dst_ch1 = 0x100000;
+
+    BinaryMessage request{};
+    request.header.codec = DecoderCodec::DecodeAAC;
+    request.header.cmd = DecoderCommand::Init;
+    REQUIRE(decoder.SubmitRequest(request)->header.result == ResultStatus::Success);
+
+    request.header.cmd = DecoderCommand::EncodeDecode;
+    request.decode_aac_request.src_addr = Memory::FCRAM_PADDR;
+    request.decode_aac_request.size = fixure_buffer_size;
+    request.decode_aac_request.dst_addr_ch0 = Memory::FCRAM_PADDR + dst_ch0;
+    request.decode_aac_request.dst_addr_ch1 = Memory::FCRAM_PADDR + dst_ch1;
+
+    // The third request repeats the second one including the frame before it, so it is served
+    // from the cache.
+    std::vector<BinaryMessage> responses;
+    std::vector<std::vector<u8>> outputs;
+    for (int i = 0; i < 3; i++) {
+        std::memcpy(fcram, fixure_buffer, fixure_buffer_size);
+        REQUIRE(!decoder.SubmitRequest(request).has_value());
+        // The input is copied on submission, so the application may reuse the buffer.
+        std::memset(fcram, 0, fixure_buffer_size);
+        std::memset(fcram + dst_ch0, 0, 4096);
+
+        auto popped = decoder.PopResponses();
+        REQUIRE(popped.size() == 1);
+        responses.push_back(popped[0]);
+        outputs.emplace_back(fcram + dst_ch0, fcram + dst_ch0 + 4096);
+    }
+    REQUIRE(decoder.PopResponses().empty());
+
+    REQUIRE(responses[1].decode_aac_response.num_samples > 0);
+    REQUIRE(std::memcmp(&responses[1], &responses[2], sizeof(BinaryMessage)) == 0);
+    REQUIRE(outputs[1] == outputs[2]);
+
+    SECTION("requests in flight complete in submission order") {
+        std::memcpy(fcram, fixure_buffer, fixure_buffer_size);
+        for (u32 i = 0; i < 4; i++) {
+            request.decode_aac_request.dst_addr_ch0 = Memory::FCRAM_PADDR + dst_ch0 + i * 0x1000;
+            REQUIRE(!decoder.SubmitRequest(request).has_value());
+        }
+        const auto in_flight = decoder.PopResponses();
+        REQUIRE(in_flight.size() == 4);
+        for (const auto& response : in_flight) {
+            REQUIRE(response.decode_aac_response.num_samples ==
+                    responses[1].decode_aac_response.num_samples);
+        }
+    }
+
+    SECTION("requests answered right away wait for the decodes before them") {
+        std::memcpy(fcram, fixure_buffer, fixure_buffer_size);
+        BinaryMessage init{};
+        init.header.codec = DecoderCodec::DecodeAAC;
+        init.header.cmd = DecoderCommand::Init;
+        REQUIRE(!decoder.SubmitRequest(request).has_value());
+        REQUIRE(!decoder.SubmitRequest(init).has_value());
+        REQUIRE(!decoder.SubmitRequest(request).has_value());
+
+        const auto in_flight = decoder.PopResponses();
+        REQUIRE(in_flight.size() == 3);
+        REQUIRE(in_flight[0].header.cmd == DecoderCommand::EncodeDecode);
+        REQUIRE(in_flight[1].header.cmd == DecoderCommand::Init);
+        REQUIRE(in_flight[1].header.result == ResultStatus::Success);
+        REQUIRE(in_flight[2].header.cmd == DecoderCommand::EncodeDecode);
+
+        // Once nothing is in flight, they are answered right away again.
+        REQUIRE(decoder.SubmitRequest(init).has_value());
+    }
+}
+
+} // namespace AudioCore::HLE
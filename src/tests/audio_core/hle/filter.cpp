@@ -0,0 +1,108 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/hle/filter.h"
+
+namespace AudioCore::HLE {
+
+using Configuration = SourceConfiguration::Configuration;
+
+static StereoFrame16 RandomFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return frame;
+}
+
+static s16 RandomCoefficient(std::mt19937& rng) {
+    // Small enough that the sum of the terms of the difference equations fits in 32 bits.
+    return static_cast<s16>(std::uniform_int_distribution<int>(-0x3000, 0x3000)(rng));
+}
+
+/// The difference equations of both filters, one sample and channel at a time.
+struct ReferenceFilters {
+    bool simple_enabled = false;
+    bool biquad_enabled = false;
+    s32 simple_b0 = 1 << 15, simple_a1 = 0;
+    s32 b0 = 1 << 14, b1 = 0, b2 = 0, a1 = 0, a2 = 0;
+    std::array<s32, 2> simple_y1{}, x1{}, x2{}, y1{}, y2{};
+
+    void ProcessFrame(StereoFrame16& frame) {
+        for (auto& sample : frame) {
+            for (std::size_t i = 0; i < 2; i++) {
+                s32 x0 = sample[i];
+                if (simple_enabled) {
+                    x0 = std::clamp((simple_b0 * x0 + simple_a1 * simple_y1[i]) >> 15, -32768,
+                                    32767);
+                    simple_y1[i] = x0;
+                }
+                if (biquad_enabled) {
+                    const s32 y0 = std::clamp(
+                        (b0 * x0 + b1 * x1[i] + b2 * x2[i] + a1 * y1[i] + a2 * y2[i]) >> 14,
+                        -32768, 32767);
+                    x2[i] = x1[i];
+                    x1[i] = x0;
+                    y2[i] = y1[i];
+                    y1[i] = y0;
+                    x0 = y0;
+                }
+                sample[i] = static_cast<s16>(x0);
+            }
+        }
+    }
+};
+
+TEST_CASE("SourceFilters match the difference equations", "[audio_core][hle]") {
+    std::mt19937 rng(0xf117);
+
+    for (int round = 0; round < 16; round++) {
+        SourceFilters filters;
+        ReferenceFilters reference;
+
+        reference.simple_enabled = round % 2 == 0;
+        reference.biquad_enabled = round % 4 < 2 || round == 15;
+        filters.Enable(reference.simple_enabled, reference.biquad_enabled);
+
+        // Half of the rounds keep the passthrough coefficients the filters are reset to.
+        if (round < 8) {
+            Configuration::SimpleFilter simple{};
+            simple.b0 = RandomCoefficient(rng);
+            simple.a1 = RandomCoefficient(rng);
+            filters.Configure(simple);
+            reference.simple_b0 = simple.b0;
+            reference.simple_a1 = simple.a1;
+
+            Configuration::BiquadFilter biquad{};
+            biquad.b0 = RandomCoefficient(rng);
+            biquad.b1 = RandomCoefficient(rng);
+            biquad.b2 = RandomCoefficient(rng);
+            biquad.a1 = RandomCoefficient(rng);
+            biquad.a2 = RandomCoefficient(rng);
+            filters.Configure(biquad);
+            reference.b0 = biquad.b0;
+            reference.b1 = biquad.b1;
+            reference.b2 = biquad.b2;
+            reference.a1 = biquad.a1;
+            reference.a2 = biquad.a2;
+        }
+
+        // Several frames, so that the filter state is carried from one to the next.
+        for (int frame = 0; frame < 4; frame++) {
+            StereoFrame16 expected = RandomFrame(rng);
+            StereoFrame16 actual = expected;
+            reference.ProcessFrame(expected);
+            filters.ProcessFrame(actual);
+            INFO("round " << round << " frame " << frame);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+} // namespace AudioCore::HLE
@@ -3,11 +3,16 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <array>
+#include <cstring>
+#include <functional>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/core.h>
 
 #include "audio_core/hle/decoder.h"
 #include "audio_core/hle/hle.h"
+#include "audio_core/hle/shared_memory.h"
 #include "audio_core/lle/lle.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
@@ -26,7 +31,7 @@ TEST_CASE("DSP LLE vs HLE", "[audio_core][hle]") {
         lle_memory, lle_core_timing, [] {}, Kernel::MemoryMode::Prod, 1,
         Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
 
-    AudioCore::DspHle hle(system, hle_memory, hle_core_timing);
+    AudioCore::DspHle hle(system, hle_memory, hle_core_timing, false);
     AudioCore::DspLle lle(system, lle_memory, lle_core_timing, true);
 
     // Initialise LLE
@@ -140,3 +145,314 @@ TEST_CASE("DSP LLE vs HLE", "[audio_core][hle]") {
         REQUIRE(hle_read_buffer == lle_read_buffer);
     }
 }
+
+namespace {
+
+namespace HLE = AudioCore::HLE;
+using Configuration = HLE::SourceConfiguration::Configuration;
+
+constexpr u32 pcm16_offset = 0x1000;
+constexpr u32 pcm8_offset = 0x10000;
+constexpr u32 adpcm_offset = 0x20000;
+
+void FillSampleData(Memory::MemorySystem& memory) {
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    for (u32 i = 0; i < 0x8000; i++) {
+        const s16 sample = static_cast<s16>((i * 997) ^ (i << 7));
+        std::memcpy(fcram + pcm16_offset + i * sizeof(s16), &sample, sizeof(sample));
+        fcram[pcm8_offset + i] = static_cast<u8>(i * 13 + (i >> 5));
+        // Keep the ADPCM headers within the range of valid predictors.
+        fcram[adpcm_offset + i] = i % 8 == 0 ? static_cast<u8>(i / 8 % 0x80) : static_cast<u8>(i);
+    }
+}
+
+void SetEmbeddedBuffer(Configuration& config, u32 offset, u32 length, u16 buffer_id,
+                       bool looping) {
+    config.physical_address = Memory::FCRAM_PADDR + offset;
+    config.length = length;
+    config.buffer_id = buffer_id;
+    config.play_position = 0;
+    config.is_looping.Assign(looping);
+    config.embedded_buffer_dirty.Assign(1);
+}
+
+void QueueBuffer(Configuration& config, std::size_t slot, u32 offset, u32 length, u16 buffer_id) {
+    auto& buffer = config.buffers[slot];
+    buffer.physical_address = Memory::FCRAM_PADDR + offset;
+    buffer.length = length;
+    buffer.buffer_id = buffer_id;
+    buffer.is_looping = 0;
+    buffer.adpcm_dirty = 0;
+    config.buffers_dirty = static_cast<u16>(config.buffers_dirty | (1 << slot));
+    config.buffer_queue_dirty.Assign(1);
+}
+
+void SetGain(Configuration& config, std::size_t mix, float gain) {
+    for (auto& channel : config.gain[mix]) {
+        channel = gain;
+    }
+    config.dirty_raw = config.dirty_raw | (1u << (25 + mix));
+}
+
+/// Applies the scripted application-side updates for a frame to the region the DSP will read.
+void ApplyCommands(std::size_t frame, HLE::SharedMemory& region) {
+    auto& configs = region.source_configurations.config;
+    auto& dsp_config = region.dsp_configuration;
+
+    switch (frame) {
+    case 0: {
+        auto& stereo = configs[0];
+        stereo.enable = 1;
+        stereo.enable_dirty.Assign(1);
+        stereo.format.Assign(Configuration::Format::PCM16);
+        stereo.mono_or_stereo.Assign(Configuration::MonoOrStereo::Stereo);
+        stereo.format_dirty.Assign(1);
+        stereo.mono_or_stereo_dirty.Assign(1);
+        stereo.interpolation_mode = Configuration::InterpolationMode::Polyphase;
+        stereo.interpolation_dirty.Assign(1);
+        stereo.rate_multiplier = 1.25f;
+        stereo.rate_multiplier_dirty.Assign(1);
+        SetGain(stereo, 0, 0.75f);
+        SetEmbeddedBuffer(stereo, pcm16_offset, 0x1800, 1, false);
+        QueueBuffer(stereo, 0, pcm16_offset + 0x6000, 0x800, 2);
+
+        auto& mono = configs[1];
+        mono.enable = 1;
+        mono.enable_dirty.Assign(1);
+        mono.format.Assign(Configuration::Format::PCM8);
+        mono.mono_or_stereo.Assign(Configuration::MonoOrStereo::Mono);
+        mono.format_dirty.Assign(1);
+        mono.mono_or_stereo_dirty.Assign(1);
+        mono.interpolation_mode = Configuration::InterpolationMode::Linear;
+        mono.interpolation_dirty.Assign(1);
+        mono.rate_multiplier = 0.7f;
+        mono.rate_multiplier_dirty.Assign(1);
+        SetGain(mono, 0, 0.5f);
+        SetGain(mono, 1, 0.25f);
+        mono.simple_filter_enabled.Assign(1);
+        mono.filters_enabled_dirty.Assign(1);
+        mono.simple_filter.b0 = 0x3000;
+        mono.simple_filter.a1 = 0x2000;
+        mono.simple_filter_dirty.Assign(1);
+        SetEmbeddedBuffer(mono, pcm8_offset, 0x4000, 3, true);
+
+        auto& adpcm = configs[2];
+        adpcm.enable = 1;
+        adpcm.enable_dirty.Assign(1);
+        adpcm.format.Assign(Configuration::Format::ADPCM);
+        adpcm.mono_or_stereo.Assign(Configuration::MonoOrStereo::Mono);
+        adpcm.format_dirty.Assign(1);
+        adpcm.mono_or_stereo_dirty.Assign(1);
+        adpcm.interpolation_mode = Configuration::InterpolationMode::None;
+        adpcm.interpolation_dirty.Assign(1);
+        adpcm.rate_multiplier = 1.0f;
+        adpcm.rate_multiplier_dirty.Assign(1);
+        SetGain(adpcm, 0, 1.0f);
+        SetGain(adpcm, 2, 0.5f);
+        adpcm.biquad_filter_enabled.Assign(1);
+        adpcm.filters_enabled_dirty.Assign(1);
+        adpcm.biquad_filter.b0 = 0x1000;
+        adpcm.biquad_filter.b1 = 0x2000;
+        adpcm.biquad_filter.b2 = 0x1000;
+        adpcm.biquad_filter.a1 = 0x1800;
+        adpcm.biquad_filter.a2 = -0x0800;
+        adpcm.biquad_filter_dirty.Assign(1);
+        for (std::size_t i = 0; i < 16; i++) {
+            region.adpcm_coefficients.coeff[2][i] = static_cast<s16>((i % 2 ? -1 : 1) * 0x100 * i);
+        }
+        adpcm.adpcm_coefficients_dirty.Assign(1);
+        adpcm.adpcm_ps = 0x12;
+        adpcm.adpcm_yn[0] = 0;
+        adpcm.adpcm_yn[1] = 0;
+        adpcm.adpcm_dirty.Assign(1);
+        SetEmbeddedBuffer(adpcm, adpcm_offset, 0x6000, 4, false);
+
+        dsp_config.master_volume = 1.0f;
+        dsp_config.master_volume_dirty.Assign(1);
+        dsp_config.aux_bus_enable[0] = 1;
+        dsp_config.aux_bus_enable_0_dirty.Assign(1);
+        dsp_config.aux_return_volume[0] = 0.5f;
+        dsp_config.aux_return_volume_0_dirty.Assign(1);
+        dsp_config.aux_return_volume[1] = 0.25f;
+        dsp_config.aux_return_volume_1_dirty.Assign(1);
+        break;
+    }
+    case 40:
+        configs[0].rate_multiplier = 0.8f;
+        configs[0].rate_multiplier_dirty.Assign(1);
+        SetGain(configs[1], 0, 0.9f);
+        break;
+    case 70:
+        QueueBuffer(configs[0], 1, pcm16_offset + 0x8000, 0x1000, 5);
+        break;
+    case 90:
+        configs[1].enable = 0;
+        configs[1].enable_dirty.Assign(1);
+        break;
+    case 120:
+        dsp_config.output_format = HLE::DspConfiguration::OutputFormat::Mono;
+        dsp_config.output_format_dirty.Assign(1);
+        break;
+    default:
+        break;
+    }
+
+    // The application processes aux bus 0 and hands it back every frame.
+    for (std::size_t channel = 0; channel < 4; channel++) {
+        for (std::size_t sample = 0; sample < AudioCore::samples_per_frame; sample++) {
+            region.intermediate_mix_samples.mix1.pcm32[channel][sample] =
+                static_cast<s32>((frame * 7919 + channel * 131 + sample * 17) % 0x4000) - 0x2000;
+        }
+    }
+}
+
+/// Sample memory the application rewrote while the DSP was generating a frame.
+struct SampleWrite {
+    u32 offset;
+    std::vector<u8> data;
+};
+
+/// Everything the application did for an audio frame: the image of the shared memory region the
+/// DSP reads, and the sample memory it rewrote right after the DSP was signalled.
+struct RecordedFrame {
+    std::vector<u8> region;
+    std::vector<SampleWrite> sample_writes;
+};
+
+/// The application streams new samples into each sample area, a chunk per frame.
+std::vector<SampleWrite> RewriteSamples(std::size_t frame) {
+    constexpr u32 chunk_size = 0x200;
+    constexpr std::array<std::pair<u32, u32>, 3> areas{{
+        {pcm16_offset, 0xF000},
+        {pcm8_offset, 0x8000},
+        {adpcm_offset, 0x8000},
+    }};
+
+    std::vector<SampleWrite> writes;
+    for (const auto& [area_offset, area_size] : areas) {
+        const u32 offset = static_cast<u32>(frame * chunk_size % area_size);
+        auto& write = writes.emplace_back(SampleWrite{area_offset + offset, {}});
+        write.data.resize(chunk_size);
+        for (u32 i = 0; i < chunk_size; i++) {
+            const u8 value = static_cast<u8>(frame * 31 + i * 7 + (i >> 3));
+            const bool adpcm_header = area_offset == adpcm_offset && (offset + i) % 8 == 0;
+            write.data[i] = adpcm_header ? value % 0x80 : value;
+        }
+    }
+    return writes;
+}
+
+void ApplySampleWrites(Memory::MemorySystem& memory, const std::vector<SampleWrite>& writes) {
+    u8* const fcram = memory.GetFCRAMPointer(0);
+    for (const auto& write : writes) {
+        std::memcpy(fcram + write.offset, write.data.data(), write.data.size());
+    }
+}
+
+/// Appends the raw bytes of a shared memory struct to a record.
+template <typename T>
+void Record(std::vector<u8>& record, const T& data) {
+    const auto* const bytes = reinterpret_cast<const u8*>(&data);
+    record.insert(record.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * Runs DspHle for num_frames audio frames and records everything the DSP wrote back to the shared
+ * memory region after each of them.
+ * @param before_tick Called with the region the DSP reads next, before the frame.
+ * @param after_tick Called right after the DSP was signalled, while a multithreaded DSP is still
+ *                   generating the frame.
+ */
+std::vector<std::vector<u8>> RunDsp(
+    bool multithread, std::size_t num_frames,
+    const std::function<void(std::size_t, HLE::SharedMemory&)>& before_tick,
+    const std::function<void(std::size_t, Memory::MemorySystem&)>& after_tick) {
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Core::Timing timing(1, 100);
+    AudioCore::DspHle dsp(system, memory, timing, multithread);
+
+    std::size_t audio_interrupts = 0;
+    dsp.SetInterruptHandler([&](Service::DSP::InterruptType, AudioCore::DspPipe pipe) {
+        if (pipe == AudioCore::DspPipe::Audio) {
+            audio_interrupts++;
+        }
+    });
+
+    FillSampleData(memory);
+    const std::vector<u8> initialize(4, 0);
+    dsp.PipeWrite(AudioCore::DspPipe::Audio, initialize);
+
+    auto& dsp_memory = *reinterpret_cast<HLE::DspMemory*>(dsp.GetDspMemory().data());
+    std::vector<std::vector<u8>> records;
+    for (std::size_t frame = 0; frame < num_frames; frame++) {
+        HLE::SharedMemory& read = frame % 2 == 0 ? dsp_memory.region_0 : dsp_memory.region_1;
+        HLE::SharedMemory& write = frame % 2 == 0 ? dsp_memory.region_1 : dsp_memory.region_0;
+        before_tick(frame, read);
+
+        const std::size_t interrupts_before = audio_interrupts;
+        while (audio_interrupts == interrupts_before) {
+            timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+            timing.GetTimer(0)->Advance();
+            timing.GetTimer(0)->SetNextSlice();
+        }
+        after_tick(frame, memory);
+
+        std::vector<u8>& record = records.emplace_back();
+        Record(record, write.final_samples);
+        Record(record, write.source_statuses);
+        Record(record, write.dsp_status);
+        Record(record, write.intermediate_mix_samples.mix1);
+    }
+    return records;
+}
+
+/// Runs the scripted application against a synchronous DSP and records what it did every frame.
+std::vector<RecordedFrame> RecordCommandStream(std::size_t num_frames,
+                                               std::vector<std::vector<u8>>& output) {
+    std::vector<RecordedFrame> stream(num_frames);
+    output = RunDsp(
+        false, num_frames,
+        [&](std::size_t frame, HLE::SharedMemory& region) {
+            ApplyCommands(frame, region);
+            region.frame_counter = static_cast<u16>(frame + 1);
+            Record(stream[frame].region, region);
+        },
+        [&](std::size_t frame, Memory::MemorySystem& memory) {
+            stream[frame].sample_writes = RewriteSamples(frame);
+            ApplySampleWrites(memory, stream[frame].sample_writes);
+        });
+    return stream;
+}
+
+/// Replays a recorded command stream into a fresh DSP.
+std::vector<std::vector<u8>> ReplayCommandStream(bool multithread,
+                                                 const std::vector<RecordedFrame>& stream) {
+    return RunDsp(
+        multithread, stream.size(),
+        [&](std::size_t frame, HLE::SharedMemory& region) {
+            std::memcpy(&region, stream[frame].region.data(), sizeof(region));
+        },
+        [&](std::size_t frame, Memory::MemorySystem& memory) {
+            ApplySampleWrites(memory, stream[frame].sample_writes);
+        });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DSP HLE multithreaded matches synchronous", "[audio_core][hle]") {
+    constexpr std::size_t num_frames = 160;
+    std::vector<std::vector<u8>> recorded;
+    const auto stream = RecordCommandStream(num_frames, recorded);
+
+    const auto synchronous = ReplayCommandStream(false, stream);
+    REQUIRE(synchronous == recorded);
+
+    // The multithreaded DSP writes each frame back one frame later. The sample memory the
+    // application rewrites while the frame is generated must not leak into it.
+    const auto multithreaded = ReplayCommandStream(true, stream);
+    for (std::size_t frame = 0; frame + 1 < num_frames; frame++) {
+        INFO("frame " << frame);
+        REQUIRE(multithreaded[frame + 1] == synchronous[frame]);
+    }
+}
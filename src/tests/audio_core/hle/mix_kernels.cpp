@@ -0,0 +1,144 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <random>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators_range.hpp>
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/mix_kernels.h"
+
+namespace AudioCore::HLE {
+
+static StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {static_cast<s16>(dist(rng)), static_cast<s16>(dist(rng))};
+    }
+    return frame;
+}
+
+static QuadFrame32 RandomQuadFrame(std::mt19937& rng, s32 range) {
+    std::uniform_int_distribution<s32> dist(-range, range);
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        for (auto& channel : sample) {
+            channel = dist(rng);
+        }
+    }
+    return frame;
+}
+
+static std::array<float, 4> RandomGains(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    return {dist(rng), dist(rng), dist(rng), dist(rng)};
+}
+
+TEST_CASE("MixKernels match the generic implementation", "[audio_core][hle]") {
+    const MixKernels& generic = GetGenericMixKernels();
+    // Every implementation the host supports is tested, not just the one GetMixKernels picks.
+    const auto supported = GetSupportedMixKernels();
+    const auto& [name, host] = supported[GENERATE_COPY(range(std::size_t{0}, supported.size()))];
+    INFO(name);
+    std::mt19937 rng(0x3d5);
+
+    SECTION("mix_into_quad") {
+        for (int round = 0; round < 64; round++) {
+            const StereoFrame16 source = RandomStereoFrame(rng);
+            const std::array<float, 4> gains = RandomGains(rng);
+            QuadFrame32 expected = RandomQuadFrame(rng, 1 << 20);
+            QuadFrame32 actual = expected;
+            generic.mix_into_quad(expected, source, gains);
+            host.mix_into_quad(actual, source, gains);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("downmix") {
+        for (int round = 0; round < 64; round++) {
+            // Large enough to exercise saturation at both the downmix and the accumulation.
+            const QuadFrame32 source = RandomQuadFrame(rng, 1 << 17);
+            const float gain = std::uniform_real_distribution<float>(0.0f, 1.5f)(rng);
+            const StereoFrame16 accumulator = RandomStereoFrame(rng);
+
+            StereoFrame16 expected = accumulator;
+            StereoFrame16 actual = accumulator;
+            generic.downmix_stereo(expected, source, gain);
+            host.downmix_stereo(actual, source, gain);
+            REQUIRE(actual == expected);
+
+            expected = accumulator;
+            actual = accumulator;
+            generic.downmix_mono(expected, source, gain);
+            host.downmix_mono(actual, source, gain);
+            REQUIRE(actual == expected);
+        }
+    }
+
+    SECTION("planar conversion") {
+        const QuadFrame32 source = RandomQuadFrame(rng, 1 << 30);
+        PlanarQuadFrame32 planar;
+        host.quad_to_planar(planar, source);
+        for (std::size_t sample = 0; sample < samples_per_frame; sample++) {
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                REQUIRE(planar[channel][sample] == source[sample][channel]);
+            }
+        }
+
+        QuadFrame32 roundtrip{};
+        host.planar_to_quad(roundtrip, planar);
+        REQUIRE(roundtrip == source);
+    }
+}
+
+TEST_CASE("MixKernels[Benchmark]", "[.][audio_core][hle][benchmark]") {
+    // A synthetic frame with every voice playing into all three intermediate mixes, followed by
+    // the aux transfers and final downmix, i.e. the per-frame mixing work of a busy game.
+    std::mt19937 rng(24);
+    std::array<StereoFrame16, num_sources> voices;
+    std::array<std::array<std::array<float, 4>, 3>, num_sources> gains;
+    for (std::size_t i = 0; i < num_sources; i++) {
+        voices[i] = RandomStereoFrame(rng);
+        for (auto& mix_gains : gains[i]) {
+            mix_gains = RandomGains(rng);
+        }
+    }
+
+    auto mixes = std::make_unique<std::array<QuadFrame32, 3>>();
+    auto planar = std::make_unique<std::array<PlanarQuadFrame32, 2>>();
+    StereoFrame16 output;
+
+    const auto run_frame = [&](const MixKernels& kernels) {
+        for (auto& mix : *mixes) {
+            mix.fill({});
+        }
+        for (std::size_t i = 0; i < num_sources; i++) {
+            for (std::size_t mix = 0; mix < 3; mix++) {
+                kernels.mix_into_quad((*mixes)[mix], voices[i], gains[i][mix]);
+            }
+        }
+        kernels.quad_to_planar((*planar)[0], (*mixes)[1]);
+        kernels.quad_to_planar((*planar)[1], (*mixes)[2]);
+        kernels.planar_to_quad((*mixes)[1], (*planar)[0]);
+        kernels.planar_to_quad((*mixes)[2], (*planar)[1]);
+        output.fill({});
+        for (const auto& mix : *mixes) {
+            kernels.downmix_stereo(output, mix, 0.8f);
+        }
+        return output[0][0];
+    };
+
+    BENCHMARK("Generic 24 voices") {
+        return run_frame(GetGenericMixKernels());
+    };
+
+    BENCHMARK("Host 24 voices") {
+        return run_frame(GetMixKernels());
+    };
+}
+
+} // namespace AudioCore::HLE
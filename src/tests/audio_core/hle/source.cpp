@@ -1,7 +1,12 @@
 #include <cstdio>
+#include <cstring>
 #include <catch2/catch_template_test_macros.hpp>
 #include "audio_core/hle/shared_memory.h"
+#include "audio_core/hle/source.h"
+#include "audio_core/stage_timings.h"
 #include "common/settings.h"
+#include "core/core.h"
+#include "core/memory.h"
 #include "tests/audio_core/merryhime_3ds_audio/merry_audio/merry_audio.h"
 
 TEST_CASE_METHOD(MerryAudio::MerryAudioFixture, "Verify SourceStatus::Status::last_buffer_id 1",
@@ -377,3 +382,71 @@ TEST_CASE_METHOD(MerryAudio::MerryAudioFixture, "Verify SourceStatus::Status::la
 end:
     audioExit(state);
 }
+
+TEST_CASE("Source decodes a looping buffer once until it is written", "[audio_core][hle]") {
+    using Configuration = AudioCore::HLE::SourceConfiguration::Configuration;
+    constexpr u32 length = 0x100;
+
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    u8* const samples = memory.GetFCRAMPointer(0);
+    for (u32 i = 0; i < length; i++) {
+        samples[i] = static_cast<u8>(i * 37);
+    }
+
+    AudioCore::HLE::Source source(0);
+    source.SetMemory(memory);
+    const s16_le adpcm_coeffs[16] = {};
+
+    Configuration config{};
+    config.enable = 1;
+    config.enable_dirty.Assign(1);
+    config.format.Assign(Configuration::Format::PCM8);
+    config.mono_or_stereo.Assign(Configuration::MonoOrStereo::Mono);
+    config.interpolation_mode = Configuration::InterpolationMode::None;
+    config.interpolation_dirty.Assign(1);
+    config.rate_multiplier = 1.0f;
+    config.rate_multiplier_dirty.Assign(1);
+    config.gain[0][0] = 1.0f;
+    config.gain_0_dirty.Assign(1);
+    config.physical_address = Memory::FCRAM_PADDR;
+    config.length = length;
+    config.buffer_id = 1;
+    config.is_looping.Assign(1);
+    config.embedded_buffer_dirty.Assign(1);
+
+    const auto run_frame = [&] {
+        source.PrepareFrame(config, adpcm_coeffs);
+        source.Tick();
+        AudioCore::QuadFrame32 output{};
+        source.MixInto(output, 0);
+        return output;
+    };
+    const auto decode_count = [] {
+        return AudioCore::GetStageTimings()[static_cast<std::size_t>(
+                                                AudioCore::AudioStage::SourceDecode)]
+            .calls;
+    };
+
+    AudioCore::SetStageTimingEnabled(true);
+    AudioCore::ResetStageTimings();
+
+    // The buffer loops several times over these frames.
+    for (int frame = 0; frame < 8; frame++) {
+        run_frame();
+    }
+    REQUIRE(decode_count() == 1);
+
+    // Rewriting the buffer is picked up by the next frame, and then kept again. The loop already
+    // playing finishes with the old samples.
+    std::memset(samples, 0x10, length);
+    run_frame();
+    run_frame();
+    const auto output = run_frame();
+    REQUIRE(decode_count() == 2);
+    for (const auto& sample : output) {
+        REQUIRE(sample[0] == 0x1000);
+    }
+
+    AudioCore::SetStageTimingEnabled(false);
+}
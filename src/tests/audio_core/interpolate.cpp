@@ -0,0 +1,165 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore::AudioInterp {
+
+static StereoBuffer16 MakeRamp(std::size_t size) {
+    StereoBuffer16 samples(size);
+    for (std::size_t i = 0; i < size; i++) {
+        samples[i] = {static_cast<s16>(i * 97), static_cast<s16>(-static_cast<s16>(i * 31))};
+    }
+    return samples;
+}
+
+TEST_CASE("AudioInterp::Linear consumes input by index", "[audio_core]") {
+    const StereoBuffer16 input = MakeRamp(400);
+    constexpr float rate = 1.37f;
+
+    // Reference: the whole buffer at once.
+    State whole_state{};
+    StereoFrame16 whole_frame{};
+    std::size_t whole_inputi = 0;
+    std::size_t whole_outputi = 0;
+    Linear(whole_state, input, whole_inputi, rate, whole_frame, whole_outputi);
+    REQUIRE(whole_outputi == whole_frame.size());
+
+    // The same buffer split into several smaller ones must give identical results, which
+    // exercises carrying the history samples across calls.
+    State split_state{};
+    StereoFrame16 split_frame{};
+    std::size_t split_outputi = 0;
+    for (std::size_t offset = 0; offset < input.size() && split_outputi < split_frame.size();
+         offset += 23) {
+        const StereoSpan16 chunk =
+            StereoSpan16{input}.subspan(offset, std::min<std::size_t>(23, input.size() - offset));
+        std::size_t chunk_inputi = 0;
+        while (chunk_inputi < chunk.size() && split_outputi < split_frame.size()) {
+            Linear(split_state, chunk, chunk_inputi, rate, split_frame, split_outputi);
+        }
+    }
+
+    CHECK(split_outputi == whole_outputi);
+    CHECK(split_frame == whole_frame);
+    CHECK(split_state.xn1 == whole_state.xn1);
+    CHECK(split_state.xn2 == whole_state.xn2);
+}
+
+TEST_CASE("AudioInterp::None leaves unconsumed input in place", "[audio_core]") {
+    const StereoBuffer16 input = MakeRamp(300);
+
+    State state{};
+    StereoFrame16 frame{};
+    std::size_t inputi = 0;
+    std::size_t outputi = 0;
+    None(state, input, inputi, 1.0f, frame, outputi);
+
+    // There is a two-sample predelay, so the frame starts with the (zero) history samples.
+    REQUIRE(outputi == frame.size());
+    CHECK(frame[0] == std::array<s16, 2>{});
+    CHECK(frame[1] == std::array<s16, 2>{});
+    CHECK(frame[2] == input[0]);
+    CHECK(inputi < input.size());
+    CHECK(state.xn1 == input[inputi - 1]);
+
+    // Continuing from inputi carries on where the previous frame stopped.
+    StereoFrame16 next_frame{};
+    outputi = 0;
+    None(state, input, inputi, 1.0f, next_frame, outputi);
+    CHECK(next_frame[0] == input[frame.size() - 2]);
+}
+
+TEST_CASE("AudioInterp::Polyphase reconstructs a sine wave", "[audio_core]") {
+    constexpr double amplitude = 12000.0;
+    constexpr double frequency = 0.01; // cycles per input sample
+    StereoBuffer16 input(4000);
+    for (std::size_t i = 0; i < input.size(); i++) {
+        const auto value = static_cast<s16>(
+            std::lround(amplitude * std::sin(2 * std::numbers::pi * frequency * i)));
+        input[i] = {value, static_cast<s16>(-value)};
+    }
+
+    const float rate = GENERATE(0.5f, 1.0f, 1.25f, 1.7f);
+    // The decimation banks trade some passband accuracy for less aliasing.
+    const double tolerance = rate <= 1.0f ? 2.0 : 16.0;
+
+    State state{};
+    std::size_t inputi = 0;
+    std::size_t produced = 0;
+    double max_error = 0.0;
+    for (int frame = 0; frame < 10; frame++) {
+        StereoFrame16 output{};
+        std::size_t outputi = 0;
+        Polyphase(state, input, inputi, rate, output, outputi);
+        REQUIRE(outputi == output.size());
+
+        for (std::size_t k = 0; k < outputi; k++, produced++) {
+            // Like the other interpolators there is a two-sample predelay.
+            const double position = static_cast<double>(produced) * rate - 2.0;
+            if (position < 2.0) {
+                continue;
+            }
+            const double expected =
+                amplitude * std::sin(2 * std::numbers::pi * frequency * position);
+            max_error = std::max(max_error, std::abs(output[k][0] - expected));
+            CHECK(std::abs(output[k][0] + output[k][1]) <= 1);
+        }
+    }
+    CHECK(max_error < tolerance);
+}
+
+TEST_CASE("AudioInterp::Polyphase passes input through at rate 1", "[audio_core]") {
+    // Every output sample then falls on phase 0, where the windowed sinc is zero at all taps but
+    // the one under the output. Only the Q15 rounding of that tap may show.
+    const StereoBuffer16 input = MakeRamp(400);
+
+    State state{};
+    StereoFrame16 frame{};
+    std::size_t inputi = 0;
+    std::size_t outputi = 0;
+    Polyphase(state, input, inputi, 1.0f, frame, outputi);
+    REQUIRE(outputi == frame.size());
+
+    // Like the other interpolators there is a two-sample predelay.
+    for (std::size_t i = 2; i < frame.size(); i++) {
+        CHECK(std::abs(frame[i][0] - input[i - 2][0]) <= 1);
+        CHECK(std::abs(frame[i][1] - input[i - 2][1]) <= 1);
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase consumes input by index", "[audio_core]") {
+    const StereoBuffer16 input = MakeRamp(400);
+    constexpr float rate = 0.73f;
+
+    State whole_state{};
+    StereoFrame16 whole_frame{};
+    std::size_t whole_inputi = 0;
+    std::size_t whole_outputi = 0;
+    Polyphase(whole_state, input, whole_inputi, rate, whole_frame, whole_outputi);
+    REQUIRE(whole_outputi == whole_frame.size());
+
+    State split_state{};
+    StereoFrame16 split_frame{};
+    std::size_t split_outputi = 0;
+    for (std::size_t offset = 0; offset < input.size() && split_outputi < split_frame.size();
+         offset += 2) {
+        const StereoSpan16 chunk = StereoSpan16{input}.subspan(offset, 2);
+        std::size_t chunk_inputi = 0;
+        Polyphase(split_state, chunk, chunk_inputi, rate, split_frame, split_outputi);
+    }
+
+    CHECK(split_frame == whole_frame);
+    CHECK(split_state.xn1 == whole_state.xn1);
+    CHECK(split_state.xn2 == whole_state.xn2);
+    CHECK(split_state.xn3 == whole_state.xn3);
+}
+
+} // namespace AudioCore::AudioInterp
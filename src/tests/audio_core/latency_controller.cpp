@@ -0,0 +1,71 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/latency_controller.h"
+
+namespace AudioCore {
+
+TEST_CASE("LatencyController steers towards the target", "[audio_core]") {
+    constexpr std::size_t callback_frames = 512;
+    LatencyController controller(0x1800);
+    controller.SetSampleRate(native_sample_rate);
+
+    SECTION("starts from two callbacks of latency") {
+        controller.Update(0, callback_frames);
+        REQUIRE(controller.GetTargetLevel() == callback_frames * 2);
+    }
+
+    SECTION("consumes faster when overfull and slower when underfull") {
+        double ratio = 1.0;
+        for (int i = 0; i < 200; i++) {
+            ratio = controller.Update(0x1000, callback_frames);
+        }
+        REQUIRE(ratio > 1.0);
+        REQUIRE(ratio <= 1.005);
+
+        for (int i = 0; i < 200; i++) {
+            ratio = controller.Update(0, callback_frames);
+        }
+        REQUIRE(ratio < 1.0);
+        REQUIRE(ratio >= 0.995);
+    }
+
+    SECTION("leaves the ratio alone at the target") {
+        const double ratio = controller.Update(callback_frames * 2, callback_frames);
+        REQUIRE(ratio == 1.0);
+    }
+}
+
+TEST_CASE("LatencyController adapts the target to underruns", "[audio_core]") {
+    constexpr std::size_t callback_frames = 512;
+    LatencyController controller(0x1800);
+    controller.SetSampleRate(native_sample_rate);
+
+    controller.Update(0, callback_frames);
+    const std::size_t initial_target = controller.GetTargetLevel();
+
+    for (int i = 0; i < 3; i++) {
+        controller.ReportUnderrun();
+        controller.Update(0, callback_frames);
+    }
+    const std::size_t raised_target = controller.GetTargetLevel();
+    REQUIRE(raised_target == initial_target + 3 * callback_frames);
+
+    // Never grows past the configured maximum.
+    for (int i = 0; i < 100; i++) {
+        controller.ReportUnderrun();
+        controller.Update(0, callback_frames);
+    }
+    REQUIRE(controller.GetTargetLevel() == 0x1800);
+
+    // A long stable stretch lowers it back down towards the minimum.
+    for (int i = 0; i < 64 * 60; i++) {
+        controller.Update(controller.GetTargetLevel(), callback_frames);
+    }
+    REQUIRE(controller.GetTargetLevel() < raised_target);
+    REQUIRE(controller.GetTargetLevel() >= initial_target);
+}
+
+} // namespace AudioCore
@@ -3,6 +3,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstdlib>
+#include <optional>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/core.h>
 
@@ -100,3 +103,90 @@ TEST_CASE("DSP LLE Sanity", "[audio_core][lle]") {
         REQUIRE(resp.data == request.data);
     }
 }
+
+namespace {
+
+std::optional<std::vector<u8>> LoadFirmware() {
+    FileUtil::SetUserPath();
+    // see the test above for details on dspaudio.cdc
+    const std::string firm_filepath =
+        FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir) + "3ds" DIR_SEP "dspaudio.cdc";
+    if (!FileUtil::Exists(firm_filepath)) {
+        return std::nullopt;
+    }
+    FileUtil::IOFile firm_file(firm_filepath, "rb");
+    std::vector<u8> firm_file_buf(firm_file.GetSize());
+    firm_file.ReadArray(firm_file_buf.data(), firm_file_buf.size());
+    return firm_file_buf;
+}
+
+struct InterruptRecord {
+    Service::DSP::InterruptType type;
+    AudioCore::DspPipe pipe;
+    s64 ticks;
+};
+
+struct LleRun {
+    std::vector<InterruptRecord> interrupts;
+    std::vector<u8> audio_pipe;
+};
+
+/// Initialises the audio pipe and runs the DSP for a fixed amount of ARM time, recording every
+/// interrupt with the time it was delivered at.
+LleRun RunAudioPipeInit(Core::System& system, std::span<const u8> firm, bool multithread) {
+    Memory::MemorySystem memory{system};
+    Core::Timing core_timing(1, 100);
+    AudioCore::DspLle lle(system, memory, core_timing, multithread);
+    lle.LoadComponent(firm);
+
+    LleRun run;
+    lle.SetInterruptHandler([&](Service::DSP::InterruptType type, AudioCore::DspPipe pipe) {
+        run.interrupts.push_back({type, pipe, core_timing.GetTicks()});
+    });
+
+    std::vector<u8> buffer(4, 0);
+    lle.PipeWrite(AudioCore::DspPipe::Audio, buffer);
+    lle.SetSemaphore(0x4000);
+
+    // 20 ms is many times what the firmware needs to answer.
+    auto* timer = core_timing.GetTimer(0).get();
+    while (core_timing.GetTicks() < static_cast<s64>(BASE_CLOCK_RATE_ARM11 / 50)) {
+        timer->AddTicks(timer->GetDowncount());
+        timer->Advance();
+        timer->SetNextSlice();
+    }
+
+    run.audio_pipe = lle.PipeRead(AudioCore::DspPipe::Audio,
+                                  lle.GetPipeReadableSize(AudioCore::DspPipe::Audio));
+    lle.UnloadComponent();
+    return run;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DSP LLE pipelined matches lock-stepped", "[audio_core][lle]") {
+    const auto firm = LoadFirmware();
+    if (!firm) {
+        SKIP("Test requires dspaudio.cdc");
+    }
+
+    Core::System system;
+    const LleRun lock_stepped = RunAudioPipeInit(system, *firm, false);
+    const LleRun pipelined = RunAudioPipeInit(system, *firm, true);
+
+    REQUIRE(!lock_stepped.audio_pipe.empty());
+    REQUIRE(pipelined.audio_pipe == lock_stepped.audio_pipe);
+
+    // Interrupts raised by Teakra during a slice are delivered at the next slice event instead of
+    // right away, and the slice size adapts, so each one may arrive up to two of the largest
+    // slices (65536 DSP cycles, at half the ARM clock) later.
+    constexpr s64 MaxDelay = 2 * 65536 * 2;
+    REQUIRE(pipelined.interrupts.size() == lock_stepped.interrupts.size());
+    for (std::size_t i = 0; i < pipelined.interrupts.size(); i++) {
+        INFO("interrupt " << i);
+        REQUIRE(pipelined.interrupts[i].type == lock_stepped.interrupts[i].type);
+        REQUIRE(pipelined.interrupts[i].pipe == lock_stepped.interrupts[i].pipe);
+        REQUIRE(std::abs(pipelined.interrupts[i].ticks - lock_stepped.interrupts[i].ticks) <=
+                MaxDelay);
+    }
+}
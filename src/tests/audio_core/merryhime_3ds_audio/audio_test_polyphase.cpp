@@ -0,0 +1,224 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <optional>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "audio_core/hle/shared_memory.h"
+#include "common/settings.h"
+#include "merry_audio/merry_audio.h"
+
+namespace {
+
+constexpr std::size_t NUM_SAMPLES = 160 * 40;
+constexpr std::size_t NUM_OUTPUT_SAMPLES = 160 * 8;
+
+/// The input is silent apart from a single impulse, so the output is the impulse response of the
+/// interpolator. Unlike a slow sine, which every interpolator follows closely, the impulse
+/// response tells the filters apart.
+constexpr std::size_t IMPULSE_POSITION = 100;
+constexpr s16 IMPULSE_AMPLITUDE = 0x4000;
+
+using InterpolationMode = AudioCore::HLE::SourceConfiguration::Configuration::InterpolationMode;
+
+/// Plays the impulse in stereo through source 0 using the given interpolation mode and returns
+/// the left channel of the first auxiliary intermediate mix, starting at the first non-zero
+/// sample. Returns std::nullopt if the DSP could not be started.
+std::optional<std::vector<s32>> Render(Settings::AudioEmulation emulation, float rate,
+                                       InterpolationMode mode = InterpolationMode::Polyphase) {
+    MerryAudio::MerryAudioFixture fixture;
+
+    u32* audio_buffer = (u32*)fixture.linearAlloc(NUM_SAMPLES * sizeof(u32));
+    for (std::size_t i = 0; i < NUM_SAMPLES; i++) {
+        const auto data = static_cast<u16>(i == IMPULSE_POSITION ? IMPULSE_AMPLITUDE : 0);
+        audio_buffer[i] = (data << 16) | data;
+    }
+    fixture.DSP_FlushDataCache(audio_buffer, NUM_SAMPLES);
+
+    std::vector<u8> dspfirm;
+    fixture.InitDspCore(emulation);
+    if (emulation == Settings::AudioEmulation::HLE) {
+        // HLE AudioCore doesn't require a valid firmware
+        dspfirm = {0};
+    } else {
+        dspfirm = fixture.loadDspFirmFromFile();
+    }
+    if (dspfirm.empty()) {
+        return std::nullopt;
+    }
+    auto ret = fixture.audioInit(dspfirm);
+    if (!ret) {
+        return std::nullopt;
+    }
+    MerryAudio::AudioState state = *ret;
+
+    state.waitForSync();
+    fixture.initSharedMem(state);
+    state.write().dsp_configuration->aux_bus_enable_0_dirty.Assign(true);
+    state.write().dsp_configuration->aux_bus_enable[0] = true;
+    state.write().source_configurations->config[0].gain[1][0] = 1.0;
+    state.write().source_configurations->config[0].gain_1_dirty.Assign(true);
+    state.notifyDsp();
+    state.waitForSync();
+
+    auto& config = state.write().source_configurations->config[0];
+    config.play_position = 0;
+    config.physical_address = fixture.osConvertVirtToPhys(audio_buffer);
+    config.length = NUM_SAMPLES;
+    config.mono_or_stereo.Assign(
+        AudioCore::HLE::SourceConfiguration::Configuration::MonoOrStereo::Stereo);
+    config.format.Assign(AudioCore::HLE::SourceConfiguration::Configuration::Format::PCM16);
+    config.fade_in.Assign(false);
+    config.adpcm_dirty.Assign(false);
+    config.is_looping.Assign(false);
+    config.buffer_id = 1;
+    config.partial_reset_flag.Assign(true);
+    config.play_position_dirty.Assign(true);
+    config.embedded_buffer_dirty.Assign(true);
+    config.interpolation_mode = mode;
+    config.interpolation_dirty.Assign(true);
+    config.rate_multiplier = rate;
+    config.rate_multiplier_dirty.Assign(true);
+    config.enable = true;
+    config.enable_dirty.Assign(true);
+    state.notifyDsp();
+
+    std::vector<s32> output;
+    for (std::size_t frame_count = 0; output.size() < NUM_OUTPUT_SAMPLES && frame_count < 40;
+         frame_count++) {
+        state.waitForSync();
+        for (std::size_t i = 0; i < 160 && output.size() < NUM_OUTPUT_SAMPLES; i++) {
+            const s32 sample = state.read().intermediate_mix_samples->mix1.pcm32[0][i];
+            if (!output.empty() || sample != 0) {
+                output.push_back(sample);
+            }
+        }
+        state.notifyDsp();
+    }
+
+    fixture.audioExit(state);
+    return output;
+}
+
+/**
+ * Computes the impulse response of the polyphase filter in floating point, in the same form as
+ * Render. Every output reads four input samples around its position, weighted by a low-pass
+ * sinc at the output Nyquist frequency times a Lanczos window, normalised to unity gain. Outputs
+ * are 2 input samples behind their position, as the interpolator keeps 3 samples of history.
+ */
+std::vector<s32> ReferenceResponse(float rate) {
+    const auto sinc = [](double x) {
+        return x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+    };
+    const double cutoff = rate <= 1.0f ? 1.0 : rate <= 4.0f / 3.0f ? 0.75 : 0.5;
+    const auto input = [](s64 index) {
+        return index == static_cast<s64>(IMPULSE_POSITION) ? IMPULSE_AMPLITUDE : 0;
+    };
+
+    // The interpolator steps in 24 bit fixed point and uses 256 phases.
+    const u64 step = static_cast<u64>(rate * (1 << 24));
+    std::vector<s32> output;
+    for (u64 position = 0; output.size() < NUM_OUTPUT_SAMPLES; position += step) {
+        const s64 index = static_cast<s64>(position >> 24);
+        const double fraction = static_cast<double>((position >> 16) & 0xFF) / 256.0;
+
+        std::array<double, 4> weights{};
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < weights.size(); tap++) {
+            const double t = static_cast<double>(tap) - 1.0 - fraction;
+            weights[tap] = cutoff * sinc(cutoff * t) * sinc(t / 2.0);
+            sum += weights[tap];
+        }
+        double sample = 0.0;
+        for (std::size_t tap = 0; tap < weights.size(); tap++) {
+            sample += input(index - 3 + static_cast<s64>(tap)) * weights[tap] / sum;
+        }
+
+        const s32 rounded = static_cast<s32>(std::lround(sample));
+        if (!output.empty() || rounded != 0) {
+            output.push_back(rounded);
+        }
+    }
+    return output;
+}
+
+/// Sum of squared differences between two responses.
+double Distance(const std::vector<s32>& a, const std::vector<s32>& b) {
+    double sum = 0.0;
+    for (std::size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+        const double difference = static_cast<double>(a[i]) - b[i];
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AudioTest-Polyphase is opt-in for HLE", "[audio_core][merryhime_3ds_audio]") {
+    // Runs without firmware. Sources requesting polyphase interpolation sound like they always did
+    // unless the filter is enabled.
+    const float rate = GENERATE(0.5f, 1.5f);
+
+    const auto linear_output =
+        Render(Settings::AudioEmulation::HLE, rate, InterpolationMode::Linear);
+    REQUIRE(linear_output);
+    REQUIRE(linear_output->size() == NUM_OUTPUT_SAMPLES);
+
+    const auto default_output = Render(Settings::AudioEmulation::HLE, rate);
+    REQUIRE(default_output == linear_output);
+}
+
+TEST_CASE("AudioTest-Polyphase HLE impulse response", "[audio_core][merryhime_3ds_audio]") {
+    // Runs without firmware. Covers every filter bank, and phases other than the midpoint.
+    const float rate = GENERATE(0.5f, 0.75f, 1.25f, 1.5f, 2.5f);
+    INFO("rate " << rate);
+
+    Settings::values.polyphase_interpolation = true;
+    const auto polyphase_output = Render(Settings::AudioEmulation::HLE, rate);
+    Settings::values.polyphase_interpolation = false;
+    REQUIRE(polyphase_output);
+    REQUIRE(polyphase_output->size() == NUM_OUTPUT_SAMPLES);
+
+    // The filter taps are rounded to Q15.
+    const auto reference = ReferenceResponse(rate);
+    for (std::size_t i = 0; i < NUM_OUTPUT_SAMPLES; i++) {
+        INFO("sample " << i);
+        REQUIRE(std::abs((*polyphase_output)[i] - reference[i]) <= 2);
+    }
+
+    // Linear interpolation gets nowhere near it.
+    const auto linear_output =
+        Render(Settings::AudioEmulation::HLE, rate, InterpolationMode::Linear);
+    REQUIRE(linear_output);
+    REQUIRE(Distance(*linear_output, reference) > 0x100 * 0x100);
+}
+
+TEST_CASE("AudioTest-Polyphase", "[audio_core][merryhime_3ds_audio]") {
+    // At a rate of 1 every output lies on an input sample, where all the filters agree.
+    const float rate = GENERATE(0.5f, 0.75f, 1.5f);
+    INFO("rate " << rate);
+
+    Settings::values.polyphase_interpolation = true;
+    const auto hle_output = Render(Settings::AudioEmulation::HLE, rate);
+    Settings::values.polyphase_interpolation = false;
+    REQUIRE(hle_output);
+    REQUIRE(hle_output->size() == NUM_OUTPUT_SAMPLES);
+
+    const auto lle_output = Render(Settings::AudioEmulation::LLE, rate);
+    if (!lle_output) {
+        SKIP("Couldn't load firmware\n");
+    }
+    REQUIRE(lle_output->size() == NUM_OUTPUT_SAMPLES);
+
+    // The firmware's exact filter taps are unknown, so the HLE filter only has to be closer to
+    // the firmware's impulse response than linear interpolation is.
+    const auto linear_output =
+        Render(Settings::AudioEmulation::HLE, rate, InterpolationMode::Linear);
+    REQUIRE(linear_output);
+    REQUIRE(Distance(*hle_output, *lle_output) < Distance(*linear_output, *lle_output));
+}
@@ -110,7 +110,7 @@ void* ServiceFixture::linearAlloc(size_t size) {
 
 Result ServiceFixture::dspInit() {
     if (!dsp) {
-        dsp = std::make_unique<AudioCore::DspHle>(system, memory, core_timing);
+        dsp = std::make_unique<AudioCore::DspHle>(system, memory, core_timing, false);
         dsp->SetInterruptHandler([this](Service::DSP::InterruptType type, AudioCore::DspPipe pipe) {
             interrupts_fired[static_cast<u32>(type)][static_cast<u32>(pipe)] = 1;
         });
@@ -121,8 +121,10 @@ Result ServiceFixture::dspInit() {
 
 // Fixture
 void ServiceFixture::InitDspCore(Settings::AudioEmulation dsp_core) {
-    if (dsp_core == Settings::AudioEmulation::HLE) {
-        dsp = std::make_unique<AudioCore::DspHle>(system, memory, core_timing);
+    if (dsp_core == Settings::AudioEmulation::HLE ||
+        dsp_core == Settings::AudioEmulation::HLEMultithreaded) {
+        dsp = std::make_unique<AudioCore::DspHle>(
+            system, memory, core_timing, dsp_core == Settings::AudioEmulation::HLEMultithreaded);
     } else {
         dsp = std::make_unique<AudioCore::DspLle>(
             system, memory, core_timing, dsp_core == Settings::AudioEmulation::LLEMultithreaded);
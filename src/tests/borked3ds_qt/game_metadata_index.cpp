@@ -0,0 +1,94 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "borked3ds_qt/game_metadata_index.h"
+#include "common/file_util.h"
+#include "core/loader/loader.h"
+
+namespace {
+
+/// An ELF header is enough for a loader to recognize the file, zeros are not.
+std::vector<u8> MakeFile(std::size_t size, bool elf) {
+    std::vector<u8> data(size);
+    if (elf) {
+        const u32 magic = Loader::MakeMagic('\x7f', 'E', 'L', 'F');
+        std::memcpy(data.data(), &magic, sizeof(magic));
+    }
+    return data;
+}
+
+void WriteFile(const std::string& path, const std::vector<u8>& data) {
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+/// Looks the file up in a fresh index loaded from disk.
+bool IsRecognized(const std::string& path) {
+    const std::atomic_bool cancel{false};
+    GameMetadataIndex index;
+    index.Load();
+    return index.Lookup({path}, cancel)[0]->has_loader;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GameMetadataIndex reuses entries until the file changes", "[borked3ds_qt]") {
+    const auto temp = std::filesystem::temp_directory_path() / "borked3ds_game_list_test";
+    std::filesystem::remove_all(temp);
+    const std::string cache_path = (temp / "cache").generic_string();
+    REQUIRE(FileUtil::CreateDir(temp.generic_string()));
+    REQUIRE(FileUtil::CreateDir(cache_path));
+
+    const std::string old_cache_path = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, cache_path);
+
+    const std::string game = (temp / "game.bin").generic_string();
+    const std::string missing = (temp / "missing.bin").generic_string();
+    WriteFile(game, MakeFile(0x100, true));
+
+    {
+        const std::atomic_bool cancel{false};
+        GameMetadataIndex index;
+        index.Load();
+        const auto results = index.Lookup({game, missing, ""}, cancel);
+        REQUIRE(results[0]->has_loader);
+        REQUIRE(results[0]->file_type == Loader::FileType::ELF);
+        REQUIRE(results[0]->size == 0x100);
+        REQUIRE(!results[1]->has_loader);
+        REQUIRE(!results[2]->has_loader);
+        index.Save();
+    }
+
+    // Replace the contents but keep the size and modification time, so the file is only
+    // recognized if its entry is taken from the saved index instead of the file being read.
+    const auto modified = std::filesystem::last_write_time(game);
+    const auto rewrite = [&](std::size_t size, std::filesystem::file_time_type time) {
+        WriteFile(game, MakeFile(size, false));
+        std::filesystem::last_write_time(game, time);
+    };
+    rewrite(0x100, modified);
+    REQUIRE(IsRecognized(game));
+
+    // A newer modification time makes the file be read again.
+    rewrite(0x100, modified + std::chrono::seconds{10});
+    REQUIRE(!IsRecognized(game));
+
+    // So does a different size with the same modification time.
+    rewrite(0x200, modified);
+    REQUIRE(!IsRecognized(game));
+
+    // The old cache directory can only be restored if it exists, so keep the new one around.
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, old_cache_path);
+    std::filesystem::remove_all(temp / "game.bin");
+    std::filesystem::remove_all(temp / "cache" / "game_list");
+}
@@ -0,0 +1,146 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+
+#include "common/async_file_reader.h"
+#include "common/file_util.h"
+
+using FileUtil::AsyncFileReader;
+
+namespace {
+
+struct TempFile {
+    explicit TempFile(std::size_t size) {
+        path = (std::filesystem::temp_directory_path() / "borked3ds_async_file_reader_test.bin")
+                   .string();
+        data.resize(size);
+        std::mt19937 rng(43);
+        for (auto& byte : data) {
+            byte = static_cast<u8>(rng());
+        }
+        FileUtil::IOFile file(path, "wb");
+        file.WriteBytes(data.data(), data.size());
+    }
+
+    ~TempFile() {
+        FileUtil::Delete(path);
+    }
+
+    std::string path;
+    std::vector<u8> data;
+};
+
+struct Read {
+    u64 offset;
+    std::vector<u8> buffer;
+    s64 result = 0;
+};
+
+/// Submits all reads in one batch and waits for them to complete.
+void ReadAll(AsyncFileReader& reader, FileUtil::IOFile& file, std::vector<Read>& reads) {
+    std::promise<void> done;
+    std::atomic<std::size_t> remaining = reads.size();
+    std::vector<AsyncFileReader::Request> requests;
+    for (auto& read : reads) {
+        requests.push_back({&file, read.buffer.data(), read.buffer.size(), read.offset,
+                            [&read, &remaining, &done](s64 result) {
+                                read.result = result;
+                                if (--remaining == 0) {
+                                    done.set_value();
+                                }
+                            }});
+    }
+    reader.Submit(requests);
+    done.get_future().wait();
+}
+
+/// Reads of various sizes at random offsets, some of them running past the end of the file.
+std::vector<Read> MakeReads(std::size_t count, std::size_t file_size, std::size_t max_length) {
+    std::mt19937 rng(count);
+    std::vector<Read> reads(count);
+    for (auto& read : reads) {
+        read.offset = rng() % file_size;
+        read.buffer.resize(1 + rng() % max_length);
+    }
+    return reads;
+}
+
+void CheckReads(const std::vector<Read>& reads, const std::vector<u8>& data) {
+    for (const auto& read : reads) {
+        const auto expected = std::min<u64>(read.buffer.size(), data.size() - read.offset);
+        REQUIRE(read.result == static_cast<s64>(expected));
+        REQUIRE(std::memcmp(read.buffer.data(), data.data() + read.offset, expected) == 0);
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AsyncFileReader reads match the file", "[common]") {
+    TempFile temp(1024 * 1024);
+    FileUtil::IOFile file(temp.path, "rb");
+    REQUIRE(file.IsOpen());
+
+    const auto backend =
+        GENERATE(AsyncFileReader::Backend::IoUring, AsyncFileReader::Backend::Threaded);
+    // Fewer slots than reads, so submissions have to wait for earlier reads to complete.
+    AsyncFileReader reader(backend, 8);
+    if (backend == AsyncFileReader::Backend::Threaded) {
+        REQUIRE(reader.GetBackend() == AsyncFileReader::Backend::Threaded);
+    }
+
+    SECTION("Small reads") {
+        auto reads = MakeReads(200, temp.data.size(), 4096);
+        ReadAll(reader, file, reads);
+        CheckReads(reads, temp.data);
+    }
+
+    SECTION("Reads larger than the registered buffers") {
+        auto reads = MakeReads(20, temp.data.size(), 256 * 1024);
+        ReadAll(reader, file, reads);
+        CheckReads(reads, temp.data);
+    }
+
+    SECTION("Single reads") {
+        std::vector<u8> buffer(100);
+        std::promise<s64> result;
+        reader.Submit({&file, buffer.data(), buffer.size(), 5000,
+                       [&result](s64 bytes) { result.set_value(bytes); }});
+        REQUIRE(result.get_future().get() == 100);
+        REQUIRE(std::memcmp(buffer.data(), temp.data.data() + 5000, 100) == 0);
+    }
+}
+
+TEST_CASE("AsyncFileReader[Benchmark]", "[.][common][benchmark]") {
+    TempFile temp(64 * 1024 * 1024);
+    FileUtil::IOFile file(temp.path, "rb");
+
+    AsyncFileReader io_uring_reader(AsyncFileReader::Backend::IoUring);
+    AsyncFileReader threaded_reader(AsyncFileReader::Backend::Threaded);
+    // 16 KiB reads at random offsets, the pattern of a game streaming assets from RomFS.
+    auto reads = MakeReads(512, temp.data.size() - 16 * 1024, 1);
+    for (auto& read : reads) {
+        read.buffer.resize(16 * 1024);
+    }
+
+    BENCHMARK("io_uring random reads") {
+        ReadAll(io_uring_reader, file, reads);
+        return reads[0].result;
+    };
+
+    BENCHMARK("Threaded random reads") {
+        ReadAll(threaded_reader, file, reads);
+        return reads[0].result;
+    };
+}
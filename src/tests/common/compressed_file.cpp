@@ -0,0 +1,142 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/compressed_file.h"
+#include "common/file_util.h"
+
+namespace {
+
+/// Half of the frames compress well, the other half are random and end up stored.
+std::vector<u8> MakeImage(std::size_t size) {
+    std::vector<u8> data(size);
+    std::mt19937 rng(40);
+    for (std::size_t i = 0; i < data.size(); i++) {
+        data[i] = (i / 65536) % 2 ? static_cast<u8>(rng()) : static_cast<u8>(i / 100);
+    }
+    return data;
+}
+
+struct TempImage {
+    TempImage() {
+        const auto dir = std::filesystem::temp_directory_path();
+        raw_path = (dir / "borked3ds_compressed_file_test.bin").string();
+        compressed_path = (dir / "borked3ds_compressed_file_test.zbin").string();
+        data = MakeImage(3 * 65536 + 12345);
+
+        FileUtil::IOFile file(raw_path, "wb");
+        file.WriteBytes(data.data(), data.size());
+    }
+
+    ~TempImage() {
+        FileUtil::Delete(raw_path);
+        FileUtil::Delete(compressed_path);
+    }
+
+    bool Compress() const {
+        FileUtil::CompressOptions options;
+        options.frame_size = 16 * 1024;
+        options.num_threads = 3;
+        return FileUtil::CompressFile(raw_path, compressed_path, options);
+    }
+
+    std::string raw_path;
+    std::string compressed_path;
+    std::vector<u8> data;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("CompressedFile round trip through IOFile", "[common]") {
+    TempImage image;
+    REQUIRE(!FileUtil::IsCompressedFile(image.raw_path));
+    REQUIRE(image.Compress());
+    REQUIRE(FileUtil::IsCompressedFile(image.compressed_path));
+    REQUIRE(FileUtil::GetSize(image.compressed_path) < image.data.size());
+
+    FileUtil::IOFile file(image.compressed_path, "rb");
+    REQUIRE(file.IsCompressed());
+    REQUIRE(file.GetSize() == image.data.size());
+    REQUIRE(file.GetCompressedReader()->Verify());
+
+    SECTION("sequential reads") {
+        std::vector<u8> out(image.data.size());
+        std::size_t pos = 0;
+        while (pos < out.size()) {
+            const std::size_t length = std::min<std::size_t>(7777, out.size() - pos);
+            REQUIRE(file.ReadBytes(out.data() + pos, length) == length);
+            pos += length;
+        }
+        REQUIRE(out == image.data);
+        REQUIRE(file.Tell() == image.data.size());
+
+        u8 byte;
+        REQUIRE(file.ReadBytes(&byte, 1) == 0);
+    }
+
+    SECTION("seeking") {
+        u8 byte;
+        REQUIRE(file.Seek(-10, SEEK_END));
+        REQUIRE(file.Tell() == image.data.size() - 10);
+        REQUIRE(file.ReadBytes(&byte, 1) == 1);
+        REQUIRE(byte == image.data[image.data.size() - 10]);
+
+        REQUIRE(file.Seek(5, SEEK_CUR));
+        REQUIRE(file.ReadBytes(&byte, 1) == 1);
+        REQUIRE(byte == image.data[image.data.size() - 4]);
+
+        std::array<u8, 16> span;
+        REQUIRE(file.Seek(100, SEEK_SET));
+        REQUIRE(file.ReadSpan<u8>(span) == span.size());
+        REQUIRE(std::memcmp(span.data(), image.data.data() + 100, span.size()) == 0);
+    }
+
+    SECTION("concurrent random reads") {
+        std::vector<std::thread> threads;
+        std::vector<bool> matched(4, true);
+        for (std::size_t t = 0; t < matched.size(); t++) {
+            threads.emplace_back([&, t] {
+                std::mt19937 rng(static_cast<u32>(t));
+                for (int i = 0; i < 100; i++) {
+                    const std::size_t offset = rng() % image.data.size();
+                    const std::size_t length =
+                        std::min<std::size_t>(rng() % 40000, image.data.size() - offset);
+                    std::vector<u8> buffer(length);
+                    if (file.ReadAtBytes(buffer.data(), length, offset) != length ||
+                        std::memcmp(buffer.data(), image.data.data() + offset, length) != 0) {
+                        matched[t] = false;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(matched == std::vector<bool>(matched.size(), true));
+    }
+}
+
+TEST_CASE("CompressedFile detects corrupted frames", "[common]") {
+    TempImage image;
+    REQUIRE(image.Compress());
+    {
+        FileUtil::IOFile file(image.compressed_path, "r+b");
+        REQUIRE(file.Seek(-5, SEEK_END));
+        const u8 byte = 0x55;
+        REQUIRE(file.WriteBytes(&byte, 1) == 1);
+    }
+
+    FileUtil::IOFile file(image.compressed_path, "rb");
+    REQUIRE(file.IsCompressed());
+    REQUIRE(!file.GetCompressedReader()->Verify());
+}
@@ -0,0 +1,79 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "common/common_types.h"
+#include "common/ring_buffer.h"
+
+namespace Common {
+
+TEST_CASE("MPSCRingBuffer: basic", "[common]") {
+    MPSCRingBuffer<char, 4, 1> buf;
+
+    REQUIRE(buf.Push(std::span<const char>{"abcde", 5}) == 4);
+    REQUIRE(buf.Size() == 4);
+
+    std::array<char, 4> out{};
+    REQUIRE(buf.Pop(out.data(), 2) == 2);
+    REQUIRE(out[0] == 'a');
+    REQUIRE(out[1] == 'b');
+
+    // Wraps around the end of the buffer.
+    REQUIRE(buf.Push(std::span<const char>{"xyz", 3}) == 2);
+    REQUIRE(buf.Pop(out.data(), 4) == 4);
+    REQUIRE(out == std::array<char, 4>{'c', 'd', 'x', 'y'});
+    REQUIRE(buf.Size() == 0);
+    REQUIRE(buf.Pop(out.data(), 4) == 0);
+}
+
+TEST_CASE("MPSCRingBuffer: concurrent producers", "[common]") {
+    constexpr std::size_t num_producers = 4;
+    constexpr u32 values_per_producer = 200000;
+    MPSCRingBuffer<u32, 1024, 2> buf;
+
+    std::vector<std::thread> producers;
+    for (u32 producer = 0; producer < num_producers; producer++) {
+        producers.emplace_back([&buf, producer] {
+            u32 value = 0;
+            while (value < values_per_producer) {
+                // Push in small batches so reservations from different threads interleave.
+                std::array<std::array<u32, 2>, 3> batch;
+                std::size_t count = 0;
+                for (; count < batch.size() && value + count < values_per_producer; count++) {
+                    batch[count] = {producer, value + static_cast<u32>(count)};
+                }
+                std::size_t pushed = 0;
+                while (pushed < count) {
+                    pushed += buf.Push(batch.data() + pushed, count - pushed);
+                }
+                value += static_cast<u32>(count);
+            }
+        });
+    }
+
+    // Each producer's values must arrive complete and in order.
+    std::array<u32, num_producers> expected{};
+    std::size_t received = 0;
+    std::array<std::array<u32, 2>, 64> out;
+    while (received < num_producers * values_per_producer) {
+        const std::size_t count = buf.Pop(out.data(), out.size());
+        for (std::size_t i = 0; i < count; i++) {
+            const auto [producer, value] = out[i];
+            REQUIRE(producer < num_producers);
+            REQUIRE(value == expected[producer]);
+            expected[producer]++;
+        }
+        received += count;
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    REQUIRE(buf.Size() == 0);
+}
+
+} // namespace Common
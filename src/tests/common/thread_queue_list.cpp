@@ -0,0 +1,123 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/thread_queue_list.h"
+
+namespace {
+struct FakeThread {
+    unsigned int priority;
+    bool can_schedule = true;
+};
+
+using ReadyQueue = Common::ThreadQueueList<FakeThread*, 64>;
+
+constexpr auto Schedulable = [](const FakeThread* t) { return t->can_schedule; };
+} // Anonymous namespace
+
+TEST_CASE("ThreadQueueList[PriorityOrder]", "[common]") {
+    ReadyQueue queue;
+    FakeThread a{48}, b{24}, c{24}, d{63}, e{0};
+
+    REQUIRE(queue.get_first() == nullptr);
+    REQUIRE(queue.pop_first() == nullptr);
+
+    queue.push_back(a.priority, &a);
+    queue.push_back(b.priority, &b);
+    queue.push_back(c.priority, &c);
+    queue.push_back(d.priority, &d);
+    queue.push_front(e.priority, &e);
+
+    REQUIRE(queue.get_first() == &e);
+    REQUIRE(queue.pop_first() == &e);
+    REQUIRE(queue.empty(0));
+    REQUIRE(queue.pop_first() == &b);
+    REQUIRE(queue.pop_first() == &c);
+    REQUIRE(queue.pop_first() == &a);
+    REQUIRE(queue.pop_first() == &d);
+    REQUIRE(queue.pop_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList[PopFirstBetter]", "[common]") {
+    ReadyQueue queue;
+    FakeThread a{30}, b{31};
+
+    queue.push_back(a.priority, &a);
+    queue.push_back(b.priority, &b);
+
+    // Only strictly better priorities qualify.
+    REQUIRE(queue.pop_first_better(30) == nullptr);
+    REQUIRE(queue.pop_first_better(31) == &a);
+    REQUIRE(queue.pop_first_better(31) == nullptr);
+    REQUIRE(queue.pop_first_better(63) == &b);
+}
+
+TEST_CASE("ThreadQueueList[MoveRemove]", "[common]") {
+    ReadyQueue queue;
+    FakeThread a{40}, b{40}, c{50};
+
+    queue.push_back(a.priority, &a);
+    queue.push_back(b.priority, &b);
+    queue.push_back(c.priority, &c);
+
+    queue.move(&c, 50, 20);
+    REQUIRE(queue.empty(50));
+    REQUIRE(queue.contains(&c) == 20);
+
+    queue.remove(40, &a);
+    REQUIRE(queue.contains(&a) == static_cast<unsigned int>(-1));
+
+    queue.rotate(20);
+    REQUIRE(queue.pop_first() == &c);
+    REQUIRE(queue.pop_first() == &b);
+    REQUIRE(queue.pop_first() == nullptr);
+}
+
+TEST_CASE("ThreadQueueList[PopFirstIf]", "[common]") {
+    ReadyQueue queue;
+    FakeThread a{10, false}, b{10}, c{20, false}, d{20};
+
+    queue.push_back(a.priority, &a);
+    queue.push_back(b.priority, &b);
+    queue.push_back(c.priority, &c);
+    queue.push_back(d.priority, &d);
+
+    REQUIRE(queue.pop_first_better_if(10, Schedulable) == nullptr);
+    REQUIRE(queue.pop_first_if(Schedulable) == &b);
+    REQUIRE(queue.pop_first_better_if(21, Schedulable) == &d);
+    REQUIRE(queue.pop_first_if(Schedulable) == nullptr);
+
+    // Skipped elements keep their place in the queue.
+    REQUIRE(queue.get_first() == &a);
+    c.can_schedule = true;
+    REQUIRE(queue.pop_first_if(Schedulable) == &c);
+    REQUIRE(queue.pop_first() == &a);
+}
+
+TEST_CASE("ThreadQueueList[Benchmark]", "[.][common][benchmark]") {
+    ReadyQueue queue;
+    std::array<FakeThread, 64> threads{};
+    for (std::size_t i = 0; i < threads.size(); ++i) {
+        threads[i].priority = static_cast<unsigned int>(16 + (i * 7) % 48);
+        threads[i].can_schedule = (i % 8) != 0;
+    }
+
+    BENCHMARK("Reschedule") {
+        for (auto& thread : threads) {
+            queue.push_back(thread.priority, &thread);
+        }
+        // Simulate a running thread yielding to better ones until only worse ones remain, then
+        // drain the rest the way an idle core would.
+        FakeThread* running = &threads[0];
+        while (FakeThread* next = queue.pop_first_better_if(running->priority, Schedulable)) {
+            running = next;
+        }
+        while (queue.pop_first_if(Schedulable) != nullptr) {
+        }
+        queue.clear();
+        return running;
+    };
+}
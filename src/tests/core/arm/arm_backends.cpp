@@ -0,0 +1,132 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include "common/arch.h"
+#include "common/memory_ref.h"
+#if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
+#include "core/arm/dynarmic/arm_dynarmic.h"
+#include "core/arm/dynarmic/arm_exclusive_monitor.h"
+#endif
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+
+namespace {
+
+constexpr VAddr CODE_ADDRESS = 0x00100000;
+constexpr u32 LOOP_COUNT = 0x1000;
+constexpr u32 LOOP_SUM = LOOP_COUNT * (LOOP_COUNT + 1) / 2;
+
+// r0 = sum(1..r1) followed by an infinite loop
+constexpr std::array<u32, 6> SUM_PROGRAM{
+    0xE3A00000, // mov r0, #0
+    0xE3A01A01, // mov r1, #0x1000
+    0xE0800001, // loop: add r0, r0, r1
+    0xE2511001, // subs r1, r1, #1
+    0x1AFFFFFC, // bne loop
+    0xEAFFFFFE, // b .
+};
+
+struct TestEnvironment {
+    TestEnvironment()
+        : memory{system}, kernel{memory,
+                                 timing,
+                                 [] {},
+                                 Kernel::MemoryMode::Prod,
+                                 1,
+                                 Kernel::New3dsHwCapabilities{false, false,
+                                                              Kernel::New3dsMemoryMode::Legacy}} {
+        process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+        code_mem = std::make_shared<BufferMem>(Memory::BORKED3DS_PAGE_SIZE);
+        code = MemoryRef{code_mem};
+        REQUIRE(process->vm_manager
+                    .MapBackingMemory(CODE_ADDRESS, code,
+                                      static_cast<u32>(code.GetSize()),
+                                      Kernel::MemoryState::Private)
+                    .Code() == ResultSuccess);
+        memory.SetCurrentPageTable(process->vm_manager.page_table);
+        WriteProgram(SUM_PROGRAM);
+    }
+
+    template <std::size_t N>
+    void WriteProgram(const std::array<u32, N>& program) {
+        std::memcpy(code.GetPtr(), program.data(), sizeof(program));
+    }
+
+    void RunSlice(Core::ARM_Interface& cpu, s64 ticks) {
+        cpu.GetTimer().Advance();
+        cpu.GetTimer().SetNextSlice(ticks);
+        cpu.Run();
+    }
+
+    Core::Timing timing{1, 100};
+    Core::System system;
+    Memory::MemorySystem memory;
+    Kernel::KernelSystem kernel;
+    std::shared_ptr<Kernel::Process> process;
+    std::shared_ptr<BufferMem> code_mem;
+    MemoryRef code;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("ARM_DynCom[SumLoop]", "[core][arm]") {
+    TestEnvironment env;
+    Core::ARM_DynCom cpu(env.system, env.memory, USER32MODE, 0, env.timing.GetTimer(0));
+
+    cpu.SetPC(CODE_ADDRESS);
+    env.RunSlice(cpu, Core::Timing::MAX_SLICE_LENGTH);
+    REQUIRE(cpu.GetReg(0) == LOOP_SUM);
+    REQUIRE(cpu.GetReg(1) == 0);
+}
+
+TEST_CASE("ARM_DynCom[InvalidateCacheRange]", "[core][arm]") {
+    TestEnvironment env;
+    Core::ARM_DynCom cpu(env.system, env.memory, USER32MODE, 0, env.timing.GetTimer(0));
+
+    cpu.SetPC(CODE_ADDRESS);
+    env.RunSlice(cpu, Core::Timing::MAX_SLICE_LENGTH);
+    REQUIRE(cpu.GetReg(0) == LOOP_SUM);
+
+    // Turn the add into a sub, the translated block must not be reused.
+    auto program = SUM_PROGRAM;
+    program[2] = 0xE0400001; // loop: sub r0, r0, r1
+    env.WriteProgram(program);
+    cpu.InvalidateCacheRange(CODE_ADDRESS + 8, 4);
+
+    cpu.SetPC(CODE_ADDRESS);
+    env.RunSlice(cpu, Core::Timing::MAX_SLICE_LENGTH);
+    REQUIRE(cpu.GetReg(0) == static_cast<u32>(0 - LOOP_SUM));
+}
+
+TEST_CASE("ARM backends[Benchmark]", "[.][core][arm][benchmark]") {
+    TestEnvironment env;
+    // Enough ticks to run the whole loop once
+    constexpr s64 slice_ticks = LOOP_COUNT * 3 + 8;
+
+    Core::ARM_DynCom dyncom(env.system, env.memory, USER32MODE, 0, env.timing.GetTimer(0));
+    BENCHMARK("DynCom") {
+        dyncom.SetPC(CODE_ADDRESS);
+        env.RunSlice(dyncom, slice_ticks);
+        return dyncom.GetReg(0);
+    };
+
+#if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
+    Core::DynarmicExclusiveMonitor exclusive_monitor(env.memory, 1);
+    Core::ARM_Dynarmic dynarmic(env.system, env.memory, 0, env.timing.GetTimer(0),
+                                exclusive_monitor);
+    BENCHMARK("Dynarmic") {
+        dynarmic.SetPC(CODE_ADDRESS);
+        env.RunSlice(dynarmic, slice_ticks);
+        return dynarmic.GetReg(0);
+    };
+#endif
+}
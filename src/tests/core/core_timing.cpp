@@ -2,14 +2,18 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
 #include <bitset>
+#include <set>
 #include <string>
+#include <vector>
 #include "common/file_util.h"
 #include "core/core.h"
 #include "core/core_timing.h"
+#include "core/cpu_core_threads.h"
 
 // Numbers are chosen randomly to make sure the correct one is given.
 static constexpr std::array<u64, 5> CB_IDS{{42, 144, 93, 1026, UINT64_C(0xFFFF7FFFF7FFFF)}};
@@ -196,4 +200,187 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
-// TODO: Add tests for multiple timers
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+    Core::TimingEventType* cb_d = timing.RegisterEvent("callbackD", CallbackTemplate<3>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(200, cb_b, CB_IDS[1], 0);
+    timing.ScheduleEvent(300, cb_c, CB_IDS[2], 0);
+    timing.ScheduleEvent(400, cb_d, CB_IDS[3], 0);
+    timing.ScheduleEvent(250, cb_b, CB_IDS[0], 0);
+
+    // Only the event matching both type and user data is removed.
+    timing.UnscheduleEvent(cb_b, CB_IDS[0]);
+    timing.UnscheduleEvent(cb_a, CB_IDS[0]);
+    timing.UnscheduleEvent(cb_c, CB_IDS[2]);
+
+    AdvanceAndCheck(timing, 1, 200, 0, -100); // (400 - 200)
+    AdvanceAndCheck(timing, 3, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[UnscheduleThreadSafe]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    // Events scheduled in thread safe mode sit in the timer's ts_queue until the next Advance(),
+    // they must still be cancellable before then.
+    timing.ScheduleEvent(0, cb_a, CB_IDS[0], 0, true);
+    timing.ScheduleEvent(0, cb_b, CB_IDS[1], 0, true);
+    timing.UnscheduleEvent(cb_a, CB_IDS[0]);
+
+    timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+    REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
+
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[UnscheduleHandle]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    // Events sharing type and user data are told apart by their handles.
+    const auto first = timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0);
+    const auto second = timing.ScheduleEvent(200, cb_a, CB_IDS[0], 0);
+    const auto pending = timing.ScheduleEvent(0, cb_c, CB_IDS[2], 0, true);
+    timing.ScheduleEvent(300, cb_b, CB_IDS[1], 0);
+    REQUIRE(first != second);
+
+    // Fill the heap so that cancelling has to move events around.
+    std::vector<Core::Timing::EventHandle> fillers;
+    for (int i = 0; i < 32; ++i) {
+        fillers.push_back(timing.ScheduleEvent(150 + i, cb_c, CB_IDS[2], 0));
+    }
+    for (const auto handle : fillers) {
+        timing.UnscheduleEvent(handle);
+    }
+    timing.UnscheduleEvent(second);
+    // Events still waiting in the ts_queue can be cancelled as well.
+    timing.UnscheduleEvent(pending);
+
+    AdvanceAndCheck(timing, 0, 200);
+    // Cancelling an event that already fired does nothing.
+    timing.UnscheduleEvent(first);
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH);
+}
+
+TEST_CASE("CoreTiming[ParallelCores]", "[core]") {
+    static constexpr std::size_t NUM_CORES = 4;
+    static constexpr std::size_t NUM_SLICES = 8;
+    static constexpr std::uintptr_t EVENTS_PER_SLICE = 64;
+    Core::Timing timing(NUM_CORES, 100);
+    Core::CpuCoreThreads threads(NUM_CORES);
+
+    // Callbacks only fire in Advance() on this thread, so no locking is needed here.
+    std::size_t advancing_core = 0;
+    std::array<std::multiset<std::uintptr_t>, NUM_CORES> fired;
+    Core::TimingEventType* cb = timing.RegisterEvent(
+        "callbackParallel",
+        [&](std::uintptr_t user_data, s64) { fired[advancing_core].insert(user_data); });
+
+    const auto encode = [](std::size_t slice, std::size_t core, std::uintptr_t i) {
+        return (slice * NUM_CORES + core) * EVENTS_PER_SLICE + i;
+    };
+
+    for (std::size_t slice = 0; slice < NUM_SLICES; ++slice) {
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            timing.GetTimer(core)->Advance();
+            timing.GetTimer(core)->SetNextSlice();
+        }
+
+        // Every core schedules events on the next one while all of them run, cancelling every
+        // other event again. Catch isn't thread safe, so results are checked after the slice.
+        std::array<bool, NUM_CORES> ticks_match{};
+        threads.RunSlice([&](std::size_t core) {
+            timing.BindThreadTimer(core);
+            auto& timer = *timing.GetTimer(core);
+            const std::size_t target = (core + 1) % NUM_CORES;
+            ticks_match[core] = true;
+            for (std::uintptr_t i = 0; i < EVENTS_PER_SLICE; ++i) {
+                timer.AddTicks(100);
+                ticks_match[core] &= timing.GetTicks() == static_cast<s64>(timer.GetTicks());
+                timing.ScheduleEvent(1000, cb, encode(slice, core, i), target);
+                if (i % 2 == 1) {
+                    timing.UnscheduleEvent(cb, encode(slice, core, i - 1));
+                }
+            }
+            timing.UnbindThreadTimer();
+        });
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            REQUIRE(ticks_match[core]);
+        }
+
+        // Finish the slice on every core, the events are all due by then.
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            auto& timer = *timing.GetTimer(core);
+            advancing_core = core;
+            timer.AddTicks(timer.GetDowncount());
+            timer.Advance();
+        }
+
+        for (std::size_t core = 0; core < NUM_CORES; ++core) {
+            const std::size_t source = (core + NUM_CORES - 1) % NUM_CORES;
+            std::multiset<std::uintptr_t> expected;
+            for (std::uintptr_t i = 1; i < EVENTS_PER_SLICE; i += 2) {
+                expected.insert(encode(slice, source, i));
+            }
+            REQUIRE(fired[core] == expected);
+            fired[core].clear();
+        }
+    }
+}
+
+TEST_CASE("CoreTiming[Benchmark]", "[.][core][benchmark]") {
+    Core::Timing timing(1, 100);
+
+    static constexpr std::size_t NUM_EVENTS = 256;
+    Core::TimingEventType* cb = timing.RegisterEvent("callbackBench", [](std::uintptr_t, s64) {});
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    BENCHMARK("Schedule/Unschedule") {
+        for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+            timing.ScheduleEvent(static_cast<s64>(1000 + (i * 7919) % 4096), cb, i, 0);
+        }
+        for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+            timing.UnscheduleEvent(cb, (i * 31) % NUM_EVENTS);
+        }
+    };
+
+    BENCHMARK("Schedule/Advance") {
+        for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+            timing.ScheduleEvent(static_cast<s64>(1 + (i * 7919) % 4096), cb, i, 0);
+        }
+        do {
+            timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+            timing.GetTimer(0)->Advance();
+            timing.GetTimer(0)->SetNextSlice();
+        } while (timing.GetTimer(0)->GetDowncount() != MAX_SLICE_LENGTH);
+    };
+}
+
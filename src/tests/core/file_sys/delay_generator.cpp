@@ -0,0 +1,57 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/settings.h"
+#include "core/file_sys/delay_generator.h"
+
+using FileSys::DeviceDelayGenerator;
+using FileSys::DeviceQueue;
+using FileSys::StorageDevice;
+
+TEST_CASE("DeviceDelayGenerator follows the measured timings", "[core][file_sys]") {
+    Settings::values.fs_timing_profile = Settings::FSTimingProfile::Accurate;
+    DeviceDelayGenerator game_card(StorageDevice::GameCard);
+    DeviceDelayGenerator sd_card(StorageDevice::SDCard);
+
+    // Small reads are bound by the minimum, larger ones grow with their size.
+    REQUIRE(game_card.GetReadDelayNs(16) == 663124);
+    REQUIRE(game_card.GetReadDelayNs(0x10000) == 0x10000 * 94 + 582778);
+    REQUIRE(sd_card.GetReadDelayNs(0x10000) == 0x10000 * 183 + 524879);
+    REQUIRE(game_card.GetOpenDelayNs() == 9438006);
+    REQUIRE(sd_card.GetOpenDelayNs() == 269082);
+
+    SECTION("the fast profile only keeps the cost of a request") {
+        Settings::values.fs_timing_profile = Settings::FSTimingProfile::Fast;
+        REQUIRE(game_card.GetReadDelayNs(0x10000) == 582778);
+        REQUIRE(game_card.GetReadDelayNs(16) == 582778);
+        REQUIRE(game_card.GetOpenDelayNs() == 582778);
+        REQUIRE(DeviceQueue::Reserve(StorageDevice::GameCard, 1000000000, 0) == 0);
+    }
+
+    Settings::values.fs_timing_profile = Settings::FSTimingProfile::Accurate;
+}
+
+TEST_CASE("DeviceQueue makes reads wait for the ones ahead of them", "[core][file_sys]") {
+    Settings::values.fs_timing_profile = Settings::FSTimingProfile::Accurate;
+    DeviceQueue::Reset();
+    constexpr u64 service_ticks = 1000;
+
+    // Reads issued at the same emulated time are served one after another.
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::SDCard, service_ticks, 5000) == 0);
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::SDCard, service_ticks, 5000) == 1000);
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::SDCard, service_ticks, 5500) == 1500);
+
+    // A read issued once the device is idle again does not wait.
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::SDCard, service_ticks, 9000) == 0);
+
+    // Devices queue independently.
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::GameCard, service_ticks, 5000) == 0);
+
+    // The queues start over with the emulated clock.
+    DeviceQueue::Reset();
+    REQUIRE(DeviceQueue::Reserve(StorageDevice::SDCard, service_ticks, 0) == 0);
+    DeviceQueue::Reset();
+}
@@ -0,0 +1,142 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/file_util.h"
+#include "core/file_sys/layered_fs.h"
+
+namespace {
+
+class MemoryRomFS final : public FileSys::RomFSReader {
+public:
+    explicit MemoryRomFS(std::vector<u8> data_) : data{std::move(data_)} {}
+
+    std::size_t GetSize() const override {
+        return data.size();
+    }
+
+    std::size_t ReadFile(std::size_t offset, std::size_t length, u8* buffer) override {
+        std::memcpy(buffer, data.data() + offset, length);
+        return length;
+    }
+
+    bool AllowsCachedReads() const override {
+        return false;
+    }
+
+    bool CacheReady(std::size_t file_offset, std::size_t length) override {
+        return false;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+/// A RomFS with only the root directory, so every file comes from the mod directory.
+std::vector<u8> MakeEmptyRomFS() {
+    FileSys::RomFSHeader header{};
+    header.header_length = sizeof(header);
+    header.directory_hash_table = {0x28, 4};
+    header.directory_metadata_table = {0x2C, 0x18};
+    header.file_hash_table = {0x44, 4};
+    header.file_metadata_table = {0x48, 0};
+    header.file_data_offset = 0x50;
+
+    std::vector<u8> data(header.file_data_offset, 0xFF);
+    std::memcpy(data.data(), &header, sizeof(header));
+    // The root directory is its own parent and has an empty name.
+    std::memset(data.data() + 0x28, 0, 4);
+    std::memset(data.data() + 0x2C, 0, 4);
+    std::memset(data.data() + 0x2C + 0x14, 0, 4);
+    return data;
+}
+
+std::vector<u8> MakeData(std::size_t size, u8 seed) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; i++) {
+        data[i] = static_cast<u8>(seed + i * 7);
+    }
+    return data;
+}
+
+void WriteFile(const std::string& path, const std::vector<u8>& data) {
+    REQUIRE(FileUtil::CreateFullPath(path));
+    FileUtil::IOFile file(path, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+bool Contains(const std::vector<u8>& image, const std::vector<u8>& data) {
+    return std::search(image.begin(), image.end(), data.begin(), data.end()) != image.end();
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LayeredFS reuses its index while the mods are unchanged", "[core][file_sys]") {
+    const auto temp = std::filesystem::temp_directory_path() / "borked3ds_layered_fs_test";
+    std::filesystem::remove_all(temp);
+    const std::string mods_path = (temp / "mods").generic_string() + "/";
+    const std::string cache_path = (temp / "cache").generic_string();
+    REQUIRE(FileUtil::CreateDir(temp.generic_string()));
+    REQUIRE(FileUtil::CreateDir(cache_path));
+
+    const std::string old_cache_path = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir);
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, cache_path);
+
+    const auto a = MakeData(1000, 1);
+    const auto b = MakeData(3000, 2);
+    WriteFile(mods_path + "romfs/a.bin", a);
+    WriteFile(mods_path + "romfs/dir/b.bin", b);
+
+    const auto romfs = std::make_shared<MemoryRomFS>(MakeEmptyRomFS());
+    const auto build = [&] {
+        FileSys::LayeredFS layered_fs(romfs, mods_path + "romfs/", mods_path + "romfs_ext/");
+        std::vector<u8> image(layered_fs.GetSize());
+        REQUIRE(layered_fs.ReadFile(0, image.size(), image.data()) == image.size());
+        return image;
+    };
+
+    const auto first = build();
+    REQUIRE(Contains(first, a));
+    REQUIRE(Contains(first, b));
+    REQUIRE(!std::filesystem::is_empty(temp / "cache" / "layered_fs"));
+
+    // Damage the metadata kept in the index without changing its key, so that only an image
+    // built from the index has the damaged byte.
+    const auto index_path =
+        std::filesystem::directory_iterator(temp / "cache" / "layered_fs")->path().generic_string();
+    constexpr std::size_t index_metadata_offset = 0x18; // magic, version, key and metadata size
+    constexpr std::size_t damaged_offset = 0x28;
+    {
+        FileUtil::IOFile index(index_path, "r+b");
+        u8 value;
+        REQUIRE(index.Seek(index_metadata_offset + damaged_offset, SEEK_SET));
+        REQUIRE(index.ReadBytes(&value, 1) == 1);
+        value ^= 0xFF;
+        REQUIRE(index.Seek(index_metadata_offset + damaged_offset, SEEK_SET));
+        REQUIRE(index.WriteBytes(&value, 1) == 1);
+    }
+    auto from_index = first;
+    from_index[damaged_offset] ^= 0xFF;
+    REQUIRE(build() == from_index);
+
+    const auto new_b = MakeData(500, 3);
+    WriteFile(mods_path + "romfs/dir/b.bin", new_b);
+    const auto rebuilt = build();
+    REQUIRE(Contains(rebuilt, a));
+    REQUIRE(Contains(rebuilt, new_b));
+    REQUIRE(rebuilt.size() < first.size());
+    REQUIRE(rebuilt[damaged_offset] == first[damaged_offset]);
+
+    // The old cache directory can only be restored if it exists, so keep the new one around.
+    FileUtil::UpdateUserPath(FileUtil::UserPath::CacheDir, old_cache_path);
+    std::filesystem::remove_all(temp / "mods");
+    std::filesystem::remove_all(temp / "cache" / "layered_fs");
+}
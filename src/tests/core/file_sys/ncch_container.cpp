@@ -0,0 +1,80 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/file_sys/ncch_container.h"
+
+namespace {
+
+/**
+ * A compressed section is decompressed back to front. Its footer points at the compressed
+ * stream before it, which is read backwards:
+ * - control byte 0x18: three literals then two back-references
+ * - literals 'C', 'B', 'A'
+ * - 0xF000: 18 bytes from 3 bytes further on, which overlaps the bytes being written
+ * - 0x0001: 3 bytes from 4 bytes further on
+ * The "HEAD" in front of the stream is left as it is.
+ */
+std::vector<u8> MakeCompressed() {
+    return {'H', 'E', 'A', 'D',                          // uncompressed head
+            0x01, 0x00, 0x00, 0xF0, 'A', 'B', 'C', 0x18, // compressed stream
+            0x10, 0x00, 0x00, 0x08,                      // stream spans 0x10 to 0x08 from the end
+            0x08, 0x00, 0x00, 0x00};                     // decompressed minus compressed size
+}
+
+std::vector<u8> Decompress(const std::vector<u8>& compressed, bool& success) {
+    std::vector<u8> decompressed(FileSys::LZSS_GetDecompressedSize(compressed));
+    success = FileSys::LZSS_Decompress(compressed, decompressed);
+    return decompressed;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("LZSS_Decompress expands overlapping back-references", "[core][file_sys]") {
+    bool success = false;
+    const auto decompressed = Decompress(MakeCompressed(), success);
+    REQUIRE(success);
+
+    constexpr std::string_view expected = "HEADBCAABCABCABCABCABCABCABC";
+    REQUIRE(std::string_view(reinterpret_cast<const char*>(decompressed.data()),
+                             decompressed.size()) == expected);
+}
+
+TEST_CASE("LZSS_Decompress rejects damaged sections", "[core][file_sys]") {
+    bool success = true;
+
+    SECTION("too short for a footer") {
+        const std::vector<u8> compressed{0x01, 0x02};
+        REQUIRE(FileSys::LZSS_GetDecompressedSize(compressed) == 0);
+        std::vector<u8> decompressed(8);
+        REQUIRE(!FileSys::LZSS_Decompress(compressed, decompressed));
+    }
+
+    SECTION("truncated footer") {
+        // Without the decompressed size, the stream bytes are taken as the footer.
+        auto compressed = MakeCompressed();
+        compressed.resize(compressed.size() - 4);
+        std::vector<u8> decompressed(28);
+        REQUIRE(!FileSys::LZSS_Decompress(compressed, decompressed));
+    }
+
+    SECTION("stream starting before the section") {
+        auto compressed = MakeCompressed();
+        compressed[12] = 0x21;
+        Decompress(compressed, success);
+        REQUIRE(!success);
+    }
+
+    SECTION("back-reference past the end of the output") {
+        auto compressed = MakeCompressed();
+        compressed[4] = 0xFF;
+        compressed[5] = 0x0F;
+        Decompress(compressed, success);
+        REQUIRE(!success);
+    }
+}
@@ -0,0 +1,193 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/aes.h>
+#include <cryptopp/modes.h>
+
+#include "common/file_util.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/file_sys/romfs_page_cache.h"
+#include "core/file_sys/romfs_reader.h"
+
+using FileSys::RomFSPageCache;
+
+namespace {
+
+RomFSPageCache::Page MakePage(u8 value) {
+    return std::make_shared<const std::vector<u8>>(RomFSPageCache::page_size, value);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("RomFSPageCache evicts the least recently used page", "[core][file_sys]") {
+    // One page per shard.
+    RomFSPageCache cache(16 * RomFSPageCache::page_size);
+    REQUIRE(cache.IsEnabled());
+
+    // Pages 0 and 16 land in the same shard.
+    constexpr u64 first = 0;
+    constexpr u64 second = 16 * RomFSPageCache::page_size;
+    cache.Insert(first, MakePage(1));
+    REQUIRE(cache.Contains(first));
+    REQUIRE(cache.Find(first)->at(0) == 1);
+
+    cache.Insert(second, MakePage(2));
+    REQUIRE(!cache.Contains(first));
+    REQUIRE(cache.Find(first) == nullptr);
+    REQUIRE(cache.Find(second)->at(0) == 2);
+
+    // Inserting a page that is already cached keeps the cached copy.
+    cache.Insert(second, MakePage(3));
+    REQUIRE(cache.Find(second)->at(0) == 2);
+
+    const auto stats = cache.GetStats();
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.misses == 1);
+
+    cache.Clear();
+    REQUIRE(!cache.Contains(second));
+}
+
+TEST_CASE("RomFSPageCache with no capacity is disabled", "[core][file_sys]") {
+    RomFSPageCache cache(0);
+    REQUIRE(!cache.IsEnabled());
+    cache.Insert(0, MakePage(1));
+    REQUIRE(!cache.Contains(0));
+}
+
+TEST_CASE("DirectRomFSReader decrypts through the page cache", "[core][file_sys]") {
+    constexpr std::size_t file_offset = 0x200;
+    constexpr std::size_t data_size = 40 * RomFSPageCache::page_size + 1234;
+    constexpr std::size_t crypto_offset = 0x1000;
+    const std::array<u8, 16> key{0x10, 0x32, 0x54, 0x76, 0x98, 0xBA, 0xDC, 0xFE};
+    const std::array<u8, 16> ctr{0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+
+    std::vector<u8> plain(data_size);
+    std::mt19937 rng(41);
+    for (auto& byte : plain) {
+        byte = static_cast<u8>(rng());
+    }
+    std::vector<u8> encrypted = plain;
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption e(key.data(), key.size(), ctr.data());
+    e.Seek(crypto_offset);
+    e.ProcessData(encrypted.data(), encrypted.data(), encrypted.size());
+
+    const auto path =
+        (std::filesystem::temp_directory_path() / "borked3ds_romfs_reader_test.bin").string();
+    {
+        FileUtil::IOFile file(path, "wb");
+        const std::vector<u8> padding(file_offset);
+        file.WriteBytes(padding.data(), padding.size());
+        file.WriteBytes(encrypted.data(), encrypted.size());
+    }
+
+    SCOPE_EXIT({
+        Settings::values.romfs_cache_size = Settings::values.romfs_cache_size.GetDefault();
+        FileUtil::Delete(path);
+    });
+    Settings::values.romfs_cache_size = 1;
+    FileSys::DirectRomFSReader reader(FileUtil::IOFile(path, "rb"), file_offset, data_size, key,
+                                      ctr, crypto_offset);
+
+    SECTION("sequential reads") {
+        std::vector<u8> out(data_size);
+        for (std::size_t offset = 0; offset < data_size; offset += 1000) {
+            const std::size_t length = std::min<std::size_t>(1000, data_size - offset);
+            REQUIRE(reader.ReadFile(offset, length, out.data() + offset) == length);
+        }
+        REQUIRE(out == plain);
+
+        // Everything read so far has been cached, including the read ahead pages.
+        REQUIRE(reader.CacheReady(0, 1000));
+        REQUIRE(reader.CacheReady(data_size - 1000, 1000));
+    }
+
+    SECTION("large reads bypass the cache") {
+        std::vector<u8> out(3 * RomFSPageCache::page_size);
+        REQUIRE(!reader.CacheReady(100, out.size()));
+        REQUIRE(reader.ReadFile(100, out.size(), out.data()) == out.size());
+        REQUIRE(std::memcmp(out.data(), plain.data() + 100, out.size()) == 0);
+        REQUIRE(!reader.CacheReady(100, 1));
+    }
+
+    SECTION("concurrent random reads") {
+        REQUIRE(!reader.CacheReady(0, 1));
+        std::vector<std::thread> threads;
+        std::array<std::atomic<bool>, 4> matched{true, true, true, true};
+        for (std::size_t t = 0; t < matched.size(); t++) {
+            threads.emplace_back([&, t] {
+                std::mt19937 thread_rng(static_cast<u32>(t));
+                std::vector<u8> out(RomFSPageCache::page_size);
+                for (int i = 0; i < 500; i++) {
+                    const std::size_t offset = thread_rng() % data_size;
+                    const std::size_t length = std::min<std::size_t>(
+                        thread_rng() % RomFSPageCache::page_size + 1, data_size - offset);
+                    if (reader.ReadFile(offset, length, out.data()) != length ||
+                        std::memcmp(out.data(), plain.data() + offset, length) != 0) {
+                        matched[t] = false;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(std::all_of(matched.begin(), matched.end(),
+                            [](const std::atomic<bool>& m) { return m.load(); }));
+    }
+
+    SECTION("asynchronous reads") {
+        std::mt19937 read_rng(43);
+        std::vector<u8> out(3 * RomFSPageCache::page_size);
+        for (int i = 0; i < 200; i++) {
+            const std::size_t offset = read_rng() % data_size;
+            // Mostly reads through the cache, some that bypass it.
+            const std::size_t max_length = i % 10 ? RomFSPageCache::page_size : out.size();
+            const std::size_t length =
+                std::min<std::size_t>(read_rng() % max_length + 1, data_size - offset);
+            std::promise<ResultVal<std::size_t>> result;
+            reader.ReadFileAsync(
+                offset, length, out.data(),
+                [&result](ResultVal<std::size_t> read) { result.set_value(std::move(read)); });
+            const ResultVal<std::size_t> read = result.get_future().get();
+            REQUIRE(read.Succeeded());
+            REQUIRE(*read == length);
+            REQUIRE(std::memcmp(out.data(), plain.data() + offset, length) == 0);
+        }
+    }
+}
+
+TEST_CASE("DirectRomFSReader reports failed asynchronous reads", "[core][file_sys]") {
+    constexpr std::size_t data_size = 4 * RomFSPageCache::page_size;
+    SCOPE_EXIT({
+        Settings::values.romfs_cache_size = Settings::values.romfs_cache_size.GetDefault();
+    });
+    Settings::values.romfs_cache_size = 1;
+
+    // The file is not open, so every host read fails.
+    FileSys::DirectRomFSReader reader(FileUtil::IOFile(), 0, data_size);
+    std::vector<u8> out(2 * RomFSPageCache::page_size);
+
+    // Through the cache, and bypassing it.
+    for (const std::size_t length : {std::size_t{100}, out.size()}) {
+        std::promise<ResultVal<std::size_t>> result;
+        reader.ReadFileAsync(
+            0, length, out.data(),
+            [&result](ResultVal<std::size_t> read) { result.set_value(std::move(read)); });
+        REQUIRE(result.get_future().get().Failed());
+    }
+    REQUIRE(!reader.CacheReady(0, 100));
+}
@@ -0,0 +1,133 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/hle/kernel/async_io_executor.h"
+
+using Kernel::AsyncIOExecutor;
+
+TEST_CASE("AsyncIOExecutor runs higher priority requests first", "[kernel]") {
+    AsyncIOExecutor executor(1);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::mutex order_mutex;
+    std::vector<int> order;
+    const auto record = [&](int id) {
+        std::scoped_lock lock{order_mutex};
+        order.push_back(id);
+    };
+
+    std::vector<AsyncIOExecutor::TaskHandle> handles;
+    // Occupies the only thread until the other requests are queued.
+    handles.push_back(executor.Submit("fs", false, 0x30, [released] { released.wait(); }));
+    handles.push_back(executor.Submit("fs", false, 0x30, [&] { record(1); }));
+    handles.push_back(executor.Submit("fs", false, 0x18, [&] { record(2); }));
+    handles.push_back(executor.Submit("fs", false, 0x30, [&] { record(3); }));
+    std::promise<void> done;
+    handles.push_back(executor.Submit("fs", false, 0x3F, [&done] { done.set_value(); }));
+    release.set_value();
+    done.get_future().wait();
+    handles.clear();
+
+    REQUIRE(order == std::vector<int>{2, 1, 3});
+
+    const auto stats = executor.GetStats();
+    REQUIRE(stats.size() == 1);
+    REQUIRE(stats[0].name == "fs");
+    REQUIRE(stats[0].submitted == 5);
+    REQUIRE(stats[0].num_threads == 1);
+    REQUIRE(stats[0].max_queue_depth >= 3);
+}
+
+TEST_CASE("AsyncIOExecutor cancels requests that have not started", "[kernel]") {
+    AsyncIOExecutor executor(1);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> ran = false;
+
+    auto blocker = executor.Submit("fs", false, 0, [released] { released.wait(); });
+    {
+        // Destroyed while the blocker still occupies the only thread.
+        auto cancelled = executor.Submit("fs", false, 0, [&ran] { ran = true; });
+    }
+    std::promise<void> done;
+    auto last = executor.Submit("fs", false, 0, [&done] { done.set_value(); });
+    release.set_value();
+    done.get_future().wait();
+
+    REQUIRE(!ran);
+    const auto stats = executor.GetStats();
+    REQUIRE(stats[0].cancelled == 1);
+}
+
+TEST_CASE("AsyncIOExecutor starts threads for blocking queues", "[kernel]") {
+    AsyncIOExecutor executor(1);
+
+    // Each request waits for the other, which only works if both run at the same time.
+    std::promise<void> first_started, second_started;
+    std::shared_future<void> first = first_started.get_future().share();
+    std::shared_future<void> second = second_started.get_future().share();
+
+    std::promise<void> both_done;
+    std::atomic<int> num_done = 0;
+    const auto finish = [&] {
+        if (++num_done == 2) {
+            both_done.set_value();
+        }
+    };
+
+    auto a = executor.Submit("soc", true, 0, [&first_started, second, &finish] {
+        first_started.set_value();
+        second.wait();
+        finish();
+    });
+    auto b = executor.Submit("soc", true, 0, [&second_started, first, &finish] {
+        second_started.set_value();
+        first.wait();
+        finish();
+    });
+    both_done.get_future().wait();
+    { auto discard_a = std::move(a), discard_b = std::move(b); }
+
+    const auto stats = executor.GetStats();
+    REQUIRE(stats.size() == 1);
+    REQUIRE(stats[0].completed == 2);
+    REQUIRE(stats[0].num_threads == 2);
+}
+
+TEST_CASE("AsyncIOExecutor releases the thread of deferred requests", "[kernel]") {
+    AsyncIOExecutor executor(1);
+
+    // The first request only completes once the second one has run on the only thread.
+    AsyncIOExecutor::Completion pending;
+    std::promise<void> started;
+    auto deferred = executor.SubmitDeferred(
+        "fs", false, 0, [&pending, &started](AsyncIOExecutor::Completion completion) {
+            pending = std::move(completion);
+            started.set_value();
+        });
+    started.get_future().wait();
+
+    std::promise<void> done;
+    auto other = executor.Submit("fs", false, 0, [&done] { done.set_value(); });
+    done.get_future().wait();
+    { auto discard = std::move(other); }
+
+    auto stats = executor.GetStats();
+    REQUIRE(stats[0].completed == 1);
+
+    pending();
+    { auto discard = std::move(deferred); }
+    stats = executor.GetStats();
+    REQUIRE(stats[0].completed == 2);
+    REQUIRE(stats[0].num_threads == 1);
+}
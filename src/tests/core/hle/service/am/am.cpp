@@ -0,0 +1,225 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+#include <cryptopp/sha.h>
+
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "core/core.h"
+#include "core/file_sys/cia_common.h"
+#include "core/file_sys/cia_container.h"
+#include "core/file_sys/ticket.h"
+#include "core/file_sys/title_metadata.h"
+#include "core/hle/service/am/am.h"
+#include "core/loader/loader.h"
+
+namespace {
+
+constexpr u64 TITLE_ID = 0x00040000000B3D00;
+constexpr u32 SIGNATURE_SIZE = 0x100;
+constexpr std::size_t SIGNED_BODY_OFFSET = 0x140;
+
+/// Points the SD card at an empty directory for the duration of a test.
+struct TempSDMC {
+    TempSDMC() {
+        std::filesystem::remove_all(temp);
+        std::filesystem::create_directories(temp / "sdmc");
+        old_sdmc_path = FileUtil::GetUserPath(FileUtil::UserPath::SDMCDir);
+        FileUtil::UpdateUserPath(FileUtil::UserPath::SDMCDir, (temp / "sdmc").generic_string());
+    }
+
+    ~TempSDMC() {
+        FileUtil::UpdateUserPath(FileUtil::UserPath::SDMCDir, old_sdmc_path);
+        std::filesystem::remove_all(temp);
+    }
+
+    std::string WriteCIA(const std::string& name, const std::vector<u8>& cia) const {
+        const std::string path = (temp / name).generic_string();
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(cia.data(), cia.size()) == cia.size());
+        return path;
+    }
+
+    const std::filesystem::path temp =
+        std::filesystem::temp_directory_path() / "borked3ds_am_install_test";
+    std::string old_sdmc_path;
+};
+
+std::vector<u8> MakeContent(std::size_t size, u8 seed) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 31 + seed + (i >> 12));
+    }
+    return data;
+}
+
+std::array<u8, 0x20> Sha256(const std::vector<u8>& data) {
+    std::array<u8, 0x20> hash;
+    CryptoPP::SHA256().CalculateDigest(hash.data(), data.data(), data.size());
+    return hash;
+}
+
+template <typename T>
+void Append(std::vector<u8>& out, const T& value) {
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/// Starts a signed section: signature type, an empty signature and padding up to the body.
+std::vector<u8> MakeSigned() {
+    std::vector<u8> section;
+    Append(section, u32_be{FileSys::Rsa2048Sha256});
+    section.resize(SIGNED_BODY_OFFSET);
+    static_assert(Common::AlignUp(SIGNATURE_SIZE + sizeof(u32), 0x40) == SIGNED_BODY_OFFSET);
+    return section;
+}
+
+/// Builds an unencrypted CIA holding the given contents, whose TMD hashes can be damaged.
+std::vector<u8> MakeCIA(const std::vector<std::vector<u8>>& contents, bool bad_hash = false) {
+    auto ticket = MakeSigned();
+    FileSys::Ticket::Body ticket_body{};
+    ticket_body.title_id = TITLE_ID;
+    Append(ticket, ticket_body);
+
+    auto tmd = MakeSigned();
+    FileSys::TitleMetadata::Body tmd_body{};
+    tmd_body.title_id = TITLE_ID;
+    tmd_body.content_count = static_cast<u16>(contents.size());
+    Append(tmd, tmd_body);
+
+    FileSys::CIAContainer::Header header{};
+    header.header_size = FileSys::CIA_HEADER_SIZE;
+    header.tik_size = static_cast<u32>(ticket.size());
+    header.tmd_size = static_cast<u32>(
+        tmd.size() + contents.size() * sizeof(FileSys::TitleMetadata::ContentChunk));
+
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        FileSys::TitleMetadata::ContentChunk chunk{};
+        chunk.id = static_cast<u32>(i);
+        chunk.index = static_cast<u16>(i);
+        chunk.size = contents[i].size();
+        chunk.hash = Sha256(contents[i]);
+        if (bad_hash) {
+            chunk.hash[0] ^= 0xFF;
+        }
+        Append(tmd, chunk);
+        header.content_size = header.content_size + contents[i].size();
+        header.SetContentPresent(static_cast<u16>(i));
+    }
+
+    std::vector<u8> cia;
+    const auto append_section = [&cia](const std::vector<u8>& section) {
+        cia.resize(Common::AlignUp(cia.size(), FileSys::CIA_SECTION_ALIGNMENT));
+        cia.insert(cia.end(), section.begin(), section.end());
+    };
+    Append(cia, header);
+    append_section(ticket);
+    append_section(tmd);
+    cia.resize(Common::AlignUp(cia.size(), FileSys::CIA_SECTION_ALIGNMENT));
+    for (const auto& content : contents) {
+        cia.insert(cia.end(), content.begin(), content.end());
+    }
+    return cia;
+}
+
+std::vector<u8> ReadInstalledContent(std::size_t index) {
+    std::vector<u8> data;
+    const auto path =
+        Service::AM::GetTitleContentPath(Service::FS::MediaType::SDMC, TITLE_ID, index);
+    FileUtil::IOFile file(path, "rb");
+    if (file.IsOpen()) {
+        data.resize(file.GetSize());
+        file.ReadBytes(data.data(), data.size());
+    }
+    return data;
+}
+
+bool IsTitleInstalled() {
+    return FileUtil::Exists(Service::AM::GetTitlePath(Service::FS::MediaType::SDMC, TITLE_ID));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("InstallCIA installs every content", "[core][am]") {
+    TempSDMC sdmc;
+    Core::System system;
+
+    // The first content spans several write blocks of the install pipeline.
+    const std::vector<std::vector<u8>> contents{MakeContent(0x280123, 1),
+                                                MakeContent(0x1000, 2)};
+    const auto path = sdmc.WriteCIA("title.cia", MakeCIA(contents));
+
+    std::size_t last_written = 0;
+    std::size_t last_total = 0;
+    const auto status = Service::AM::InstallCIA(system, path, [&](std::size_t written,
+                                                                  std::size_t total) {
+        REQUIRE(written >= last_written);
+        last_written = written;
+        last_total = total;
+    });
+
+    REQUIRE(status == Service::AM::InstallStatus::Success);
+    REQUIRE(last_total == FileUtil::GetSize(path));
+    REQUIRE(ReadInstalledContent(0) == contents[0]);
+    REQUIRE(ReadInstalledContent(1) == contents[1]);
+}
+
+TEST_CASE("CIAFile closed before all contents arrived aborts the install", "[core][am]") {
+    TempSDMC sdmc;
+    Core::System system;
+
+    const auto cia = MakeCIA({MakeContent(0x180000, 3)});
+    {
+        Service::AM::CIAFile file(system, Service::FS::MediaType::SDMC);
+        const std::size_t partial = cia.size() - 0x100;
+        REQUIRE(file.Write(0, partial, true, false, cia.data()).Unwrap() == partial);
+        REQUIRE(IsTitleInstalled());
+        file.Close();
+    }
+    REQUIRE(!IsTitleInstalled());
+}
+
+TEST_CASE("InstallCIA rejects contents that do not match the TMD", "[core][am]") {
+    TempSDMC sdmc;
+    Core::System system;
+
+    const auto path =
+        sdmc.WriteCIA("title.cia", MakeCIA({MakeContent(0x180000, 4)}, /*bad_hash=*/true));
+    REQUIRE(Service::AM::InstallCIA(system, path) == Service::AM::InstallStatus::ErrorInvalid);
+    REQUIRE(!IsTitleInstalled());
+}
+
+TEST_CASE("InstallCIAs installs the same title one at a time", "[core][am]") {
+    TempSDMC sdmc;
+    Core::System system;
+
+    const std::vector<std::vector<u8>> first{MakeContent(0x180000, 5)};
+    const std::vector<std::vector<u8>> second{MakeContent(0x1A0000, 6)};
+    const std::vector<std::string> paths{sdmc.WriteCIA("first.cia", MakeCIA(first)),
+                                         sdmc.WriteCIA("second.cia", MakeCIA(second))};
+
+    std::vector<std::size_t> reported;
+    const auto statuses = Service::AM::InstallCIAs(
+        system, paths, nullptr,
+        [&](std::size_t index, Service::AM::InstallStatus) { reported.push_back(index); }, 2);
+
+    REQUIRE(statuses ==
+            std::vector<Service::AM::InstallStatus>(2, Service::AM::InstallStatus::Success));
+    REQUIRE(reported.size() == 2);
+
+    // Whichever install ran last replaced the other one as a whole.
+    const auto installed = ReadInstalledContent(0);
+    REQUIRE((installed == first[0] || installed == second[0]));
+    FileSys::TitleMetadata tmd;
+    REQUIRE(tmd.Load(Service::AM::GetTitleMetadataPath(Service::FS::MediaType::SDMC, TITLE_ID)) ==
+            Loader::ResultStatus::Success);
+    REQUIRE(tmd.GetContentCount() == 1);
+    REQUIRE(tmd.GetContentHashByIndex(0) == Sha256(installed));
+}
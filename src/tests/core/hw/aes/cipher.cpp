@@ -0,0 +1,187 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/hw/aes/cipher.h"
+#include "core/hw/sha/sha.h"
+
+using namespace HW::AES;
+
+namespace {
+
+// Test vectors from NIST SP 800-38A, F.5.1 CTR-AES128.Encrypt and F.2.2 CBC-AES128.Decrypt.
+constexpr AESKey nist_key{0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                          0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+constexpr AESIV nist_ctr{0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+                         0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff};
+constexpr AESIV nist_iv{0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                        0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+constexpr std::array<u8, 64> nist_plaintext{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73,
+    0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7,
+    0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4,
+    0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45,
+    0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+constexpr std::array<u8, 64> nist_ctr_ciphertext{
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99,
+    0x0d, 0xb6, 0xce, 0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17,
+    0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff, 0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3,
+    0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab, 0x1e, 0x03, 0x1d, 0xda,
+    0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee};
+constexpr std::array<u8, 32> nist_cbc_ciphertext{
+    0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e,
+    0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72,
+    0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2};
+
+std::vector<u8> RandomData(std::size_t size) {
+    std::mt19937 rng(size);
+    std::vector<u8> data(size);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CTRCipher matches the NIST test vectors", "[core][hw][aes]") {
+    const CTRCipher cipher(nist_key);
+
+    SECTION("Whole stream") {
+        auto data = nist_plaintext;
+        cipher.Transform(nist_ctr, 0, data.data(), data.size());
+        REQUIRE(data == nist_ctr_ciphertext);
+    }
+
+    SECTION("Unaligned parts of the stream") {
+        // Crosses the carry out of the lowest counter byte between the first and second block.
+        for (std::size_t start = 0; start < nist_plaintext.size(); start += 7) {
+            for (std::size_t length = 0; start + length <= nist_plaintext.size(); length += 5) {
+                std::vector<u8> data(nist_plaintext.begin() + start,
+                                     nist_plaintext.begin() + start + length);
+                cipher.Transform(nist_ctr, start, data.data(), data.size());
+                REQUIRE(std::equal(data.begin(), data.end(), nist_ctr_ciphertext.begin() + start));
+            }
+        }
+    }
+}
+
+TEST_CASE("CTRCipher decrypts large buffers like many small ones", "[core][hw][aes]") {
+    const auto cipher = GetCTRCipher(nist_key);
+    REQUIRE(cipher == GetCTRCipher(nist_key));
+
+    // The counter carries through all of its bytes once the stream passes 16 bytes.
+    AESIV ctr{};
+    ctr.fill(0xff);
+    ctr[0] = 0x00;
+
+    const auto plaintext = RandomData(0x20000 + 13);
+    auto whole = plaintext;
+    cipher->Transform(ctr, 3, whole.data(), whole.size());
+
+    auto pieces = plaintext;
+    std::mt19937 rng(7);
+    for (std::size_t offset = 0; offset < pieces.size();) {
+        const std::size_t length = std::min<std::size_t>(rng() % 5000, pieces.size() - offset);
+        cipher->Transform(ctr, 3 + offset, pieces.data() + offset, length);
+        offset += length;
+    }
+    REQUIRE(whole == pieces);
+
+    // Decrypting again gives back the plaintext.
+    cipher->Transform(ctr, 3, whole.data(), whole.size());
+    REQUIRE(whole == plaintext);
+}
+
+TEST_CASE("CTRCipher can be shared between threads", "[core][hw][aes]") {
+    const auto cipher = GetCTRCipher(nist_key);
+    const auto plaintext = RandomData(0x40000);
+    auto expected = plaintext;
+    cipher->Transform(nist_ctr, 0, expected.data(), expected.size());
+
+    // Each thread decrypts every fourth 4 KiB part of the stream, as concurrent reads would.
+    constexpr std::size_t thread_count = 4;
+    constexpr std::size_t part_size = 0x1000;
+    auto data = plaintext;
+    {
+        std::vector<std::jthread> threads;
+        for (std::size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back([&, t] {
+                for (std::size_t offset = t * part_size; offset < data.size();
+                     offset += thread_count * part_size) {
+                    cipher->Transform(nist_ctr, offset, data.data() + offset, part_size);
+                }
+            });
+        }
+    }
+    REQUIRE(data == expected);
+}
+
+TEST_CASE("CBCDecryptor matches the NIST test vectors", "[core][hw][aes]") {
+    CBCDecryptor decryptor(nist_key, nist_iv);
+    auto data = nist_cbc_ciphertext;
+    // Decrypted in two calls, the chaining value carries over.
+    decryptor.Decrypt(data.data(), 16);
+    decryptor.Decrypt(data.data() + 16, 16);
+    REQUIRE(std::equal(data.begin(), data.end(), nist_plaintext.begin()));
+}
+
+TEST_CASE("SHA256 hashes incrementally", "[core][hw][sha]") {
+    // SHA-256("abc") from FIPS 180-2.
+    constexpr HW::SHA::SHA256Hash abc_hash{
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40,
+        0xde, 0x5d, 0xae, 0x22, 0x23, 0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17,
+        0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad};
+    constexpr std::array<u8, 3> abc{'a', 'b', 'c'};
+    REQUIRE(HW::SHA::ComputeSHA256(abc) == abc_hash);
+
+    const auto data = RandomData(100000);
+    HW::SHA::SHA256 sha;
+    sha.Update(data.data(), 12345);
+    sha.Update(data.data() + 12345, data.size() - 12345);
+    REQUIRE(sha.Final() == HW::SHA::ComputeSHA256(data));
+}
+
+TEST_CASE("ContentCrypto[Benchmark]", "[.][core][hw][benchmark]") {
+    constexpr std::size_t line_size = 0x4000;
+    auto data = RandomData(16 * 1024 * 1024);
+
+    // How DirectRomFSReader used to decrypt a read: a new key schedule for every cache line.
+    BENCHMARK("AES-CTR, key schedule per 16 KiB line") {
+        for (std::size_t offset = 0; offset < data.size(); offset += line_size) {
+            CTRCipher(nist_key).Transform(nist_ctr, offset, data.data() + offset, line_size);
+        }
+        return data[0];
+    };
+
+    const auto cipher = GetCTRCipher(nist_key);
+    BENCHMARK("AES-CTR, cached key schedule per 16 KiB line") {
+        for (std::size_t offset = 0; offset < data.size(); offset += line_size) {
+            cipher->Transform(nist_ctr, offset, data.data() + offset, line_size);
+        }
+        return data[0];
+    };
+
+    BENCHMARK("AES-CTR, one call") {
+        cipher->Transform(nist_ctr, 0, data.data(), data.size());
+        return data[0];
+    };
+
+    BENCHMARK("AES-CBC") {
+        CBCDecryptor(nist_key, nist_iv).Decrypt(data.data(), data.size());
+        return data[0];
+    };
+
+    BENCHMARK("SHA-256") {
+        return HW::SHA::ComputeSHA256(data);
+    };
+}
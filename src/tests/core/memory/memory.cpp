@@ -3,6 +3,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <span>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -56,3 +61,62 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.BlockAccess", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+
+    // Two adjacent mappings whose backing memory is not contiguous on the host, so the block
+    // functions have to split their accesses at the boundary.
+    constexpr VAddr base_address = 0x10000000;
+    constexpr std::size_t mapping_size = 2 * Memory::BORKED3DS_PAGE_SIZE;
+    auto mem_low = std::make_shared<BufferMem>(mapping_size);
+    auto mem_high = std::make_shared<BufferMem>(mapping_size);
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(base_address, MemoryRef{mem_low},
+                                  static_cast<u32>(mapping_size), Kernel::MemoryState::Private)
+                .Succeeded());
+    REQUIRE(process->vm_manager
+                .MapBackingMemory(base_address + static_cast<VAddr>(mapping_size),
+                                  MemoryRef{mem_high}, static_cast<u32>(mapping_size),
+                                  Kernel::MemoryState::Private)
+                .Succeeded());
+
+    constexpr VAddr start = base_address + 0x800;
+    constexpr std::size_t size = 2 * mapping_size - 0x1000;
+    std::vector<u8> pattern(size);
+    std::iota(pattern.begin(), pattern.end(), u8{1});
+
+    memory.WriteBlock(*process, start, pattern.data(), size);
+    CHECK(std::equal(pattern.begin(), pattern.begin() + mapping_size - 0x800,
+                     mem_low->Vector().begin() + 0x800));
+    CHECK(std::equal(pattern.begin() + mapping_size - 0x800, pattern.end(),
+                     mem_high->Vector().begin()));
+
+    SECTION("ReadBlock returns the written data") {
+        std::vector<u8> result(size);
+        memory.ReadBlock(*process, start, result.data(), size);
+        CHECK(result == pattern);
+    }
+
+    SECTION("ZeroBlock clears the range across mappings") {
+        memory.ZeroBlock(*process, start, size);
+        std::vector<u8> result(size, 0xFF);
+        memory.ReadBlock(*process, start, result.data(), size);
+        CHECK(result == std::vector<u8>(size, 0));
+        CHECK(mem_low->Vector()[0x7FF] == 0);
+        CHECK(mem_high->Vector()[mapping_size - 0x800] == 0);
+    }
+
+    SECTION("CopyBlock handles ranges crossing mappings") {
+        memory.CopyBlock(*process, base_address, start, 0x2000);
+        std::vector<u8> result(0x2000);
+        memory.ReadBlock(*process, base_address, result.data(), result.size());
+        CHECK(std::equal(result.begin(), result.end(), pattern.begin()));
+    }
+}
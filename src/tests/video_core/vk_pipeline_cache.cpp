@@ -0,0 +1,132 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/file_util.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/frontend/emu_window.h"
+#include "video_core/pica/regs_internal.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/renderer_vulkan/vk_descriptor_update_queue.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+#include "video_core/renderer_vulkan/vk_render_manager.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+
+namespace {
+
+constexpr u64 PROGRAM_ID = 0x00040000000B3D00;
+
+class TestWindow final : public Frontend::EmuWindow {
+public:
+    void PollEvents() override {}
+};
+
+/// Owns everything a pipeline cache needs, torn down in the same order as the renderer does.
+struct Device {
+    explicit Device(Frontend::EmuWindow& window)
+        : instance{window, 0}, scheduler{instance}, render_manager{instance, scheduler},
+          update_queue{instance} {}
+
+    Vulkan::Instance instance;
+    Vulkan::Scheduler scheduler;
+    Vulkan::RenderManager render_manager;
+    Vulkan::DescriptorUpdateQueue update_queue;
+};
+
+/// Returns the device, or nullptr if there is no Vulkan driver to run on.
+std::unique_ptr<Device> CreateDevice(Frontend::EmuWindow& window) {
+    try {
+        if (Vulkan::Instance{}.GetPhysicalDevices().empty()) {
+            return nullptr;
+        }
+        return std::make_unique<Device>(window);
+    } catch (const std::runtime_error&) {
+        return nullptr;
+    }
+}
+
+/// Binds the shaders and pipeline for the PICA state, as a draw would.
+void BindKeys(Vulkan::PipelineCache& cache, const Device& device, const Pica::RegsInternal& regs,
+              Pica::ShaderSetup& setup, const Vulkan::PipelineInfo& info) {
+    REQUIRE(cache.UseProgrammableVertexShader(regs, setup, info.vertex_layout, false));
+    if (device.instance.IsFragmentShaderBarycentricSupported()) {
+        cache.UseTrivialGeometryShader();
+    } else {
+        REQUIRE(cache.UseFixedGeometryShader(regs));
+    }
+    cache.UseFragmentShader(regs, {});
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PipelineCache builds recorded pipelines on load", "[video_core][vulkan]") {
+    const auto temp = std::filesystem::temp_directory_path() / "borked3ds_pipeline_cache_test";
+    std::filesystem::remove_all(temp);
+    std::filesystem::create_directories(temp);
+    const std::string old_shader_path = FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir);
+    FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, temp.generic_string());
+    const bool old_use_disk_shader_cache = Settings::values.use_disk_shader_cache.GetValue();
+    Settings::values.use_disk_shader_cache = true;
+    SCOPE_EXIT({
+        Settings::values.use_disk_shader_cache = old_use_disk_shader_cache;
+        FileUtil::UpdateUserPath(FileUtil::UserPath::ShaderDir, old_shader_path);
+        std::filesystem::remove_all(temp);
+    });
+
+    TestWindow window;
+    const auto device = CreateDevice(window);
+    if (!device) {
+        SKIP("No Vulkan driver available\n");
+    }
+
+    auto regs = std::make_unique<Pica::RegsInternal>();
+    auto setup = std::make_unique<Pica::ShaderSetup>();
+    setup->program_code[0] = 0x88000000; // end
+    setup->swizzle_data[0] = 0x1B;
+    Vulkan::PipelineInfo info{};
+    info.attachments.color = VideoCore::PixelFormat::RGBA8;
+    info.attachments.depth = VideoCore::PixelFormat::D24S8;
+
+    const std::atomic_bool stop_loading{false};
+    std::size_t num_shaders{};
+    std::size_t num_pipelines{};
+    {
+        Vulkan::PipelineCache cache{device->instance, device->scheduler, device->render_manager,
+                                    device->update_queue};
+        cache.LoadDiskCache(PROGRAM_ID, stop_loading, {});
+        REQUIRE(cache.NumPipelines() == 0);
+
+        BindKeys(cache, *device, *regs, *setup, info);
+        // Wait for the shaders and the pipeline to be built, so that no work is left behind.
+        while (!cache.BindPipeline(info)) {
+            std::this_thread::yield();
+        }
+        num_shaders = cache.NumShaders();
+        num_pipelines = cache.NumPipelines();
+        REQUIRE(num_shaders > 0);
+        REQUIRE(num_pipelines == 1);
+    }
+
+    // The keys recorded by the first session are built while loading, before any draw.
+    Vulkan::PipelineCache cache{device->instance, device->scheduler, device->render_manager,
+                                device->update_queue};
+    cache.LoadDiskCache(PROGRAM_ID, stop_loading, {});
+    REQUIRE(cache.NumShaders() == num_shaders);
+    REQUIRE(cache.NumPipelines() == num_pipelines);
+
+    // Drawing with the same state finds everything ready and compiles nothing new.
+    BindKeys(cache, *device, *regs, *setup, info);
+    REQUIRE(cache.BindPipeline(info));
+    REQUIRE(cache.NumShaders() == num_shaders);
+    REQUIRE(cache.NumPipelines() == num_pipelines);
+}
@@ -0,0 +1,146 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/file_util.h"
+#include "video_core/pica/regs_internal.h"
+#include "video_core/renderer_vulkan/vk_pipeline_key_cache.h"
+
+using Vulkan::PipelineKeyCache;
+
+namespace {
+
+struct TempPath {
+    TempPath() {
+        path = (std::filesystem::temp_directory_path() / "borked3ds_pipeline_keys_test.bin")
+                   .string();
+        FileUtil::Delete(path);
+    }
+
+    ~TempPath() {
+        FileUtil::Delete(path);
+    }
+
+    std::string path;
+};
+
+struct Keys {
+    Keys() {
+        setup->program_code[0] = 0x88000000; // end
+        setup->swizzle_data[0] = 0x1B;
+    }
+
+    PipelineKeyCache::VSConfig MakeVSConfig(bool accurate_mul) {
+        return PipelineKeyCache::VSConfig{*regs, *setup, true, false, accurate_mul};
+    }
+
+    PipelineKeyCache::FSConfig MakeFSConfig() {
+        return PipelineKeyCache::FSConfig{*regs, {}, profile};
+    }
+
+    std::unique_ptr<Pica::RegsInternal> regs = std::make_unique<Pica::RegsInternal>();
+    std::unique_ptr<Pica::ShaderSetup> setup = std::make_unique<Pica::ShaderSetup>();
+    Pica::Shader::Profile profile{};
+};
+
+} // Anonymous namespace
+
+TEST_CASE("PipelineKeyCache keeps keys across sessions", "[video_core][vulkan]") {
+    TempPath temp;
+    Keys keys;
+
+    const auto vs_config = keys.MakeVSConfig(false);
+    const auto fs_config = keys.MakeFSConfig();
+    const PipelineKeyCache::GSConfig gs_config{*keys.regs, true};
+    Vulkan::PipelineInfo info{};
+    info.attachments.color = VideoCore::PixelFormat::RGBA8;
+    info.dynamic.blend_color = 0x12345678;
+    const std::array<u64, Vulkan::MAX_SHADER_STAGES> shader_hashes{vs_config.Hash(),
+                                                                   fs_config.Hash(), 0};
+
+    {
+        PipelineKeyCache cache;
+        REQUIRE(!cache.Load(temp.path));
+        cache.AddVertexShader(vs_config, *keys.setup);
+        cache.AddVertexShader(vs_config, *keys.setup);
+        cache.AddGeometryShader(gs_config);
+        cache.AddFragmentShader(fs_config);
+        cache.AddPipeline(info, shader_hashes);
+        // Only the dynamic state differs, so this is the same pipeline.
+        info.dynamic.blend_color = 0;
+        cache.AddPipeline(info, shader_hashes);
+        REQUIRE(cache.GetPipelines().size() == 1);
+        REQUIRE(cache.Save(temp.path));
+    }
+
+    const auto first_size = FileUtil::GetSize(temp.path);
+    {
+        PipelineKeyCache cache;
+        REQUIRE(cache.Load(temp.path));
+        REQUIRE(cache.GetVertexShaders().size() == 1);
+        REQUIRE(cache.GetVertexShaders().at(vs_config.Hash()) == vs_config);
+        REQUIRE(cache.GetGeometryShaders().at(gs_config.Hash()) == gs_config);
+        REQUIRE(cache.GetFragmentShaders().at(fs_config.Hash()) == fs_config);
+        REQUIRE(cache.GetPipelines().size() == 1);
+        REQUIRE(cache.GetPipelines()[0].info.attachments.color == VideoCore::PixelFormat::RGBA8);
+        REQUIRE(cache.GetPipelines()[0].shader_hashes == shader_hashes);
+
+        const auto* program = cache.FindProgram(vs_config);
+        REQUIRE(program);
+        REQUIRE(program->code == keys.setup->program_code);
+        REQUIRE(program->swizzle == keys.setup->swizzle_data);
+
+        // Known keys are not written again, new ones are appended.
+        cache.AddFragmentShader(fs_config);
+        REQUIRE(cache.Save(temp.path));
+        REQUIRE(FileUtil::GetSize(temp.path) == first_size);
+        cache.AddVertexShader(keys.MakeVSConfig(true), *keys.setup);
+        REQUIRE(cache.Save(temp.path));
+        REQUIRE(FileUtil::GetSize(temp.path) > first_size);
+    }
+
+    PipelineKeyCache cache;
+    REQUIRE(cache.Load(temp.path));
+    REQUIRE(cache.GetVertexShaders().size() == 2);
+}
+
+TEST_CASE("PipelineKeyCache drops a damaged tail", "[video_core][vulkan]") {
+    TempPath temp;
+    Keys keys;
+
+    const auto fs_config = keys.MakeFSConfig();
+    {
+        PipelineKeyCache cache;
+        cache.Load(temp.path);
+        cache.AddFragmentShader(fs_config);
+        cache.AddVertexShader(keys.MakeVSConfig(false), *keys.setup);
+        REQUIRE(cache.Save(temp.path));
+    }
+
+    // Cut the last record short, as a crash while appending would.
+    const auto size = FileUtil::GetSize(temp.path);
+    {
+        FileUtil::IOFile file(temp.path, "r+b");
+        REQUIRE(file.Resize(size - 1));
+    }
+
+    {
+        PipelineKeyCache cache;
+        REQUIRE(cache.Load(temp.path));
+        REQUIRE(cache.GetFragmentShaders().size() == 1);
+        REQUIRE(cache.GetVertexShaders().empty());
+        // The file is rewritten with the records that were intact.
+        REQUIRE(cache.Save(temp.path));
+    }
+
+    PipelineKeyCache cache;
+    REQUIRE(cache.Load(temp.path));
+    REQUIRE(cache.GetFragmentShaders().size() == 1);
+    REQUIRE(FileUtil::GetSize(temp.path) < size);
+}
@@ -4,6 +4,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <optional>
 #include <boost/container/static_vector.hpp>
 
 #include "common/common_paths.h"
@@ -12,6 +13,8 @@
 #include "common/profiling.h"
 #include "common/scope_exit.h"
 #include "common/settings.h"
+#include "core/core.h"
+#include "core/loader/loader.h"
 #include "video_core/renderer_vulkan/pica_to_vk.h"
 #include "video_core/renderer_vulkan/vk_descriptor_update_queue.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
@@ -125,11 +128,37 @@ PipelineCache::~PipelineCache() {
     SaveDiskCache();
 }
 
-void PipelineCache::LoadDiskCache() {
+void PipelineCache::LoadDiskCache(const std::atomic_bool& stop_loading,
+                                  const VideoCore::DiskResourceLoadCallback& callback) {
+    u64 program_id{};
+    if (Core::System::GetInstance().GetAppLoader().ReadProgramId(program_id) !=
+        Loader::ResultStatus::Success) {
+        program_id = 0;
+    }
+    LoadDiskCache(program_id, stop_loading, callback);
+}
+
+void PipelineCache::LoadDiskCache(u64 program_id, const std::atomic_bool& stop_loading,
+                                  const VideoCore::DiskResourceLoadCallback& callback) {
     if (!Settings::values.use_disk_shader_cache || !EnsureDirectories()) {
         return;
     }
 
+    LoadDriverCache();
+
+    // Skip games without title id
+    if (program_id == 0) {
+        return;
+    }
+
+    key_cache_path = fmt::format("{}transferable{}{:016X}.bin", GetPipelineCacheDir(), DIR_SEP,
+                                 program_id);
+    if (key_cache.Load(key_cache_path)) {
+        BuildRecordedPipelines(stop_loading, callback);
+    }
+}
+
+void PipelineCache::LoadDriverCache() {
     const auto cache_dir = GetPipelineCacheDir();
     const u32 vendor_id = instance.GetVendorID();
     const u32 device_id = instance.GetDeviceID();
@@ -173,6 +202,10 @@ void PipelineCache::SaveDiskCache() {
         return;
     }
 
+    if (!key_cache_path.empty()) {
+        key_cache.Save(key_cache_path);
+    }
+
     const auto cache_dir = GetPipelineCacheDir();
     const u32 vendor_id = instance.GetVendorID();
     const u32 device_id = instance.GetDeviceID();
@@ -195,22 +228,7 @@ void PipelineCache::SaveDiskCache() {
 bool PipelineCache::BindPipeline(const PipelineInfo& info, bool wait_built) {
     BORKED3DS_PROFILE("Vulkan", "Pipeline Bind");
 
-    u64 shader_hash = 0;
-    for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
-        shader_hash = Common::HashCombine(shader_hash, shader_hashes[i]);
-    }
-
-    const u64 info_hash = info.Hash(instance);
-    const u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
-
-    auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
-    if (new_pipeline) {
-        it.value() =
-            std::make_unique<GraphicsPipeline>(instance, renderpass_cache, info, *pipeline_cache,
-                                               *pipeline_layout, current_shaders, &workers);
-    }
-
-    GraphicsPipeline* const pipeline{it->second.get()};
+    GraphicsPipeline* const pipeline = EmplacePipeline(info, shader_hashes, current_shaders);
     if (!pipeline->IsDone() && !pipeline->TryBuild(wait_built)) {
         return false;
     }
@@ -361,46 +379,18 @@ bool PipelineCache::UseProgrammableVertexShader(const Pica::RegsInternal& regs,
         }
     }
 
-    const auto [it, new_config] = programmable_vertex_map.try_emplace(config);
-    if (new_config) {
-        const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
-        const vk::Device device = instance.GetDevice();
-
-        std::vector<u32> code;
-
-        if (use_spirv && false) {
-            // TODO: Generate vertex shader SPIRV from the given VS program
-            // code = SPIRV::GenerateVertexShader(setup, config, profile);
-        } else {
-            // Generate GLSL
-            const std::string program = GLSL::GenerateVertexShader(setup, config, true);
-            if (program.empty()) {
-                LOG_ERROR(Render_Vulkan, "Failed to retrieve programmable vertex shader");
-                programmable_vertex_map[config] = nullptr;
-                return false;
-            }
-            // Compile GLSL to SPIRV
-            code = CompileGLSLtoSPIRV(program, vk::ShaderStageFlagBits::eVertex, device);
-        }
-
-        const u64 code_hash = Common::ComputeHash64(std::as_bytes(std::span(code)));
-
-        const auto [iter, new_program] = programmable_vertex_cache.try_emplace(code_hash, instance);
-        auto& shader = iter->second;
-
-        // Queue worker thread to create shader module
-        if (new_program) {
-            shader.program = std::move(code);
-            workers.QueueWork([device, &shader] {
-                shader.module = CompileSPV(shader.program, device);
-                shader.MarkDone();
-            });
+    Shader* shader{};
+    if (const auto it = programmable_vertex_map.find(config);
+        it != programmable_vertex_map.end()) {
+        shader = it->second;
+    } else {
+        std::vector<u32> code = GenerateVertexShader(setup, config);
+        if (!code.empty()) {
+            key_cache.AddVertexShader(config, setup);
         }
-
-        it->second = &shader;
+        shader = EmplaceVertexShader(config, std::move(code));
     }
 
-    Shader* const shader{it->second};
     if (!shader) {
         LOG_ERROR(Render_Vulkan, "Failed to retrieve programmable vertex shader");
         return false;
@@ -424,18 +414,7 @@ bool PipelineCache::UseFixedGeometryShader(const Pica::RegsInternal& regs) {
     }
 
     const PicaFixedGSConfig gs_config{regs, instance.IsShaderClipDistanceSupported()};
-    auto [it, new_shader] = fixed_geometry_shaders.try_emplace(gs_config, instance);
-    auto& shader = it->second;
-
-    if (new_shader) {
-        workers.QueueWork([gs_config, device = instance.GetDevice(), &shader]() {
-            const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
-            shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
-            shader.MarkDone();
-        });
-    }
-
-    current_shaders[ProgramType::GS] = &shader;
+    current_shaders[ProgramType::GS] = &EmplaceGeometryShader(gs_config);
     shader_hashes[ProgramType::GS] = gs_config.Hash();
 
     return true;
@@ -449,10 +428,73 @@ void PipelineCache::UseTrivialGeometryShader() {
 void PipelineCache::UseFragmentShader(const Pica::RegsInternal& regs,
                                       const Pica::Shader::UserConfig& user) {
     const FSConfig fs_config{regs, user, profile};
+    current_shaders[ProgramType::FS] = &EmplaceFragmentShader(fs_config);
+    shader_hashes[ProgramType::FS] = fs_config.Hash();
+}
+
+std::vector<u32> PipelineCache::GenerateVertexShader(const Pica::ShaderSetup& setup,
+                                                     const PicaVSConfig& config) const {
+    const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
+    if (use_spirv && false) {
+        // TODO: Generate vertex shader SPIRV from the given VS program
+        // return SPIRV::GenerateVertexShader(setup, config, profile);
+    }
+
+    // Generate GLSL
+    const std::string program = GLSL::GenerateVertexShader(setup, config, true);
+    if (program.empty()) {
+        return {};
+    }
+    // Compile GLSL to SPIRV
+    return CompileGLSLtoSPIRV(program, vk::ShaderStageFlagBits::eVertex, instance.GetDevice());
+}
+
+Shader* PipelineCache::EmplaceVertexShader(const PicaVSConfig& config, std::vector<u32> code) {
+    if (code.empty()) {
+        programmable_vertex_map[config] = nullptr;
+        return nullptr;
+    }
+
+    const u64 code_hash = Common::ComputeHash64(std::as_bytes(std::span(code)));
+
+    const auto [iter, new_program] = programmable_vertex_cache.try_emplace(code_hash, instance);
+    auto& shader = iter->second;
+
+    // Queue worker thread to create shader module
+    if (new_program) {
+        shader.program = std::move(code);
+        workers.QueueWork([device = instance.GetDevice(), &shader] {
+            shader.module = CompileSPV(shader.program, device);
+            shader.MarkDone();
+        });
+    }
+
+    programmable_vertex_map[config] = &shader;
+    return &shader;
+}
+
+Shader& PipelineCache::EmplaceGeometryShader(const PicaFixedGSConfig& gs_config) {
+    auto [it, new_shader] = fixed_geometry_shaders.try_emplace(gs_config, instance);
+    auto& shader = it->second;
+
+    if (new_shader) {
+        key_cache.AddGeometryShader(gs_config);
+        workers.QueueWork([gs_config, device = instance.GetDevice(), &shader]() {
+            const auto code = GLSL::GenerateFixedGeometryShader(gs_config, true);
+            shader.module = Compile(code, vk::ShaderStageFlagBits::eGeometry, device);
+            shader.MarkDone();
+        });
+    }
+
+    return shader;
+}
+
+Shader& PipelineCache::EmplaceFragmentShader(const FSConfig& fs_config) {
     const auto [it, new_shader] = fragment_shaders.try_emplace(fs_config, instance);
     auto& shader = it->second;
 
     if (new_shader) {
+        key_cache.AddFragmentShader(fs_config);
         workers.QueueWork([fs_config, this, &shader]() {
             const bool use_spirv = Settings::values.spirv_shader_gen.GetValue();
             if (use_spirv && !fs_config.UsesShadowPipeline()) {
@@ -467,8 +509,173 @@ void PipelineCache::UseFragmentShader(const Pica::RegsInternal& regs,
         });
     }
 
-    current_shaders[ProgramType::FS] = &shader;
-    shader_hashes[ProgramType::FS] = fs_config.Hash();
+    return shader;
+}
+
+GraphicsPipeline* PipelineCache::EmplacePipeline(
+    const PipelineInfo& info, const std::array<u64, MAX_SHADER_STAGES>& stage_hashes,
+    const std::array<Shader*, MAX_SHADER_STAGES>& stages) {
+    u64 shader_hash = 0;
+    for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+        shader_hash = Common::HashCombine(shader_hash, stage_hashes[i]);
+    }
+
+    const u64 info_hash = info.Hash(instance);
+    const u64 pipeline_hash = Common::HashCombine(shader_hash, info_hash);
+
+    auto [it, new_pipeline] = graphics_pipelines.try_emplace(pipeline_hash);
+    if (new_pipeline) {
+        key_cache.AddPipeline(info, stage_hashes);
+        it.value() = std::make_unique<GraphicsPipeline>(instance, renderpass_cache, info,
+                                                        *pipeline_cache, *pipeline_layout, stages,
+                                                        &workers);
+    }
+
+    return it->second.get();
+}
+
+void PipelineCache::BuildRecordedPipelines(const std::atomic_bool& stop_loading,
+                                           const VideoCore::DiskResourceLoadCallback& callback) {
+    const auto& vertex_keys = key_cache.GetVertexShaders();
+    const auto& geometry_keys = key_cache.GetGeometryShaders();
+    const auto& fragment_keys = key_cache.GetFragmentShaders();
+    const auto& pipeline_keys = key_cache.GetPipelines();
+
+    const std::size_t total =
+        vertex_keys.size() + geometry_keys.size() + fragment_keys.size() + pipeline_keys.size();
+    std::size_t built = 0;
+
+    // Work is queued in batches, so loading can be stopped and progress reported in between.
+    // The queued work is always waited for before giving up, as it refers to locals.
+    const std::size_t batch_size = workers.NumWorkers() * 4;
+    std::size_t batch = 0;
+    const auto finish_item = [&] {
+        ++built;
+        if (++batch < batch_size && built < total && !stop_loading) {
+            return true;
+        }
+        batch = 0;
+        workers.WaitForRequests();
+        if (callback) {
+            callback(VideoCore::LoadCallbackStage::Build, built, total);
+        }
+        return !stop_loading;
+    };
+
+    if (callback) {
+        callback(VideoCore::LoadCallbackStage::Build, 0, total);
+    }
+
+    // Decompiling the programs is the slow part of vertex shaders, so it runs on the workers.
+    // The results are added to the caches here, which are only used from this thread.
+    std::vector<std::pair<const PicaVSConfig*, std::vector<u32>>> vertex_shaders;
+    vertex_shaders.reserve(batch_size);
+    const auto emplace_vertex_shaders = [&] {
+        workers.WaitForRequests();
+        for (auto& [config, code] : vertex_shaders) {
+            EmplaceVertexShader(*config, std::move(code));
+        }
+        vertex_shaders.clear();
+    };
+    for (const auto& [hash, config] : vertex_keys) {
+        if (const auto* program = key_cache.FindProgram(config)) {
+            auto& entry = vertex_shaders.emplace_back(&config, std::vector<u32>{});
+            workers.QueueWork([this, program, vs_config = entry.first, &code = entry.second] {
+                auto setup = std::make_unique<Pica::ShaderSetup>();
+                setup->program_code = program->code;
+                setup->swizzle_data = program->swizzle;
+                code = GenerateVertexShader(*setup, *vs_config);
+            });
+            if (vertex_shaders.size() == batch_size) {
+                emplace_vertex_shaders();
+            }
+        }
+        if (!finish_item()) {
+            return;
+        }
+    }
+    emplace_vertex_shaders();
+
+    for (const auto& [hash, config] : geometry_keys) {
+        EmplaceGeometryShader(config);
+        if (!finish_item()) {
+            return;
+        }
+    }
+
+    for (const auto& [hash, config] : fragment_keys) {
+        EmplaceFragmentShader(config);
+        if (!finish_item()) {
+            return;
+        }
+    }
+
+    // Pipelines are built last, once the shaders they use are done.
+    workers.WaitForRequests();
+    const auto find_stage = [&](ProgramType type, u64 hash) -> std::optional<Shader*> {
+        switch (type) {
+        case ProgramType::VS: {
+            if (hash == 0) {
+                return &trivial_vertex_shader;
+            }
+            const auto key = vertex_keys.find(hash);
+            if (key == vertex_keys.end()) {
+                return std::nullopt;
+            }
+            const auto it = programmable_vertex_map.find(key->second);
+            if (it == programmable_vertex_map.end() || !it->second) {
+                return std::nullopt;
+            }
+            return it->second;
+        }
+        case ProgramType::GS: {
+            if (hash == 0) {
+                return nullptr;
+            }
+            const auto key = geometry_keys.find(hash);
+            if (key == geometry_keys.end()) {
+                return std::nullopt;
+            }
+            return &fixed_geometry_shaders.at(key->second);
+        }
+        case ProgramType::FS: {
+            const auto key = fragment_keys.find(hash);
+            if (key == fragment_keys.end()) {
+                return std::nullopt;
+            }
+            return &fragment_shaders.at(key->second);
+        }
+        default:
+            return std::nullopt;
+        }
+    };
+
+    std::size_t num_pipelines = 0;
+    for (const auto& [info, stage_hashes] : pipeline_keys) {
+        std::array<Shader*, MAX_SHADER_STAGES> stages{};
+        bool has_stages = true;
+        for (u32 i = 0; i < MAX_SHADER_STAGES; i++) {
+            const auto stage = find_stage(static_cast<ProgramType>(i), stage_hashes[i]);
+            has_stages &= stage.has_value();
+            stages[i] = stage.value_or(nullptr);
+        }
+        if (has_stages) {
+            GraphicsPipeline* const pipeline = EmplacePipeline(info, stage_hashes, stages);
+            if (!pipeline->IsDone()) {
+                pipeline->TryBuild(true);
+            }
+            ++num_pipelines;
+        }
+        if (!finish_item()) {
+            return;
+        }
+    }
+    workers.WaitForRequests();
+
+    LOG_INFO(Render_Vulkan, "Built {} shaders and {} pipelines from the title's pipeline keys",
+             programmable_vertex_cache.size() + fixed_geometry_shaders.size() +
+                 fragment_shaders.size(),
+             num_pipelines);
 }
 
 bool PipelineCache::IsCacheValid(std::span<const u8> data) const {
@@ -524,7 +731,8 @@ bool PipelineCache::EnsureDirectories() const {
     };
 
     return create_dir(FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir)) &&
-           create_dir(GetPipelineCacheDir());
+           create_dir(GetPipelineCacheDir()) &&
+           create_dir(GetPipelineCacheDir() + "transferable" + DIR_SEP);
 }
 
 std::string PipelineCache::GetPipelineCacheDir() const {
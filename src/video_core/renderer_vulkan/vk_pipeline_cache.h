@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <bitset>
 #include <tsl/robin_map.h>
 
+#include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/renderer_vulkan/vk_pipeline_key_cache.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 #include "video_core/shader/generator/pica_fs_config.h"
 #include "video_core/shader/generator/profile.h"
@@ -58,8 +61,13 @@ public:
         offsets[binding] = offset;
     }
 
-    /// Loads the pipeline cache stored to disk
-    void LoadDiskCache();
+    /// Loads the pipeline cache stored to disk and builds the pipelines recorded for the title
+    void LoadDiskCache(const std::atomic_bool& stop_loading,
+                       const VideoCore::DiskResourceLoadCallback& callback);
+
+    /// Loads the pipeline cache stored to disk and builds the pipelines recorded for program_id
+    void LoadDiskCache(u64 program_id, const std::atomic_bool& stop_loading,
+                       const VideoCore::DiskResourceLoadCallback& callback);
 
     /// Stores the generated pipeline cache to disk
     void SaveDiskCache();
@@ -83,10 +91,47 @@ public:
     /// Binds a fragment shader generated from PICA state
     void UseFragmentShader(const Pica::RegsInternal& regs, const Pica::Shader::UserConfig& user);
 
+    /// Returns the number of vertex, geometry and fragment shader configurations known
+    [[nodiscard]] std::size_t NumShaders() const {
+        return programmable_vertex_map.size() + fixed_geometry_shaders.size() +
+               fragment_shaders.size();
+    }
+
+    /// Returns the number of pipelines created or being created
+    [[nodiscard]] std::size_t NumPipelines() const {
+        return graphics_pipelines.size();
+    }
+
 private:
     /// Builds the rasterizer pipeline layout
     void BuildLayout();
 
+    /// Loads the driver pipeline cache and creates the pipeline cache object
+    void LoadDriverCache();
+
+    /// Builds the shaders and pipelines recorded by earlier sessions on the worker threads
+    void BuildRecordedPipelines(const std::atomic_bool& stop_loading,
+                                const VideoCore::DiskResourceLoadCallback& callback);
+
+    /// Generates SPIR-V for a programmable vertex shader. Returns an empty vector on failure.
+    std::vector<u32> GenerateVertexShader(
+        const Pica::ShaderSetup& setup, const Pica::Shader::Generator::PicaVSConfig& config) const;
+
+    /// Stores the vertex shader built from code for config, creating its module if it is new
+    Shader* EmplaceVertexShader(const Pica::Shader::Generator::PicaVSConfig& config,
+                                std::vector<u32> code);
+
+    /// Returns the geometry shader for config, queueing its creation if it is new
+    Shader& EmplaceGeometryShader(const Pica::Shader::Generator::PicaFixedGSConfig& config);
+
+    /// Returns the fragment shader for config, queueing its creation if it is new
+    Shader& EmplaceFragmentShader(const Pica::Shader::FSConfig& config);
+
+    /// Returns the pipeline for info and the given shaders, creating it if it is new
+    GraphicsPipeline* EmplacePipeline(const PipelineInfo& info,
+                                      const std::array<u64, MAX_SHADER_STAGES>& stage_hashes,
+                                      const std::array<Shader*, MAX_SHADER_STAGES>& stages);
+
     /// Returns true when the disk data can be used by the current driver
     bool IsCacheValid(std::span<const u8> cache_data) const;
 
@@ -123,6 +168,9 @@ private:
     std::unordered_map<Pica::Shader::Generator::PicaFixedGSConfig, Shader> fixed_geometry_shaders;
     std::unordered_map<Pica::Shader::FSConfig, Shader> fragment_shaders;
     Shader trivial_vertex_shader;
+
+    PipelineKeyCache key_cache;
+    std::string key_cache_path;
 };
 
 } // namespace Vulkan
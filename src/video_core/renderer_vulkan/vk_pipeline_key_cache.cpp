@@ -0,0 +1,275 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bit>
+#include <cstring>
+
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/loader/loader.h"
+#include "video_core/renderer_vulkan/vk_pipeline_key_cache.h"
+
+namespace Vulkan {
+
+namespace {
+
+constexpr u32 KEY_CACHE_MAGIC = Loader::MakeMagic('B', '3', 'P', 'K');
+
+/// Increase whenever the layout of the records or of the configs they hold changes
+constexpr u32 KEY_CACHE_VERSION = 1;
+
+struct FileHeader {
+    u32 magic;
+    u32 version;
+    // Guard against configs changing size without the version being bumped
+    u32 vs_config_size;
+    u32 gs_config_size;
+    u32 fs_config_size;
+    u32 pipeline_size;
+};
+
+constexpr FileHeader CURRENT_HEADER{
+    .magic = KEY_CACHE_MAGIC,
+    .version = KEY_CACHE_VERSION,
+    .vs_config_size = sizeof(PipelineKeyCache::VSConfig),
+    .gs_config_size = sizeof(PipelineKeyCache::GSConfig),
+    .fs_config_size = sizeof(PipelineKeyCache::FSConfig),
+    .pipeline_size = sizeof(PipelineKeyCache::Pipeline),
+};
+
+struct RecordHeader {
+    u8 type;
+    std::array<u8, 3> reserved;
+    u32 size;
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+static_assert(sizeof(PipelineKeyCache::Program) == sizeof(Pica::ProgramCode) +
+                                                       sizeof(Pica::SwizzleData),
+              "Program records are hashed as two consecutive arrays");
+
+template <typename T>
+std::span<const u8> AsBytes(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return {reinterpret_cast<const u8*>(&value), sizeof(T)};
+}
+
+/// The configs have no default constructor, so they are copied out of the record as a whole.
+template <typename T>
+T FromBytes(std::span<const u8> data) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    std::array<u8, sizeof(T)> bytes;
+    std::memcpy(bytes.data(), data.data(), sizeof(T));
+    return std::bit_cast<T>(bytes);
+}
+
+u64 ProgramKey(u64 program_hash, u64 swizzle_hash) {
+    return Common::HashCombine(program_hash, swizzle_hash);
+}
+
+} // Anonymous namespace
+
+bool PipelineKeyCache::Load(const std::string& path) {
+    Clear();
+
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "No pipeline keys found for title");
+        return false;
+    }
+
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render_Vulkan, "Error reading pipeline keys");
+        return false;
+    }
+
+    FileHeader header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(&header, &CURRENT_HEADER, sizeof(header)) != 0) {
+        LOG_INFO(Render_Vulkan, "Pipeline keys are from a different version, ignoring");
+        return false;
+    }
+
+    std::size_t offset = sizeof(FileHeader);
+    while (data.size() - offset >= sizeof(RecordHeader)) {
+        RecordHeader record;
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        const auto type = static_cast<RecordType>(record.type);
+        const std::size_t size = GetRecordSize(type);
+        if (size == 0 || record.size != size || data.size() - offset - sizeof(record) < size) {
+            break;
+        }
+        AddRecord(type, std::span{data}.subspan(offset + sizeof(record), size));
+        offset += sizeof(record) + size;
+    }
+
+    // A record cut short by a crash or an unknown record ends the file. Keep what was read before
+    // it and write the file again from the start on the next save.
+    rewrite_file = offset != data.size();
+    if (rewrite_file) {
+        LOG_WARNING(Render_Vulkan, "Pipeline keys are damaged after offset {:#x}", offset);
+        pending_records.assign(data.begin() + sizeof(FileHeader), data.begin() + offset);
+    }
+
+    LOG_INFO(Render_Vulkan,
+             "Loaded {} vertex, {} geometry, {} fragment shader and {} pipeline keys",
+             vertex_shaders.size(), geometry_shaders.size(), fragment_shaders.size(),
+             pipelines.size());
+    return true;
+}
+
+bool PipelineKeyCache::Save(const std::string& path) {
+    if (pending_records.empty() && !rewrite_file) {
+        return true;
+    }
+
+    FileUtil::IOFile file(path, rewrite_file ? "wb" : "ab");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Unable to open pipeline keys for writing");
+        return false;
+    }
+
+    if (rewrite_file) {
+        file.WriteObject(CURRENT_HEADER);
+    }
+    file.WriteBytes(pending_records.data(), pending_records.size());
+    if (!file.IsGood()) {
+        LOG_ERROR(Render_Vulkan, "Error writing pipeline keys");
+        file.Close();
+        FileUtil::Delete(path);
+        rewrite_file = true;
+        return false;
+    }
+
+    pending_records.clear();
+    rewrite_file = false;
+    return true;
+}
+
+void PipelineKeyCache::AddVertexShader(const VSConfig& config, const Pica::ShaderSetup& setup) {
+    const u64 program_key = ProgramKey(config.state.program_hash, config.state.swizzle_hash);
+    if (!programs.contains(program_key)) {
+        auto& program = programs[program_key];
+        program.code = setup.program_code;
+        program.swizzle = setup.swizzle_data;
+        AppendRecord(RecordType::Program, AsBytes(program));
+    }
+    if (AddRecord(RecordType::VertexShader, AsBytes(config))) {
+        AppendRecord(RecordType::VertexShader, AsBytes(config));
+    }
+}
+
+void PipelineKeyCache::AddGeometryShader(const GSConfig& config) {
+    if (AddRecord(RecordType::GeometryShader, AsBytes(config))) {
+        AppendRecord(RecordType::GeometryShader, AsBytes(config));
+    }
+}
+
+void PipelineKeyCache::AddFragmentShader(const FSConfig& config) {
+    if (AddRecord(RecordType::FragmentShader, AsBytes(config))) {
+        AppendRecord(RecordType::FragmentShader, AsBytes(config));
+    }
+}
+
+void PipelineKeyCache::AddPipeline(const PipelineInfo& info,
+                                   const std::array<u64, MAX_SHADER_STAGES>& shader_hashes) {
+    // Zero the padding so equal pipelines are stored once.
+    Pipeline pipeline;
+    std::memset(static_cast<void*>(&pipeline), 0, sizeof(pipeline));
+    std::memcpy(&pipeline.info, &info, sizeof(info));
+    pipeline.shader_hashes = shader_hashes;
+    // Dynamic state is set when drawing and does not change the pipeline that is built.
+    std::memset(static_cast<void*>(&pipeline.info.dynamic), 0, sizeof(pipeline.info.dynamic));
+
+    if (AddRecord(RecordType::Pipeline, AsBytes(pipeline))) {
+        AppendRecord(RecordType::Pipeline, AsBytes(pipeline));
+    }
+}
+
+const PipelineKeyCache::Program* PipelineKeyCache::FindProgram(const VSConfig& config) const {
+    const auto it = programs.find(ProgramKey(config.state.program_hash, config.state.swizzle_hash));
+    return it != programs.end() ? &it->second : nullptr;
+}
+
+std::size_t PipelineKeyCache::GetRecordSize(RecordType type) {
+    switch (type) {
+    case RecordType::Program:
+        return sizeof(Program);
+    case RecordType::VertexShader:
+        return sizeof(VSConfig);
+    case RecordType::GeometryShader:
+        return sizeof(GSConfig);
+    case RecordType::FragmentShader:
+        return sizeof(FSConfig);
+    case RecordType::Pipeline:
+        return sizeof(Pipeline);
+    }
+    return 0;
+}
+
+bool PipelineKeyCache::AddRecord(RecordType type, std::span<const u8> data) {
+    switch (type) {
+    case RecordType::Program: {
+        // The key is recomputed from the data, so a damaged program is never used for a config.
+        const u64 program_hash = Common::ComputeHash64(data.data(), sizeof(Pica::ProgramCode));
+        const u64 swizzle_hash = Common::ComputeHash64(data.data() + sizeof(Pica::ProgramCode),
+                                                       sizeof(Pica::SwizzleData));
+        const auto [it, added] = programs.try_emplace(ProgramKey(program_hash, swizzle_hash));
+        if (added) {
+            std::memcpy(&it->second, data.data(), sizeof(Program));
+        }
+        return added;
+    }
+    case RecordType::VertexShader: {
+        const auto config = FromBytes<VSConfig>(data);
+        return vertex_shaders.try_emplace(config.Hash(), config).second;
+    }
+    case RecordType::GeometryShader: {
+        const auto config = FromBytes<GSConfig>(data);
+        return geometry_shaders.try_emplace(config.Hash(), config).second;
+    }
+    case RecordType::FragmentShader: {
+        const auto config = FromBytes<FSConfig>(data);
+        return fragment_shaders.try_emplace(config.Hash(), config).second;
+    }
+    case RecordType::Pipeline: {
+        const u64 key = Common::ComputeHash64(data.data(), data.size());
+        if (!pipeline_keys.insert(key).second) {
+            return false;
+        }
+        std::memcpy(&pipelines.emplace_back(), data.data(), sizeof(Pipeline));
+        return true;
+    }
+    }
+    return false;
+}
+
+void PipelineKeyCache::AppendRecord(RecordType type, std::span<const u8> data) {
+    const RecordHeader record{
+        .type = static_cast<u8>(type),
+        .reserved = {},
+        .size = static_cast<u32>(data.size()),
+    };
+    const auto header = AsBytes(record);
+    pending_records.insert(pending_records.end(), header.begin(), header.end());
+    pending_records.insert(pending_records.end(), data.begin(), data.end());
+}
+
+void PipelineKeyCache::Clear() {
+    programs.clear();
+    vertex_shaders.clear();
+    geometry_shaders.clear();
+    fragment_shaders.clear();
+    pipeline_keys.clear();
+    pipelines.clear();
+    pending_records.clear();
+    rewrite_file = true;
+}
+
+} // namespace Vulkan
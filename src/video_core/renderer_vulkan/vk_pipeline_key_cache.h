@@ -0,0 +1,107 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "video_core/pica/shader_setup.h"
+#include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/shader/generator/pica_fs_config.h"
+#include "video_core/shader/generator/shader_gen.h"
+
+namespace Vulkan {
+
+/**
+ * Records the shader configurations and pipelines a title uses, so they can be built when it
+ * boots instead of on first use. Unlike the driver pipeline cache, the keys do not depend on the
+ * GPU and can be shared between devices.
+ *
+ * Save only appends the keys found since the last Load or Save, so the file is not rewritten at
+ * the end of every session.
+ */
+class PipelineKeyCache {
+public:
+    struct Program {
+        Pica::ProgramCode code;
+        Pica::SwizzleData swizzle;
+    };
+
+    struct Pipeline {
+        PipelineInfo info;
+        std::array<u64, MAX_SHADER_STAGES> shader_hashes;
+    };
+
+    using VSConfig = Pica::Shader::Generator::PicaVSConfig;
+    using GSConfig = Pica::Shader::Generator::PicaFixedGSConfig;
+    using FSConfig = Pica::Shader::FSConfig;
+
+    /// Reads the keys stored at path. Returns false if there is no usable file.
+    bool Load(const std::string& path);
+
+    /// Appends the keys added since the last Load or Save to the file at path.
+    bool Save(const std::string& path);
+
+    void AddVertexShader(const VSConfig& config, const Pica::ShaderSetup& setup);
+    void AddGeometryShader(const GSConfig& config);
+    void AddFragmentShader(const FSConfig& config);
+    void AddPipeline(const PipelineInfo& info,
+                     const std::array<u64, MAX_SHADER_STAGES>& shader_hashes);
+
+    /// Returns the program the vertex shader was generated from.
+    [[nodiscard]] const Program* FindProgram(const VSConfig& config) const;
+
+    [[nodiscard]] const std::unordered_map<u64, VSConfig>& GetVertexShaders() const {
+        return vertex_shaders;
+    }
+
+    [[nodiscard]] const std::unordered_map<u64, GSConfig>& GetGeometryShaders() const {
+        return geometry_shaders;
+    }
+
+    [[nodiscard]] const std::unordered_map<u64, FSConfig>& GetFragmentShaders() const {
+        return fragment_shaders;
+    }
+
+    [[nodiscard]] const std::vector<Pipeline>& GetPipelines() const {
+        return pipelines;
+    }
+
+private:
+    enum class RecordType : u8 {
+        Program,
+        VertexShader,
+        GeometryShader,
+        FragmentShader,
+        Pipeline,
+    };
+
+    /// Returns the payload size of a record type, or zero if the type is unknown.
+    static std::size_t GetRecordSize(RecordType type);
+
+    /// Adds the key held by a record. Returns false if the key is already known.
+    bool AddRecord(RecordType type, std::span<const u8> data);
+
+    /// Queues a record to be written on the next Save.
+    void AppendRecord(RecordType type, std::span<const u8> data);
+
+    void Clear();
+
+    std::unordered_map<u64, Program> programs;
+    std::unordered_map<u64, VSConfig> vertex_shaders;
+    std::unordered_map<u64, GSConfig> geometry_shaders;
+    std::unordered_map<u64, FSConfig> fragment_shaders;
+    std::unordered_set<u64> pipeline_keys;
+    std::vector<Pipeline> pipelines;
+
+    std::vector<u8> pending_records; ///< Records not yet in the file
+    bool rewrite_file = true;        ///< Whether the file has to be written from the start
+};
+
+} // namespace Vulkan